@@ -27,6 +27,7 @@ using namespace std;
 #include <iostream>
 #include <string.h>
 #include <vector>
+#include <atomic>
 #include <openssl/sha.h>
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -115,6 +116,69 @@ main(int argc, char* argv[])
 
 NS_LOG_COMPONENT_DEFINE("ChordRun");
 
+//Capacity of command queue (power of two)
+#define DEFAULT_COMMAND_QUEUE_SIZE 4096
+//Script commands are scheduled this far (ms) ahead of simulator time
+#define DEFAULT_SCRIPT_WINDOW 1000
+//Read buffer of script file
+#define DEFAULT_SCRIPT_BUFFER_SIZE (1 << 20)
+
+/**
+ *  \brief Lock-free single producer single consumer queue
+ *
+ *  Command thread pushes command lines, simulator thread pops them. Each side only writes its own index, slot contents
+ *  are published by release store of producer index and handed back by release store of consumer index.
+ */
+template <typename T>
+class CommandQueue
+{
+  public:
+    CommandQueue (uint32_t size)
+      : m_slots (size),
+        m_mask (size - 1),
+        m_head (0),
+        m_tail (0)
+    {
+      NS_ASSERT ((size & m_mask) == 0);
+    }
+    /**
+     *  \brief Appends item (producer thread only)
+     *  \returns false if queue is full
+     */
+    bool Push (const T &item)
+    {
+      uint32_t tail = m_tail.load (std::memory_order_relaxed);
+      if (tail - m_head.load (std::memory_order_acquire) == m_slots.size ())
+      {
+        return false;
+      }
+      m_slots[tail & m_mask] = item;
+      m_tail.store (tail + 1, std::memory_order_release);
+      return true;
+    }
+    /**
+     *  \brief Removes oldest item (consumer thread only)
+     *  \returns false if queue is empty
+     */
+    bool Pop (T &item)
+    {
+      uint32_t head = m_head.load (std::memory_order_relaxed);
+      if (head == m_tail.load (std::memory_order_acquire))
+      {
+        return false;
+      }
+      item.swap (m_slots[head & m_mask]);
+      m_head.store (head + 1, std::memory_order_release);
+      return true;
+    }
+
+  private:
+    std::vector<T> m_slots;
+    uint32_t m_mask;
+    std::atomic<uint32_t> m_head;
+    std::atomic<uint32_t> m_tail;
+};
+
 struct CommandHandlerArgument
 {
   std::string scriptFile;
@@ -126,6 +190,7 @@ class ChordRun
 {
 
  public:
+    ChordRun ();
 
     void Start (std::string scriptFile, NodeContainer nodeContainer);
     void Stop ();
@@ -148,9 +213,9 @@ class ChordRun
     void JoinSuccess (std::string vNodeName, uint8_t* key, uint8_t numBytes);
     void LookupSuccess (uint8_t* lookupKey, uint8_t lookupKeyBytes, Ipv4Address ipAddress, uint16_t port);
     void LookupFailure (uint8_t* lookupKey, uint8_t lookupKeyBytes);
-    void InsertSuccess (uint8_t* key, uint8_t numBytes, uint8_t* object, uint32_t objectBytes);
-    void RetrieveSuccess (uint8_t* key, uint8_t numBytes, uint8_t* object, uint32_t objectBytes);
-    void InsertFailure (uint8_t* key, uint8_t numBytes, uint8_t* object, uint32_t objectBytes);
+    void InsertSuccess (uint8_t* key, uint8_t numBytes, Ptr<const Packet> object);
+    void RetrieveSuccess (uint8_t* key, uint8_t numBytes, Ptr<const Packet> object);
+    void InsertFailure (uint8_t* key, uint8_t numBytes, Ptr<const Packet> object);
     void RetrieveFailure (uint8_t* key, uint8_t numBytes);
     void VNodeKeyOwnership (std::string vNodeName, uint8_t* key, uint8_t keyBytes, uint8_t* predecessorKey, uint8_t predecessorKeyBytes
 			   ,uint8_t* oldPredecessorKey, uint8_t oldPredecessorKeyBytes, Ipv4Address predecessorIp, uint16_t predecessorPort);
@@ -165,8 +230,12 @@ class ChordRun
     //Keyboard Handlers
     static void *CommandHandler (void *arg);
     void Tokenize(const std::string& str, std::vector<std::string>& tokens, const std::string& delimiters);
-    void ProcessCommandTokens (std::vector<std::string> tokens, Time time);
-    void ReadCommandTokens (void);
+    void ProcessCommandTokens (const std::vector<std::string> &tokens, Time time);
+    void SubmitCommand (const std::string &commandLine);
+    void DrainCommands (void);
+
+    //Script Loader
+    void LoadScript (void);
 
 
     pthread_t commandHandlerThreadId;
@@ -177,10 +246,18 @@ class ChordRun
     std::string m_scriptFile;
     NodeContainer m_nodeContainer;
     std::vector<std::string> m_tokens;
-    bool m_readyToRead;
+    //Commands from command thread
+    CommandQueue<std::string> m_commandQueue;
+    std::atomic<bool> m_drainScheduled;
+    //Script being streamed
+    std::ifstream m_scriptStream;
+    std::vector<char> m_scriptBuffer;
+    Time m_scriptTime;
+    uint64_t m_scriptCommands;
     
     //Print
     void PrintCharArray (uint8_t*, uint32_t, std::ostream&);
+    void PrintCharArray (Ptr<const Packet>, std::ostream&);
     void PrintHexArray (uint8_t*, uint32_t, std::ostream&);
 
 };
@@ -196,53 +273,21 @@ class ChordRun
   this->m_chordRun = this;
   this->m_nodeContainer = nodeContainer;
 
-  m_readyToRead = false;
   //process script-file
   if (scriptFile != "")                                 //Start reading the script file.....if not null
   {
-    std::ifstream file;
-    file.open (scriptFile.c_str());
-    if (file.is_open())
+    m_scriptBuffer.resize (DEFAULT_SCRIPT_BUFFER_SIZE);
+    m_scriptStream.rdbuf ()->pubsetbuf (&m_scriptBuffer[0], m_scriptBuffer.size ());
+    m_scriptStream.open (scriptFile.c_str());
+    if (m_scriptStream.is_open())
     {
       NS_LOG_INFO ("Reading Script File: " << scriptFile);
-      Time time = MilliSeconds (0.0);
-      std::string commandLine;
-      while (!file.eof())
-      {
-        std::getline (file, commandLine, '\n');
-        deout << "Adding Command: " << commandLine << std::endl;
-        m_chordRun->Tokenize (commandLine, m_chordRun -> m_tokens, " ");
-        if (m_chordRun -> m_tokens.size() == 0)
-        {
-          NS_LOG_INFO ("Failed to Tokenize");
-          continue;
-        }
-        //check for time command
-        std::vector<std::string>::iterator iterator = m_chordRun -> m_tokens.begin();
-        if (*iterator == "Time")
-        {
-          if (m_chordRun -> m_tokens.size() < 2)
-          {
-            continue;
-          }
-          iterator++;
-          std::istringstream sin (*iterator);
-          uint64_t delta;
-          sin >> delta;
-          time = MilliSeconds( time.GetMilliSeconds() + delta);
-          deout << "Time Pointer: " << time.GetMilliSeconds() << std::endl;
-          m_chordRun -> m_tokens.clear();
-          continue;
-        }
-        NS_LOG_INFO ("Processing...");
-        m_chordRun->ProcessCommandTokens (m_chordRun -> m_tokens, MilliSeconds(time.GetMilliSeconds()));
-        m_chordRun -> m_tokens.clear();
-      }
+      m_scriptTime = MilliSeconds (0.0);
+      m_scriptCommands = 0;
+      LoadScript ();
     }
   }
 
-    Simulator::Schedule (MilliSeconds (200), &ChordRun::ReadCommandTokens, this);
-
    if (pthread_create (&commandHandlerThreadId, NULL, ChordRun::CommandHandler, &th_argument) != 0)
    {
      perror ("New Thread Creation Failed, Exiting...");
@@ -446,29 +491,31 @@ sdfout <<cache_ndn;
 
 }
     //std::getline(std::cin, commandLine, '\n');
-    if (chordRun->m_readyToRead == true)
-    {
-      deout << "Simulator busy, please try again..\n";
-      continue;
-    }
-
-    chordRun->Tokenize (commandLine, chordRun -> m_tokens, " ");
-
-    std::vector<std::string>::iterator iterator = chordRun -> m_tokens.begin();
-
-    if (chordRun -> m_tokens.size() == 0)
+    //Buffer may carry several commands, one per line
+    std::vector<std::string> commandLines;
+    chordRun->Tokenize (commandLine, commandLines, "\r\n");
+    std::vector<std::string> tokens;
+    for (std::vector<std::string>::iterator lineIter = commandLines.begin(); lineIter != commandLines.end(); lineIter++)
     {
-      continue;
+      tokens.clear();
+      chordRun->Tokenize (*lineIter, tokens, " ");
+      if (tokens.size() == 0)
+      {
+        continue;
+      }
+      //check for quit
+      else if (tokens.front() == "quit")
+      {
+        isExit = true;
+        break;
+      }
+      //SINGLE THREADED SIMULATOR WILL CRASH, so let simulator schedule processcommandtokens!
+      chordRun->SubmitCommand (*lineIter);
     }
-    //check for quit
-    else if (*iterator == "quit")
+    if (isExit)
     {
       break;
     }
-    chordRun -> m_readyToRead = true;
-    //sleep(1);
-    //SINGLE THREADED SIMULATOR WILL CRASH, so let simulator schedule processcommandtokens!
-    //chordRun->ProcessCommandTokens (tokens, MilliSeconds (0.));
 
   //}
 ////sever part finish
@@ -531,29 +578,102 @@ cout << cstr << endl;
   pthread_exit (NULL);
 }
 
+ChordRun::ChordRun ()
+  : m_commandQueue (DEFAULT_COMMAND_QUEUE_SIZE),
+    m_drainScheduled (false),
+    m_scriptCommands (0)
+{
+}
+
+/*  Logic: Called from command thread. Command line goes into lock-free queue, and simulator is woken up once per burst:
+ *  only the submitter which flips m_drainScheduled schedules DrainCommands (ScheduleWithContext is safe to call from another
+ *  thread). DrainCommands clears flag before popping, so a command pushed while draining either gets popped or schedules
+ *  next drain.
+ */
+
 void
-ChordRun::ReadCommandTokens (void)
+ChordRun::SubmitCommand (const std::string &commandLine)
 {
-  if (m_readyToRead == true)
+  while (!m_commandQueue.Push (commandLine))
+  {
+    //Simulator lagging behind, wait for it to drain queue
+    usleep (1000);
+  }
+  if (!m_drainScheduled.exchange (true))
   {
+    Simulator::ScheduleWithContext (Simulator::NO_CONTEXT, Seconds (0.0), &ChordRun::DrainCommands, this);
+  }
+}
 
+void
+ChordRun::DrainCommands (void)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  m_drainScheduled.store (false);
+  std::string commandLine;
+  while (m_commandQueue.Pop (commandLine))
+  {
+    m_tokens.clear();
+    Tokenize (commandLine, m_tokens, " ");
     if (m_tokens.size() > 0)
     {
-      m_chordRun->ProcessCommandTokens (m_tokens, MilliSeconds (0.0));
+      ProcessCommandTokens (m_tokens, MilliSeconds (0.0));
     }
-    m_tokens.clear();
-    m_readyToRead = false;
   }
-  Simulator::Schedule (MilliSeconds (200), &ChordRun::ReadCommandTokens, this);
+  m_tokens.clear();
+}
 
+/*  Logic: Script is streamed, not loaded whole. Each pass schedules commands up to DEFAULT_SCRIPT_WINDOW ahead of simulator
+ *  time (a "Time <delta>" line advances time pointer), then schedules next pass for when time pointer comes into window.
+ *  Simulator event queue therefore holds about one window of script commands however long script is.
+ */
+
+void
+ChordRun::LoadScript (void)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  Time horizon = Simulator::Now () + MilliSeconds (DEFAULT_SCRIPT_WINDOW);
+  std::string commandLine;
+  while (m_scriptTime <= horizon && std::getline (m_scriptStream, commandLine))
+  {
+    m_tokens.clear();
+    Tokenize (commandLine, m_tokens, " \r");
+    if (m_tokens.size() == 0)
+    {
+      continue;
+    }
+    //check for time command
+    if (m_tokens.front() == "Time")
+    {
+      if (m_tokens.size() < 2)
+      {
+        continue;
+      }
+      std::istringstream sin (m_tokens[1]);
+      uint64_t delta;
+      sin >> delta;
+      m_scriptTime = MilliSeconds (m_scriptTime.GetMilliSeconds() + delta);
+      continue;
+    }
+    ProcessCommandTokens (m_tokens, m_scriptTime - Simulator::Now ());
+    m_scriptCommands++;
+  }
+  m_tokens.clear();
+  if (m_scriptStream.good())
+  {
+    Simulator::Schedule (m_scriptTime - horizon, &ChordRun::LoadScript, this);
+    return;
+  }
+  NS_LOG_INFO ("Script loaded, " << m_scriptCommands << " commands");
+  m_scriptStream.close();
 }
 
 void
-ChordRun::ProcessCommandTokens (std::vector<std::string> tokens, Time time)
+ChordRun::ProcessCommandTokens (const std::vector<std::string> &tokens, Time time)
 {
   NS_LOG_INFO ("Processing Command Token...");
   //Process tokens
-  std::vector<std::string>::iterator iterator = tokens.begin();
+  std::vector<std::string>::const_iterator iterator = tokens.begin();
 
   std::istringstream sin (*iterator);
   uint16_t nodeNumber;
@@ -608,6 +728,12 @@ deout<<"stop  ";
     Simulator::Schedule (MilliSeconds(time.GetMilliSeconds()), &ChordRun::DumpDHashInfo, this, chordApplication);
   }
 
+  else if (*iterator == "AuditDHash")
+  {
+    NS_LOG_INFO ("Scheduling Command AuditDHash...");
+    Simulator::Schedule (MilliSeconds(time.GetMilliSeconds()), &ChordIpv4::AuditDHashObjects, chordApplication);
+  }
+
   else if (*iterator == "TraceRing")
   {
     if (tokens.size() < 3)
@@ -879,40 +1005,42 @@ ChordRun::VNodeFailure (std::string vNodeName, uint8_t* key, uint8_t numBytes)
 }
 
 void
-ChordRun::InsertSuccess (uint8_t* key, uint8_t numBytes, uint8_t* object, uint32_t objectBytes)
+ChordRun::InsertSuccess (uint8_t* key, uint8_t numBytes, Ptr<const Packet> object)
 { 
   NS_LOG_FUNCTION_NOARGS();
   deout << "\nCurrent Simulation Time: " << Simulator::Now ().GetMilliSeconds() << std::endl;
   deout << "Insert Success!";
   PrintHexArray (key, numBytes, deout);
-  PrintCharArray (object, objectBytes, deout);
+  PrintCharArray (object, deout);
 }
 
 void
-ChordRun::RetrieveSuccess (uint8_t* key, uint8_t numBytes, uint8_t* object, uint32_t objectBytes)
+ChordRun::RetrieveSuccess (uint8_t* key, uint8_t numBytes, Ptr<const Packet> object)
 { //inode/directory
 ///
 std::ofstream out("D:\\hello.txt", std::ios::app);
     if (out.is_open())
     {
-        out << "        YES" <<"       "<<object << std::endl;
+        std::string value (object->GetSize (), '\0');
+        object->CopyData ((uint8_t*) &value[0], value.size ());
+        out << "        YES" <<"       "<<value.c_str () << std::endl;
     }
 ///
   NS_LOG_FUNCTION_NOARGS();
   deout << "\nCurrent Simulation Time: " << Simulator::Now ().GetMilliSeconds() << std::endl;
   deout << "Retrieve Success!";
   PrintHexArray (key, numBytes, deout);
-  PrintCharArray (object, objectBytes, deout);
+  PrintCharArray (object, deout);
 }
 
 void
-ChordRun::InsertFailure (uint8_t* key, uint8_t numBytes, uint8_t* object, uint32_t objectBytes)
+ChordRun::InsertFailure (uint8_t* key, uint8_t numBytes, Ptr<const Packet> object)
 {
   NS_LOG_FUNCTION_NOARGS();
   deout << "\nCurrent Simulation Time: " << Simulator::Now ().GetMilliSeconds() << std::endl;
   deout << "Insert Failure Reported...";
   PrintHexArray (key, numBytes, deout);
-  PrintCharArray (object, objectBytes, deout);
+  PrintCharArray (object, deout);
 }
 
 void
@@ -970,6 +1098,14 @@ ChordRun::PrintCharArray (uint8_t* array, uint32_t size, std::ostream &os)
   os << "\n";
 }
 
+void
+ChordRun::PrintCharArray (Ptr<const Packet> packet, std::ostream &os)
+{
+  std::vector<uint8_t> array (packet->GetSize ());
+  packet->CopyData (array.size () ? &array[0] : 0, array.size ());
+  PrintCharArray (array.size () ? &array[0] : 0, array.size (), os);
+}
+
 void
 ChordRun::PrintHexArray (uint8_t* array, uint32_t size, std::ostream &os)
 {
@@ -993,6 +1129,7 @@ std::ofstream out("D:\\hello.txt", std::ios::out);
 std::ofstream dout("C:\\hello.txt", std::ios::out);
 //
    uint16_t nodes=100;
+   int argCount = argc;
    argc=3;
    
    uint16_t bootStrapNodeNum=1;
@@ -1033,7 +1170,8 @@ std::ofstream dout("C:\\hello.txt", std::ios::out);
    // run-time, via command-line arguments
    //
    CommandLine cmd;
-   //cmd.Parse (argc, argv);
+   cmd.AddValue ("script", "Script file of timestamped commands, streamed into simulator", scriptFile);
+   cmd.Parse (argCount, argv);
 
 
    //
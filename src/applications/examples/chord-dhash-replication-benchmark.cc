@@ -0,0 +1,292 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// DHash retrieve latency under churn for different replication factors.
+//
+// Same topology as chord-run (ChordBenchmarkHelper CSMA segment, one vnode
+// per node). After the ring has stabilized, objects are inserted from random
+// nodes. Random nodes then crash (ChordBenchmarkHelper::Crash, interfaces go
+// down) at a fixed rate, while surviving nodes keep retrieving random objects. The
+// run is repeated for DHashReplicationFactor 1..maxReplicas and retrieve
+// latency percentiles are reported per run. With --fragments=m, runs with
+// r > m store erasure coded fragments instead of whole copies.
+//
+// ./waf --run "chord-dhash-replication-benchmark --nodes=8 --maxReplicas=4"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/chord-benchmark-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordDHashReplicationBenchmark");
+
+struct BenchmarkConfig
+{
+  uint32_t nodes;
+  uint32_t objects;
+  double retrieveRate;
+  double crashInterval;
+  double duration;
+  Time auditInterval;
+  uint32_t dataFragments;
+};
+
+class ReplicationRun
+{
+public:
+  ReplicationRun (BenchmarkConfig &config, uint8_t replicationFactor)
+    : m_config (config),
+      m_replicationFactor (replicationFactor),
+      m_benchmark (GetBenchmarkConfig (config)),
+      m_inserted (0),
+      m_insertFailures (0),
+      m_retrieveFailures (0),
+      m_crashed (0)
+  {
+  }
+
+  void Run (void)
+  {
+    NodeContainer nodeContainer;
+    nodeContainer.Create (m_config.nodes);
+    std::vector<Ipv4Address> addresses = ChordBenchmarkHelper::BuildCsma (nodeContainer, MicroSeconds (500));
+
+    m_benchmark.SetAttribute ("DHashEnable", BooleanValue (true));
+    m_benchmark.SetAttribute ("DHashReplicationFactor", UintegerValue (m_replicationFactor));
+    m_benchmark.SetAttribute ("DHashAuditObjectsTimeout", TimeValue (m_config.auditInterval));
+    m_benchmark.SetAttribute ("DHashDataFragments", UintegerValue (m_config.dataFragments));
+    int64_t stream = m_benchmark.AssignStreams (1) + 1;
+    ApplicationContainer applications = m_benchmark.Install (nodeContainer, addresses);
+    for (uint32_t j = 0; j < applications.GetN (); j++)
+      {
+        Ptr<ChordIpv4> chordApplication = DynamicCast<ChordIpv4> (applications.Get (j));
+        chordApplication->SetInsertSuccessCallback (MakeCallback (&ReplicationRun::InsertSuccess, this));
+        chordApplication->SetInsertFailureCallback (MakeCallback (&ReplicationRun::InsertFailure, this));
+        chordApplication->SetRetrieveSuccessCallback (MakeBoundCallback (&ReplicationRun::RetrieveSuccess, this, j));
+        chordApplication->SetRetrieveFailureCallback (MakeBoundCallback (&ReplicationRun::RetrieveFailure, this, j));
+        m_applications.push_back (chordApplication);
+      }
+    m_random = CreateObject<UniformRandomVariable> ();
+    m_random->SetStream (stream);
+
+    //Store objects once ring has settled
+    Time insertStart = m_benchmark.GetStartTime ();
+    for (uint32_t k = 0; k < m_config.objects; k++)
+      {
+        uint8_t key[ChordKey::NUM_BYTES];
+        for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+          {
+            key[b] = m_random->GetInteger (0, 255);
+          }
+        m_keys.push_back (ChordKey (key));
+        Simulator::Schedule (insertStart + Seconds (m_random->GetValue (0, 10)), &ReplicationRun::Insert, this, k);
+      }
+    //Churn and retrieval
+    m_churnStart = insertStart + Seconds (30);
+    Simulator::Schedule (m_churnStart, &ReplicationRun::Crash, this);
+    Simulator::Schedule (m_churnStart, &ReplicationRun::Retrieve, this);
+    Simulator::Stop (m_benchmark.GetStopTime ());
+    Simulator::Run ();
+    Report ();
+    Simulator::Destroy ();
+  }
+
+private:
+  static ChordBenchmarkConfig GetBenchmarkConfig (BenchmarkConfig &config)
+  {
+    ChordBenchmarkConfig benchmarkConfig;
+    benchmarkConfig.settle = Seconds (10);
+    benchmarkConfig.duration = Seconds (30 + config.duration);
+    benchmarkConfig.drain = Seconds (30);
+    benchmarkConfig.lookupRate = 0;
+    return benchmarkConfig;
+  }
+  void Insert (uint32_t objectIndex)
+  {
+    uint8_t object[256];
+    for (uint32_t b = 0; b < sizeof (object); b++)
+      {
+        object[b] = (uint8_t) objectIndex;
+      }
+    uint32_t nodeIndex;
+    if (m_benchmark.PickNode (false, true, nodeIndex))
+      {
+        m_applications[nodeIndex]->Insert (m_keys[objectIndex], object, sizeof (object));
+      }
+  }
+  void Crash (void)
+  {
+    if (Simulator::Now () > m_churnStart + Seconds (m_config.duration))
+      {
+        return;
+      }
+    //Never crash bootstrap node, keep half the ring up
+    uint32_t nodeIndex;
+    if (m_crashed < m_config.nodes / 2 && m_benchmark.PickNode (false, false, nodeIndex))
+      {
+        m_benchmark.Crash (nodeIndex);
+        m_crashed++;
+        //Outstanding retrieves of crashed node are lost
+        m_pending.erase (m_pending.lower_bound (std::make_pair (nodeIndex, 0)), m_pending.lower_bound (std::make_pair (nodeIndex + 1, 0)));
+      }
+    Simulator::Schedule (Seconds (m_config.crashInterval), &ReplicationRun::Crash, this);
+  }
+  void Retrieve (void)
+  {
+    if (Simulator::Now () > m_churnStart + Seconds (m_config.duration))
+      {
+        return;
+      }
+    uint32_t nodeIndex;
+    uint32_t objectIndex = m_random->GetInteger (0, m_keys.size () - 1);
+    if (m_benchmark.PickNode (false, true, nodeIndex))
+      {
+        std::pair<uint32_t, uint32_t> request = std::make_pair (nodeIndex, objectIndex);
+        if (m_pending.find (request) == m_pending.end ())
+          {
+            m_pending[request] = Simulator::Now ();
+            m_applications[nodeIndex]->Retrieve (m_keys[objectIndex]);
+          }
+      }
+    Simulator::Schedule (Seconds (1.0 / m_config.retrieveRate), &ReplicationRun::Retrieve, this);
+  }
+  bool FindRequest (uint32_t nodeIndex, uint8_t *key, std::map<std::pair<uint32_t, uint32_t>, Time>::iterator &iter)
+  {
+    ChordKey chordKey (key);
+    for (iter = m_pending.lower_bound (std::make_pair (nodeIndex, 0)); iter != m_pending.end () && iter->first.first == nodeIndex; iter++)
+      {
+        if (m_keys[iter->first.second] == chordKey)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+  void InsertSuccess (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    m_inserted++;
+  }
+  void InsertFailure (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    m_insertFailures++;
+  }
+  static void RetrieveSuccess (ReplicationRun *run, uint32_t nodeIndex, uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    std::map<std::pair<uint32_t, uint32_t>, Time>::iterator iter;
+    if (run->FindRequest (nodeIndex, key, iter))
+      {
+        run->m_latencies.push_back ((Simulator::Now () - iter->second).GetSeconds () * 1000.0);
+        run->m_pending.erase (iter);
+      }
+  }
+  static void RetrieveFailure (ReplicationRun *run, uint32_t nodeIndex, uint8_t *key, uint8_t keyBytes)
+  {
+    std::map<std::pair<uint32_t, uint32_t>, Time>::iterator iter;
+    if (run->FindRequest (nodeIndex, key, iter))
+      {
+        run->m_retrieveFailures++;
+        run->m_pending.erase (iter);
+      }
+  }
+  void Report (void)
+  {
+    std::sort (m_latencies.begin (), m_latencies.end ());
+    double p50 = 0, p99 = 0;
+    if (m_latencies.size ())
+      {
+        p50 = m_latencies[m_latencies.size () / 2];
+        p99 = m_latencies[std::min<size_t> (m_latencies.size () - 1, m_latencies.size () * 99 / 100)];
+      }
+    std::cout << std::setw (4) << (uint16_t) m_replicationFactor
+              << std::setw (10) << m_inserted
+              << std::setw (8) << m_crashed
+              << std::setw (10) << m_latencies.size ()
+              << std::setw (10) << m_retrieveFailures
+              << std::setw (10) << m_pending.size ()
+              << std::setw (12) << p50
+              << std::setw (12) << p99 << std::endl;
+  }
+
+  BenchmarkConfig &m_config;
+  uint8_t m_replicationFactor;
+  ChordBenchmarkHelper m_benchmark;
+  Ptr<UniformRandomVariable> m_random;
+  std::vector<Ptr<ChordIpv4> > m_applications;
+  std::vector<ChordKey> m_keys;
+  //(node, object) -> retrieve start time
+  std::map<std::pair<uint32_t, uint32_t>, Time> m_pending;
+  std::vector<double> m_latencies;
+  Time m_churnStart;
+  uint32_t m_inserted;
+  uint32_t m_insertFailures;
+  uint32_t m_retrieveFailures;
+  uint32_t m_crashed;
+};
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.nodes = 8;
+  config.objects = 200;
+  config.retrieveRate = 20;
+  config.crashInterval = 10;
+  config.duration = 120;
+  uint32_t auditInterval = 60000;
+  uint32_t maxReplicas = 4;
+  config.dataFragments = 0;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of chord nodes", config.nodes);
+  cmd.AddValue ("objects", "Number of objects inserted before churn", config.objects);
+  cmd.AddValue ("rate", "Retrieves per second (whole ring)", config.retrieveRate);
+  cmd.AddValue ("crashInterval", "Seconds between node crashes", config.crashInterval);
+  cmd.AddValue ("duration", "Seconds of churn and retrieval", config.duration);
+  cmd.AddValue ("audit", "DHash audit interval in milli seconds", auditInterval);
+  cmd.AddValue ("maxReplicas", "Largest replication factor to run", maxReplicas);
+  cmd.AddValue ("fragments", "Erasure code objects, any this many of r fragments rebuild object (0 stores whole copies)", config.dataFragments);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+  config.auditInterval = MilliSeconds (auditInterval);
+  Config::SetDefault ("ns3::CsmaNetDevice::Mtu", UintegerValue (1400));
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (4) << "r"
+            << std::setw (10) << "inserted"
+            << std::setw (8) << "crashed"
+            << std::setw (10) << "retrieved"
+            << std::setw (10) << "failed"
+            << std::setw (10) << "stalled"
+            << std::setw (12) << "p50(ms)"
+            << std::setw (12) << "p99(ms)" << std::endl;
+  for (uint32_t r = 1; r <= maxReplicas; r++)
+    {
+      RngSeedManager::SetSeed (seed);
+      ReplicationRun run (config, r);
+      run.Run ();
+    }
+  return 0;
+}
@@ -0,0 +1,238 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Heap allocation and time per operation for 160-bit Chord identifiers.
+//
+// Measures the identifier work done for one lookup: creating the requested
+// ChordIdentifier, packing a LOOKUP_REQ ChordMessage and parsing it into a
+// ChordMessageView as ChordIpv4 does on receive, and resolving the next hop
+// in a 160 entry finger table. The same ring arithmetic is then run on the
+// ChordKey value type.
+//
+// Allocations are counted by replacing global operator new and, on glibc,
+// malloc. operator new takes memory from __libc_malloc, so each allocation
+// is counted once.
+//
+// ./waf --run "chord-identifier-benchmark --iterations=100000"
+
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/chord-identifier.h"
+#include "ns3/chord-key.h"
+#include "ns3/chord-node.h"
+#include "ns3/chord-vnode.h"
+#include "ns3/chord-message.h"
+#include "ns3/chord-message-view.h"
+#include "ns3/chord-node-table.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordIdentifierBenchmark");
+
+static uint64_t g_allocations = 0;
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc (size_t size);
+
+extern "C" void*
+malloc (size_t size)
+{
+  g_allocations++;
+  return __libc_malloc (size);
+}
+
+//Bypasses counting malloc, so that each new is counted once
+static void*
+RawAlloc (std::size_t size)
+{
+  return __libc_malloc (size);
+}
+#else
+static void*
+RawAlloc (std::size_t size)
+{
+  return malloc (size);
+}
+#endif
+
+void*
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = RawAlloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  free (p);
+}
+
+static void
+RandomKey (Ptr<UniformRandomVariable> random, uint8_t *key)
+{
+  for (int i = 0; i < ChordKey::NUM_BYTES; i++)
+    {
+      key[i] = (uint8_t) random->GetInteger (0, 255);
+    }
+}
+
+static void
+Report (std::string name, uint32_t iterations, uint64_t allocations, int64_t ms)
+{
+  std::cout << std::setw (28) << std::left << name << std::right
+            << std::setw (14) << (double) allocations / iterations
+            << std::setw (14) << ms * 1000000.0 / iterations << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t iterations = 100000;
+
+  CommandLine cmd;
+  cmd.AddValue ("iterations", "Number of operations per measurement", iterations);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  uint8_t key[ChordKey::NUM_BYTES];
+
+  //Local vnode with full finger table
+  RandomKey (random, key);
+  Ptr<ChordIdentifier> vNodeIdentifier = Create<ChordIdentifier> (key, ChordKey::NUM_BYTES);
+  Ptr<ChordNode> node = Create<ChordNode> (vNodeIdentifier, "vnode", Ipv4Address ("10.1.1.1"), 2000, 3000, 4000);
+  Ptr<ChordVNode> vNode = Create<ChordVNode> (node, 8, 8);
+  ChordNodeTable fingerTable;
+  std::vector<ChordKey> fingerKeys;
+  for (uint16_t i = 0; i < ChordKey::NUM_BYTES * 8; i++)
+    {
+      RandomKey (random, key);
+      Ptr<ChordNode> finger = Create<ChordNode> (Create<ChordIdentifier> (key, ChordKey::NUM_BYTES), Ipv4Address ("10.1.1.2"), 2000, 3000, 4000);
+      fingerTable.UpdateNode (finger);
+      fingerKeys.push_back (ChordKey (key));
+    }
+  std::sort (fingerKeys.begin (), fingerKeys.end ());
+
+  std::vector<ChordKey> targets;
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      RandomKey (random, key);
+      targets.push_back (ChordKey (key));
+    }
+
+  std::cout << std::fixed << std::setprecision (2);
+  std::cout << std::setw (28) << std::left << "operation" << std::right
+            << std::setw (14) << "allocs/op"
+            << std::setw (14) << "ns/op" << std::endl;
+
+  SystemWallClockMs clock;
+  uint64_t allocations;
+
+  //Create identifier from key bytes (LookupKey)
+  allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      targets[i].GetKey (key);
+      Ptr<ChordIdentifier> identifier = Create<ChordIdentifier> (key, ChordKey::NUM_BYTES);
+    }
+  Report ("create identifier", iterations, g_allocations - allocations, clock.End ());
+
+  //Pack, serialize and parse LOOKUP_REQ
+  ChordMessageView received;
+  allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      Ptr<ChordIdentifier> identifier = Create<ChordIdentifier> (targets[i]);
+      ChordMessage chordMessage = ChordMessage ();
+      vNode->PackLookupReq (identifier, chordMessage);
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (chordMessage);
+      packet->RemoveHeader (received);
+    }
+  Report ("lookup message round trip", iterations, g_allocations - allocations, clock.End ());
+
+  //Next hop from finger table
+  allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      Ptr<ChordNode> nextHop;
+      fingerTable.FindNearestNode (targets[i], nextHop);
+    }
+  Report ("finger table next hop", iterations, g_allocations - allocations, clock.End ());
+
+  //Ring interval tests on ChordIdentifier
+  Ptr<ChordIdentifier> low = Create<ChordIdentifier> (fingerKeys[10]);
+  Ptr<ChordIdentifier> high = Create<ChordIdentifier> (fingerKeys[100]);
+  std::vector<Ptr<ChordIdentifier> > targetIdentifiers;
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      targetIdentifiers.push_back (Create<ChordIdentifier> (targets[i]));
+    }
+  uint32_t inBetween = 0;
+  allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      inBetween += targetIdentifiers[i]->IsInBetween (low, high);
+    }
+  Report ("identifier IsInBetween", iterations, g_allocations - allocations, clock.End ());
+
+  //Same on ChordKey
+  uint32_t keyInBetween = 0;
+  allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      keyInBetween += targets[i].IsInBetween (fingerKeys[10], fingerKeys[100]);
+    }
+  Report ("key IsInBetween", iterations, g_allocations - allocations, clock.End ());
+  NS_ABORT_MSG_IF (inBetween != keyInBetween, "ChordKey and ChordIdentifier disagree");
+
+  //Next hop over sorted ChordKey fingers
+  uint32_t oddHops = 0;
+  allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      std::vector<ChordKey>::iterator iter = std::upper_bound (fingerKeys.begin (), fingerKeys.end (), targets[i]);
+      if (iter == fingerKeys.begin ())
+        {
+          iter = fingerKeys.end ();
+        }
+      iter--;
+      oddHops += iter->GetWord (0) & 1;
+    }
+  Report ("key next hop", iterations, g_allocations - allocations, clock.End ());
+  NS_LOG_INFO ("Odd next hops: " << oddHops);
+
+  return 0;
+}
@@ -0,0 +1,268 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Chord lookups at scale, with churn and uniform or Zipf key popularity
+// (see ChordBenchmarkHelper).
+//
+// --nodes chord hosts run --vnodes vNodes each, on one of these topologies:
+//   csma        all hosts on one CSMA segment (as chord-run)
+//   tree        hosts hang off the leaves of a --fanout-ary tree of routers
+//   rocketfuel  hosts hang off random routers of a Rocketfuel map or weights
+//               file (--topologyFile), read with TopologyReaderHelper
+// Routers do not run Chord; tree and rocketfuel use Nix-vector routing so
+// routing state stays small at thousands of nodes. Links have one-way delay
+// --delay ms. Hosts join one after another, then for --duration seconds
+// random hosts look up keys at --lookupRate per second (whole network) while
+// hosts depart at --churnRate per second, --crashFraction of them crashing,
+// and come back after --downtime seconds on average.
+//
+// One summary row (success rate, hops, latency, messages and bytes per node
+// per second, wall clock, peak RSS) is appended to --summary and printed,
+// hop count and latency histograms are appended to --histograms. Same
+// --seed and --run give the same results.
+//
+// ./waf --run "chord-large-scale-benchmark --nodes=1000 --topology=tree --churnRate=0.5 --alpha=0.9"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/topology-read-module.h"
+#include "ns3/nix-vector-routing-module.h"
+#include "ns3/chord-benchmark-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordLargeScaleBenchmark");
+
+struct TopologyConfig
+{
+  std::string topology;
+  uint32_t nodes;
+  uint32_t fanout;
+  std::string topologyFile;
+  double delay;
+};
+
+//Hangs each host off router picked by routerIndex (link per host)
+static void
+AttachHosts (TopologyConfig &config, NodeContainer &routers, std::vector<uint32_t> &routerIndex, Ipv4AddressHelper &ipv4, NodeContainer &hosts, std::vector<Ipv4Address> &addresses)
+{
+  hosts.Create (config.nodes);
+  InternetStackHelper internet;
+  Ipv4NixVectorHelper nixRouting;
+  internet.SetRoutingHelper (nixRouting);
+  internet.Install (hosts);
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (config.delay * 1000)));
+  for (uint32_t j = 0; j < config.nodes; j++)
+    {
+      NetDeviceContainer devices = pointToPoint.Install (hosts.Get (j), routers.Get (routerIndex[j]));
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      addresses.push_back (interfaces.GetAddress (0));
+    }
+}
+
+static void
+BuildTree (TopologyConfig &config, NodeContainer &hosts, std::vector<Ipv4Address> &addresses)
+{
+  //Enough routers for fanout hosts on each
+  uint32_t fanout = std::max<uint32_t> (config.fanout, 2);
+  uint32_t numRouters = (config.nodes + fanout - 1) / fanout;
+  NodeContainer routers;
+  routers.Create (numRouters);
+  InternetStackHelper internet;
+  Ipv4NixVectorHelper nixRouting;
+  internet.SetRoutingHelper (nixRouting);
+  internet.Install (routers);
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (config.delay * 1000)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t r = 1; r < numRouters; r++)
+    {
+      ipv4.Assign (pointToPoint.Install (routers.Get (r), routers.Get ((r - 1) / fanout)));
+      ipv4.NewNetwork ();
+    }
+  //Hosts fill routers from bottom of tree up
+  std::vector<uint32_t> routerIndex;
+  for (uint32_t j = 0; j < config.nodes; j++)
+    {
+      routerIndex.push_back (numRouters - 1 - j / fanout);
+    }
+  AttachHosts (config, routers, routerIndex, ipv4, hosts, addresses);
+}
+
+static bool
+BuildRocketfuel (TopologyConfig &config, NodeContainer &hosts, std::vector<Ipv4Address> &addresses)
+{
+  TopologyReaderHelper topologyHelper;
+  topologyHelper.SetFileName (config.topologyFile);
+  topologyHelper.SetFileType ("Rocketfuel");
+  Ptr<TopologyReader> reader = topologyHelper.GetTopologyReader ();
+  NodeContainer routers = reader->Read ();
+  if (reader->LinksSize () == 0)
+    {
+      std::cerr << "Can not read Rocketfuel topology " << config.topologyFile << std::endl;
+      return false;
+    }
+  InternetStackHelper internet;
+  Ipv4NixVectorHelper nixRouting;
+  internet.SetRoutingHelper (nixRouting);
+  internet.Install (routers);
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  pointToPoint.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (config.delay * 1000)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  for (TopologyReader::ConstLinksIterator iter = reader->LinksBegin (); iter != reader->LinksEnd (); iter++)
+    {
+      ipv4.Assign (pointToPoint.Install (iter->GetFromNode (), iter->GetToNode ()));
+      ipv4.NewNetwork ();
+    }
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<uint32_t> routerIndex;
+  for (uint32_t j = 0; j < config.nodes; j++)
+    {
+      routerIndex.push_back (random->GetInteger (0, routers.GetN () - 1));
+    }
+  AttachHosts (config, routers, routerIndex, ipv4, hosts, addresses);
+  return true;
+}
+
+static void
+AppendCsv (std::string fileName, void (*writeHeader)(std::ostream &), std::ostringstream &rows)
+{
+  std::ifstream existing (fileName.c_str ());
+  bool empty = !existing.good () || existing.peek () == std::ifstream::traits_type::eof ();
+  existing.close ();
+  std::ofstream os (fileName.c_str (), std::ios::app);
+  if (empty)
+    {
+      writeHeader (os);
+    }
+  os << rows.str ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  TopologyConfig topologyConfig;
+  topologyConfig.topology = "tree";
+  topologyConfig.nodes = 100;
+  topologyConfig.fanout = 4;
+  topologyConfig.topologyFile = "src/topology-read/examples/RocketFuel_toposample_1239_weights.txt";
+  topologyConfig.delay = 1;
+  ChordBenchmarkConfig config;
+  double joinInterval = config.joinInterval.GetSeconds () * 1000;
+  double settle = config.settle.GetSeconds ();
+  double duration = config.duration.GetSeconds ();
+  double drain = config.drain.GetSeconds ();
+  double downtime = config.downtime.GetSeconds ();
+  double latencyBin = config.latencyBin.GetSeconds () * 1000;
+  uint32_t seed = 1;
+  uint32_t run = 1;
+  std::string summaryFile = "chord-large-scale-summary.csv";
+  std::string histogramsFile = "chord-large-scale-histograms.csv";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of chord hosts (up to 10000)", topologyConfig.nodes);
+  cmd.AddValue ("vnodes", "vNodes per host", config.vNodes);
+  cmd.AddValue ("topology", "csma, tree or rocketfuel", topologyConfig.topology);
+  cmd.AddValue ("fanout", "Children per router of tree topology", topologyConfig.fanout);
+  cmd.AddValue ("topologyFile", "Rocketfuel map or weights file of rocketfuel topology", topologyConfig.topologyFile);
+  cmd.AddValue ("delay", "One-way delay of every link in ms", topologyConfig.delay);
+  cmd.AddValue ("joinInterval", "Milli seconds between host joins", joinInterval);
+  cmd.AddValue ("settle", "Seconds between last join and measurement", settle);
+  cmd.AddValue ("duration", "Seconds of measurement (lookups and churn)", duration);
+  cmd.AddValue ("drain", "Seconds after measurement for outstanding lookups", drain);
+  cmd.AddValue ("lookupRate", "Lookups per second of whole network", config.lookupRate);
+  cmd.AddValue ("keys", "Number of keys looked up", config.keys);
+  cmd.AddValue ("alpha", "Zipf exponent of key popularity, 0 for uniform", config.zipfAlpha);
+  cmd.AddValue ("churnRate", "Host departures per second of whole network", config.churnRate);
+  cmd.AddValue ("crashFraction", "Fraction of departures which crash instead of leaving", config.crashFraction);
+  cmd.AddValue ("downtime", "Mean seconds until departed host joins again", downtime);
+  cmd.AddValue ("latencyBin", "Latency histogram bin width in ms", latencyBin);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.AddValue ("run", "Random run number", run);
+  cmd.AddValue ("summary", "CSV file summary row is appended to", summaryFile);
+  cmd.AddValue ("histograms", "CSV file histograms are appended to", histogramsFile);
+  cmd.Parse (argc, argv);
+  config.joinInterval = MicroSeconds (joinInterval * 1000);
+  config.settle = Seconds (settle);
+  config.duration = Seconds (duration);
+  config.drain = Seconds (drain);
+  config.downtime = Seconds (downtime);
+  config.latencyBin = MicroSeconds (latencyBin * 1000);
+  config.keys = std::max<uint32_t> (config.keys, 1);
+  config.vNodes = std::max<uint32_t> (config.vNodes, 1);
+  topologyConfig.nodes = std::max<uint32_t> (topologyConfig.nodes, 2);
+  RngSeedManager::SetSeed (seed);
+  RngSeedManager::SetRun (run);
+
+  NodeContainer hosts;
+  std::vector<Ipv4Address> addresses;
+  if (topologyConfig.topology == "csma")
+    {
+      hosts.Create (topologyConfig.nodes);
+      addresses = ChordBenchmarkHelper::BuildCsma (hosts, MicroSeconds (topologyConfig.delay * 1000));
+    }
+  else if (topologyConfig.topology == "tree")
+    {
+      BuildTree (topologyConfig, hosts, addresses);
+    }
+  else if (topologyConfig.topology == "rocketfuel")
+    {
+      if (BuildRocketfuel (topologyConfig, hosts, addresses) == false)
+        {
+          return 1;
+        }
+    }
+  else
+    {
+      std::cerr << "Unknown topology " << topologyConfig.topology << std::endl;
+      return 1;
+    }
+
+  ChordBenchmarkHelper benchmark (config);
+  benchmark.Install (hosts, addresses);
+  Simulator::Stop (benchmark.GetStopTime ());
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t wallClockMs = clock.End ();
+
+  std::ostringstream summary, histograms;
+  benchmark.WriteSummary (summary, topologyConfig.topology, wallClockMs);
+  benchmark.WriteHistograms (histograms, topologyConfig.topology);
+  Simulator::Destroy ();
+
+  ChordBenchmarkHelper::WriteSummaryHeader (std::cout);
+  std::cout << summary.str ();
+  AppendCsv (summaryFile, &ChordBenchmarkHelper::WriteSummaryHeader, summary);
+  AppendCsv (histogramsFile, &ChordBenchmarkHelper::WriteHistogramsHeader, histograms);
+  return 0;
+}
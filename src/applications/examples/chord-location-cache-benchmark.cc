@@ -0,0 +1,140 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Chord lookups of Zipf distributed keys without and with lookup location
+// cache (LocationCacheSize).
+//
+// Same topology as chord-lookup-latency-benchmark (ChordBenchmarkHelper star:
+// nodes hang off a central router on links with one-way delay drawn from
+// [minDelay, maxDelay] ms). After the ring has stabilized, random nodes look
+// up keys drawn from a fixed population of --keys keys with Zipf(--alpha)
+// popularity, --rate per second (Poisson) until about --lookups are issued;
+// latency is measured from LookupKey until the success upcall. hit(%) is the
+// share of lookups answered from cache of the requesting node
+// (ChordLookupStats). Both runs use the same seed.
+//
+// ./waf --run "chord-location-cache-benchmark --nodes=32 --keys=5000"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/chord-benchmark-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordLocationCacheBenchmark");
+
+struct BenchmarkConfig
+{
+  uint32_t nodes;
+  uint32_t lookups;
+  double lookupRate;
+  uint32_t keys;
+  double alpha;
+  double minDelay;
+  double maxDelay;
+  uint32_t cacheSize;
+};
+
+static void
+Run (BenchmarkConfig &config, bool locationCache)
+{
+  NodeContainer nodeContainer;
+  nodeContainer.Create (config.nodes);
+  std::vector<Ipv4Address> addresses = ChordBenchmarkHelper::BuildStar (nodeContainer, MicroSeconds (config.minDelay * 1000), MicroSeconds (config.maxDelay * 1000), 0);
+
+  //Let ring stabilize and fingers settle, then look up at given rate
+  ChordBenchmarkConfig benchmarkConfig;
+  benchmarkConfig.settle = Seconds (30);
+  benchmarkConfig.duration = Seconds (config.lookups / config.lookupRate);
+  benchmarkConfig.drain = Seconds (10);
+  benchmarkConfig.lookupRate = config.lookupRate;
+  benchmarkConfig.keys = config.keys;
+  benchmarkConfig.zipfAlpha = config.alpha;
+  ChordBenchmarkHelper benchmark (benchmarkConfig);
+  benchmark.SetAttribute ("LocationCacheSize", UintegerValue (locationCache ? config.cacheSize : 0));
+  benchmark.AssignStreams (1);
+  ApplicationContainer applications = benchmark.Install (nodeContainer, addresses);
+  Simulator::Stop (benchmark.GetStopTime ());
+  Simulator::Run ();
+
+  uint64_t hits = 0, misses = 0, invalidations = 0;
+  for (uint32_t j = 0; j < applications.GetN (); j++)
+    {
+      ChordLookupStats stats;
+      DynamicCast<ChordIpv4> (applications.Get (j))->GetLookupStats (stats);
+      hits += stats.cacheHits;
+      misses += stats.cacheMisses;
+      invalidations += stats.cacheInvalidations;
+    }
+  std::cout << std::setw (6) << (locationCache ? "on" : "off")
+            << std::setw (10) << benchmark.GetSucceeded ()
+            << std::setw (8) << benchmark.GetFailed ()
+            << std::setw (8) << (hits + misses ? 100.0 * hits / (hits + misses) : 0.0)
+            << std::setw (8) << invalidations
+            << std::setw (10) << benchmark.GetMeanLatency ()
+            << std::setw (10) << benchmark.GetLatencyPercentile (50)
+            << std::setw (10) << benchmark.GetLatencyPercentile (99) << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.nodes = 32;
+  config.lookups = 5000;
+  config.lookupRate = 100;
+  config.keys = 5000;
+  config.alpha = 0.9;
+  config.minDelay = 1;
+  config.maxDelay = 50;
+  config.cacheSize = DEFAULT_LOCATION_CACHE_SIZE;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of chord nodes", config.nodes);
+  cmd.AddValue ("lookups", "Number of lookups", config.lookups);
+  cmd.AddValue ("rate", "Lookups per second (whole ring)", config.lookupRate);
+  cmd.AddValue ("keys", "Number of distinct keys", config.keys);
+  cmd.AddValue ("alpha", "Zipf exponent of key popularity", config.alpha);
+  cmd.AddValue ("minDelay", "Min one-way delay of node to router link in milli seconds", config.minDelay);
+  cmd.AddValue ("maxDelay", "Max one-way delay of node to router link in milli seconds", config.maxDelay);
+  cmd.AddValue ("cacheSize", "LocationCacheSize of cached run", config.cacheSize);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (6) << "cache"
+            << std::setw (10) << "resolved"
+            << std::setw (8) << "failed"
+            << std::setw (8) << "hit(%)"
+            << std::setw (8) << "inval"
+            << std::setw (10) << "mean(ms)"
+            << std::setw (10) << "p50(ms)"
+            << std::setw (10) << "p99(ms)" << std::endl;
+  for (uint32_t cache = 0; cache < 2; cache++)
+    {
+      RngSeedManager::SetSeed (seed);
+      Run (config, cache == 1);
+    }
+  return 0;
+}
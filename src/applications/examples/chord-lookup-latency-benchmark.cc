@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Chord lookup latency with and without proximity neighbor selection
+// (ProximityNeighborSelection, off by default since it only pays off on rings
+// of about 16 nodes or more).
+//
+// Nodes hang off a central router on point-to-point links whose one-way delay
+// is drawn uniformly from [minDelay, maxDelay] ms (ChordBenchmarkHelper star),
+// so RTT between two nodes varies widely. After the ring has stabilized and
+// fingers have been fixed a few rounds, random nodes look up random keys,
+// --rate per second (Poisson) until about --lookups are issued; latency is
+// measured from LookupKey until the success upcall. Both runs use the same
+// seed (same delays, identifiers and workload). --recursive=0 resolves lookups
+// iteratively (RecursiveLookup) instead. Location cache is off, every lookup
+// is routed (see chord-location-cache-benchmark).
+//
+// ./waf --run "chord-lookup-latency-benchmark --nodes=16 --lookups=2000"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/chord-benchmark-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordLookupLatencyBenchmark");
+
+struct BenchmarkConfig
+{
+  uint32_t nodes;
+  uint32_t lookups;
+  double lookupRate;
+  double minDelay;
+  double maxDelay;
+  Time fixFingerInterval;
+  bool recursiveLookup;
+};
+
+static void
+Run (BenchmarkConfig &config, bool proximityNeighborSelection)
+{
+  NodeContainer nodeContainer;
+  nodeContainer.Create (config.nodes);
+  std::vector<Ipv4Address> addresses = ChordBenchmarkHelper::BuildStar (nodeContainer, MicroSeconds (config.minDelay * 1000), MicroSeconds (config.maxDelay * 1000), 0);
+
+  //Let ring stabilize, then fix fingers a few rounds (RTT probes go out on first round)
+  ChordBenchmarkConfig benchmarkConfig;
+  benchmarkConfig.settle = Seconds (10) + config.fixFingerInterval * 4;
+  benchmarkConfig.duration = Seconds (config.lookups / config.lookupRate);
+  benchmarkConfig.drain = Seconds (30);
+  benchmarkConfig.lookupRate = config.lookupRate;
+  ChordBenchmarkHelper benchmark (benchmarkConfig);
+  benchmark.SetAttribute ("FixFingerInterval", TimeValue (config.fixFingerInterval));
+  benchmark.SetAttribute ("ProximityNeighborSelection", BooleanValue (proximityNeighborSelection));
+  benchmark.SetAttribute ("RecursiveLookup", BooleanValue (config.recursiveLookup));
+  benchmark.SetAttribute ("LocationCacheSize", UintegerValue (0));
+  benchmark.AssignStreams (1);
+  benchmark.Install (nodeContainer, addresses);
+  Simulator::Stop (benchmark.GetStopTime ());
+  Simulator::Run ();
+
+  std::cout << std::setw (5) << (proximityNeighborSelection ? "on" : "off")
+            << std::setw (10) << benchmark.GetSucceeded ()
+            << std::setw (8) << benchmark.GetFailed ()
+            << std::setw (10) << benchmark.GetMeanLatency ()
+            << std::setw (10) << benchmark.GetLatencyPercentile (50)
+            << std::setw (10) << benchmark.GetLatencyPercentile (90)
+            << std::setw (10) << benchmark.GetLatencyPercentile (99) << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.nodes = 16;
+  config.lookups = 2000;
+  config.lookupRate = 50;
+  config.minDelay = 1;
+  config.maxDelay = 50;
+  uint32_t fixFingerInterval = 5000;
+  config.recursiveLookup = true;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of chord nodes", config.nodes);
+  cmd.AddValue ("lookups", "Number of lookups", config.lookups);
+  cmd.AddValue ("rate", "Lookups per second (whole ring)", config.lookupRate);
+  cmd.AddValue ("minDelay", "Min one-way delay of node to router link in milli seconds", config.minDelay);
+  cmd.AddValue ("maxDelay", "Max one-way delay of node to router link in milli seconds", config.maxDelay);
+  cmd.AddValue ("fixFinger", "Fix finger interval in milli seconds", fixFingerInterval);
+  cmd.AddValue ("recursive", "Recursive (1) or iterative (0) lookups", config.recursiveLookup);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+  config.fixFingerInterval = MilliSeconds (fixFingerInterval);
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (5) << "pns"
+            << std::setw (10) << "resolved"
+            << std::setw (8) << "failed"
+            << std::setw (10) << "mean(ms)"
+            << std::setw (10) << "p50(ms)"
+            << std::setw (10) << "p90(ms)"
+            << std::setw (10) << "p99(ms)" << std::endl;
+  for (uint32_t pns = 0; pns < 2; pns++)
+    {
+      RngSeedManager::SetSeed (seed);
+      Run (config, pns == 1);
+    }
+  return 0;
+}
@@ -0,0 +1,296 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Chord maintenance overhead against repair time, with fixed and adaptive
+// (AdaptiveMaintenance) stabilize, heartbeat and fix finger intervals.
+//
+// Same topology as chord-dhash-replication-benchmark (ChordBenchmarkHelper
+// CSMA segment, one vnode per node, no DHash). After the ring has settled,
+// packets sent by ChordIpv4 of all nodes are counted over a quiet window
+// (msg/s per node) and the mean stabilize interval at its end is reported.
+// Then random joined nodes crash (ChordBenchmarkHelper::Crash) one at a time,
+// --crashInterval seconds apart. For each crash, handoff is the time until
+// the ring successor of the crashed vnode takes over its keys (predecessor
+// failure detected by heartbeat), and lookup is the time until a lookup of
+// the crashed vnode identifier, repeated every 100ms from a random live
+// joined node, resolves to that successor. Both runs use the same seed.
+//
+// ./waf --run "chord-maintenance-benchmark --nodes=32 --crashes=4"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/chord-benchmark-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordMaintenanceBenchmark");
+
+struct BenchmarkConfig
+{
+  uint32_t nodes;
+  uint32_t crashes;
+  double settle;
+  double quiet;
+  double crashInterval;
+  uint32_t maxBackoff;
+};
+
+class MaintenanceRun
+{
+public:
+  MaintenanceRun (BenchmarkConfig &config, bool adaptive)
+    : m_config (config),
+      m_adaptive (adaptive),
+      m_benchmark (GetBenchmarkConfig (config)),
+      m_meanInterval (0)
+  {
+  }
+
+  void Run (void)
+  {
+    NodeContainer nodeContainer;
+    nodeContainer.Create (m_config.nodes);
+    m_addresses = ChordBenchmarkHelper::BuildCsma (nodeContainer, MicroSeconds (500));
+
+    m_benchmark.SetAttribute ("AdaptiveMaintenance", BooleanValue (m_adaptive));
+    m_benchmark.SetAttribute ("MaxMaintenanceBackoff", UintegerValue (m_config.maxBackoff));
+    m_benchmark.AssignStreams (1);
+    ApplicationContainer applications = m_benchmark.Install (nodeContainer, m_addresses);
+    m_benchmark.SetLookupSuccessCallback (MakeCallback (&MaintenanceRun::LookupSuccess, this));
+    for (uint32_t j = 0; j < applications.GetN (); j++)
+      {
+        Ptr<ChordIpv4> chordApplication = DynamicCast<ChordIpv4> (applications.Get (j));
+        chordApplication->SetVNodeKeyOwnershipCallback (MakeCallback (&MaintenanceRun::KeyOwnership, this));
+        chordApplication->TraceConnectWithoutContext ("MaintenanceInterval", MakeBoundCallback (&MaintenanceRun::IntervalChange, this, j));
+      }
+
+    //Messages are counted over quiet window, nodes crash after it
+    Time quietEnd = m_benchmark.GetStartTime () + Seconds (m_config.quiet);
+    Simulator::Schedule (quietEnd, &MaintenanceRun::AverageIntervals, this);
+    for (uint32_t c = 0; c < m_config.crashes; c++)
+      {
+        Simulator::Schedule (quietEnd + Seconds (c * m_config.crashInterval), &MaintenanceRun::Crash, this);
+      }
+    Simulator::Schedule (quietEnd, &MaintenanceRun::Lookup, this);
+    m_stop = quietEnd + Seconds (m_config.crashes * m_config.crashInterval);
+    Simulator::Stop (m_benchmark.GetStopTime ());
+    Simulator::Run ();
+    Report ();
+    Simulator::Destroy ();
+  }
+
+private:
+  struct Repair
+  {
+    ChordKey key;
+    Time crashTime;
+    Ipv4Address successor;
+    ChordKey successorKey;
+    double handoff;
+    double lookup;
+  };
+
+  static ChordBenchmarkConfig GetBenchmarkConfig (BenchmarkConfig &config)
+  {
+    ChordBenchmarkConfig benchmarkConfig;
+    benchmarkConfig.settle = Seconds (config.settle);
+    benchmarkConfig.duration = Seconds (config.quiet);
+    benchmarkConfig.drain = Seconds (config.crashes * config.crashInterval + 1);
+    benchmarkConfig.lookupRate = 0;
+    return benchmarkConfig;
+  }
+  void AverageIntervals (void)
+  {
+    double sum = 0;
+    for (std::map<uint32_t, Time>::iterator iter = m_intervals.begin (); iter != m_intervals.end (); iter++)
+      {
+        sum += iter->second.GetMilliSeconds ();
+      }
+    //vNodes never backed off run at configured interval
+    sum += (m_config.nodes - m_intervals.size ()) * (double) DEFAULT_STABILIZE_INTERVAL;
+    m_meanInterval = sum / m_config.nodes;
+  }
+  static void IntervalChange (MaintenanceRun *run, uint32_t nodeIndex, std::string vNodeName, Time interval)
+  {
+    //One vNode per node
+    run->m_intervals[nodeIndex] = interval;
+  }
+  void Crash (void)
+  {
+    uint32_t nodeIndex;
+    if (m_benchmark.PickNode (true, false, nodeIndex) == false)
+      {
+        return;
+      }
+    Repair repair;
+    repair.key = m_benchmark.GetVNodeKey (nodeIndex, 0);
+    repair.crashTime = Simulator::Now ();
+    m_benchmark.Crash (nodeIndex);
+    //Ring successor of crashed vNode takes over
+    repair.successor = m_benchmark.GetOwnerAddress (repair.key);
+    for (uint32_t j = 0; j < m_addresses.size (); j++)
+      {
+        if (m_addresses[j] == repair.successor)
+          {
+            repair.successorKey = m_benchmark.GetVNodeKey (j, 0);
+          }
+      }
+    repair.handoff = -1;
+    repair.lookup = -1;
+    m_repairs.push_back (repair);
+  }
+  void Lookup (void)
+  {
+    if (Simulator::Now () > m_stop)
+      {
+        return;
+      }
+    for (uint32_t r = 0; r < m_repairs.size (); r++)
+      {
+        uint32_t nodeIndex;
+        if (m_repairs[r].lookup < 0 && m_benchmark.PickNode (false, true, nodeIndex))
+          {
+            m_benchmark.LookupKey (nodeIndex, m_repairs[r].key);
+          }
+      }
+    Simulator::Schedule (MilliSeconds (100), &MaintenanceRun::Lookup, this);
+  }
+  void LookupSuccess (ChordKey key, Ipv4Address ownerIp)
+  {
+    for (uint32_t r = 0; r < m_repairs.size (); r++)
+      {
+        if (m_repairs[r].lookup < 0 && m_repairs[r].key == key && m_repairs[r].successor == ownerIp)
+          {
+            m_repairs[r].lookup = (Simulator::Now () - m_repairs[r].crashTime).GetSeconds ();
+          }
+      }
+  }
+  void KeyOwnership (std::string vNodeName, uint8_t *key, uint8_t keyBytes, uint8_t *predecessorKey, uint8_t predecessorKeyBytes, uint8_t *oldPredecessorKey, uint8_t oldPredecessorKeyBytes, Ipv4Address predecessorIp, uint16_t predecessorPort)
+  {
+    ChordKey vNodeKey (key);
+    ChordKey oldPredecessor (oldPredecessorKey);
+    for (uint32_t r = 0; r < m_repairs.size (); r++)
+      {
+        if (m_repairs[r].handoff < 0 && m_repairs[r].successorKey == vNodeKey && m_repairs[r].key == oldPredecessor)
+          {
+            m_repairs[r].handoff = (Simulator::Now () - m_repairs[r].crashTime).GetSeconds ();
+          }
+      }
+  }
+  static void Summarize (std::vector<double> &times, double &mean, double &max)
+  {
+    mean = 0;
+    max = 0;
+    for (uint32_t t = 0; t < times.size (); t++)
+      {
+        mean += times[t] / times.size ();
+        max = std::max (max, times[t]);
+      }
+  }
+  void Report (void)
+  {
+    std::vector<double> handoffs, lookups;
+    uint32_t unrepaired = 0;
+    for (uint32_t r = 0; r < m_repairs.size (); r++)
+      {
+        if (m_repairs[r].handoff < 0 || m_repairs[r].lookup < 0)
+          {
+            unrepaired++;
+          }
+        if (m_repairs[r].handoff >= 0)
+          {
+            handoffs.push_back (m_repairs[r].handoff);
+          }
+        if (m_repairs[r].lookup >= 0)
+          {
+            lookups.push_back (m_repairs[r].lookup);
+          }
+      }
+    double handoffMean, handoffMax, lookupMean, lookupMax;
+    Summarize (handoffs, handoffMean, handoffMax);
+    Summarize (lookups, lookupMean, lookupMax);
+    std::cout << std::setw (10) << (m_adaptive ? "adaptive" : "fixed")
+              << std::setw (8) << m_config.nodes
+              << std::setw (10) << (double) m_benchmark.GetMessages () / m_config.quiet / m_config.nodes
+              << std::setw (13) << m_meanInterval
+              << std::setw (8) << m_repairs.size ()
+              << std::setw (12) << handoffMean
+              << std::setw (12) << handoffMax
+              << std::setw (12) << lookupMean
+              << std::setw (12) << lookupMax
+              << std::setw (12) << unrepaired << std::endl;
+  }
+
+  BenchmarkConfig &m_config;
+  bool m_adaptive;
+  ChordBenchmarkHelper m_benchmark;
+  std::vector<Ipv4Address> m_addresses;
+  std::map<uint32_t, Time> m_intervals;
+  std::vector<Repair> m_repairs;
+  double m_meanInterval;
+  Time m_stop;
+};
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.nodes = 16;
+  config.crashes = 4;
+  config.settle = 60;
+  config.quiet = 120;
+  config.crashInterval = 40;
+  config.maxBackoff = DEFAULT_MAX_MAINTENANCE_BACKOFF;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of chord nodes", config.nodes);
+  cmd.AddValue ("crashes", "Number of nodes crashed after quiet window", config.crashes);
+  cmd.AddValue ("settle", "Seconds between last join and quiet window", config.settle);
+  cmd.AddValue ("quiet", "Seconds of quiet window", config.quiet);
+  cmd.AddValue ("crashInterval", "Seconds between crashes", config.crashInterval);
+  cmd.AddValue ("maxBackoff", "MaxMaintenanceBackoff of adaptive run", config.maxBackoff);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+  config.crashes = std::min (config.crashes, config.nodes / 2);
+
+  std::cout << std::fixed << std::setprecision (2);
+  std::cout << std::setw (10) << "mode"
+            << std::setw (8) << "nodes"
+            << std::setw (10) << "msg/s"
+            << std::setw (13) << "interval(ms)"
+            << std::setw (8) << "crashed"
+            << std::setw (12) << "handoff(s)"
+            << std::setw (12) << "max(s)"
+            << std::setw (12) << "lookup(s)"
+            << std::setw (12) << "max(s)"
+            << std::setw (12) << "unrepaired" << std::endl;
+  for (uint32_t adaptive = 0; adaptive < 2; adaptive++)
+    {
+      RngSeedManager::SetSeed (seed);
+      MaintenanceRun run (config, adaptive == 1);
+      run.Run ();
+    }
+  return 0;
+}
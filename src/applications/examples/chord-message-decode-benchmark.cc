@@ -0,0 +1,164 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Heap allocations and time per decoded chord message, ChordMessage versus
+// ChordMessageView.
+//
+// STABILIZE_REQ, STABILIZE_RSP (full successor list) and LOOKUP_REQ messages
+// are packed once, then decoded --messages times each straight from the
+// packet (PeekHeader). ChordMessage builds a ChordNode/ChordIdentifier for
+// every node and identifier carried, the view holds them by value.
+// Allocations are counted by replacing global operator new.
+//
+// ./waf --run "chord-message-decode-benchmark --messages=1000000"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/chord-key.h"
+#include "ns3/chord-identifier.h"
+#include "ns3/chord-node.h"
+#include "ns3/chord-message.h"
+#include "ns3/chord-message-view.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordMessageDecodeBenchmark");
+
+static uint64_t g_allocations = 0;
+
+void*
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *pointer = std::malloc (size ? size : 1);
+  if (pointer == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return pointer;
+}
+
+void
+operator delete (void *pointer) noexcept
+{
+  std::free (pointer);
+}
+
+static Ptr<ChordNode>
+RandomNode (Ptr<UniformRandomVariable> random, uint32_t index)
+{
+  uint8_t key[ChordKey::NUM_BYTES];
+  for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+    {
+      key[b] = random->GetInteger (0, 255);
+    }
+  return Create<ChordNode> (Create<ChordIdentifier> (key, ChordKey::NUM_BYTES), Ipv4Address (0x0a010001 + index), 2000, 2001, 2002);
+}
+
+static Ptr<Packet>
+PackMessage (ChordMessage &chordMessage)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (chordMessage);
+  return packet;
+}
+
+template <typename T>
+static void
+Decode (std::string name, Ptr<Packet> packet, uint32_t messages)
+{
+  uint32_t size = 0;
+  SystemWallClockMs clock;
+  uint64_t allocations = g_allocations;
+  clock.Start ();
+  for (uint32_t m = 0; m < messages; m++)
+    {
+      //Fresh message per packet, as in ChordIpv4::ProcessUdpPacket
+      T message;
+      size += packet->PeekHeader (message);
+    }
+  int64_t ms = clock.End ();
+  allocations = g_allocations - allocations;
+  std::cout << std::setw (15) << name
+            << std::setw (24) << T::GetTypeId ().GetName ()
+            << std::setw (8) << packet->GetSize ()
+            << std::setw (14) << (double) allocations / messages
+            << std::setw (12) << (double) ms * 1000000 / messages
+            << std::setw (6) << ((size == packet->GetSize () * messages) ? "ok" : "FAIL") << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t messages = 1000000;
+  uint32_t successors = 8;
+
+  CommandLine cmd;
+  cmd.AddValue ("messages", "Number of messages decoded per message type and decoder", messages);
+  cmd.AddValue ("successors", "Successor list size carried by STABILIZE_RSP", successors);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Ptr<ChordNode> requestorNode = RandomNode (random, 0);
+  Ptr<ChordNode> vNode = RandomNode (random, 1);
+  Ptr<ChordNode> ownerNode = RandomNode (random, 2);
+
+  ChordMessage stabilizeReq = ChordMessage ();
+  stabilizeReq.SetMessageType (ChordMessage::STABILIZE_REQ);
+  stabilizeReq.SetRequestorNode (requestorNode);
+  stabilizeReq.GetStabilizeReq ().successorIdentifier = vNode->GetChordIdentifier ();
+
+  ChordMessage stabilizeRsp = ChordMessage ();
+  stabilizeRsp.SetMessageType (ChordMessage::STABILIZE_RSP);
+  stabilizeRsp.SetRequestorNode (requestorNode);
+  stabilizeRsp.GetStabilizeRsp ().predecessorNode = requestorNode;
+  for (uint32_t s = 0; s < successors; s++)
+    {
+      stabilizeRsp.GetStabilizeRsp ().successorList.push_back (RandomNode (random, 3 + s));
+    }
+  stabilizeRsp.GetStabilizeRsp ().successorListSize = successors;
+
+  ChordMessage lookupReq = ChordMessage ();
+  lookupReq.SetMessageType (ChordMessage::LOOKUP_REQ);
+  lookupReq.SetRequestorNode (requestorNode);
+  lookupReq.SetTransactionId (1);
+  lookupReq.GetLookupReq ().requestedIdentifier = ownerNode->GetChordIdentifier ();
+  lookupReq.GetLookupReq ().numSuccessors = 3;
+  lookupReq.GetLookupReq ().lookupMode = ChordMessage::RECURSIVE_LOOKUP;
+
+  std::cout << std::fixed << std::setprecision (2);
+  std::cout << std::setw (15) << "message"
+            << std::setw (24) << "decoder"
+            << std::setw (8) << "bytes"
+            << std::setw (14) << "allocs/msg"
+            << std::setw (12) << "ns/msg" << std::endl;
+  Ptr<Packet> packet = PackMessage (stabilizeReq);
+  Decode<ChordMessage> ("STABILIZE_REQ", packet, messages);
+  Decode<ChordMessageView> ("STABILIZE_REQ", packet, messages);
+  packet = PackMessage (stabilizeRsp);
+  Decode<ChordMessage> ("STABILIZE_RSP", packet, messages);
+  Decode<ChordMessageView> ("STABILIZE_RSP", packet, messages);
+  packet = PackMessage (lookupReq);
+  Decode<ChordMessage> ("LOOKUP_REQ", packet, messages);
+  Decode<ChordMessageView> ("LOOKUP_REQ", packet, messages);
+  return 0;
+}
@@ -0,0 +1,182 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Micro-benchmark for ChordNodeTable::FindNearestNode.
+//
+// Compares ring-ordered routable index against linear scan of node map (the
+// original implementation), for tables of 64, 1k and 100k entries. One in
+// ten entries is marked unroutable.
+//
+// ./waf --run "chord-node-table-benchmark --lookups=10000"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include "ns3/core-module.h"
+#include "ns3/chord-identifier.h"
+#include "ns3/chord-node.h"
+#include "ns3/chord-node-table.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordNodeTableBenchmark");
+
+#define IDENTIFIER_BYTES 20
+#define LINEAR_SCAN_BUDGET 5000000
+
+static Ptr<ChordIdentifier>
+RandomIdentifier (Ptr<UniformRandomVariable> random)
+{
+  uint8_t key[IDENTIFIER_BYTES];
+  for (int i = 0; i < IDENTIFIER_BYTES; i++)
+    {
+      key[i] = (uint8_t) random->GetInteger (0, 255);
+    }
+  return Create<ChordIdentifier> (key, IDENTIFIER_BYTES);
+}
+
+// Original ChordNodeTable::FindNearestNode
+static bool
+LinearFindNearestNode (ChordNodeTable &table, Ptr<ChordIdentifier> &targetIdentifier, Ptr<ChordNode> &chordNode)
+{
+  Ptr<ChordNode> closestNodeOnRight = 0;
+  Ptr<ChordNode> closestNodeOnLeft = 0;
+  Ptr<ChordIdentifier> zeroIdentifier = Create<ChordIdentifier> ();
+  uint8_t* key;
+  key = (uint8_t *) malloc (sizeof(uint8_t) * targetIdentifier->GetNumBytes ());
+  memset (key, 0, targetIdentifier->GetNumBytes ());
+  zeroIdentifier->SetKey (key, targetIdentifier->GetNumBytes ());
+  free (key);
+
+  for (ChordNodeMap::iterator nodeIter = table.GetMap ().begin (); nodeIter != table.GetMap ().end (); nodeIter++)
+    {
+      Ptr<ChordNode> node = (*nodeIter).second;
+      if (node->GetRoutable () == false)
+        continue;
+      if (node->GetChordIdentifier ()->IsInBetween (zeroIdentifier, targetIdentifier))
+        {
+          if (closestNodeOnRight == 0 || node->GetChordIdentifier ()->IsGreater (closestNodeOnRight->GetChordIdentifier ()))
+            {
+              closestNodeOnRight = node;
+            }
+        }
+      if (closestNodeOnLeft == 0 || node->GetChordIdentifier ()->IsGreater (closestNodeOnLeft->GetChordIdentifier ()))
+        {
+          closestNodeOnLeft = node;
+        }
+    }
+  if (closestNodeOnRight != 0)
+    {
+      chordNode = closestNodeOnRight;
+      return true;
+    }
+  if (closestNodeOnLeft != 0)
+    {
+      chordNode = closestNodeOnLeft;
+      return true;
+    }
+  return false;
+}
+
+static void
+RunBenchmark (uint32_t tableSize, uint32_t lookups, Ptr<UniformRandomVariable> random)
+{
+  ChordNodeTable table;
+  for (uint32_t i = 0; i < tableSize; i++)
+    {
+      Ptr<ChordNode> node = Create<ChordNode> (RandomIdentifier (random), Ipv4Address ("10.1.1.1"), 2000, 3000, 4000);
+      table.UpdateNode (node);
+      if (i % 10 == 0)
+        {
+          table.SetRoutable (node, false);
+        }
+    }
+
+  std::vector<Ptr<ChordIdentifier> > targets;
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      targets.push_back (RandomIdentifier (random));
+    }
+  uint32_t linearLookups = std::max<uint32_t> (1, std::min<uint32_t> (lookups, LINEAR_SCAN_BUDGET / tableSize));
+
+  SystemWallClockMs clock;
+  Ptr<ChordNode> result;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < linearLookups; i++)
+    {
+      LinearFindNearestNode (table, targets[i], result);
+    }
+  double linearMs = clock.End ();
+
+  clock.Start ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      table.FindNearestNode (targets[i], result);
+    }
+  double indexedMs = clock.End ();
+
+  //Cross check results
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < linearLookups; i++)
+    {
+      Ptr<ChordNode> linearNode;
+      Ptr<ChordNode> indexedNode;
+      LinearFindNearestNode (table, targets[i], linearNode);
+      table.FindNearestNode (targets[i], indexedNode);
+      if (linearNode != indexedNode)
+        {
+          mismatches++;
+        }
+    }
+
+  std::cout << std::setw (8) << tableSize
+            << std::setw (14) << linearMs * 1000000.0 / linearLookups
+            << std::setw (14) << indexedMs * 1000000.0 / lookups
+            << std::setw (12) << mismatches << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t lookups = 100000;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("lookups", "Number of FindNearestNode calls per table size", lookups);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+
+  RngSeedManager::SetSeed (seed);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (8) << "entries"
+            << std::setw (14) << "linear(ns)"
+            << std::setw (14) << "indexed(ns)"
+            << std::setw (12) << "mismatches" << std::endl;
+
+  uint32_t tableSizes[] = { 64, 1000, 100000 };
+  for (uint32_t i = 0; i < sizeof (tableSizes) / sizeof (tableSizes[0]); i++)
+    {
+      RunBenchmark (tableSizes[i], lookups, random);
+    }
+
+  return 0;
+}
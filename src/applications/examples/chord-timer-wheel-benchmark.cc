@@ -0,0 +1,271 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Scheduler event count for ChordIpv4 request timeouts.
+//
+// Replays the transaction pattern of a chord-run lookup load: every node
+// issues lookups at a fixed rate, each lookup holds a request timeout until
+// its response arrives (random RTT, some responses lost) and lost requests
+// are retransmitted up to MaxRequestRetries times. Timeouts are driven either
+// by one Simulator event per transaction (previous ChordIpv4 behaviour) or by
+// a ChordTimerWheel per node. Scheduler inserts, removals and executed events
+// are counted by wrapping the default map scheduler.
+//
+// ./waf --run "chord-timer-wheel-benchmark --nodes=64 --rate=50 --duration=60"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/chord-timer-wheel.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordTimerWheelBenchmark");
+
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::ChordBenchmarkCountingScheduler")
+      .SetParent<MapScheduler> ()
+      .AddConstructor<CountingScheduler> ()
+    ;
+    return tid;
+  }
+  virtual void Insert (const Scheduler::Event &ev)
+  {
+    inserts++;
+    MapScheduler::Insert (ev);
+  }
+  virtual Scheduler::Event RemoveNext (void)
+  {
+    executed++;
+    return MapScheduler::RemoveNext ();
+  }
+  virtual void Remove (const Scheduler::Event &ev)
+  {
+    removes++;
+    MapScheduler::Remove (ev);
+  }
+  static uint64_t inserts;
+  static uint64_t removes;
+  static uint64_t executed;
+};
+
+uint64_t CountingScheduler::inserts = 0;
+uint64_t CountingScheduler::removes = 0;
+uint64_t CountingScheduler::executed = 0;
+
+struct BenchmarkConfig
+{
+  uint32_t nodes;
+  double rate;
+  Time duration;
+  Time requestTimeout;
+  uint8_t maxRetries;
+  double lossRate;
+  bool useWheel;
+};
+
+// One chord node: outstanding transactions and their timeouts
+class TransactionNode
+{
+public:
+  TransactionNode (BenchmarkConfig &config, Ptr<UniformRandomVariable> random)
+    : m_config (config),
+      m_random (random),
+      m_nextTransactionId (0),
+      m_timeouts (0),
+      m_failures (0)
+  {
+  }
+  void Start (void)
+  {
+    Simulator::Schedule (Seconds (m_random->GetValue (0, 1.0 / m_config.rate)), &TransactionNode::Lookup, this);
+  }
+  void Lookup (void)
+  {
+    uint32_t transactionId = m_nextTransactionId++;
+    Transaction &transaction = m_transactions[transactionId];
+    transaction.retries = 0;
+    Send (transactionId);
+    if (Simulator::Now () + Seconds (1.0 / m_config.rate) < m_config.duration)
+    {
+      Simulator::Schedule (Seconds (1.0 / m_config.rate), &TransactionNode::Lookup, this);
+    }
+  }
+  void Send (uint32_t transactionId)
+  {
+    Transaction &transaction = m_transactions[transactionId];
+    if (m_config.useWheel)
+    {
+      transaction.wheelTimeout = m_wheel.Schedule (m_config.requestTimeout, &TransactionNode::HandleTimeout, this, transactionId);
+    }
+    else
+    {
+      transaction.timeout = Simulator::Schedule (m_config.requestTimeout, &TransactionNode::HandleTimeout, this, transactionId);
+    }
+    //Response over a few hops, unless lost
+    if (m_random->GetValue () >= m_config.lossRate)
+    {
+      Simulator::Schedule (MilliSeconds (m_random->GetInteger (2, 80)), &TransactionNode::HandleResponse, this, transactionId);
+    }
+  }
+  void HandleResponse (uint32_t transactionId)
+  {
+    std::map<uint32_t, Transaction>::iterator iter = m_transactions.find (transactionId);
+    if (iter == m_transactions.end ())
+      return;
+    //Same as ChordVNode::RemoveTransaction -> ChordTransaction::DoDispose
+    if (m_config.useWheel)
+    {
+      iter->second.wheelTimeout->Cancel ();
+    }
+    else
+    {
+      Simulator::Cancel (iter->second.timeout);
+    }
+    m_transactions.erase (iter);
+  }
+  void HandleTimeout (uint32_t transactionId)
+  {
+    m_timeouts++;
+    Transaction &transaction = m_transactions[transactionId];
+    if (transaction.retries >= m_config.maxRetries)
+    {
+      m_failures++;
+      m_transactions.erase (transactionId);
+      return;
+    }
+    transaction.retries++;
+    Send (transactionId);
+  }
+
+  uint64_t GetTimeouts (void) const
+  {
+    return m_timeouts;
+  }
+  uint64_t GetFailures (void) const
+  {
+    return m_failures;
+  }
+  uint64_t GetLookups (void) const
+  {
+    return m_nextTransactionId;
+  }
+
+private:
+  struct Transaction
+  {
+    uint8_t retries;
+    EventId timeout;
+    Ptr<EventImpl> wheelTimeout;
+  };
+  BenchmarkConfig &m_config;
+  Ptr<UniformRandomVariable> m_random;
+  std::map<uint32_t, Transaction> m_transactions;
+  ChordTimerWheel m_wheel;
+  uint32_t m_nextTransactionId;
+  uint64_t m_timeouts;
+  uint64_t m_failures;
+};
+
+static void
+RunScenario (BenchmarkConfig config, uint32_t seed)
+{
+  RngSeedManager::SetSeed (seed);
+  ObjectFactory schedulerFactory;
+  schedulerFactory.SetTypeId (CountingScheduler::GetTypeId ());
+  Simulator::SetScheduler (schedulerFactory);
+  CountingScheduler::inserts = 0;
+  CountingScheduler::removes = 0;
+  CountingScheduler::executed = 0;
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<TransactionNode *> nodes;
+  for (uint32_t i = 0; i < config.nodes; i++)
+    {
+      nodes.push_back (new TransactionNode (config, random));
+      nodes.back ()->Start ();
+    }
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t ms = clock.End ();
+
+  uint64_t lookups = 0, timeouts = 0, failures = 0;
+  for (uint32_t i = 0; i < config.nodes; i++)
+    {
+      lookups += nodes[i]->GetLookups ();
+      timeouts += nodes[i]->GetTimeouts ();
+      failures += nodes[i]->GetFailures ();
+      delete nodes[i];
+    }
+  Simulator::Destroy ();
+
+  std::cout << std::setw (12) << (config.useWheel ? "wheel" : "per-request")
+            << std::setw (10) << lookups
+            << std::setw (10) << timeouts
+            << std::setw (10) << failures
+            << std::setw (12) << CountingScheduler::inserts
+            << std::setw (12) << CountingScheduler::executed
+            << std::setw (12) << (double) CountingScheduler::inserts / lookups
+            << std::setw (10) << ms << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.nodes = 64;
+  config.rate = 50;
+  config.maxRetries = 3;
+  config.lossRate = 0.01;
+  double duration = 60;
+  uint32_t requestTimeout = 1000;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of chord nodes", config.nodes);
+  cmd.AddValue ("rate", "Lookups per second per node", config.rate);
+  cmd.AddValue ("duration", "Simulated seconds of lookup load", duration);
+  cmd.AddValue ("timeout", "Request timeout in milli seconds", requestTimeout);
+  cmd.AddValue ("loss", "Probability that response is lost", config.lossRate);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+  config.duration = Seconds (duration);
+  config.requestTimeout = MilliSeconds (requestTimeout);
+
+  std::cout << std::setw (12) << "timeouts"
+            << std::setw (10) << "lookups"
+            << std::setw (10) << "expired"
+            << std::setw (10) << "failed"
+            << std::setw (12) << "inserted"
+            << std::setw (12) << "executed"
+            << std::setw (12) << "ins/lookup"
+            << std::setw (10) << "wall(ms)" << std::endl;
+
+  config.useWheel = false;
+  RunScenario (config, seed);
+  config.useWheel = true;
+  RunScenario (config, seed);
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Chord with many vNodes per physical node, with per-vNode routing state and
+// messages (SharedFingerRouting and CoalesceMessages off) against shared
+// fingers and coalesced messages (both on).
+//
+// Same topology as chord-lookup-latency-benchmark (ChordBenchmarkHelper star:
+// nodes hang off a central router on links with one-way delay drawn from
+// [minDelay, maxDelay] ms). Every node runs --vnodes vNodes. After the ring
+// has stabilized and fingers have been fixed a few rounds, packets sent by
+// ChordIpv4 of all nodes are counted over a quiet window (pkt/s per node),
+// then random nodes look up random keys and latency is measured from
+// LookupKey until the success upcall. fingers is the number of distinct
+// finger entries of node 0 against the sum of finger table sizes of its
+// vNodes. Both runs use the same seed.
+//
+// ./waf --run "chord-vnode-scaling-benchmark --nodes=8 --vnodes=32"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <sstream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/chord-benchmark-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ChordVNodeScalingBenchmark");
+
+struct BenchmarkConfig
+{
+  uint32_t nodes;
+  uint32_t vNodes;
+  uint32_t lookups;
+  double lookupRate;
+  double minDelay;
+  double maxDelay;
+  double quiet;
+};
+
+class VNodeScalingRun
+{
+public:
+  VNodeScalingRun (BenchmarkConfig &config, bool shared)
+    : m_config (config),
+      m_shared (shared),
+      m_benchmark (GetBenchmarkConfig (config)),
+      m_sharedFingers (0),
+      m_fingerReferences (0),
+      m_issued (0)
+  {
+  }
+
+  void Run (void)
+  {
+    NodeContainer nodeContainer;
+    nodeContainer.Create (m_config.nodes);
+    std::vector<Ipv4Address> addresses = ChordBenchmarkHelper::BuildStar (nodeContainer, MicroSeconds (m_config.minDelay * 1000), MicroSeconds (m_config.maxDelay * 1000), 0);
+
+    m_benchmark.SetAttribute ("SharedFingerRouting", BooleanValue (m_shared));
+    m_benchmark.SetAttribute ("CoalesceMessages", BooleanValue (m_shared));
+    int64_t stream = m_benchmark.AssignStreams (1) + 1;
+    m_applications = m_benchmark.Install (nodeContainer, addresses);
+    m_random = CreateObject<UniformRandomVariable> ();
+    m_random->SetStream (stream);
+
+    //Messages are counted over quiet window, lookups follow it
+    Time quietEnd = m_benchmark.GetStartTime () + Seconds (m_config.quiet);
+    Simulator::Schedule (quietEnd, &VNodeScalingRun::CountFingers, this);
+    Simulator::Schedule (quietEnd, &VNodeScalingRun::Lookup, this);
+    Simulator::Stop (m_benchmark.GetStopTime ());
+    Simulator::Run ();
+    Report ();
+    Simulator::Destroy ();
+  }
+
+private:
+  static ChordBenchmarkConfig GetBenchmarkConfig (BenchmarkConfig &config)
+  {
+    //Staggered joins, one vNode of every node per round. Let ring stabilize, then fix fingers a few rounds
+    ChordBenchmarkConfig benchmarkConfig;
+    benchmarkConfig.vNodes = config.vNodes;
+    benchmarkConfig.joinInterval = MilliSeconds (100);
+    benchmarkConfig.vNodeJoinInterval = MilliSeconds (100) * (int64_t) config.nodes;
+    benchmarkConfig.settle = Seconds (10) + MilliSeconds (4 * DEFAULT_FIX_FINGER_INTERVAL);
+    benchmarkConfig.duration = Seconds (config.quiet);
+    benchmarkConfig.drain = Seconds (config.lookups / config.lookupRate + 30);
+    benchmarkConfig.lookupRate = 0;
+    return benchmarkConfig;
+  }
+  void CountFingers (void)
+  {
+    //Shared finger entries against per vNode finger tables of node 0
+    std::ostringstream os;
+    DynamicCast<ChordIpv4> (m_applications.Get (0))->DumpVNodeInfo ("vnode0", os);
+    std::string info = os.str ();
+    std::string::size_type position = info.find ("Shared Fingers (all vNodes): ");
+    if (position != std::string::npos)
+      {
+        std::istringstream is (info.substr (position + 29));
+        std::string text;
+        is >> m_sharedFingers >> text >> m_fingerReferences;
+      }
+  }
+  void Lookup (void)
+  {
+    if (m_issued == m_config.lookups)
+      {
+        return;
+      }
+    uint8_t key[ChordKey::NUM_BYTES];
+    for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+      {
+        key[b] = m_random->GetInteger (0, 255);
+      }
+    uint32_t nodeIndex;
+    if (m_benchmark.PickNode (false, true, nodeIndex))
+      {
+        m_benchmark.LookupKey (nodeIndex, ChordKey (key));
+        m_issued++;
+      }
+    Simulator::Schedule (Seconds (1.0 / m_config.lookupRate), &VNodeScalingRun::Lookup, this);
+  }
+  void Report (void)
+  {
+    std::ostringstream fingers;
+    fingers << m_sharedFingers << "/" << m_fingerReferences;
+    std::cout << std::setw (9) << (m_shared ? "shared" : "per-vnode")
+              << std::setw (8) << m_config.nodes
+              << std::setw (8) << m_config.vNodes
+              << std::setw (8) << m_benchmark.GetJoinedVNodes ()
+              << std::setw (10) << m_benchmark.GetMessages () / m_config.quiet / m_config.nodes
+              << std::setw (12) << fingers.str ()
+              << std::setw (10) << m_benchmark.GetSucceeded ()
+              << std::setw (8) << m_benchmark.GetFailed ()
+              << std::setw (10) << m_benchmark.GetMeanLatency ()
+              << std::setw (10) << m_benchmark.GetLatencyPercentile (99) << std::endl;
+  }
+
+  BenchmarkConfig &m_config;
+  bool m_shared;
+  ChordBenchmarkHelper m_benchmark;
+  ApplicationContainer m_applications;
+  Ptr<UniformRandomVariable> m_random;
+  uint32_t m_sharedFingers;
+  uint32_t m_fingerReferences;
+  uint32_t m_issued;
+};
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig config;
+  config.nodes = 8;
+  config.vNodes = 32;
+  config.lookups = 1000;
+  config.lookupRate = 50;
+  config.minDelay = 1;
+  config.maxDelay = 50;
+  config.quiet = 60;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of physical nodes", config.nodes);
+  cmd.AddValue ("vnodes", "Number of vNodes per physical node", config.vNodes);
+  cmd.AddValue ("lookups", "Number of lookups", config.lookups);
+  cmd.AddValue ("rate", "Lookups per second (whole ring)", config.lookupRate);
+  cmd.AddValue ("minDelay", "Min one-way delay of node to router link in milli seconds", config.minDelay);
+  cmd.AddValue ("maxDelay", "Max one-way delay of node to router link in milli seconds", config.maxDelay);
+  cmd.AddValue ("quiet", "Seconds of quiet window", config.quiet);
+  cmd.AddValue ("seed", "Random seed", seed);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (9) << "routing"
+            << std::setw (8) << "nodes"
+            << std::setw (8) << "vnodes"
+            << std::setw (8) << "joined"
+            << std::setw (10) << "pkt/s"
+            << std::setw (12) << "fingers"
+            << std::setw (10) << "resolved"
+            << std::setw (8) << "failed"
+            << std::setw (10) << "mean(ms)"
+            << std::setw (10) << "p99(ms)" << std::endl;
+  for (uint32_t shared = 0; shared < 2; shared++)
+    {
+      RngSeedManager::SetSeed (seed);
+      VNodeScalingRun run (config, shared == 1);
+      run.Run ();
+    }
+  return 0;
+}
@@ -0,0 +1,287 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// DHash transfer throughput between two nodes, with and without bulk
+// messages (DHashBulkTransferSize).
+//
+// Two nodes on a point-to-point link. The first node forms the ring alone (vnode
+// identifier 0) and stores all objects locally, with keys in (0, 2^159). The
+// second node then joins at 2^159, taking over all of them: handoff throughput
+// is objects (and object bytes) per simulated second from join until the
+// second node stores every object. The first node then retrieves every object,
+// keeping a window of retrieves outstanding (each retrieve also does a Chord
+// lookup, one UDP request per key).
+//
+// ./waf --run "dhash-bulk-transfer-benchmark --objects=10000 --size=4096"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/chord-ipv4-helper.h"
+#include "ns3/chord-ipv4.h"
+#include "ns3/chord-key.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DHashBulkTransferBenchmark");
+
+class BulkTransferRun
+{
+public:
+  BulkTransferRun (uint32_t objects, uint32_t size, uint32_t window, uint32_t bulkTransferSize)
+    : m_objects (objects),
+      m_size (size),
+      m_window (window),
+      m_bulkTransferSize (bulkTransferSize),
+      m_inserted (0),
+      m_nextRetrieve (0),
+      m_retrieved (0),
+      m_retrieveFailures (0)
+  {
+  }
+
+  void Run (void)
+  {
+    NodeContainer nodeContainer;
+    nodeContainer.Create (2);
+    InternetStackHelper internet;
+    internet.Install (nodeContainer);
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+    pointToPoint.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (500)));
+    NetDeviceContainer devices = pointToPoint.Install (nodeContainer);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase ("10.1.0.0", "255.255.0.0");
+    Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+    uint16_t port = 2000;
+    for (uint32_t j = 0; j < 2; j++)
+      {
+        ChordIpv4Helper helper (interfaces.GetAddress (0), port, interfaces.GetAddress (j), port, port + 1, port + 2);
+        helper.SetAttribute ("DHashBulkTransferSize", UintegerValue (m_bulkTransferSize));
+        ApplicationContainer apps = helper.Install (nodeContainer.Get (j));
+        apps.Start (Seconds (0.0));
+        Ptr<ChordIpv4> chordApplication = nodeContainer.Get (j)->GetApplication (0)->GetObject<ChordIpv4> ();
+        m_applications.push_back (chordApplication);
+      }
+    m_applications[0]->SetInsertSuccessCallback (MakeCallback (&BulkTransferRun::InsertSuccess, this));
+    m_applications[0]->SetInsertFailureCallback (MakeCallback (&BulkTransferRun::InsertFailure, this));
+    m_applications[0]->SetRetrieveSuccessCallback (MakeCallback (&BulkTransferRun::RetrieveSuccess, this));
+    m_applications[0]->SetRetrieveFailureCallback (MakeCallback (&BulkTransferRun::RetrieveFailure, this));
+
+    //Keys in (0, 2^(8*NUM_BYTES-1)) move to second node on its join
+    for (uint32_t k = 0; k < m_objects; k++)
+      {
+        uint8_t key[ChordKey::NUM_BYTES] = {0};
+        key[0] = (uint8_t) k;
+        key[1] = (uint8_t) (k >> 8);
+        key[2] = (uint8_t) (k >> 16);
+        key[ChordKey::NUM_BYTES - 1] = 0x01 + k % 0x7f;
+        m_keys.push_back (ChordKey (key));
+      }
+    Simulator::Schedule (MilliSeconds (100), &BulkTransferRun::Join, this, 0);
+    Simulator::Schedule (Seconds (5), &BulkTransferRun::InsertAll, this);
+    Simulator::Schedule (Seconds (10), &BulkTransferRun::Join, this, 1);
+    Simulator::Stop (Seconds (3600));
+    Simulator::Run ();
+    Report ();
+    Simulator::Destroy ();
+  }
+
+private:
+  void Join (uint32_t nodeIndex)
+  {
+    //VNode identifiers 0 and 2^(8*NUM_BYTES-1)
+    std::ostringstream name;
+    name << "vnode" << nodeIndex;
+    uint8_t key[ChordKey::NUM_BYTES] = {0};
+    key[ChordKey::NUM_BYTES - 1] = (nodeIndex == 0) ? 0x00 : 0x80;
+    if (nodeIndex == 1)
+      {
+        m_start = Simulator::Now ();
+        Simulator::Schedule (MilliSeconds (1), &BulkTransferRun::CheckHandoff, this);
+      }
+    m_applications[nodeIndex]->InsertVNode (name.str (), key, ChordKey::NUM_BYTES);
+  }
+  void InsertAll (void)
+  {
+    //Single node ring, stored locally
+    std::vector<uint8_t> object (m_size);
+    for (uint32_t k = 0; k < m_objects; k++)
+      {
+        for (uint32_t b = 0; b < m_size; b++)
+          {
+            object[b] = (uint8_t) (k + b);
+          }
+        m_applications[0]->Insert (m_keys[k], &object[0], m_size);
+      }
+  }
+  void InsertSuccess (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    m_inserted++;
+  }
+  void InsertFailure (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+  }
+  uint32_t StoredObjects (uint32_t nodeIndex)
+  {
+    std::ostringstream os;
+    m_applications[nodeIndex]->DumpDHashInfo (os);
+    std::string info = os.str ();
+    std::string::size_type pos = info.find ("Stored DHash Objects: ");
+    return atoi (info.c_str () + pos + strlen ("Stored DHash Objects: "));
+  }
+  void CheckHandoff (void)
+  {
+    if (StoredObjects (1) < m_inserted)
+      {
+        Simulator::Schedule (MilliSeconds (1), &BulkTransferRun::CheckHandoff, this);
+        return;
+      }
+    m_handoffTime = Simulator::Now () - m_start;
+    //Let ring settle before retrieving
+    Simulator::Schedule (Seconds (5), &BulkTransferRun::RetrieveAll, this);
+  }
+  void RetrieveAll (void)
+  {
+    m_start = Simulator::Now ();
+    while (m_nextRetrieve < std::min (m_window, m_objects))
+      {
+        m_applications[0]->Retrieve (m_keys[m_nextRetrieve++]);
+      }
+  }
+  void RetrieveSuccess (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    m_retrieved++;
+    RetrieveDone ();
+  }
+  void RetrieveFailure (uint8_t *key, uint8_t keyBytes)
+  {
+    m_retrieveFailures++;
+    RetrieveDone ();
+  }
+  void RetrieveDone (void)
+  {
+    if (m_nextRetrieve < m_objects)
+      {
+        m_applications[0]->Retrieve (m_keys[m_nextRetrieve++]);
+      }
+    else if (m_retrieved + m_retrieveFailures == m_objects)
+      {
+        m_retrieveTime = Simulator::Now () - m_start;
+        Simulator::Stop ();
+      }
+  }
+  void Report (void)
+  {
+    double megaBytes = (double) m_size * m_objects / (1024 * 1024);
+    double handoffSeconds = std::max (m_handoffTime.GetSeconds (), 1e-9);
+    double retrieveSeconds = std::max (m_retrieveTime.GetSeconds (), 1e-9);
+    std::cout << std::setw (8) << m_objects
+              << std::setw (6) << m_size
+              << std::setw (7) << m_bulkTransferSize
+              << std::setw (12) << (m_handoffTime.IsZero () ? 0 : m_objects / handoffSeconds)
+              << std::setw (10) << (m_handoffTime.IsZero () ? 0 : megaBytes / handoffSeconds)
+              << std::setw (9) << m_retrieveFailures
+              << std::setw (12) << (m_retrieveTime.IsZero () ? 0 : m_objects / retrieveSeconds)
+              << std::setw (10) << (m_retrieveTime.IsZero () ? 0 : megaBytes / retrieveSeconds) << std::endl;
+  }
+
+  uint32_t m_objects;
+  uint32_t m_size;
+  uint32_t m_window;
+  uint32_t m_bulkTransferSize;
+  std::vector<Ptr<ChordIpv4> > m_applications;
+  std::vector<ChordKey> m_keys;
+  uint32_t m_inserted;
+  uint32_t m_nextRetrieve;
+  uint32_t m_retrieved;
+  uint32_t m_retrieveFailures;
+  Time m_start;
+  Time m_handoffTime;
+  Time m_retrieveTime;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t objects = 0;
+  uint32_t size = 0;
+  uint32_t window = 64;
+  uint32_t bulkTransferSize = 65536;
+
+  CommandLine cmd;
+  cmd.AddValue ("objects", "Number of objects (0 runs 1000 and 10000)", objects);
+  cmd.AddValue ("size", "Object size in bytes (0 runs 256 and 4096)", size);
+  cmd.AddValue ("window", "Retrieves outstanding at a time", window);
+  cmd.AddValue ("bulk", "DHashBulkTransferSize compared with 0 (unbatched)", bulkTransferSize);
+  cmd.Parse (argc, argv);
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  //Requests must not expire while queued behind the whole batch
+  Config::SetDefault ("ns3::DHashIpv4::RequestTimeout", TimeValue (Seconds (600)));
+
+  std::vector<uint32_t> objectCounts;
+  std::vector<uint32_t> sizes;
+  if (objects)
+    {
+      objectCounts.push_back (objects);
+    }
+  else
+    {
+      objectCounts.push_back (1000);
+      objectCounts.push_back (10000);
+    }
+  if (size)
+    {
+      sizes.push_back (size);
+    }
+  else
+    {
+      sizes.push_back (256);
+      sizes.push_back (4096);
+    }
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (8) << "objects"
+            << std::setw (6) << "size"
+            << std::setw (7) << "bulk"
+            << std::setw (12) << "hand(obj/s)"
+            << std::setw (10) << "hand(MB/s)"
+            << std::setw (9) << "ret-fail"
+            << std::setw (12) << "ret(obj/s)"
+            << std::setw (10) << "ret(MB/s)" << std::endl;
+  for (uint32_t i = 0; i < objectCounts.size (); i++)
+    {
+      for (uint32_t j = 0; j < sizes.size (); j++)
+        {
+          BulkTransferRun unbatched (objectCounts[i], sizes[j], window, 0);
+          unbatched.Run ();
+          BulkTransferRun batched (objectCounts[i], sizes[j], window, bulkTransferSize);
+          batched.Run ();
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,124 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Encode and decode throughput of DHashErasureCode.
+//
+// For each (m, n) an object is coded into n fragments, and rebuilt from the
+// last m fragments (the most parity, so the worst case for decode). Throughput
+// is object bytes per wall clock second, for the table kernel and, when built
+// with SSSE3 (e.g. CXXFLAGS=-march=native), the pshufb kernel. The stored
+// column compares bytes held by the ring with whole copies giving the same loss
+// tolerance (n - m + 1 replicas).
+//
+// ./waf --run "dhash-erasure-code-benchmark --size=65536 --iterations=2000"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include "ns3/core-module.h"
+#include "ns3/dhash-erasure-code.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DHashErasureCodeBenchmark");
+
+static void
+RunCode (uint8_t m, uint8_t n, uint32_t size, uint32_t iterations, bool vectorized)
+{
+  DHashErasureCode erasureCode (m);
+  erasureCode.SetVectorized (vectorized);
+  if (vectorized && !erasureCode.IsVectorized ())
+    {
+      return;
+    }
+  std::vector<uint8_t> object (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      object[i] = (uint8_t) (i * 131 + 7);
+    }
+  uint32_t fragmentSize = erasureCode.GetFragmentSize (size);
+  std::vector<std::vector<uint8_t> > fragments (n, std::vector<uint8_t> (fragmentSize));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t k = 0; k < iterations; k++)
+    {
+      for (uint8_t i = 0; i < n; i++)
+        {
+          erasureCode.Encode (i, &object[0], size, &fragments[i][0]);
+        }
+    }
+  int64_t encodeMs = clock.End ();
+
+  std::vector<uint8_t> fragmentIndices;
+  std::vector<const uint8_t*> fragmentData;
+  for (uint8_t i = n - m; i < n; i++)
+    {
+      fragmentIndices.push_back (i);
+      fragmentData.push_back (&fragments[i][0]);
+    }
+  std::vector<uint8_t> decoded (size);
+  bool ok = true;
+  clock.Start ();
+  for (uint32_t k = 0; k < iterations; k++)
+    {
+      ok = erasureCode.Decode (fragmentIndices, fragmentData, size, &decoded[0]) && ok;
+    }
+  int64_t decodeMs = clock.End ();
+  ok = ok && memcmp (&decoded[0], &object[0], size) == 0;
+
+  double megaBytes = (double) size * iterations / (1024 * 1024);
+  std::cout << std::setw (4) << (uint16_t) m
+            << std::setw (4) << (uint16_t) n
+            << std::setw (8) << (vectorized ? "ssse3" : "table")
+            << std::setw (12) << megaBytes * 1000 / std::max<int64_t> (encodeMs, 1)
+            << std::setw (12) << megaBytes * 1000 / std::max<int64_t> (decodeMs, 1)
+            << std::setw (10) << (double) n * fragmentSize / size
+            << std::setw (10) << (double) (n - m + 1)
+            << std::setw (6) << (ok ? "ok" : "FAIL") << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t size = 65536;
+  uint32_t iterations = 2000;
+
+  CommandLine cmd;
+  cmd.AddValue ("size", "Object size in bytes", size);
+  cmd.AddValue ("iterations", "Objects encoded and decoded per configuration", iterations);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (4) << "m"
+            << std::setw (4) << "n"
+            << std::setw (8) << "kernel"
+            << std::setw (12) << "enc(MB/s)"
+            << std::setw (12) << "dec(MB/s)"
+            << std::setw (10) << "stored"
+            << std::setw (10) << "replicas" << std::endl;
+  uint8_t codes[][2] = { {2, 3}, {2, 4}, {4, 6}, {4, 8}, {8, 12}, {16, 24} };
+  for (uint32_t c = 0; c < sizeof (codes) / sizeof (codes[0]); c++)
+    {
+      RunCode (codes[c][0], codes[c][1], size, iterations, false);
+      RunCode (codes[c][0], codes[c][1], size, iterations, true);
+    }
+  return 0;
+}
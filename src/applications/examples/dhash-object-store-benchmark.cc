@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Memory use and throughput of DHash storage backends (DHashObjectStore).
+//
+// Objects with random keys are added to the store, then all of them are
+// retrieved in random order, then the ring is handed off in 16 ordered range
+// scans (GetRange) and finally all objects are removed. Throughput is objects
+// per wall clock second. rss is resident memory held once all objects are
+// stored, minus resident memory before; peak is the process peak so far (run
+// one store per process, e.g. --store=ns3::DHashLogStore, for exact peaks).
+// --store=both runs DHashLogStore before DHashMapStore.
+//
+// ./waf --run "dhash-object-store-benchmark --objects=1000000 --size=1024"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/chord-key.h"
+#include "ns3/chord-identifier.h"
+#include "ns3/dhash-object.h"
+#include "ns3/dhash-object-store.h"
+#include "ns3/dhash-log-store.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DHashObjectStoreBenchmark");
+
+static double
+ResidentMegaBytes (void)
+{
+  //Current resident set (Linux)
+  std::ifstream statm ("/proc/self/statm");
+  uint64_t size = 0, resident = 0;
+  statm >> size >> resident;
+  return (double) resident * sysconf (_SC_PAGESIZE) / (1024 * 1024);
+}
+
+static double
+PeakMegaBytes (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return (double) usage.ru_maxrss / 1024;
+}
+
+static double
+Rate (uint32_t count, int64_t ms)
+{
+  return (double) count * 1000 / std::max<int64_t> (ms, 1);
+}
+
+static void
+RunStore (std::string storeType, std::vector<ChordKey> &keys, uint32_t size)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (storeType);
+  Ptr<DHashObjectStore> store = factory.Create<DHashObjectStore> ();
+  store->Open ("benchmark");
+  double residentBefore = ResidentMegaBytes ();
+
+  std::vector<uint8_t> object (size);
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t k = 0; k < keys.size (); k++)
+    {
+      for (uint32_t b = 0; b < size; b += 64)
+        {
+          object[b] = (uint8_t) (k + b);
+        }
+      store->Add (Create<DHashObject> (Create<ChordIdentifier> (keys[k]), &object[0], size));
+    }
+  int64_t insertMs = clock.End ();
+  double resident = ResidentMegaBytes () - residentBefore;
+
+  std::vector<uint32_t> order (keys.size ());
+  for (uint32_t k = 0; k < keys.size (); k++)
+    {
+      order[k] = k;
+    }
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  for (uint32_t k = keys.size (); k > 1; k--)
+    {
+      std::swap (order[k - 1], order[random->GetInteger (0, k - 1)]);
+    }
+  uint32_t found = 0;
+  clock.Start ();
+  for (uint32_t k = 0; k < keys.size (); k++)
+    {
+      Ptr<DHashObject> dHashObject;
+      if (store->Find (Create<ChordIdentifier> (keys[order[k]]), dHashObject) && dHashObject->GetSizeOfObject () == size)
+        {
+          found++;
+        }
+    }
+  int64_t retrieveMs = clock.End ();
+
+  //Hand off ring in 16 ranges, as on predecessor changes
+  uint32_t scanned = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < 16; r++)
+    {
+      uint8_t low[ChordKey::NUM_BYTES] = {0};
+      uint8_t high[ChordKey::NUM_BYTES] = {0};
+      low[ChordKey::NUM_BYTES - 1] = r * 16;
+      high[ChordKey::NUM_BYTES - 1] = r * 16 + 16;
+      std::vector<Ptr<DHashObject> > objects;
+      store->GetRange (Create<ChordIdentifier> (low, ChordKey::NUM_BYTES), Create<ChordIdentifier> (high, ChordKey::NUM_BYTES), objects, 0);
+      scanned += objects.size ();
+    }
+  int64_t scanMs = clock.End ();
+
+  clock.Start ();
+  for (uint32_t k = 0; k < keys.size (); k++)
+    {
+      store->Remove (Create<ChordIdentifier> (keys[k]));
+    }
+  int64_t removeMs = clock.End ();
+
+  std::cout << std::setw (18) << storeType
+            << std::setw (10) << keys.size ()
+            << std::setw (7) << size
+            << std::setw (12) << Rate (keys.size (), insertMs)
+            << std::setw (12) << Rate (keys.size (), retrieveMs)
+            << std::setw (12) << Rate (scanned, scanMs)
+            << std::setw (12) << Rate (keys.size (), removeMs)
+            << std::setw (10) << resident
+            << std::setw (10) << PeakMegaBytes ()
+            << std::setw (6) << ((found == keys.size () && scanned == keys.size () && store->GetSize () == 0) ? "ok" : "FAIL") << std::endl;
+  store->Dispose ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t objects = 200000;
+  uint32_t size = 1024;
+  std::string store = "both";
+  std::string directory = "/tmp";
+
+  CommandLine cmd;
+  cmd.AddValue ("objects", "Number of objects stored", objects);
+  cmd.AddValue ("size", "Object size in bytes", size);
+  cmd.AddValue ("store", "TypeId of DHashObjectStore, or both", store);
+  cmd.AddValue ("directory", "Directory of DHashLogStore log file", directory);
+  cmd.Parse (argc, argv);
+  Config::SetDefault ("ns3::DHashLogStore::Directory", StringValue (directory));
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<ChordKey> keys (objects);
+  for (uint32_t k = 0; k < objects; k++)
+    {
+      uint8_t key[ChordKey::NUM_BYTES];
+      for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+        {
+          key[b] = random->GetInteger (0, 255);
+        }
+      keys[k] = ChordKey (key);
+    }
+  //Duplicate keys would be stored once
+  std::sort (keys.begin (), keys.end ());
+  keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+  std::random_shuffle (keys.begin (), keys.end ());
+
+  std::cout << std::fixed << std::setprecision (1);
+  std::cout << std::setw (18) << "store"
+            << std::setw (10) << "objects"
+            << std::setw (7) << "size"
+            << std::setw (12) << "add(obj/s)"
+            << std::setw (12) << "find(obj/s)"
+            << std::setw (12) << "scan(obj/s)"
+            << std::setw (12) << "rem(obj/s)"
+            << std::setw (10) << "rss(MB)"
+            << std::setw (10) << "peak(MB)" << std::endl;
+  if (store == "both")
+    {
+      RunStore ("ns3::DHashLogStore", keys, size);
+      RunStore ("ns3::DHashMapStore", keys, size);
+    }
+  else
+    {
+      RunStore (store, keys, size);
+    }
+  return 0;
+}
@@ -0,0 +1,354 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// DHash range retrieve (RetrieveRange) against one Retrieve per key.
+//
+// Nodes on one CSMA segment, one vnode per node at random identifiers. Once the
+// ring has stabilized, objects with random keys are inserted from random nodes.
+// The first node then fetches every object with key in (low, high], where the
+// range covers a given fraction of the ring: once with a range retrieve paged
+// along the successors, once with a window of single retrieves for the keys
+// known to be in the range. Reported are objects per simulated second and, for
+// the range retrieve, whether every key in the range came back exactly once.
+// With --replicas and --fragments objects are erasure coded, and the range
+// retrieve rebuilds each of them from fragments.
+//
+// ./waf --run "dhash-range-query-benchmark --nodes=8 --objects=2000 --span=0.5"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/chord-ipv4-helper.h"
+#include "ns3/chord-ipv4.h"
+#include "ns3/chord-key.h"
+#include "ns3/chord-identifier.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DHashRangeQueryBenchmark");
+
+class RangeQueryRun
+{
+public:
+  RangeQueryRun (uint32_t nodes, uint32_t objects, double span, uint32_t pageSize, uint32_t window, uint32_t replicas, uint32_t fragments, bool useRange)
+    : m_nodes (nodes),
+      m_objects (objects),
+      m_span (span),
+      m_pageSize (pageSize),
+      m_window (window),
+      m_replicas (replicas),
+      m_fragments (fragments),
+      m_useRange (useRange),
+      m_inserted (0),
+      m_nextRetrieve (0),
+      m_retrieved (0),
+      m_duplicates (0),
+      m_failures (0),
+      m_queryId (0),
+      m_success (false)
+  {
+    m_random = CreateObject<UniformRandomVariable> ();
+    //Same ring and keys for both modes
+    m_random->SetStream (1);
+  }
+
+  void Run (void)
+  {
+    NodeContainer nodeContainer;
+    nodeContainer.Create (m_nodes);
+    InternetStackHelper internet;
+    internet.Install (nodeContainer);
+    CsmaHelper csma;
+    csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+    csma.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (500)));
+    csma.SetDeviceAttribute ("Mtu", UintegerValue (1400));
+    NetDeviceContainer devices = csma.Install (nodeContainer);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase ("10.1.0.0", "255.255.0.0");
+    Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+    uint16_t port = 2000;
+    for (uint32_t j = 0; j < m_nodes; j++)
+      {
+        ChordIpv4Helper helper (interfaces.GetAddress (0), port, interfaces.GetAddress (j), port, port + 1, port + 2);
+        helper.SetAttribute ("DHashRangePageSize", UintegerValue (m_pageSize));
+        helper.SetAttribute ("DHashReplicationFactor", UintegerValue (m_replicas));
+        helper.SetAttribute ("DHashDataFragments", UintegerValue (m_fragments));
+        ApplicationContainer apps = helper.Install (nodeContainer.Get (j));
+        apps.Start (Seconds (0.0));
+        Ptr<ChordIpv4> chordApplication = nodeContainer.Get (j)->GetApplication (0)->GetObject<ChordIpv4> ();
+        chordApplication->SetInsertSuccessCallback (MakeCallback (&RangeQueryRun::InsertSuccess, this));
+        chordApplication->SetInsertFailureCallback (MakeCallback (&RangeQueryRun::InsertFailure, this));
+        m_applications.push_back (chordApplication);
+        //Staggered joins
+        Simulator::Schedule (MilliSeconds (100 + 250 * j), &RangeQueryRun::Join, this, j);
+      }
+    m_applications[0]->SetRetrieveSuccessCallback (MakeCallback (&RangeQueryRun::RetrieveSuccess, this));
+    m_applications[0]->SetRetrieveFailureCallback (MakeCallback (&RangeQueryRun::RetrieveFailure, this));
+    m_applications[0]->SetRetrieveRangeCallback (MakeCallback (&RangeQueryRun::RetrieveRange, this));
+    m_applications[0]->SetRetrieveRangeCompleteCallback (MakeCallback (&RangeQueryRun::RetrieveRangeComplete, this));
+
+    //Range (low, high] covers m_span of the ring
+    uint8_t low[ChordKey::NUM_BYTES];
+    for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+      {
+        low[b] = m_random->GetInteger (0, 255);
+      }
+    uint8_t high[ChordKey::NUM_BYTES];
+    memcpy (high, low, ChordKey::NUM_BYTES);
+    high[ChordKey::NUM_BYTES - 1] += (uint8_t) std::min (m_span * 256, 255.0);
+    m_low = ChordKey (low);
+    m_high = ChordKey (high);
+    Ptr<ChordIdentifier> lowIdentifier = Create<ChordIdentifier> (low, ChordKey::NUM_BYTES);
+    Ptr<ChordIdentifier> highIdentifier = Create<ChordIdentifier> (high, ChordKey::NUM_BYTES);
+
+    double insertStart = 10 + 0.25 * m_nodes;
+    for (uint32_t k = 0; k < m_objects; k++)
+      {
+        uint8_t key[ChordKey::NUM_BYTES];
+        for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+          {
+            key[b] = m_random->GetInteger (0, 255);
+          }
+        m_keys.push_back (ChordKey (key));
+        if (Create<ChordIdentifier> (key, ChordKey::NUM_BYTES)->IsInBetween (lowIdentifier, highIdentifier))
+          {
+            m_rangeKeys.push_back (ChordKey (key));
+          }
+        Simulator::Schedule (Seconds (insertStart + m_random->GetValue (0, 10)), &RangeQueryRun::Insert, this, k);
+      }
+    Simulator::Schedule (Seconds (insertStart + 20), &RangeQueryRun::Query, this);
+    Simulator::Stop (Seconds (3600));
+    Simulator::Run ();
+    Report ();
+    Simulator::Destroy ();
+  }
+
+private:
+  void Join (uint32_t nodeIndex)
+  {
+    std::ostringstream name;
+    name << "vnode" << nodeIndex;
+    uint8_t key[ChordKey::NUM_BYTES];
+    for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+      {
+        key[b] = m_random->GetInteger (0, 255);
+      }
+    m_applications[nodeIndex]->InsertVNode (name.str (), key, ChordKey::NUM_BYTES);
+  }
+  void Insert (uint32_t objectIndex)
+  {
+    uint8_t object[256];
+    for (uint32_t b = 0; b < sizeof (object); b++)
+      {
+        object[b] = (uint8_t) objectIndex;
+      }
+    m_applications[m_random->GetInteger (0, m_nodes - 1)]->Insert (m_keys[objectIndex], object, sizeof (object));
+  }
+  void InsertSuccess (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    m_inserted++;
+  }
+  void InsertFailure (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+  }
+  void Query (void)
+  {
+    m_start = Simulator::Now ();
+    if (m_useRange)
+      {
+        m_queryId = m_applications[0]->RetrieveRange (m_low, m_high);
+        return;
+      }
+    if (m_rangeKeys.empty ())
+      {
+        m_success = true;
+        Simulator::Stop ();
+        return;
+      }
+    while (m_nextRetrieve < std::min (m_window, (uint32_t) m_rangeKeys.size ()))
+      {
+        m_applications[0]->Retrieve (m_rangeKeys[m_nextRetrieve++]);
+      }
+  }
+  void RetrieveRange (uint32_t queryId, uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    if (queryId != m_queryId)
+      {
+        return;
+      }
+    if (m_received.insert (ChordKey (key)).second)
+      {
+        m_retrieved++;
+      }
+    else
+      {
+        m_duplicates++;
+      }
+  }
+  void RetrieveRangeComplete (uint32_t queryId, bool success)
+  {
+    if (queryId != m_queryId)
+      {
+        return;
+      }
+    m_success = success;
+    m_queryTime = Simulator::Now () - m_start;
+    Simulator::Stop ();
+  }
+  void RetrieveSuccess (uint8_t *key, uint8_t keyBytes, Ptr<const Packet> object)
+  {
+    m_received.insert (ChordKey (key));
+    m_retrieved++;
+    RetrieveDone ();
+  }
+  void RetrieveFailure (uint8_t *key, uint8_t keyBytes)
+  {
+    m_failures++;
+    RetrieveDone ();
+  }
+  void RetrieveDone (void)
+  {
+    if (m_nextRetrieve < m_rangeKeys.size ())
+      {
+        m_applications[0]->Retrieve (m_rangeKeys[m_nextRetrieve++]);
+      }
+    else if (m_retrieved + m_failures == m_rangeKeys.size ())
+      {
+        m_success = (m_failures == 0);
+        m_queryTime = Simulator::Now () - m_start;
+        Simulator::Stop ();
+      }
+  }
+  void Report (void)
+  {
+    //Keys in range that were stored but not returned
+    uint32_t missing = 0;
+    for (std::vector<ChordKey>::iterator keyIter = m_rangeKeys.begin (); keyIter != m_rangeKeys.end (); keyIter++)
+      {
+        if (m_received.find (*keyIter) == m_received.end ())
+          {
+            missing++;
+          }
+      }
+    double seconds = std::max (m_queryTime.GetSeconds (), 1e-9);
+    std::cout << std::setw (6) << m_nodes
+              << std::setw (8) << m_objects
+              << std::setw (6) << m_span
+              << std::setw (8) << (m_useRange ? "range" : "single")
+              << std::setw (6) << m_pageSize
+              << std::setw (9) << m_inserted
+              << std::setw (9) << m_rangeKeys.size ()
+              << std::setw (9) << m_retrieved
+              << std::setw (8) << missing
+              << std::setw (6) << m_duplicates
+              << std::setw (5) << (m_success ? "ok" : "fail")
+              << std::setw (10) << m_queryTime.GetSeconds () * 1000
+              << std::setw (12) << (m_queryTime.IsZero () ? 0 : m_retrieved / seconds) << std::endl;
+  }
+
+  uint32_t m_nodes;
+  uint32_t m_objects;
+  double m_span;
+  uint32_t m_pageSize;
+  uint32_t m_window;
+  uint32_t m_replicas;
+  uint32_t m_fragments;
+  bool m_useRange;
+  Ptr<UniformRandomVariable> m_random;
+  std::vector<Ptr<ChordIpv4> > m_applications;
+  std::vector<ChordKey> m_keys;
+  std::vector<ChordKey> m_rangeKeys;
+  std::set<ChordKey> m_received;
+  ChordKey m_low;
+  ChordKey m_high;
+  uint32_t m_inserted;
+  uint32_t m_nextRetrieve;
+  uint32_t m_retrieved;
+  uint32_t m_duplicates;
+  uint32_t m_failures;
+  uint32_t m_queryId;
+  bool m_success;
+  Time m_start;
+  Time m_queryTime;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 8;
+  uint32_t objects = 2000;
+  double span = 0;
+  uint32_t pageSize = 64;
+  uint32_t window = 64;
+  uint32_t replicas = 1;
+  uint32_t fragments = 0;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("objects", "Number of objects stored", objects);
+  cmd.AddValue ("span", "Fraction of ring covered by range (0 runs 0.1, 0.5 and 0.95)", span);
+  cmd.AddValue ("page", "DHashRangePageSize (objects per range response)", pageSize);
+  cmd.AddValue ("window", "Single retrieves outstanding at a time", window);
+  cmd.AddValue ("replicas", "DHashReplicationFactor", replicas);
+  cmd.AddValue ("fragments", "DHashDataFragments, any this many of replicas fragments rebuild object (0 stores whole copies)", fragments);
+  cmd.Parse (argc, argv);
+
+  std::vector<double> spans;
+  if (span > 0)
+    {
+      spans.push_back (span);
+    }
+  else
+    {
+      spans.push_back (0.1);
+      spans.push_back (0.5);
+      spans.push_back (0.95);
+    }
+
+  std::cout << std::fixed << std::setprecision (2);
+  std::cout << std::setw (6) << "nodes"
+            << std::setw (8) << "objects"
+            << std::setw (6) << "span"
+            << std::setw (8) << "mode"
+            << std::setw (6) << "page"
+            << std::setw (9) << "inserted"
+            << std::setw (9) << "in-range"
+            << std::setw (9) << "received"
+            << std::setw (8) << "missing"
+            << std::setw (6) << "dups"
+            << std::setw (5) << "end"
+            << std::setw (10) << "time(ms)"
+            << std::setw (12) << "obj/s" << std::endl;
+  for (uint32_t i = 0; i < spans.size (); i++)
+    {
+      RngSeedManager::SetRun (i + 1);
+      RangeQueryRun single (nodes, objects, spans[i], pageSize, window, replicas, fragments, false);
+      single.Run ();
+      RngSeedManager::SetRun (i + 1);
+      RangeQueryRun range (nodes, objects, spans[i], pageSize, window, replicas, fragments, true);
+      range.Run ();
+    }
+  return 0;
+}
@@ -0,0 +1,698 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//include(s)
+
+#include <sys/resource.h>
+#include <sstream>
+#include <algorithm>
+#include "chord-benchmark-helper.h"
+#include "chord-ipv4-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/integer.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/csma-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ChordBenchmarkHelper");
+
+ChordBenchmarkConfig::ChordBenchmarkConfig ()
+  : vNodes (1),
+    joinInterval (MilliSeconds (250)),
+    vNodeJoinInterval (Seconds (0)),
+    settle (Seconds (30)),
+    duration (Seconds (60)),
+    drain (Seconds (10)),
+    lookupRate (10),
+    keys (10000),
+    zipfAlpha (0),
+    churnRate (0),
+    crashFraction (0.5),
+    downtime (Seconds (30)),
+    latencyBin (MilliSeconds (10))
+{
+}
+
+ChordBenchmarkHelper::ChordBenchmarkHelper (const ChordBenchmarkConfig &config)
+  : m_config (config),
+    m_measuring (false),
+    m_issued (0),
+    m_succeeded (0),
+    m_correct (0),
+    m_failed (0),
+    m_messages (0),
+    m_bytes (0),
+    m_departures (0),
+    m_crashes (0)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_exponential = CreateObject<ExponentialRandomVariable> ();
+  if (m_config.zipfAlpha > 0)
+  {
+    m_zipf = CreateObject<ZipfRandomVariable> ();
+    m_zipf->SetAttribute ("N", IntegerValue (m_config.keys));
+    m_zipf->SetAttribute ("Alpha", DoubleValue (m_config.zipfAlpha));
+  }
+} //Constructor
+
+void
+ChordBenchmarkHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_attributes.push_back (std::make_pair (name, value.Copy ()));
+}
+
+ApplicationContainer
+ChordBenchmarkHelper::Install (NodeContainer nodes, const std::vector<Ipv4Address> &addresses)
+{
+  NS_ASSERT (nodes.GetN () == addresses.size ());
+  m_addresses = addresses;
+  //Key population, rank i is i-th most popular
+  for (uint32_t k = 0; k < m_config.keys; k++)
+  {
+    uint8_t key[ChordKey::NUM_BYTES];
+    for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+    {
+      key[b] = m_random->GetInteger (0, 255);
+    }
+    m_keys.push_back (ChordKey (key));
+  }
+
+  ApplicationContainer applications;
+  uint16_t port = 2000;
+  for (uint32_t j = 0; j < nodes.GetN (); j++)
+  {
+    ChordIpv4Helper helper (addresses[0], port, addresses[j], port, port + 1);
+    helper.SetAttribute ("DHashPort", UintegerValue (port + 2));
+    for (std::vector<std::pair<std::string, Ptr<AttributeValue> > >::iterator iter = m_attributes.begin (); iter != m_attributes.end (); iter++)
+    {
+      helper.SetAttribute (iter->first, *iter->second);
+    }
+    ApplicationContainer application = helper.Install (nodes.Get (j));
+    application.Start (Seconds (0.0));
+    applications.Add (application);
+
+    BenchmarkNode benchmarkNode;
+    benchmarkNode.node = nodes.Get (j);
+    benchmarkNode.application = DynamicCast<ChordIpv4> (application.Get (0));
+    benchmarkNode.state = LEFT;
+    benchmarkNode.vNodeKeys.resize (m_config.vNodes);
+    benchmarkNode.joined.resize (m_config.vNodes, false);
+    benchmarkNode.joinedVNodes = 0;
+    benchmarkNode.application->SetJoinSuccessCallback (MakeBoundCallback (&ChordBenchmarkHelper::JoinSuccess, this, j));
+    benchmarkNode.application->SetVNodeFailureCallback (MakeBoundCallback (&ChordBenchmarkHelper::VNodeFailure, this, j));
+    benchmarkNode.application->SetLookupSuccessCallback (MakeBoundCallback (&ChordBenchmarkHelper::LookupSuccess, this, j));
+    benchmarkNode.application->SetLookupFailureCallback (MakeBoundCallback (&ChordBenchmarkHelper::LookupFailure, this, j));
+    benchmarkNode.application->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&ChordBenchmarkHelper::Tx, this, j));
+    benchmarkNode.application->TraceConnectWithoutContext ("Lookup", MakeCallback (&ChordBenchmarkHelper::LookupResolved, this));
+    m_nodes.push_back (benchmarkNode);
+    //Staggered joins
+    Simulator::Schedule (MilliSeconds (100) + m_config.joinInterval * (int64_t) j, &ChordBenchmarkHelper::Join, this, j);
+  }
+
+  m_measurementStart = MilliSeconds (100) + m_config.joinInterval * (int64_t) nodes.GetN () + m_config.vNodeJoinInterval * (int64_t) (m_config.vNodes - 1) + m_config.settle;
+  Simulator::Schedule (m_measurementStart, &ChordBenchmarkHelper::StartMeasurement, this);
+  Simulator::Schedule (m_measurementStart + m_config.duration, &ChordBenchmarkHelper::StopMeasurement, this);
+  return applications;
+}
+
+int64_t
+ChordBenchmarkHelper::AssignStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  m_exponential->SetStream (stream + 1);
+  if (m_zipf != 0)
+  {
+    m_zipf->SetStream (stream + 2);
+  }
+  return 3;
+}
+
+std::vector<Ipv4Address>
+ChordBenchmarkHelper::BuildStar (NodeContainer nodes, Time minDelay, Time maxDelay, int64_t stream)
+{
+  NodeContainer router;
+  router.Create (1);
+  InternetStackHelper internet;
+  internet.Install (router);
+  internet.Install (nodes);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (stream);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t j = 0; j < nodes.GetN (); j++)
+  {
+    PointToPointHelper pointToPoint;
+    pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+    pointToPoint.SetChannelAttribute ("Delay", TimeValue (Seconds (random->GetValue (minDelay.GetSeconds (), maxDelay.GetSeconds ()))));
+    NetDeviceContainer devices = pointToPoint.Install (nodes.Get (j), router.Get (0));
+    Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+    ipv4.NewNetwork ();
+    addresses.push_back (interfaces.GetAddress (0));
+  }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  return addresses;
+}
+
+std::vector<Ipv4Address>
+ChordBenchmarkHelper::BuildCsma (NodeContainer nodes, Time delay)
+{
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (delay));
+  NetDeviceContainer devices = csma.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.0.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t j = 0; j < nodes.GetN (); j++)
+  {
+    addresses.push_back (interfaces.GetAddress (j));
+  }
+  return addresses;
+}
+
+Time
+ChordBenchmarkHelper::GetStartTime (void) const
+{
+  return m_measurementStart;
+}
+
+Time
+ChordBenchmarkHelper::GetStopTime (void) const
+{
+  return m_measurementStart + m_config.duration + m_config.drain;
+}
+
+void
+ChordBenchmarkHelper::Join (uint32_t nodeIndex)
+{
+  BenchmarkNode &benchmarkNode = m_nodes[nodeIndex];
+  benchmarkNode.state = UP;
+  benchmarkNode.joinedVNodes = 0;
+  for (uint32_t v = 0; v < m_config.vNodes; v++)
+  {
+    uint8_t key[ChordKey::NUM_BYTES];
+    for (int b = 0; b < ChordKey::NUM_BYTES; b++)
+    {
+      key[b] = m_random->GetInteger (0, 255);
+    }
+    benchmarkNode.vNodeKeys[v] = ChordKey (key);
+    benchmarkNode.joined[v] = false;
+    if (v == 0 || m_config.vNodeJoinInterval.IsZero ())
+    {
+      InsertVNode (nodeIndex, v);
+    }
+    else
+    {
+      Simulator::Schedule (m_config.vNodeJoinInterval * (int64_t) v, &ChordBenchmarkHelper::InsertVNode, this, nodeIndex, v);
+    }
+  }
+}
+
+void
+ChordBenchmarkHelper::InsertVNode (uint32_t nodeIndex, uint32_t vNodeIndex)
+{
+  if (m_nodes[nodeIndex].state != UP)
+  {
+    return;
+  }
+  std::ostringstream name;
+  name << "vnode" << vNodeIndex;
+  m_nodes[nodeIndex].application->InsertVNode (name.str (), m_nodes[nodeIndex].vNodeKeys[vNodeIndex]);
+}
+
+void
+ChordBenchmarkHelper::StartMeasurement (void)
+{
+  m_measuring = true;
+  if (m_config.lookupRate > 0)
+  {
+    Lookup ();
+  }
+  if (m_config.churnRate > 0)
+  {
+    Simulator::Schedule (Seconds (m_exponential->GetValue (1.0 / m_config.churnRate, 0)), &ChordBenchmarkHelper::Depart, this);
+  }
+}
+
+void
+ChordBenchmarkHelper::StopMeasurement (void)
+{
+  m_measuring = false;
+}
+
+void
+ChordBenchmarkHelper::Lookup (void)
+{
+  if (!m_measuring)
+  {
+    return;
+  }
+  Simulator::Schedule (Seconds (m_exponential->GetValue (1.0 / m_config.lookupRate, 0)), &ChordBenchmarkHelper::Lookup, this);
+  uint32_t nodeIndex;
+  if (PickNode (false, true, nodeIndex) == false)
+  {
+    return;
+  }
+  //Zipf rank starts at 1
+  uint32_t rank = (m_zipf != 0) ? m_zipf->GetInteger () - 1 : m_random->GetInteger (0, m_config.keys - 1);
+  LookupKey (nodeIndex, m_keys[rank]);
+}
+
+void
+ChordBenchmarkHelper::LookupKey (uint32_t nodeIndex, const ChordKey &key)
+{
+  std::pair<uint32_t, ChordKey> pendingKey (nodeIndex, key);
+  if (m_pending.find (pendingKey) != m_pending.end ())
+  {
+    return;
+  }
+  m_pending[pendingKey] = Simulator::Now ();
+  m_issued++;
+  //Local owner or cache hit reports success before LookupKey returns
+  m_nodes[nodeIndex].application->LookupKey (key);
+}
+
+/*  Logic: Departing node is taken out of ring model at once, so lookups resolving to it from now on count as incorrect until
+ *  ring has repaired. Leaving node sends Leave Requests to its neighbours. Crashing node just goes silent (all its interfaces
+ *  down); on return its stale vNodes are removed while still cut off, so their Leave Requests are lost, and it joins afresh.
+ */
+
+void
+ChordBenchmarkHelper::Depart (void)
+{
+  if (!m_measuring)
+  {
+    return;
+  }
+  Simulator::Schedule (Seconds (m_exponential->GetValue (1.0 / m_config.churnRate, 0)), &ChordBenchmarkHelper::Depart, this);
+  uint32_t nodeIndex;
+  if (PickNode (true, false, nodeIndex) == false)
+  {
+    return;
+  }
+  BenchmarkNode &benchmarkNode = m_nodes[nodeIndex];
+  m_departures++;
+  if (m_random->GetValue () < m_config.crashFraction)
+  {
+    Crash (nodeIndex);
+  }
+  else
+  {
+    NS_LOG_INFO ("Node " << nodeIndex << " leaves");
+    TakeOut (nodeIndex);
+    benchmarkNode.state = LEFT;
+    for (uint32_t v = 0; v < m_config.vNodes; v++)
+    {
+      std::ostringstream name;
+      name << "vnode" << v;
+      benchmarkNode.application->RemoveVNode (name.str ());
+    }
+  }
+  Simulator::Schedule (Seconds (m_exponential->GetValue (m_config.downtime.GetSeconds (), 0)), &ChordBenchmarkHelper::Rejoin, this, nodeIndex);
+}
+
+void
+ChordBenchmarkHelper::Crash (uint32_t nodeIndex)
+{
+  NS_ASSERT (nodeIndex != 0);
+  NS_LOG_INFO ("Node " << nodeIndex << " crashes");
+  TakeOut (nodeIndex);
+  m_crashes++;
+  m_nodes[nodeIndex].state = CRASHED;
+  SetInterfacesUp (nodeIndex, false);
+}
+
+void
+ChordBenchmarkHelper::TakeOut (uint32_t nodeIndex)
+{
+  BenchmarkNode &benchmarkNode = m_nodes[nodeIndex];
+  for (uint32_t v = 0; v < m_config.vNodes; v++)
+  {
+    m_ring.erase (benchmarkNode.vNodeKeys[v]);
+    benchmarkNode.joined[v] = false;
+  }
+  benchmarkNode.joinedVNodes = 0;
+  //Lookups of departed node are not counted
+  std::map<std::pair<uint32_t, ChordKey>, Time>::iterator iter = m_pending.lower_bound (std::make_pair (nodeIndex, ChordKey ()));
+  while (iter != m_pending.end () && iter->first.first == nodeIndex)
+  {
+    m_pending.erase (iter++);
+    m_issued--;
+  }
+}
+
+void
+ChordBenchmarkHelper::Rejoin (uint32_t nodeIndex)
+{
+  BenchmarkNode &benchmarkNode = m_nodes[nodeIndex];
+  if (benchmarkNode.state == CRASHED)
+  {
+    for (uint32_t v = 0; v < m_config.vNodes; v++)
+    {
+      std::ostringstream name;
+      name << "vnode" << v;
+      benchmarkNode.application->RemoveVNode (name.str ());
+    }
+    SetInterfacesUp (nodeIndex, true);
+  }
+  NS_LOG_INFO ("Node " << nodeIndex << " joins again");
+  Join (nodeIndex);
+}
+
+void
+ChordBenchmarkHelper::SetInterfacesUp (uint32_t nodeIndex, bool up)
+{
+  Ptr<Ipv4> ipv4 = m_nodes[nodeIndex].node->GetObject<Ipv4> ();
+  //Interface 0 is loopback
+  for (uint32_t i = 1; i < ipv4->GetNInterfaces (); i++)
+  {
+    if (up)
+    {
+      ipv4->SetUp (i);
+    }
+    else
+    {
+      ipv4->SetDown (i);
+    }
+  }
+}
+
+bool
+ChordBenchmarkHelper::PickNode (bool fullyJoined, bool bootStrap, uint32_t &nodeIndex)
+{
+  //Give up if hardly any node qualifies (heavy churn)
+  for (uint32_t attempt = 0; attempt < 4 * m_nodes.size (); attempt++)
+  {
+    nodeIndex = m_random->GetInteger (bootStrap ? 0 : 1, m_nodes.size () - 1);
+    BenchmarkNode &benchmarkNode = m_nodes[nodeIndex];
+    if (benchmarkNode.state == UP && benchmarkNode.joinedVNodes > 0 && (!fullyJoined || benchmarkNode.joinedVNodes == m_config.vNodes))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+ChordBenchmarkHelper::FindVNode (uint32_t nodeIndex, const ChordKey &key, uint32_t &vNodeIndex)
+{
+  for (vNodeIndex = 0; vNodeIndex < m_config.vNodes; vNodeIndex++)
+  {
+    if (m_nodes[nodeIndex].vNodeKeys[vNodeIndex] == key)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+ChordKey
+ChordBenchmarkHelper::GetVNodeKey (uint32_t nodeIndex, uint32_t vNodeIndex) const
+{
+  return m_nodes[nodeIndex].vNodeKeys[vNodeIndex];
+}
+
+Ipv4Address
+ChordBenchmarkHelper::GetOwnerAddress (const ChordKey &key) const
+{
+  if (m_ring.empty ())
+  {
+    return Ipv4Address ();
+  }
+  //Owner is first vNode at or after key
+  std::map<ChordKey, uint32_t>::const_iterator owner = m_ring.lower_bound (key);
+  if (owner == m_ring.end ())
+  {
+    owner = m_ring.begin ();
+  }
+  return m_addresses[owner->second];
+}
+
+void
+ChordBenchmarkHelper::JoinSuccess (ChordBenchmarkHelper *helper, uint32_t nodeIndex, std::string vNodeName, uint8_t *key, uint8_t keyBytes)
+{
+  BenchmarkNode &benchmarkNode = helper->m_nodes[nodeIndex];
+  uint32_t vNodeIndex;
+  if (benchmarkNode.state != UP || keyBytes != ChordKey::NUM_BYTES || helper->FindVNode (nodeIndex, ChordKey (key), vNodeIndex) == false)
+  {
+    return;
+  }
+  if (!benchmarkNode.joined[vNodeIndex])
+  {
+    benchmarkNode.joined[vNodeIndex] = true;
+    benchmarkNode.joinedVNodes++;
+    helper->m_ring[ChordKey (key)] = nodeIndex;
+  }
+}
+
+void
+ChordBenchmarkHelper::VNodeFailure (ChordBenchmarkHelper *helper, uint32_t nodeIndex, std::string vNodeName, uint8_t *key, uint8_t keyBytes)
+{
+  BenchmarkNode &benchmarkNode = helper->m_nodes[nodeIndex];
+  uint32_t vNodeIndex;
+  if (benchmarkNode.state != UP || keyBytes != ChordKey::NUM_BYTES || helper->FindVNode (nodeIndex, ChordKey (key), vNodeIndex) == false)
+  {
+    return;
+  }
+  if (benchmarkNode.joined[vNodeIndex])
+  {
+    benchmarkNode.joined[vNodeIndex] = false;
+    benchmarkNode.joinedVNodes--;
+    helper->m_ring.erase (ChordKey (key));
+  }
+  //vNode was deleted (join failed or all successors lost), insert it again
+  Simulator::Schedule (Seconds (1), &ChordBenchmarkHelper::InsertVNode, helper, nodeIndex, vNodeIndex);
+}
+
+void
+ChordBenchmarkHelper::LookupSuccess (ChordBenchmarkHelper *helper, uint32_t nodeIndex, uint8_t *key, uint8_t keyBytes, Ipv4Address ownerIp, uint16_t ownerPort)
+{
+  std::map<std::pair<uint32_t, ChordKey>, Time>::iterator iter = helper->m_pending.find (std::make_pair (nodeIndex, ChordKey (key)));
+  if (iter == helper->m_pending.end ())
+  {
+    return;
+  }
+  helper->m_latencies.push_back ((Simulator::Now () - iter->second).GetSeconds () * 1000.0);
+  helper->m_succeeded++;
+  if (helper->GetOwnerAddress (iter->first.second) == ownerIp)
+  {
+    helper->m_correct++;
+  }
+  helper->m_pending.erase (iter);
+  if (!helper->m_lookupSuccessFn.IsNull ())
+  {
+    helper->m_lookupSuccessFn (ChordKey (key), ownerIp);
+  }
+}
+
+void
+ChordBenchmarkHelper::LookupFailure (ChordBenchmarkHelper *helper, uint32_t nodeIndex, uint8_t *key, uint8_t keyBytes)
+{
+  std::map<std::pair<uint32_t, ChordKey>, Time>::iterator iter = helper->m_pending.find (std::make_pair (nodeIndex, ChordKey (key)));
+  if (iter != helper->m_pending.end ())
+  {
+    helper->m_failed++;
+    helper->m_pending.erase (iter);
+  }
+}
+
+void
+ChordBenchmarkHelper::Tx (ChordBenchmarkHelper *helper, uint32_t nodeIndex, Ptr<const Packet> packet)
+{
+  //Crashed nodes send into the void
+  if (helper->m_measuring && helper->m_nodes[nodeIndex].state != CRASHED)
+  {
+    helper->m_messages++;
+    helper->m_bytes += packet->GetSize ();
+  }
+}
+
+void
+ChordBenchmarkHelper::LookupResolved (Time latency, uint8_t hops)
+{
+  //Lookups are only issued from measurement window on
+  if (Simulator::Now () < m_measurementStart)
+  {
+    return;
+  }
+  if (m_hops.size () <= hops)
+  {
+    m_hops.resize (hops + 1, 0);
+  }
+  m_hops[hops]++;
+}
+
+void
+ChordBenchmarkHelper::SetLookupSuccessCallback (Callback<void, ChordKey, Ipv4Address> lookupSuccessFn)
+{
+  m_lookupSuccessFn = lookupSuccessFn;
+}
+
+uint64_t
+ChordBenchmarkHelper::GetSucceeded (void) const
+{
+  return m_succeeded;
+}
+
+uint64_t
+ChordBenchmarkHelper::GetFailed (void) const
+{
+  return m_failed;
+}
+
+double
+ChordBenchmarkHelper::GetMeanLatency (void) const
+{
+  double mean = 0;
+  for (uint32_t i = 0; i < m_latencies.size (); i++)
+  {
+    mean += m_latencies[i];
+  }
+  return m_latencies.size () ? mean / m_latencies.size () : 0.0;
+}
+
+double
+ChordBenchmarkHelper::GetLatencyPercentile (uint32_t percent) const
+{
+  if (m_latencies.empty ())
+  {
+    return 0;
+  }
+  std::vector<double> latencies (m_latencies);
+  std::vector<double>::iterator nth = latencies.begin () + std::min<size_t> (latencies.size () - 1, latencies.size () * percent / 100);
+  std::nth_element (latencies.begin (), nth, latencies.end ());
+  return *nth;
+}
+
+uint64_t
+ChordBenchmarkHelper::GetMessages (void) const
+{
+  return m_messages;
+}
+
+uint32_t
+ChordBenchmarkHelper::GetJoinedVNodes (void) const
+{
+  return m_ring.size ();
+}
+
+void
+ChordBenchmarkHelper::WriteSummaryHeader (std::ostream &os)
+{
+  os << "label,nodes,vnodes,keys,zipf_alpha,churn_rate,crash_fraction,duration_s,"
+     << "lookups,succeeded,correct,failed,success_rate,mean_hops,mean_latency_ms,p50_latency_ms,p99_latency_ms,"
+     << "messages_per_node_s,bytes_per_node_s,departures,crashes,wall_clock_s,peak_rss_mb" << std::endl;
+}
+
+void
+ChordBenchmarkHelper::WriteSummary (std::ostream &os, std::string label, int64_t wallClockMs) const
+{
+  //Routed lookups are traced with hops, the rest was resolved locally
+  uint64_t routed = 0;
+  double hopSum = 0;
+  for (uint32_t h = 0; h < m_hops.size (); h++)
+  {
+    routed += m_hops[h];
+    hopSum += (double) h * m_hops[h];
+  }
+  uint64_t resolved = std::max (routed, m_succeeded);
+  double nodeSeconds = m_nodes.size () * std::max (m_config.duration.GetSeconds (), 1e-9);
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  os << label << ","
+     << m_nodes.size () << ","
+     << m_config.vNodes << ","
+     << m_config.keys << ","
+     << m_config.zipfAlpha << ","
+     << m_config.churnRate << ","
+     << m_config.crashFraction << ","
+     << m_config.duration.GetSeconds () << ","
+     << m_issued << ","
+     << m_succeeded << ","
+     << m_correct << ","
+     << m_failed << ","
+     << (m_issued ? (double) m_succeeded / m_issued : 0.0) << ","
+     << (resolved ? hopSum / resolved : 0.0) << ","
+     << GetMeanLatency () << ","
+     << GetLatencyPercentile (50) << ","
+     << GetLatencyPercentile (99) << ","
+     << m_messages / nodeSeconds << ","
+     << m_bytes / nodeSeconds << ","
+     << m_departures << ","
+     << m_crashes << ","
+     << wallClockMs / 1000.0 << ","
+     //Kilo bytes on Linux
+     << usage.ru_maxrss / 1024.0 << std::endl;
+}
+
+void
+ChordBenchmarkHelper::WriteHistogramsHeader (std::ostream &os)
+{
+  os << "label,histogram,bin,count" << std::endl;
+}
+
+void
+ChordBenchmarkHelper::WriteHistograms (std::ostream &os, std::string label) const
+{
+  std::vector<uint64_t> hops (m_hops);
+  if (hops.empty ())
+  {
+    hops.resize (1, 0);
+  }
+  uint64_t routed = 0;
+  for (uint32_t h = 0; h < hops.size (); h++)
+  {
+    routed += hops[h];
+  }
+  if (m_succeeded > routed)
+  {
+    hops[0] += m_succeeded - routed;
+  }
+  for (uint32_t h = 0; h < hops.size (); h++)
+  {
+    os << label << ",hops," << h << "," << hops[h] << std::endl;
+  }
+  double binMs = std::max (m_config.latencyBin.GetSeconds () * 1000.0, 1e-3);
+  std::map<uint64_t, uint64_t> latencyBins;
+  for (uint32_t i = 0; i < m_latencies.size (); i++)
+  {
+    latencyBins[(uint64_t) (m_latencies[i] / binMs)]++;
+  }
+  for (std::map<uint64_t, uint64_t>::iterator iter = latencyBins.begin (); iter != latencyBins.end (); iter++)
+  {
+    os << label << ",latency_ms," << iter->first * binMs << "," << iter->second << std::endl;
+  }
+}
+
+} //namespace ns3
@@ -0,0 +1,308 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_BENCHMARK_HELPER_H
+#define CHORD_BENCHMARK_HELPER_H
+
+//include(s)
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <ostream>
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/chord-ipv4.h"
+#include "ns3/chord-key.h"
+
+namespace ns3 {
+
+/**
+ *  \brief Workload and churn of ChordBenchmarkHelper
+ */
+struct ChordBenchmarkConfig
+{
+  ChordBenchmarkConfig ();
+
+  //VirtualNodes (ChordVNode) per node
+  uint32_t vNodes;
+  //Nodes join one after another, joinInterval apart
+  Time joinInterval;
+  //vNodes of a node join vNodeJoinInterval apart, 0 for all at once
+  Time vNodeJoinInterval;
+  //Time between last join and measurement window
+  Time settle;
+  //Measurement window (lookups and churn)
+  Time duration;
+  //Time after window for outstanding lookups
+  Time drain;
+  //Lookups per second issued by whole network (Poisson), 0 for no lookup workload
+  double lookupRate;
+  //Key population looked up
+  uint32_t keys;
+  //Zipf exponent of key popularity, 0 for uniform
+  double zipfAlpha;
+  //Node departures per second in whole network (Poisson), 0 for no churn
+  double churnRate;
+  //Fraction of departures which crash (node cut off network) instead of leaving
+  double crashFraction;
+  //Mean time until departed node joins again with new identifiers
+  Time downtime;
+  //Width of latency histogram bins
+  Time latencyBin;
+};
+
+/**
+ *  \brief Runs Chord lookup workload with churn over a set of nodes and reports lookup and overhead metrics in CSV
+ *
+ *  Installs ChordIpv4 (see ChordIpv4Helper) on every node, node 0 is boot strap node and never departs. Nodes join one after another,
+ *  then during measurement window random joined nodes look up keys of a fixed population (uniform or Zipf popularity) and nodes
+ *  depart and come back. A departing node either leaves (RemoveVNode) or crashes (its IPv4 interfaces go down, peers find out
+ *  by timeouts). Lookups are checked against the ring of joined vNodes; lookups of a node which departs before they complete are
+ *  not counted. Messages (packets sent by ChordIpv4) are counted within window only.
+ *
+ *  Benchmarks with a workload of their own turn lookups and churn off, and drive nodes through LookupKey and Crash. The helper
+ *  owns join, vNode failure and lookup callbacks of every ChordIpv4; other callbacks and trace sources are free. Each ChordIpv4
+ *  gets DHashPort (listening port + 2), DHash stays off unless DHashEnable is set.
+ *
+ *  Callbacks refer to helper, it must outlive Simulator::Run.
+ */
+class ChordBenchmarkHelper
+{
+  public:
+
+    /* Constructor(s) */
+
+    /**
+     *  \param config Workload and churn
+     */
+    ChordBenchmarkHelper (const ChordBenchmarkConfig &config);
+
+    /**
+     *  \brief Record an attribute to be set in each ChordIpv4 Application after it is created.
+     *  \param name the name of the attribute to set
+     *  \param value the value of the attribute to set
+     */
+    void SetAttribute (std::string name, const AttributeValue &value);
+
+    /**
+     *  \brief Installs ChordIpv4 on nodes and schedules joins, lookups and churn
+     *  \param nodes Nodes running Chord
+     *  \param addresses Ipv4 address of each node used by Chord (same order as nodes)
+     *  \returns The applications created, one Application per Node
+     */
+    ApplicationContainer Install (NodeContainer nodes, const std::vector<Ipv4Address> &addresses);
+    /**
+     *  \brief Assigns fixed random variable streams to workload (identifiers, keys, lookups and churn)
+     *  \param stream First stream index to use
+     *  \returns Number of streams used
+     *
+     *  Call before Install. Runs which only differ in ChordIpv4 attributes then see same workload.
+     */
+    int64_t AssignStreams (int64_t stream);
+
+    /**
+     *  \brief Builds star: every node hangs off one central router (no Chord) on its own 100Mbps point-to-point link
+     *  \param nodes Nodes running Chord, Internet stack is installed on them
+     *  \param minDelay Least one-way delay of a link
+     *  \param maxDelay Largest one-way delay of a link, delay of each link is drawn uniformly from [minDelay, maxDelay]
+     *  \param stream Random variable stream of link delays, -1 for automatic assignment
+     *  \returns Ipv4 address of each node (same order as nodes)
+     */
+    static std::vector<Ipv4Address> BuildStar (NodeContainer nodes, Time minDelay, Time maxDelay, int64_t stream = -1);
+    /**
+     *  \brief Puts all nodes on one 100Mbps CSMA segment (as chord-run)
+     *  \param nodes Nodes running Chord, Internet stack is installed on them
+     *  \param delay One-way delay of segment
+     *  \returns Ipv4 address of each node (same order as nodes)
+     */
+    static std::vector<Ipv4Address> BuildCsma (NodeContainer nodes, Time delay);
+
+    /**
+     *  \returns Start of measurement window (valid after Install)
+     */
+    Time GetStartTime (void) const;
+    /**
+     *  \returns Time last outstanding lookup is given up (end of drain)
+     */
+    Time GetStopTime (void) const;
+
+    /**
+     *  \brief Picks random node which is up and has joined vNodes
+     *  \param fullyJoined Only nodes whose vNodes all have joined
+     *  \param bootStrap Boot strap node (node 0) may be picked
+     *  \param nodeIndex Picked node
+     *  \returns false if hardly any node qualifies
+     */
+    bool PickNode (bool fullyJoined, bool bootStrap, uint32_t &nodeIndex);
+    /**
+     *  \returns Identifier of vNode (changes when node joins again)
+     */
+    ChordKey GetVNodeKey (uint32_t nodeIndex, uint32_t vNodeIndex) const;
+    /**
+     *  \returns Ipv4 address of node owning key in ring of joined vNodes
+     */
+    Ipv4Address GetOwnerAddress (const ChordKey &key) const;
+    /**
+     *  \brief Looks up key from node, measured and checked like lookups of workload
+     *  \param nodeIndex Requesting node
+     *  \param key Key to look up
+     *
+     *  Does nothing if same node still looks up same key.
+     */
+    void LookupKey (uint32_t nodeIndex, const ChordKey &key);
+    /**
+     *  \brief Crashes node: its IPv4 interfaces go down and its vNodes are taken out of ring, lookups it still waits for are not counted
+     *  \param nodeIndex Node to crash, must not be boot strap node
+     */
+    void Crash (uint32_t nodeIndex);
+    /**
+     *  \brief Upcall on every measured lookup which succeeds, with key and Ipv4 address of owner
+     */
+    void SetLookupSuccessCallback (Callback<void, ChordKey, Ipv4Address> lookupSuccessFn);
+
+    /**
+     *  \returns Measured lookups which succeeded
+     */
+    uint64_t GetSucceeded (void) const;
+    /**
+     *  \returns Measured lookups which failed
+     */
+    uint64_t GetFailed (void) const;
+    /**
+     *  \returns Mean latency of succeeded lookups in milli seconds
+     */
+    double GetMeanLatency (void) const;
+    /**
+     *  \param percent Percentile (50 for median)
+     *  \returns Latency percentile of succeeded lookups in milli seconds
+     */
+    double GetLatencyPercentile (uint32_t percent) const;
+    /**
+     *  \returns Messages sent by all nodes within window
+     */
+    uint64_t GetMessages (void) const;
+    /**
+     *  \returns Number of joined vNodes in ring
+     */
+    uint32_t GetJoinedVNodes (void) const;
+
+    /**
+     *  \brief Writes CSV header of summary
+     *  \param os Output stream
+     */
+    static void WriteSummaryHeader (std::ostream &os);
+    /**
+     *  \brief Writes one CSV row of summary
+     *  \param os Output stream
+     *  \param label First column (e.g. topology)
+     *  \param wallClockMs Wall clock time of simulation run
+     *
+     *  Peak RSS is read for whole process.
+     */
+    void WriteSummary (std::ostream &os, std::string label, int64_t wallClockMs) const;
+    /**
+     *  \brief Writes CSV header of histograms
+     *  \param os Output stream
+     */
+    static void WriteHistogramsHeader (std::ostream &os);
+    /**
+     *  \brief Writes hop count and latency histograms, one CSV row per bin
+     *  \param os Output stream
+     *  \param label First column (e.g. topology)
+     *
+     *  Lookups resolved locally (own vNode or location cache) take 0 hops. Latency bins are named by their lower edge in milli seconds.
+     */
+    void WriteHistograms (std::ostream &os, std::string label) const;
+
+  private:
+    /**
+     *  \cond
+     */
+    enum NodeState
+    {
+      UP,
+      LEFT,
+      CRASHED
+    };
+    struct BenchmarkNode
+    {
+      Ptr<Node> node;
+      Ptr<ChordIpv4> application;
+      NodeState state;
+      std::vector<ChordKey> vNodeKeys;
+      std::vector<bool> joined;
+      uint32_t joinedVNodes;
+    };
+
+    void Join (uint32_t nodeIndex);
+    void InsertVNode (uint32_t nodeIndex, uint32_t vNodeIndex);
+    void StartMeasurement (void);
+    void StopMeasurement (void);
+    void Lookup (void);
+    void Depart (void);
+    void TakeOut (uint32_t nodeIndex);
+    void Rejoin (uint32_t nodeIndex);
+    void SetInterfacesUp (uint32_t nodeIndex, bool up);
+    bool FindVNode (uint32_t nodeIndex, const ChordKey &key, uint32_t &vNodeIndex);
+    static void JoinSuccess (ChordBenchmarkHelper *helper, uint32_t nodeIndex, std::string vNodeName, uint8_t *key, uint8_t keyBytes);
+    static void VNodeFailure (ChordBenchmarkHelper *helper, uint32_t nodeIndex, std::string vNodeName, uint8_t *key, uint8_t keyBytes);
+    static void LookupSuccess (ChordBenchmarkHelper *helper, uint32_t nodeIndex, uint8_t *key, uint8_t keyBytes, Ipv4Address ownerIp, uint16_t ownerPort);
+    static void LookupFailure (ChordBenchmarkHelper *helper, uint32_t nodeIndex, uint8_t *key, uint8_t keyBytes);
+    static void Tx (ChordBenchmarkHelper *helper, uint32_t nodeIndex, Ptr<const Packet> packet);
+    void LookupResolved (Time latency, uint8_t hops);
+
+    ChordBenchmarkConfig m_config;
+    std::vector<std::pair<std::string, Ptr<AttributeValue> > > m_attributes;
+    Ptr<UniformRandomVariable> m_random;
+    Ptr<ExponentialRandomVariable> m_exponential;
+    Ptr<ZipfRandomVariable> m_zipf;
+    std::vector<ChordKey> m_keys;
+    std::vector<Ipv4Address> m_addresses;
+    std::vector<BenchmarkNode> m_nodes;
+    //Identifier -> node of joined vNodes
+    std::map<ChordKey, uint32_t> m_ring;
+    //(node, key) -> lookup start time
+    std::map<std::pair<uint32_t, ChordKey>, Time> m_pending;
+    Time m_measurementStart;
+    bool m_measuring;
+    //Lookup results
+    uint64_t m_issued;
+    uint64_t m_succeeded;
+    uint64_t m_correct;
+    uint64_t m_failed;
+    std::vector<double> m_latencies;
+    std::vector<uint64_t> m_hops;
+    Callback<void, ChordKey, Ipv4Address> m_lookupSuccessFn;
+    //Overhead and churn
+    uint64_t m_messages;
+    uint64_t m_bytes;
+    uint32_t m_departures;
+    uint32_t m_crashes;
+    /**
+     *  \endcond
+     */
+}; //class ChordBenchmarkHelper
+
+} //namespace ns3
+
+#endif /* CHORD_BENCHMARK_HELPER_H */
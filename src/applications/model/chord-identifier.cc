@@ -20,6 +20,7 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include <stdlib.h>
+#include <string.h>
 
 NS_LOG_COMPONENT_DEFINE ("ChordIdentifier");
 
@@ -34,21 +35,14 @@ ChordIdentifier::ChordIdentifier ()
 ChordIdentifier::ChordIdentifier (uint8_t* key, uint8_t numBytes)
 {
   NS_LOG_FUNCTION_NOARGS();
-  //Allocate memory to store key
-  m_key = (uint8_t *) malloc(numBytes * sizeof (uint8_t));
-  NS_ABORT_MSG_IF (m_key == 0,"ChordIdentifier::ChordIdentifier() malloc failed");
-  //Copy entire key to this area
-  for (int i=0; i<numBytes; i++)
-  {
-    m_key[i] = key[i];
-  }
-  //Save numBytes
-  m_numBytes = numBytes;
+  m_key = 0;
+  CopyKey (key, numBytes);
 }
 
 ChordIdentifier::ChordIdentifier(Ptr<ChordIdentifier> identifier)
 {
   NS_LOG_FUNCTION_NOARGS();
+  m_key = 0;
   CopyIdentifier(identifier);
 }
 
@@ -56,20 +50,33 @@ ChordIdentifier::ChordIdentifier(Ptr<ChordIdentifier> identifier)
 ChordIdentifier::ChordIdentifier(const ChordIdentifier& identifier)
 {
   NS_LOG_FUNCTION_NOARGS();
-  Ptr<ChordIdentifier> chordIdentifier = const_cast<ChordIdentifier *>(&identifier);
-  CopyIdentifier (chordIdentifier);
+  m_key = 0;
+  CopyKey (identifier.m_key, identifier.m_numBytes);
 }
 
-ChordIdentifier::~ChordIdentifier ()
+ChordIdentifier::ChordIdentifier (const ChordKey &key)
 {
   NS_LOG_FUNCTION_NOARGS();
-  //Free memory
-  if (m_key != 0)
+  m_key = 0;
+  AllocateKey (ChordKey::NUM_BYTES);
+  key.GetKey (m_key);
+}
+
+ChordIdentifier&
+ChordIdentifier::operator= (const ChordIdentifier& identifier)
+{
+  if (this != &identifier)
   {
-    free (m_key);
-    m_numBytes= 0;
-    m_key = 0;
+    CopyKey (identifier.m_key, identifier.m_numBytes);
   }
+  return *this;
+}
+
+ChordIdentifier::~ChordIdentifier ()
+{
+  NS_LOG_FUNCTION_NOARGS();
+  //Free memory
+  FreeKey ();
 }
 
 void
@@ -77,81 +84,116 @@ ChordIdentifier::DoDispose (void)
 {
   NS_LOG_FUNCTION_NOARGS();
   //Free memory
-  if (m_key != 0)
-  {
-    free (m_key);
-    m_numBytes= 0;
-    m_key = 0;
-  }
+  FreeKey ();
 }
 
 void
 ChordIdentifier::CopyIdentifier(Ptr<ChordIdentifier> identifier)
 {
   NS_LOG_FUNCTION_NOARGS();
-  uint8_t *key = identifier->GetKey();
-  m_numBytes = identifier->GetNumBytes();
+  CopyKey (identifier->GetKey(), identifier->GetNumBytes());
+}
 
-  //Allocate memory to store key
-  m_key = (uint8_t *) malloc(m_numBytes * sizeof (uint8_t));
-  NS_ABORT_MSG_IF (m_key == 0,"ChordIdentifier::ChordIdentifier() malloc failed");
+void
+ChordIdentifier::CopyKey (const uint8_t* key, uint8_t numBytes)
+{
+  AllocateKey (numBytes);
   //Copy entire key to this area
-  for (int i=0; i<m_numBytes; i++)
+  for (int i=0; i<numBytes; i++)
   {
     m_key[i] = key[i];
   }
 }
 
-bool
-ChordIdentifier::IsEqual (Ptr<ChordIdentifier> identifier)
+void
+ChordIdentifier::AllocateKey (uint8_t numBytes)
 {
-  NS_LOG_FUNCTION_NOARGS();
-  //Retrieve key
-  uint8_t* key= identifier->GetKey();
-  //Check for contents
-  for (int i= 0; i<m_numBytes; i++)
+  FreeKey ();
+  if (numBytes <= sizeof (m_inlineKey))
+  {
+    //Inline storage, zero padding lets Compare() work on whole words
+    memset (m_inlineKey, 0, sizeof (m_inlineKey));
+    m_key = (uint8_t *) m_inlineKey;
+  }
+  else
+  {
+    //Allocate memory to store key
+    m_key = (uint8_t *) malloc(numBytes * sizeof (uint8_t));
+    NS_ABORT_MSG_IF (m_key == 0,"ChordIdentifier::ChordIdentifier() malloc failed");
+  }
+  m_numBytes = numBytes;
+}
+
+void
+ChordIdentifier::FreeKey (void)
+{
+  if (m_key != 0 && !IsInline ())
   {
-    if (key[i] != m_key[i])
-      return false;
+    free (m_key);
   }
-  //Keys are equal, return true
-  return true;
+  m_numBytes = 0;
+  m_key = 0;
 }
 
 bool
-ChordIdentifier::IsLess (Ptr<ChordIdentifier> identifier)
+ChordIdentifier::IsInline (void) const
 {
-  NS_LOG_FUNCTION_NOARGS();
-  //Retrieve key
-  uint8_t* key= identifier->GetKey();
+  return m_key == (const uint8_t *) m_inlineKey;
+}
+
+static inline uint64_t
+LoadWord (const uint8_t* key)
+{
+  //Little-endian load, independent of host byte order
+  return (uint64_t) key[0] | ((uint64_t) key[1] << 8) | ((uint64_t) key[2] << 16) | ((uint64_t) key[3] << 24) |
+         ((uint64_t) key[4] << 32) | ((uint64_t) key[5] << 40) | ((uint64_t) key[6] << 48) | ((uint64_t) key[7] << 56);
+}
+
+int
+ChordIdentifier::Compare (const ChordIdentifier &identifier) const
+{
+  const uint8_t* key = identifier.m_key;
+  if (IsInline () && identifier.IsInline ())
+  {
+    //Compare word by word, most significant first
+    for (int i = ChordKey::NUM_WORDS - 1; i >= 0; i--)
+    {
+      uint64_t wordL = LoadWord (m_key + 8 * i);
+      uint64_t wordR = LoadWord (key + 8 * i);
+      if (wordL != wordR)
+        return (wordL < wordR) ? -1 : 1;
+    }
+    return 0;
+  }
   //Compare two keys byte by byte
   for (int i= m_numBytes-1; i>=0; i--)
   {
-    if (m_key[i] < key[i])
-      return true;
-    else if (m_key[i] > key[i])
-      return false;
+    if (m_key[i] != key[i])
+      return (m_key[i] < key[i]) ? -1 : 1;
   }
-  //Keys are equal, return false
-  return false;
+  //Keys are equal
+  return 0;
+}
+
+bool
+ChordIdentifier::IsEqual (Ptr<ChordIdentifier> identifier)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  return Compare (*PeekPointer (identifier)) == 0;
+}
+
+bool
+ChordIdentifier::IsLess (Ptr<ChordIdentifier> identifier)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  return Compare (*PeekPointer (identifier)) < 0;
 }
 
 bool
 ChordIdentifier::IsGreater (Ptr<ChordIdentifier> identifier)
 {
   NS_LOG_FUNCTION_NOARGS();
-  //Retrieve key
-  uint8_t* key= identifier->GetKey();
-  //Compare two keys byte by byte
-  for (int i= m_numBytes-1; i>=0; i--)
-  {
-    if (m_key[i] > key[i])
-      return true;
-    else if (m_key[i] < key[i])
-      return false;
-  }
-  //Keys are equal, return false
-  return false;
+  return Compare (*PeekPointer (identifier)) > 0;
 }
 
 bool
@@ -159,51 +201,20 @@ ChordIdentifier::IsInBetween (Ptr<ChordIdentifier> identifierLow, Ptr<ChordIdent
 {
   NS_LOG_FUNCTION_NOARGS();
   //Check for existence in between range (keyLow,keyHigh], taken on circular identifier space, in clockwise direction
-
-  //Check for wrap-around
-  if (identifierHigh->IsGreater(identifierLow))
+  int order = identifierHigh->Compare (*PeekPointer (identifierLow));
+  if (order > 0)
   {
     //No wrap-around
-    if (!IsGreater(identifierLow))
-      return false;
-
-    if (IsLess(identifierHigh) || IsEqual(identifierHigh))
-      return true;
-    else 
-      return false;
+    return Compare (*PeekPointer (identifierLow)) > 0 && Compare (*PeekPointer (identifierHigh)) <= 0;
   }
-  else if (identifierHigh->IsLess(identifierLow))
+  else if (order < 0)
   {
     //Wrap-around is there
-    //Either key lies on left of 0 or on right. So check for both scenarios
-    if (IsGreater(identifierHigh) || IsEqual(identifierHigh))
-    {
-      //Key lies on left of 0?
-      if (IsGreater(identifierLow))
-        return true;
-      else 
-        return false;
-    }
-    //Check if key lies on right of 0 and in between
-    if (IsLess(identifierHigh) || IsEqual(identifierHigh))
-    {
-      //Key lies on right of 0?
-      if (IsLess(identifierLow))
-        return true;
-      else 
-        return false;
-    }
-  }
-  else if (identifierHigh->IsEqual(identifierLow))
-  {
-    //Everything is in between! (except keyHigh)
-    if (!IsEqual(identifierHigh))
-      return true;
-    return false;
+    //Either key lies on left of 0 or on right
+    return Compare (*PeekPointer (identifierLow)) > 0 || Compare (*PeekPointer (identifierHigh)) <= 0;
   }
-  NS_LOG_ERROR ("Something is seriously is wrong..");
-  //Something is seriously wrong, cannot be here
-  return false;
+  //Everything is in between! (except keyHigh)
+  return Compare (*PeekPointer (identifierHigh)) != 0;
 }
 
 void
@@ -218,9 +229,8 @@ ChordIdentifier::AddPowerOfTwo (uint16_t powerOfTwo)
   uint8_t prevVal = m_key[position];
   m_key[position] = m_key[position] + (powZero << shift);
   //if carry is there
-  while ((m_key[position] < prevVal) && (position <= (m_numBytes-1)))
+  while ((m_key[position] < prevVal) && (++position < m_numBytes))
   {
-    position++;
     prevVal = m_key[position]; 
     m_key[position] = m_key[position] + 0x01;
   }
@@ -240,27 +250,19 @@ ChordIdentifier::GetNumBytes()
   return m_numBytes;
 }
 
+ChordKey
+ChordIdentifier::GetChordKey (void) const
+{
+  //Inline storage is zero padded, so shorter keys read as zero extended
+  NS_ABORT_MSG_IF (m_numBytes > ChordKey::NUM_BYTES, "ChordIdentifier::GetChordKey() key exceeds ChordKey::NUM_BYTES");
+  return ChordKey (m_key);
+}
+
 void 
 ChordIdentifier::SetKey(uint8_t* key, uint8_t numBytes)
 {
   NS_LOG_FUNCTION_NOARGS();
-
-  if (m_key != 0)
-  {
-    //Free previously stored key
-    free (m_key);
-    m_key = 0;
-  }
-  //Allocate memory to store key
-  m_key = (uint8_t *) malloc(numBytes * sizeof (uint8_t));
-  NS_ABORT_MSG_IF (m_key == 0,"ChordIdentifier::ChordIdentifier() malloc failed");
-  //Copy entire key to this area
-  for (int i=0; i<numBytes; i++)
-  {
-    m_key[i] = key[i];
-  }
-  //Save numBytes
-  m_numBytes = numBytes;
+  CopyKey (key, numBytes);
 }
 
 void
@@ -281,17 +283,8 @@ ChordIdentifier::Deserialize (Buffer::Iterator &start)
   NS_LOG_FUNCTION_NOARGS();
   uint8_t j;
 
-  m_numBytes = start.ReadU8 ();
   //Allocate memory
-  if (m_key == 0)
-  {
-    m_key = (uint8_t *) malloc(m_numBytes * sizeof (uint8_t));
-    NS_ABORT_MSG_IF (m_key == 0,"ChordIdentifier::ChordIdentifier() malloc failed");
-  }
-  else
-  {
-    //return 0;
-  }
+  AllocateKey (start.ReadU8 ());
   /* Retrieve key from buffer */
   for (j=0; j<m_numBytes;j++)
   {
@@ -329,23 +322,14 @@ std::ostream& operator<< (std::ostream& os, Ptr<ChordIdentifier> const &identifi
   return os;
 }
 
-bool operator== (ChordIdentifier &chordIdentifierL, ChordIdentifier &chordIdentifierR)
+bool operator == (const ChordIdentifier &chordIdentifierL, const ChordIdentifier &chordIdentifierR)
 {
-  Ptr<ChordIdentifier> identifierL = const_cast<ChordIdentifier *> (&chordIdentifierL);
-  Ptr<ChordIdentifier> identifierR = const_cast<ChordIdentifier *> (&chordIdentifierR);
-  if (identifierL->IsEqual(identifierR))
-    return true;
-  else
-    return false;
+  return chordIdentifierL.Compare (chordIdentifierR) == 0;
 }
+
 bool operator < (const ChordIdentifier &chordIdentifierL, const ChordIdentifier &chordIdentifierR)
 {
-  Ptr<ChordIdentifier> identifierL = const_cast<ChordIdentifier *> (&chordIdentifierL);
-  Ptr<ChordIdentifier> identifierR = const_cast<ChordIdentifier *> (&chordIdentifierR);
-  if (identifierL->IsLess(identifierR))
-    return true;
-  else
-    return false;
+  return chordIdentifierL.Compare (chordIdentifierR) < 0;
 }
 
 } //namespace ns3
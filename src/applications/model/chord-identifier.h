@@ -23,6 +23,7 @@
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 #include "ns3/buffer.h"
+#include "chord-key.h"
 
 namespace ns3 {
 /**
@@ -30,6 +31,9 @@ namespace ns3 {
  *  \class ChordIdentifier
  *  \brief Class to store and operate on keys. 
  *  We assume keys are in little-endian format 
+ *
+ *  Keys up to ChordKey::NUM_WORDS words (SHA-1 sized keys included) are stored inline and compared word-wise,
+ *  longer keys are stored in heap memory.
  */
 class ChordIdentifier : public Object
 {
@@ -55,6 +59,12 @@ class ChordIdentifier : public Object
    *  \param identifier ChordIdentifier to copy from
    */
   ChordIdentifier (const ChordIdentifier& identifier);
+  /**
+   *  \brief Constructor to store fixed width key
+   *  \param key ChordKey to copy from
+   */
+  ChordIdentifier (const ChordKey &key);
+  ChordIdentifier& operator= (const ChordIdentifier& identifier);
   virtual ~ChordIdentifier ();
   virtual void DoDispose (void);
 
@@ -96,6 +106,10 @@ class ChordIdentifier : public Object
    *  \returns number of bytes in key array
    */
   uint8_t GetNumBytes (void);
+  /**
+   *  \returns stored key as fixed width ChordKey (shorter keys are zero extended, key must not exceed ChordKey::NUM_BYTES)
+   */
+  ChordKey GetChordKey (void) const;
   //Assignment
 
   /**
@@ -141,21 +155,27 @@ class ChordIdentifier : public Object
    *  \cond
    */
   void CopyIdentifier(Ptr<ChordIdentifier> identifier);
+  void CopyKey (const uint8_t* key, uint8_t numBytes);
+  void AllocateKey (uint8_t numBytes);
+  void FreeKey (void);
+  bool IsInline (void) const;
+  int Compare (const ChordIdentifier &identifier) const;
 
   uint8_t *m_key;
   uint8_t m_numBytes;
+  uint64_t m_inlineKey[ChordKey::NUM_WORDS];
   /**
    *  \endcond
    */
   //Operators
   friend bool operator < (const ChordIdentifier &identifierL, const ChordIdentifier &identifierR);
-  friend bool operator == (const ChordIdentifier &identifierL, const ChordIdentifier identifierR);
+  friend bool operator == (const ChordIdentifier &identifierL, const ChordIdentifier &identifierR);
 
 }; //class ChordIdentifier
 
 std::ostream& operator<< (std::ostream& os, Ptr<ChordIdentifier> const &identifier);
 bool operator < (const ChordIdentifier &identifierL, const ChordIdentifier &identifierR);
-bool operator == (const ChordIdentifier &identifierL, const ChordIdentifier identifierR);
+bool operator == (const ChordIdentifier &identifierL, const ChordIdentifier &identifierR);
 
 
 } //namespace ns3
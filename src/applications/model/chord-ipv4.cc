@@ -18,6 +18,7 @@
 
 #include "stdint.h"
 #include "stdlib.h"
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
@@ -28,6 +29,7 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
 #include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/callback.h"
@@ -123,15 +125,118 @@ ChordIpv4::GetTypeId (void)
                    MakeTimeAccessor (&ChordIpv4::m_dHashInactivityTimeout),
                    MakeTimeChecker ())
     .AddAttribute ("DHashAuditObjectsTimeout",
-                   "Timeout value for auditing stored DHash Objects in milli seconds",
+                   "Interval of periodic audit of stored DHash Objects in milli seconds (0 audits only on demand, see AuditDHashObjects)",
                    TimeValue (MilliSeconds (DEFAULT_AUDIT_OBJECTS_TIMEOUT)),
                    MakeTimeAccessor (&ChordIpv4::m_dHashAuditObjectsTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("DHashReplicationFactor",
+                   "Number of nodes storing each DHash Object (owner and its successors)",
+                   UintegerValue (DEFAULT_DHASH_REPLICATION_FACTOR),
+                   MakeUintegerAccessor (&ChordIpv4::m_dHashReplicationFactor),
+                   MakeUintegerChecker<uint8_t> (1))
+    .AddAttribute ("DHashDataFragments",
+                   "Erasure code DHash Objects into DHashReplicationFactor fragments, any DHashDataFragments of which reconstruct the object (0 disables coding)",
+                   UintegerValue (DEFAULT_DHASH_DATA_FRAGMENTS),
+                   MakeUintegerAccessor (&ChordIpv4::m_dHashDataFragments),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("DHashBulkTransferSize",
+                   "Max bytes of DHash store/retrieve requests to one node packed into a single bulk message (0 sends each request in its own message)",
+                   UintegerValue (DEFAULT_DHASH_BULK_TRANSFER_SIZE),
+                   MakeUintegerAccessor (&ChordIpv4::m_dHashBulkTransferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DHashRangePageSize",
+                   "Max DHash Objects returned in one response to a range retrieve, the query resumes after the last one (see RetrieveRange)",
+                   UintegerValue (DEFAULT_DHASH_RANGE_PAGE_SIZE),
+                   MakeUintegerAccessor (&ChordIpv4::m_dHashRangePageSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DHashObjectStore",
+                   "TypeId of DHash Object storage backend (ns3::DHashMapStore keeps objects in memory, ns3::DHashLogStore in a memory mapped log file)",
+                   StringValue (DEFAULT_DHASH_OBJECT_STORE),
+                   MakeStringAccessor (&ChordIpv4::m_dHashObjectStore),
+                   MakeStringChecker ())
     .AddAttribute ("FixFingerInterval",
                    "Fix Finger Interval in milli seconds",
                    TimeValue (MilliSeconds (DEFAULT_FIX_FINGER_INTERVAL)),
                    MakeTimeAccessor (&ChordIpv4::m_fixFingerInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("AdaptiveMaintenance",
+                   "Double Stabilize, Heartbeat and Fix Finger intervals of a vNode every stabilize round its successor answers, back to configured intervals on missed answer, failure or successor/predecessor change",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ChordIpv4::m_adaptiveMaintenance),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxMaintenanceBackoff",
+                   "Max number of doublings of maintenance intervals (AdaptiveMaintenance)",
+                   UintegerValue (DEFAULT_MAX_MAINTENANCE_BACKOFF),
+                   MakeUintegerAccessor (&ChordIpv4::m_maxMaintenanceBackoff),
+                   MakeUintegerChecker<uint8_t> (0, 16))
+    .AddAttribute ("ProximityNeighborSelection",
+                   "Fill each finger with lowest RTT node of finger interval (resolved finger node and its successors), instead of resolved node alone. "
+                   "Enable on rings of about 16 nodes or more with widely varying link delays; small rings leave too few candidates per interval to make up for the RTT probes",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ChordIpv4::m_proximityNeighborSelection),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RecursiveLookup",
+                   "Lookup requests are forwarded hop by hop and owner replies directly to requestor; otherwise requestor asks each hop in turn (iterative)",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ChordIpv4::m_recursiveLookup),
+                   MakeBooleanChecker ())
+    .AddAttribute ("IterativeLookupFallback",
+                   "Retransmit timed out recursive lookup iteratively, hop by hop from requestor, instead of via bootstrap node",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ChordIpv4::m_iterativeLookupFallback),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimerWheelResolution",
+                   "Tick of request timeout timer wheel in milli seconds (timeouts fire up to one tick late)",
+                   TimeValue (MilliSeconds (DEFAULT_TIMER_WHEEL_RESOLUTION)),
+                   MakeTimeAccessor (&ChordIpv4::m_timerWheelResolution),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxLookupBatchSize",
+                   "Max number of keys carried in one batched lookup request",
+                   UintegerValue (DEFAULT_MAX_LOOKUP_BATCH_SIZE),
+                   MakeUintegerAccessor (&ChordIpv4::m_maxLookupBatchSize),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("MaxLookupsInFlight",
+                   "Max number of batched lookups awaiting response",
+                   UintegerValue (DEFAULT_MAX_LOOKUPS_IN_FLIGHT),
+                   MakeUintegerAccessor (&ChordIpv4::m_maxLookupsInFlight),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SharedFingerRouting",
+                   "Route via nearest finger of any vNode of this node, instead of fingers of nearest vNode only",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ChordIpv4::m_sharedFingerRouting),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CoalesceMessages",
+                   "Messages sent to same node by one maintenance round (of all vNodes) or while handling one received packet travel in one packet",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ChordIpv4::m_coalesceMessages),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxCoalescedPacketSize",
+                   "Max size in bytes of packet carrying coalesced messages (CoalesceMessages)",
+                   UintegerValue (DEFAULT_MAX_COALESCED_PACKET_SIZE),
+                   MakeUintegerAccessor (&ChordIpv4::m_maxCoalescedPacketSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LocationCacheSize",
+                   "Max key ranges (predecessor, owner] kept by lookup location cache, 0 disables cache",
+                   UintegerValue (DEFAULT_LOCATION_CACHE_SIZE),
+                   MakeUintegerAccessor (&ChordIpv4::m_locationCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LocationCacheTimeout",
+                   "Lifetime of lookup location cache entries in milli seconds",
+                   TimeValue (MilliSeconds (DEFAULT_LOCATION_CACHE_TIMEOUT)),
+                   MakeTimeAccessor (&ChordIpv4::m_locationCacheTimeout),
+                   MakeTimeChecker ())
+    .AddTraceSource ("MaintenanceInterval",
+                     "Stabilize interval of a vNode changed (AdaptiveMaintenance)",
+                     MakeTraceSourceAccessor (&ChordIpv4::m_maintenanceIntervalTrace),
+                     "ns3::ChordIpv4::MaintenanceIntervalCallback")
+    .AddTraceSource ("Tx",
+                     "A packet (one or more coalesced messages) is sent",
+                     MakeTraceSourceAccessor (&ChordIpv4::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Lookup",
+                     "A routed lookup is resolved",
+                     MakeTraceSourceAccessor (&ChordIpv4::m_lookupTrace),
+                     "ns3::ChordIpv4::LookupCallback")
 
      ;
   return tid;
@@ -146,6 +251,13 @@ ChordIpv4::ChordIpv4 ()
   NS_LOG_FUNCTION_NOARGS ();
   m_socket = 0;
   isBootStrapNode = false;
+  m_nextLookupBatchId = 0;
+  m_lookupsInFlight = 0;
+  m_coalescingDepth = 0;
+  m_lookupStats.cacheHits = 0;
+  m_lookupStats.cacheMisses = 0;
+  m_lookupStats.cacheInvalidations = 0;
+  m_lookupStats.routedLookups = 0;
   //Timer configuration
 }
 
@@ -178,6 +290,8 @@ ChordIpv4::StartApplication (void)
   {
     isBootStrapNode = true; 
   }
+  m_locationCache.SetMaxSize (m_locationCacheSize);
+  m_locationCache.SetTimeout (m_locationCacheTimeout);
 
   if (m_socket == 0)
   {
@@ -202,16 +316,24 @@ ChordIpv4::StartApplication (void)
     factory.Set ("ListeningPort", UintegerValue(m_dHashPort));
     factory.Set ("ConnectionInactivityTimeout", TimeValue(m_dHashInactivityTimeout));
     factory.Set ("AuditObjectsTimeout", TimeValue(m_dHashAuditObjectsTimeout));
+    factory.Set ("ReplicationFactor", UintegerValue(m_dHashReplicationFactor));
+    factory.Set ("DataFragments", UintegerValue(m_dHashDataFragments));
+    factory.Set ("BulkTransferSize", UintegerValue(m_dHashBulkTransferSize));
+    factory.Set ("RangePageSize", UintegerValue(m_dHashRangePageSize));
+    factory.Set ("ObjectStore", StringValue(m_dHashObjectStore));
     m_dHashIpv4 = factory.Create<DHashIpv4> ();
     m_dHashIpv4->SetInsertSuccessCallback (MakeCallback(&ChordIpv4::NotifyInsertSuccess, this));
     m_dHashIpv4->SetRetrieveSuccessCallback (MakeCallback(&ChordIpv4::NotifyRetrieveSuccess, this));
     m_dHashIpv4->SetInsertFailureCallback (MakeCallback(&ChordIpv4::NotifyInsertFailure, this));
     m_dHashIpv4->SetRetrieveFailureCallback (MakeCallback(&ChordIpv4::NotifyRetrieveFailure, this));
+    m_dHashIpv4->SetRetrieveRangeCallback (MakeCallback(&ChordIpv4::NotifyRetrieveRange, this));
+    m_dHashIpv4->SetRetrieveRangeCompleteCallback (MakeCallback(&ChordIpv4::NotifyRetrieveRangeComplete, this));
     //Start layer
     m_dHashIpv4->Start (this);
   }
 
   //Configure timer
+  m_timerWheel.SetResolution(m_timerWheelResolution);
   m_stabilizeTimer.SetFunction(&ChordIpv4::DoPeriodicStabilize, this);
   m_heartbeatTimer.SetFunction(&ChordIpv4::DoPeriodicHeartbeat, this);
   m_fixFingerTimer.SetFunction(&ChordIpv4::DoPeriodicFixFinger, this);
@@ -232,13 +354,32 @@ ChordIpv4::StopApplication ()
     m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket> > ());
     //m_socket = 0;
   }
-  m_dHashIpv4 -> DoDispose();
+  if (m_dHashIpv4 != 0)
+  {
+    m_dHashIpv4 -> Dispose();
+  }
   //Cancel Timers
   m_stabilizeTimer.Cancel();
   m_heartbeatTimer.Cancel();
   m_fixFingerTimer.Cancel();
+  m_timerWheel.Clear();
+  m_rttEstimator.Clear();
   //Delete vNodes
+  for(ChordNodeMap::iterator vNodeIter = m_vNodeMap.GetMap().begin(); vNodeIter != m_vNodeMap.GetMap().end(); vNodeIter++)
+  {
+    Ptr<ChordVNode> vNode = DynamicCast<ChordVNode>((*vNodeIter).second);
+    vNode->GetFingerTable().SetRoutingTable (0);
+  }
   m_vNodeMap.Clear();
+  m_vNodeKeyMap.clear();
+  m_routingTable.Clear();
+  m_coalescedPackets.clear();
+  m_coalescingDepth = 0;
+  m_locationCache.Clear();
+  //Drop batched lookups
+  m_lookupBatchMap.clear();
+  m_pendingBatchLookups.clear();
+  m_lookupsInFlight = 0;
 }
 
 
@@ -264,7 +405,14 @@ ChordIpv4::SetLookupFailureCallback (Callback<void, uint8_t*, uint8_t> lookupFai
 }
 
 void
-ChordIpv4::SetDHashLookupSuccessCallback (Callback<void, uint8_t*, uint8_t, Ipv4Address, uint16_t> dHashLookupSuccessFn)
+ChordIpv4::SetLookupBatchCallback (Callback<void, std::vector<ChordLookupResult> > lookupBatchFn)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_lookupBatchFn = lookupBatchFn;
+}
+
+void
+ChordIpv4::SetDHashLookupSuccessCallback (Callback<void, uint8_t*, uint8_t, Ipv4Address, uint16_t, std::vector<InetSocketAddress> > dHashLookupSuccessFn)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_dHashLookupSuccessFn = dHashLookupSuccessFn;
@@ -299,19 +447,19 @@ ChordIpv4::SetVNodeKeyOwnershipCallback (Callback<void, std::string, uint8_t*, u
 }
 
 void 
-ChordIpv4::SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> insertSuccessFn)
+ChordIpv4::SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > insertSuccessFn)
 {
   m_insertSuccessFn = insertSuccessFn;
 } 
 
 void 
-ChordIpv4::SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> retrieveSuccessFn)
+ChordIpv4::SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > retrieveSuccessFn)
 {
   m_retrieveSuccessFn = retrieveSuccessFn;
 } 
    
 void 
-ChordIpv4::SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> insertFailureFn)
+ChordIpv4::SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > insertFailureFn)
 {
   m_insertFailureFn = insertFailureFn;
 } 
@@ -322,6 +470,18 @@ ChordIpv4::SetRetrieveFailureCallback (Callback <void, uint8_t*, uint8_t> retrie
   m_retrieveFailureFn = retrieveFailureFn;
 }
 
+void 
+ChordIpv4::SetRetrieveRangeCallback (Callback <void, uint32_t, uint8_t*, uint8_t, Ptr<const Packet> > retrieveRangeFn)
+{
+  m_retrieveRangeFn = retrieveRangeFn;
+}
+
+void 
+ChordIpv4::SetRetrieveRangeCompleteCallback (Callback <void, uint32_t, bool> retrieveRangeCompleteFn)
+{
+  m_retrieveRangeCompleteFn = retrieveRangeCompleteFn;
+}
+
 void 
 ChordIpv4:: SetDHashVNodeKeyOwnershipCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint8_t, uint8_t*, uint8_t, Ipv4Address, uint16_t> dHashVNodeKeyOwnershipFn)
 {
@@ -339,7 +499,7 @@ ChordIpv4::NotifyJoinSuccess (std::string vNodeName, Ptr<ChordIdentifier> chordI
 }
 
 void
-ChordIpv4::NotifyLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<ChordNode> resolvedNode, ChordTransaction::Originator originator)
+ChordIpv4::NotifyLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<ChordNode> resolvedNode, std::vector<Ptr<ChordNode> > &successorList, ChordTransaction::Originator originator)
 {
   NS_LOG_FUNCTION_NOARGS ();
   if (!m_lookupSuccessFn.IsNull() && originator == ChordTransaction::APPLICATION)
@@ -348,7 +508,7 @@ ChordIpv4::NotifyLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<Chord
   }
   else if (originator == ChordTransaction::DHASH)
   {
-    NotifyDHashLookupSuccess (lookupIdentifier, resolvedNode->GetIpAddress(), resolvedNode->GetDHashPort());
+    NotifyDHashLookupSuccess (lookupIdentifier, resolvedNode, successorList);
   }
 }
 
@@ -356,6 +516,7 @@ void
 ChordIpv4::NotifyLookupFailure (Ptr<ChordIdentifier> chordIdentifier, ChordTransaction::Originator originator)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_locationCache.InvalidateIdentifier (chordIdentifier);
   if (!m_lookupFailureFn.IsNull() && originator == ChordTransaction::APPLICATION)
   {
     m_lookupFailureFn (chordIdentifier->GetKey (), chordIdentifier->GetNumBytes ());
@@ -365,13 +526,50 @@ ChordIpv4::NotifyLookupFailure (Ptr<ChordIdentifier> chordIdentifier, ChordTrans
     NotifyDHashLookupFailure (chordIdentifier);
   }
 }
+
+void
+ChordIpv4::NotifyLookupBatch (std::vector<ChordLookupResult> &results)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (!m_lookupBatchFn.IsNull())
+  {
+    m_lookupBatchFn (results);
+  }
+}
+
 void
-ChordIpv4::NotifyDHashLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ipv4Address ipAddress, uint16_t port)
+ChordIpv4::NotifyDHashLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<ChordNode> resolvedNode, std::vector<Ptr<ChordNode> > &successorList)
 {
   NS_LOG_FUNCTION_NOARGS ();
   if (!m_dHashLookupSuccessFn.IsNull())
   {
-    m_dHashLookupSuccessFn (lookupIdentifier->GetKey(), lookupIdentifier->GetNumBytes(), ipAddress, port);
+    std::vector<InetSocketAddress> replicas;
+    GetReplicaAddresses (resolvedNode, successorList, replicas);
+    m_dHashLookupSuccessFn (lookupIdentifier->GetKey(), lookupIdentifier->GetNumBytes(), resolvedNode->GetIpAddress(), resolvedNode->GetDHashPort(), replicas);
+  }
+}
+
+void
+ChordIpv4::GetReplicaAddresses (Ptr<ChordNode> ownerNode, std::vector<Ptr<ChordNode> > &successorList, std::vector<InetSocketAddress> &replicas)
+{
+  //First (replicationFactor - 1) successors of owner, physical nodes are listed once
+  for (std::vector<Ptr<ChordNode> >::iterator nodeIter = successorList.begin(); nodeIter != successorList.end() && replicas.size() + 1 < m_dHashReplicationFactor; nodeIter++)
+  {
+    Ptr<ChordNode> node = *nodeIter;
+    if (node->GetChordIdentifier()->IsEqual (ownerNode->GetChordIdentifier()))
+    {
+      //Successor list wrapped around
+      break;
+    }
+    bool duplicate = (node->GetIpAddress() == ownerNode->GetIpAddress() && node->GetDHashPort() == ownerNode->GetDHashPort());
+    for (std::vector<InetSocketAddress>::iterator replicaIter = replicas.begin(); replicaIter != replicas.end() && !duplicate; replicaIter++)
+    {
+      duplicate = (replicaIter->GetIpv4() == node->GetIpAddress() && replicaIter->GetPort() == node->GetDHashPort());
+    }
+    if (!duplicate)
+    {
+      replicas.push_back (InetSocketAddress (node->GetIpAddress(), node->GetDHashPort()));
+    }
   }
 }
 
@@ -389,6 +587,9 @@ void
 ChordIpv4::NotifyVNodeKeyOwnership (std::string vNodeName, Ptr<ChordIdentifier> chordIdentifier, Ptr<ChordNode> predecessorNode, Ptr<ChordIdentifier> oldPredecessorIdentifier)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  //Key space around this vNode was repartitioned, cached ranges there are out of date
+  m_locationCache.InvalidateRange (oldPredecessorIdentifier, chordIdentifier);
+  m_locationCache.InvalidateRange (predecessorNode->GetChordIdentifier(), chordIdentifier);
   if (!m_vNodeKeyOwnershipFn.IsNull ())
   {
     m_vNodeKeyOwnershipFn (vNodeName, chordIdentifier->GetKey (), chordIdentifier->GetNumBytes(), predecessorNode->GetChordIdentifier()->GetKey (), predecessorNode->GetChordIdentifier()->GetNumBytes (), oldPredecessorIdentifier->GetKey(), oldPredecessorIdentifier->GetNumBytes(), predecessorNode->GetIpAddress(), predecessorNode->GetApplicationPort());
@@ -420,30 +621,46 @@ ChordIpv4::NotifyVNodeFailure (std::string vNodeName, Ptr<ChordIdentifier> chord
 }
 
 void
-ChordIpv4::NotifyInsertSuccess (uint8_t* key, uint8_t keyBytes, uint8_t* object, uint32_t objectBytes)
+ChordIpv4::NotifyInsertSuccess (uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object)
 {
-  m_insertSuccessFn (key, keyBytes, object, objectBytes);
+  m_insertSuccessFn (key, keyBytes, object);
 }
 
 void
-ChordIpv4::NotifyRetrieveSuccess (uint8_t* key, uint8_t keyBytes, uint8_t* object, uint32_t objectBytes)
+ChordIpv4::NotifyRetrieveSuccess (uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object)
 {
-  m_retrieveSuccessFn (key, keyBytes, object, objectBytes);
+  m_retrieveSuccessFn (key, keyBytes, object);
 }
 
 
 void
-ChordIpv4::NotifyInsertFailure (uint8_t* key, uint8_t keyBytes, uint8_t* object, uint32_t objectBytes)
+ChordIpv4::NotifyInsertFailure (uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object)
 {
-  m_insertFailureFn (key, keyBytes, object, objectBytes);
+  //Owner taken from cache may be gone
+  m_locationCache.InvalidateIdentifier (Create<ChordIdentifier> (key, keyBytes));
+  m_insertFailureFn (key, keyBytes, object);
 }
 
 void
 ChordIpv4::NotifyRetrieveFailure (uint8_t* key, uint8_t keyBytes)
 {
+  //Owner taken from cache may be gone
+  m_locationCache.InvalidateIdentifier (Create<ChordIdentifier> (key, keyBytes));
   m_retrieveFailureFn (key, keyBytes); 
 }
 
+void
+ChordIpv4::NotifyRetrieveRange (uint32_t queryId, uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object)
+{
+  m_retrieveRangeFn (queryId, key, keyBytes, object);
+}
+
+void
+ChordIpv4::NotifyRetrieveRangeComplete (uint32_t queryId, bool success)
+{
+  m_retrieveRangeCompleteFn (queryId, success);
+}
+
 void
 ChordIpv4::Insert (uint8_t *key, uint8_t sizeOfKey ,uint8_t *object,uint32_t sizeOfObject)
 {
@@ -462,6 +679,61 @@ ChordIpv4::Retrieve (uint8_t *key, uint8_t sizeOfKey)
   }
 }
 
+void
+ChordIpv4::Insert (const ChordKey &key, uint8_t *object, uint32_t sizeOfObject)
+{
+  if (m_dHashEnable)
+  {
+    m_dHashIpv4->Insert(key, object, sizeOfObject);
+  }
+}
+
+void
+ChordIpv4::Insert (uint8_t *key, uint8_t sizeOfKey, Ptr<const Packet> object)
+{
+  if (m_dHashEnable)
+  {
+    m_dHashIpv4->Insert(key, sizeOfKey, object);
+  }
+}
+
+void
+ChordIpv4::Retrieve (const ChordKey &key)
+{
+  if (m_dHashEnable)
+  {
+    m_dHashIpv4->Retrieve(key);
+  }
+}
+
+uint32_t
+ChordIpv4::RetrieveRange (uint8_t* lowKey, uint8_t* highKey, uint8_t sizeOfKey)
+{
+  if (m_dHashEnable)
+  {
+    return m_dHashIpv4->RetrieveRange(lowKey, highKey, sizeOfKey);
+  }
+  return 0;
+}
+
+uint32_t
+ChordIpv4::RetrieveRange (const ChordKey &lowKey, const ChordKey &highKey)
+{
+  if (m_dHashEnable)
+  {
+    return m_dHashIpv4->RetrieveRange(lowKey, highKey);
+  }
+  return 0;
+}
+
+void
+ChordIpv4::InsertVNode (std::string vNodeName, const ChordKey &key)
+{
+  uint8_t keyBytes[ChordKey::NUM_BYTES];
+  key.GetKey (keyBytes);
+  InsertVNode (vNodeName, keyBytes, ChordKey::NUM_BYTES);
+}
+
 void
 ChordIpv4::InsertVNode (std::string vNodeName, uint8_t* key, uint8_t keyBytes)
 {
@@ -476,6 +748,12 @@ ChordIpv4::InsertVNode (std::string vNodeName, uint8_t* key, uint8_t keyBytes)
   vNode-> SetPredecessor (Create<ChordNode> (vNode));
   //Set routable = false
   vNode->SetRoutable(false);
+  //Share fingers with other vNodes
+  vNode->GetFingerTable().SetRoutingTable (&m_routingTable);
+  if (keyBytes == ChordKey::NUM_BYTES)
+  {
+    m_vNodeKeyMap[ChordKey (key)] = vNode;
+  }
 
   /* bootStrapIp is same as local Ip and no v-nodes exist. In that case we need to create a new chord */
   if (isBootStrapNode && m_vNodeMap.GetSize() == 0)
@@ -502,15 +780,15 @@ ChordIpv4::InsertVNode (std::string vNodeName, uint8_t* key, uint8_t keyBytes)
   vNode -> AddTransaction (chordMessage.GetTransactionId(), chordTransaction);
 
   //Start transaction timer
-  EventId requestTimeoutId = Simulator::Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, vNode, chordMessage.GetTransactionId());
-  chordTransaction -> SetRequestTimeoutEventId (requestTimeoutId);
+  Ptr<EventImpl> requestTimeout = m_timerWheel.Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, vNode, chordMessage.GetTransactionId());
+  chordTransaction -> SetRequestTimeoutEvent (requestTimeout);
   packet->AddHeader (chordMessage);
   if (packet->GetSize())
   {
     NS_LOG_INFO ("Sending JoinReq\n" << chordMessage);
     if (m_vNodeMap.GetSize() > 1)
     {
-      if (RoutePacket (vNode->GetChordIdentifier(), packet) == true)
+      if (RoutePacket (vNode->GetChordIdentifier()->GetChordKey(), packet) == true)
       {
         return;
       }
@@ -534,6 +812,12 @@ ChordIpv4::RemoveVNode (std::string vNodeName)
     return;
   }
   Ptr<ChordVNode> virtualNode = DynamicCast<ChordVNode>(chordNode);
+  if (virtualNode->GetSuccessor() == 0 || virtualNode->GetPredecessor() == 0)
+  {
+    //Not stabilized yet, neighbours find out through heartbeat/stabilize failures
+    DeleteVNode(vNodeName);
+    return;
+  }
 
   //Send this request to bootstrap IP
   Ptr<Packet> packet = Create<Packet> ();
@@ -560,6 +844,41 @@ ChordIpv4::LookupKey (uint8_t* lookupKey, uint8_t lookupKeyBytes)
   Ptr<ChordIdentifier> requestedIdentifier = Create<ChordIdentifier> (lookupKey, lookupKeyBytes);
   DoLookup (requestedIdentifier, ChordTransaction::APPLICATION);
 }
+
+void
+ChordIpv4::LookupKey (const ChordKey &lookupKey)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<ChordIdentifier> requestedIdentifier = Create<ChordIdentifier> (lookupKey);
+  DoLookup (requestedIdentifier, ChordTransaction::APPLICATION);
+}
+
+void
+ChordIpv4::LookupKeys (const std::vector<ChordKey> &lookupKeys)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t batchId = m_nextLookupBatchId++;
+  LookupBatch &lookupBatch = m_lookupBatchMap[batchId];
+  lookupBatch.results.resize (lookupKeys.size());
+  lookupBatch.pending = lookupKeys.size();
+  for (uint32_t i = 0; i < lookupKeys.size(); i++)
+  {
+    lookupBatch.results[i].key = lookupKeys[i];
+    lookupBatch.results[i].success = false;
+    lookupBatch.results[i].port = 0;
+    m_pendingBatchLookups.push_back (std::make_pair (batchId, i));
+  }
+  if (lookupKeys.size() == 0)
+  {
+    //Nothing to resolve
+    std::vector<ChordLookupResult> results;
+    m_lookupBatchMap.erase (batchId);
+    NotifyLookupBatch (results);
+    return;
+  }
+  DispatchBatchLookups ();
+}
+
 void
 ChordIpv4::DHashLookupKey (uint8_t* lookupKey, uint8_t lookupKeyBytes)
 {
@@ -578,16 +897,33 @@ ChordIpv4::DoLookup (Ptr<ChordIdentifier> requestedIdentifier, ChordTransaction:
   if (ret == true)
   {
     //We are owner, report success
-    NotifyLookupSuccess(requestedIdentifier, virtualNode, originator);
+    NotifyLookupSuccess(requestedIdentifier, virtualNode, virtualNode->GetSuccessorList(), originator);
     return;
   } 
+  //Owner of a recent lookup in same range
+  uint8_t numSuccessors = (originator == ChordTransaction::DHASH) ? m_dHashReplicationFactor - 1 : 0;
+  Ptr<ChordNode> ownerNode;
+  std::vector<Ptr<ChordNode> > successorList;
+  if (m_locationCache.Find (requestedIdentifier, numSuccessors, ownerNode, successorList) == true)
+  {
+    m_lookupStats.cacheHits++;
+    NotifyLookupSuccess (requestedIdentifier, ownerNode, successorList, originator);
+    return;
+  }
+  m_lookupStats.cacheMisses++;
   //Initiate lookup request
   
-  if (FindNearestVNode (requestedIdentifier, virtualNode) == true)
+  if (FindNearestVNode (requestedIdentifier->GetChordKey(), virtualNode) == true)
   {
     Ptr<Packet> packet = Create<Packet> ();
     ChordMessage chordMessage = ChordMessage ();
     virtualNode->PackLookupReq (requestedIdentifier, chordMessage);
+    //Ask owner for replica holders (DHash)
+    chordMessage.GetLookupReq().numSuccessors = numSuccessors;
+    if (m_recursiveLookup == false)
+    {
+      chordMessage.GetLookupReq().lookupMode = ChordMessage::ITERATIVE_LOOKUP;
+    }
     //Add transaction
     Ptr<ChordTransaction> chordTransaction = Create<ChordTransaction> (chordMessage.GetTransactionId(), chordMessage, m_requestTimeout, m_maxRequestRetries);
     chordTransaction->SetOriginator(originator);
@@ -596,13 +932,19 @@ ChordIpv4::DoLookup (Ptr<ChordIdentifier> requestedIdentifier, ChordTransaction:
     virtualNode -> AddTransaction (chordMessage.GetTransactionId(), chordTransaction);
 
     //Start transaction timer
-    EventId requestTimeoutId = Simulator::Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, virtualNode, chordMessage.GetTransactionId());
-    chordTransaction -> SetRequestTimeoutEventId (requestTimeoutId);
+    Ptr<EventImpl> requestTimeout = m_timerWheel.Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, virtualNode, chordMessage.GetTransactionId());
+    chordTransaction -> SetRequestTimeoutEvent (requestTimeout);
     packet->AddHeader (chordMessage);
     if (packet->GetSize())
     {
-      RouteViaFinger (requestedIdentifier, virtualNode, packet); 
-      //SendPacket (packet, virtualNode->GetSuccessor()->GetIpAddress(), virtualNode->GetSuccessor()->GetPort());
+      Ptr<ChordNode> nextHop;
+      FindNextHop (requestedIdentifier->GetChordKey(), virtualNode, nextHop);
+      if (m_recursiveLookup == false)
+      {
+        //We walk the hops ourselves, remember whom we asked
+        chordTransaction->SetNextHop (nextHop);
+      }
+      SendPacket (packet, nextHop->GetIpAddress(), nextHop->GetPort());
     }
   }  
   else
@@ -612,6 +954,123 @@ ChordIpv4::DoLookup (Ptr<ChordIdentifier> requestedIdentifier, ChordTransaction:
   }
 }
 
+/*  Logic: Move queued keys into flight while window permits. Keys owned locally complete at once, rest are grouped by
+ *  (originating vNode, next hop) so that each group costs one message per MaxLookupBatchSize keys.
+ */
+void
+ChordIpv4::DispatchBatchLookups ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  //(originating vNode, (next hop ip, next hop port))
+  typedef std::pair<Ptr<ChordVNode>, std::pair<uint32_t, uint16_t> > HopKey;
+  std::map<HopKey, std::vector<std::pair<uint32_t, uint32_t> > > hopMap;
+  while (m_lookupsInFlight < m_maxLookupsInFlight && !m_pendingBatchLookups.empty())
+  {
+    std::pair<uint32_t, uint32_t> slot = m_pendingBatchLookups.front();
+    m_pendingBatchLookups.pop_front();
+    std::map<uint32_t, LookupBatch>::iterator batchIter = m_lookupBatchMap.find (slot.first);
+    if (batchIter == m_lookupBatchMap.end())
+      continue;
+    Ptr<ChordIdentifier> requestedIdentifier = Create<ChordIdentifier> (batchIter->second.results[slot.second].key);
+    Ptr<ChordVNode> virtualNode;
+    if (LookupLocal (requestedIdentifier, virtualNode) == true)
+    {
+      //We are owner
+      CompleteBatchLookup (slot.first, slot.second, virtualNode);
+      continue;
+    }
+    Ptr<ChordNode> ownerNode;
+    std::vector<Ptr<ChordNode> > successorList;
+    if (m_locationCache.Find (requestedIdentifier, 0, ownerNode, successorList) == true)
+    {
+      m_lookupStats.cacheHits++;
+      CompleteBatchLookup (slot.first, slot.second, ownerNode);
+      continue;
+    }
+    m_lookupStats.cacheMisses++;
+    if (FindNearestVNode (requestedIdentifier->GetChordKey(), virtualNode) == false)
+    {
+      CompleteBatchLookup (slot.first, slot.second, 0);
+      continue;
+    }
+    Ptr<ChordNode> nextHop;
+    FindNextHop (requestedIdentifier->GetChordKey(), virtualNode, nextHop);
+    hopMap[HopKey (virtualNode, std::make_pair (nextHop->GetIpAddress().Get(), nextHop->GetPort()))].push_back (slot);
+    m_lookupsInFlight++;
+  }
+  //Send one request per group (split at max batch size)
+  for (std::map<HopKey, std::vector<std::pair<uint32_t, uint32_t> > >::iterator hopIter = hopMap.begin(); hopIter != hopMap.end(); hopIter++)
+  {
+    std::vector<std::pair<uint32_t, uint32_t> > &slots = hopIter->second;
+    for (uint32_t offset = 0; offset < slots.size(); offset += m_maxLookupBatchSize)
+    {
+      std::vector<std::pair<uint32_t, uint32_t> > chunk (slots.begin() + offset, slots.begin() + std::min<uint32_t> (offset + m_maxLookupBatchSize, slots.size()));
+      SendLookupBatchReq (hopIter->first.first, Ipv4Address (hopIter->first.second.first), hopIter->first.second.second, chunk);
+    }
+  }
+}
+
+void
+ChordIpv4::SendLookupBatchReq (Ptr<ChordVNode> virtualNode, Ipv4Address nextHopIp, uint16_t nextHopPort, std::vector<std::pair<uint32_t, uint32_t> > &slots)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ChordTransaction::BatchSlotMap batchSlots;
+  std::vector<Ptr<ChordIdentifier> > requestedIdentifiers;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::iterator slotIter = slots.begin(); slotIter != slots.end(); slotIter++)
+  {
+    ChordKey &key = m_lookupBatchMap[slotIter->first].results[slotIter->second].key;
+    //Same key asked twice is carried once
+    if (batchSlots.find (key) == batchSlots.end())
+    {
+      requestedIdentifiers.push_back (Create<ChordIdentifier> (key));
+    }
+    batchSlots.insert (std::make_pair (key, *slotIter));
+  }
+  Ptr<Packet> packet = Create<Packet> ();
+  ChordMessage chordMessage = ChordMessage ();
+  virtualNode->PackLookupBatchReq (requestedIdentifiers, chordMessage);
+  //Add transaction
+  Ptr<ChordTransaction> chordTransaction = Create<ChordTransaction> (chordMessage.GetTransactionId(), chordMessage, m_requestTimeout, m_maxRequestRetries);
+  chordTransaction->SetOriginator (ChordTransaction::APPLICATION);
+  chordTransaction->GetBatchSlots().swap (batchSlots);
+  //Add to vNode
+  virtualNode -> AddTransaction (chordMessage.GetTransactionId(), chordTransaction);
+
+  //Start transaction timer
+  Ptr<EventImpl> requestTimeout = m_timerWheel.Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, virtualNode, chordMessage.GetTransactionId());
+  chordTransaction -> SetRequestTimeoutEvent (requestTimeout);
+  packet->AddHeader (chordMessage);
+  if (packet->GetSize())
+  {
+    NS_LOG_INFO ("Sending LookupBatchReq with " << requestedIdentifiers.size() << " keys");
+    SendPacket (packet, nextHopIp, nextHopPort);
+  }
+}
+
+void
+ChordIpv4::CompleteBatchLookup (uint32_t batchId, uint32_t position, Ptr<ChordNode> resolvedNode)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::map<uint32_t, LookupBatch>::iterator batchIter = m_lookupBatchMap.find (batchId);
+  if (batchIter == m_lookupBatchMap.end())
+    return;
+  LookupBatch &lookupBatch = batchIter->second;
+  ChordLookupResult &result = lookupBatch.results[position];
+  if (resolvedNode != 0)
+  {
+    result.success = true;
+    result.ipAddress = resolvedNode->GetIpAddress();
+    result.port = resolvedNode->GetApplicationPort();
+  }
+  if (--lookupBatch.pending == 0)
+  {
+    //All keys done, report once
+    std::vector<ChordLookupResult> results;
+    results.swap (lookupBatch.results);
+    m_lookupBatchMap.erase (batchIter);
+    NotifyLookupBatch (results);
+  }
+}
 
 void
 ChordIpv4::ProcessUdpPacket (Ptr<Socket> socket)
@@ -619,17 +1078,35 @@ ChordIpv4::ProcessUdpPacket (Ptr<Socket> socket)
   NS_LOG_FUNCTION_NOARGS ();
   Ptr<Packet> packet;
   Address from;
+  //Decoded in place, reused for every message
+  ChordMessageView messageView;
+  //Replies and forwards to same node travel in one packet
+  StartCoalescing ();
   while (packet = socket->RecvFrom(from))
   {
-    if (InetSocketAddress::IsMatchingType (from))
+    if (!InetSocketAddress::IsMatchingType (from))
     {
-      InetSocketAddress address = InetSocketAddress::ConvertFrom (from);
-      NS_LOG_INFO ("ChordIpv4: Received " << packet->GetSize() << " bytes packet from " <<  address.GetIpv4());
-      Ipv4Address fromIpAddress = address.GetIpv4();
-
+      continue;
+    }
+    InetSocketAddress address = InetSocketAddress::ConvertFrom (from);
+    NS_LOG_INFO ("ChordIpv4: Received " << packet->GetSize() << " bytes packet from " <<  address.GetIpv4());
+    //Packet may carry several coalesced messages
+    while (packet->GetSize() > 0)
+    {
+      //Steady state maintenance and owned lookups are handled without building ChordMessage
+      uint32_t viewSize = packet->PeekHeader (messageView);
+      if (viewSize != 0 && ProcessMessageView (messageView))
+      {
+        NS_LOG_INFO ("ChordMessageView: " << messageView);
+        packet->RemoveAtStart (viewSize);
+        continue;
+      }
       ChordMessage chordMessage = ChordMessage ();
       //Retrieve and Deserialize chord message
-      packet->RemoveHeader(chordMessage);
+      if (packet->RemoveHeader(chordMessage) == 0)
+      {
+        break;
+      }
       NS_LOG_INFO ("ChordMessage: " << chordMessage);
       switch (chordMessage.GetMessageType ())
       {
@@ -651,6 +1128,15 @@ ChordIpv4::ProcessUdpPacket (Ptr<Socket> socket)
        case ChordMessage::LOOKUP_RSP:
          ProcessLookupRsp (chordMessage);
          break;
+       case ChordMessage::LOOKUP_REFERRAL:
+         ProcessLookupReferral (chordMessage);
+         break;
+       case ChordMessage::LOOKUP_BATCH_REQ:
+         ProcessLookupBatchReq (chordMessage);
+         break;
+       case ChordMessage::LOOKUP_BATCH_RSP:
+         ProcessLookupBatchRsp (chordMessage);
+         break;
        case ChordMessage::STABILIZE_REQ:
          ProcessStabilizeReq (chordMessage);
          break;
@@ -669,6 +1155,12 @@ ChordIpv4::ProcessUdpPacket (Ptr<Socket> socket)
        case ChordMessage::FINGER_RSP:
          ProcessFingerRsp (chordMessage);
          break;
+       case ChordMessage::PING_REQ:
+         ProcessPingReq (chordMessage);
+         break;
+       case ChordMessage::PING_RSP:
+         ProcessPingRsp (chordMessage);
+         break;
        case ChordMessage::TRACE_RING:
          ProcessTraceRing (chordMessage);
          break;
@@ -678,10 +1170,31 @@ ChordIpv4::ProcessUdpPacket (Ptr<Socket> socket)
       }
     }
   }
+  FlushCoalescedPackets ();
+}
+
+bool
+ChordIpv4::ProcessMessageView (const ChordMessageView &messageView)
+{
+  switch (messageView.GetMessageType ())
+  {
+    case ChordMessage::LOOKUP_REQ:
+      return ProcessLookupReq (messageView);
+    case ChordMessage::STABILIZE_REQ:
+      return ProcessStabilizeReq (messageView);
+    case ChordMessage::STABILIZE_RSP:
+      return ProcessStabilizeRsp (messageView);
+    case ChordMessage::HEARTBEAT_REQ:
+      return ProcessHeartbeatReq (messageView);
+    case ChordMessage::HEARTBEAT_RSP:
+      return ProcessHeartbeatRsp (messageView);
+    default:
+      return false;
+  }
 }
 
 void
-ChordIpv4::ProcessJoinReq (ChordMessage chordMessage)
+ChordIpv4::ProcessJoinReq (ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
@@ -709,15 +1222,19 @@ ChordIpv4::ProcessJoinReq (ChordMessage chordMessage)
     return;
   }
   //Could not resolve join request, forward to nearest successor
+  if (DecrementTTL (chordMessage) == false)
+  {
+    return;
+  }
   packet->AddHeader(chordMessage);
   if (packet->GetSize())
   {
-    RoutePacket (requestorNode->GetChordIdentifier(), packet);
+    RoutePacket (requestorNode->GetChordIdentifier()->GetChordKey(), packet);
   }
 }
 
 void
-ChordIpv4::ProcessJoinRsp (ChordMessage chordMessage)
+ChordIpv4::ProcessJoinRsp (ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
   //Extract info from packet
@@ -738,18 +1255,19 @@ ChordIpv4::ProcessJoinRsp (ChordMessage chordMessage)
     //VNode found, set its successor and stabilize
     virtualNode->SetSuccessor(Create<ChordNode> (successorNode));
     //Make this node routable
-    virtualNode->SetRoutable (true);
+    m_vNodeMap.SetRoutable (virtualNode, true);
     //cancel transaction
     virtualNode->RemoveTransaction (chordTransaction->GetTransactionId());
     DoStabilize(virtualNode);
     DoFixFinger (virtualNode);
+    ResetMaintenance (virtualNode);
     //notify application about join success
     NotifyJoinSuccess(virtualNode->GetVNodeName(), requestorNode->GetChordIdentifier());
   }
 }
 
 void
-ChordIpv4::ProcessLookupReq (ChordMessage chordMessage)
+ChordIpv4::ProcessLookupReq (ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
@@ -766,24 +1284,66 @@ ChordIpv4::ProcessLookupReq (ChordMessage chordMessage)
   bool ret = LookupLocal (requestedIdentifier, virtualNode);
   if (ret == true)
   {
+    SendLookupRsp (virtualNode, requestorNode, transactionId, chordMessage.GetLookupReq().numSuccessors, chordMessage.GetTTL());
+    return;
+  }
+  if (chordMessage.GetLookupReq().lookupMode == ChordMessage::ITERATIVE_LOOKUP)
+  {
+    //Could not resolve lookup request, refer requestor to nearest successor we know
+    if (FindNearestVNode (requestedIdentifier->GetChordKey(), virtualNode) == false)
+    {
+      return;
+    }
+    Ptr<ChordNode> nextHop;
+    FindNextHop (requestedIdentifier->GetChordKey(), virtualNode, nextHop);
     ChordMessage chordMessageRsp = ChordMessage ();
-    virtualNode->PackLookupRsp (requestorNode,  transactionId, chordMessageRsp);
-    packet-> AddHeader (chordMessageRsp);
-    //Send packet
+    virtualNode->PackLookupReferral (requestorNode, transactionId, nextHop, chordMessageRsp);
+    packet->AddHeader (chordMessageRsp);
     if (packet->GetSize())
     {
-      NS_LOG_INFO("Sending LookupRsp: "<<chordMessageRsp);
-      SendPacket(packet, requestorNode->GetIpAddress(), requestorNode->GetPort());
+      SendPacket (packet, requestorNode->GetIpAddress(), requestorNode->GetPort());
     }
     return;
   }
-  //Could not resolve lookup request, forward to nearest successor
+  //Could not resolve lookup request, forward to nearest successor. No state kept, owner replies to requestor directly.
+  if (DecrementTTL (chordMessage) == false)
+  {
+    return;
+  }
   packet->AddHeader(chordMessage);
-  RoutePacket (requestedIdentifier, packet);
+  RoutePacket (requestedIdentifier->GetChordKey(), packet);
+}
+
+bool
+ChordIpv4::ProcessLookupReq (const ChordMessageView &messageView)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  //Only answer requests we own, referral and forwarding go through ChordMessage
+  Ptr<ChordVNode> virtualNode;
+  if (LookupLocal (messageView.GetLookupReq().requestedIdentifier, virtualNode) == false)
+  {
+    return false;
+  }
+  SendLookupRsp (virtualNode, messageView.GetRequestorNode().CreateNode (), messageView.GetTransactionId (), messageView.GetLookupReq().numSuccessors, messageView.GetTTL());
+  return true;
+}
+
+void
+ChordIpv4::SendLookupRsp (Ptr<ChordVNode> virtualNode, Ptr<ChordNode> requestorNode, uint32_t transactionId, uint8_t numSuccessors, uint8_t ttl)
+{
+  //Owner of requested identifier answers requestor directly
+  Ptr<Packet> packet = Create<Packet> ();
+  ChordMessage chordMessageRsp = ChordMessage ();
+  virtualNode->PackLookupRsp (requestorNode, transactionId, numSuccessors, chordMessageRsp);
+  //TTL left tells requestor how many hops request took
+  chordMessageRsp.SetTTL (ttl);
+  packet->AddHeader (chordMessageRsp);
+  NS_LOG_INFO("Sending LookupRsp: "<<chordMessageRsp);
+  SendPacket(packet, requestorNode->GetIpAddress(), requestorNode->GetPort());
 }
 
 void
-ChordIpv4::ProcessLeaveReq(ChordMessage chordMessage)
+ChordIpv4::ProcessLeaveReq (ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -798,11 +1358,12 @@ ChordIpv4::ProcessLeaveReq(ChordMessage chordMessage)
   //Are we successor node?
   bool ret;
   ret = FindVNode(successorNode->GetChordIdentifier(), virtualNode);
-  if (ret == true && virtualNode->GetPredecessor()->GetChordIdentifier()->IsEqual(requestorNode->GetChordIdentifier()))
+  if (ret == true && virtualNode->GetPredecessor() != 0 && virtualNode->GetPredecessor()->GetChordIdentifier()->IsEqual(requestorNode->GetChordIdentifier()))
   {
     //Reset own predecessor
     Ptr<ChordNode> oldPredecessorNode = virtualNode->GetPredecessor();
     virtualNode->SetPredecessor(Create<ChordNode> (predecessorNode));
+    ResetMaintenance (virtualNode);
     NotifyVNodeKeyOwnership (virtualNode->GetVNodeName(), virtualNode->GetChordIdentifier(), virtualNode->GetPredecessor(), oldPredecessorNode->GetChordIdentifier());
     //Send Leave Rsp (only required in case of successor)
     ChordMessage respMessage = ChordMessage ();
@@ -815,18 +1376,19 @@ ChordIpv4::ProcessLeaveReq(ChordMessage chordMessage)
 
   //Are we predecessor node?
   ret = FindVNode(predecessorNode->GetChordIdentifier(), virtualNode);
-  if (ret == true && virtualNode->GetSuccessor()->GetChordIdentifier()->IsEqual(requestorNode->GetChordIdentifier()))
+  if (ret == true && virtualNode->GetSuccessor() != 0 && virtualNode->GetSuccessor()->GetChordIdentifier()->IsEqual(requestorNode->GetChordIdentifier()))
   {
     //Reset own successor
     virtualNode->SetSuccessor(Create<ChordNode> (successorNode));
     DoFixFinger (virtualNode);
-    virtualNode->SetRoutable(true);
+    m_vNodeMap.SetRoutable (virtualNode, true);
+    ResetMaintenance (virtualNode);
     NS_LOG_INFO("Successor changed for VNode");
   }
 }
 
 void
-ChordIpv4::ProcessLeaveRsp (ChordMessage chordMessage)
+ChordIpv4::ProcessLeaveRsp (ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
@@ -845,7 +1407,7 @@ ChordIpv4::ProcessLeaveRsp (ChordMessage chordMessage)
 }
 
 void
-ChordIpv4::ProcessLookupRsp (ChordMessage chordMessage)
+ChordIpv4::ProcessLookupRsp (ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_INFO ("Received Lookup Response");
@@ -866,55 +1428,252 @@ ChordIpv4::ProcessLookupRsp (ChordMessage chordMessage)
     }
     Ptr<ChordIdentifier> requestedIdentifier = chordTransaction->GetRequestedIdentifier ();
     ChordTransaction::Originator originator = chordTransaction->GetOriginator();
+    m_lookupStats.routedLookups++;
+    m_lookupStats.routedLatency += Simulator::Now() - chordTransaction->GetStartTime();
+    //Each forward (recursive) or referral (iterative) took one off TTL of request
+    m_lookupTrace (Simulator::Now() - chordTransaction->GetStartTime(), DEFAULT_CHORD_MESSAGE_TTL - chordMessage.GetTTL() + 1);
+    //Remember owner of whole range for later lookups
+    ValidateLocationCache (chordMessage.GetLookupRsp().successorList);
+    m_locationCache.Insert (chordMessage.GetLookupRsp().predecessorIdentifier, resolvedNode, chordMessage.GetLookupRsp().successorList, chordTransaction->GetChordMessage().GetLookupReq().numSuccessors);
     //cancel transaction
     virtualNode->RemoveTransaction (chordTransaction->GetTransactionId());
     //notify application about lookup success
-    NotifyLookupSuccess(requestedIdentifier, resolvedNode, originator);
+    NotifyLookupSuccess(requestedIdentifier, resolvedNode, chordMessage.GetLookupRsp().successorList, originator);
   }
 }
 
+/*  Logic: Iterative lookup. Each hop which is not owner refers us to its next hop, and we ask that one in turn.
+ *
+ *  Only referral of hop we asked last is taken (duplicates of retransmissions are dropped). Hops are matched on address
+ *  as finger table routing entries carry finger identifier, not identifier of node behind it. Hops lie in [vNode, key]
+ *  and each referral must move us strictly closer to key: next hop lies in (current hop, key]. Only exception is last
+ *  referral which may overshoot to owner (successor of key), i.e. next hop lies in (key, vNode). Referrals back to vNode
+ *  or to a hop at or before current one are dropped. Owner answers with LOOKUP_RSP; a hop beyond key which still refers
+ *  is ignored, so lookup ends by timeout instead of looping around the ring. Each referral takes one off TTL of request,
+ *  lookup fails once TTL runs out.
+ */
 
 void
-ChordIpv4::ProcessStabilizeReq(ChordMessage chordMessage)
+ChordIpv4::ProcessLookupReferral (ChordMessage &chordMessage)
 {
+  NS_LOG_FUNCTION_NOARGS ();
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
-
-  //Read payload and get vnode identifier
-  Ptr<ChordIdentifier> vNodeIdentifier = chordMessage.GetStabilizeReq().successorIdentifier;
-
-  //Find VNode
+  Ptr<ChordNode> referringNode = chordMessage.GetLookupReferral().referringNode;
+  Ptr<ChordNode> nextHopNode = chordMessage.GetLookupReferral().nextHopNode;
+  //Find virtual node which sent the request
   Ptr<ChordVNode> virtualNode;
-  bool ret = FindVNode(vNodeIdentifier, virtualNode);
-  if (ret == false)
+  if (FindVNode (requestorNode->GetChordIdentifier(), virtualNode) == false)
   {
-    //VNode does not exist here, drop packet
     return;
   }
-
-  //Stabilize
-  
-  if (requestorNode->GetChordIdentifier()->IsInBetween(virtualNode->GetPredecessor()->GetChordIdentifier(), virtualNode->GetChordIdentifier()))
+  Ptr<ChordTransaction> chordTransaction;
+  if (virtualNode->FindTransaction (chordMessage.GetTransactionId(), chordTransaction) == false)
   {
-    //Reset own predecessor
-    Ptr<ChordNode> predecessorNode = Create<ChordNode> (requestorNode);
-    Ptr<ChordNode> oldPredecessorNode = virtualNode->GetPredecessor();
-    virtualNode->SetPredecessor(predecessorNode);
-    //Check if requestor can be our successor as well (bootstrap case)
-    if (virtualNode->GetSuccessor()->GetChordIdentifier()->IsEqual(virtualNode->GetChordIdentifier()))
-    {
-      //Reset Successor as well
-      Ptr<ChordNode> successorNode = Create<ChordNode> (requestorNode);
-      virtualNode->SetSuccessor(successorNode);
-      virtualNode->SetRoutable(true);
-      //Stabilize
-      DoStabilize(virtualNode);
-      DoFixFinger (virtualNode);
-    }
-    NotifyVNodeKeyOwnership (virtualNode->GetVNodeName(), virtualNode->GetChordIdentifier(), virtualNode->GetPredecessor(), oldPredecessorNode->GetChordIdentifier());
-    NS_LOG_INFO("Predecessor changed for VNode");
+    return;
   }
-  Ptr<Packet> packet = Create<Packet> ();
-  //Send Response
+  Ptr<ChordNode> currentHop = chordTransaction->GetNextHop();
+  if (currentHop == 0 || currentHop->GetIpAddress() != referringNode->GetIpAddress() || currentHop->GetPort() != referringNode->GetPort())
+  {
+    //Not iterative, or stale referral
+    return;
+  }
+  Ptr<ChordIdentifier> requestedIdentifier = chordTransaction->GetRequestedIdentifier();
+  if (!currentHop->GetChordIdentifier()->IsEqual (virtualNode->GetChordIdentifier()) && !currentHop->GetChordIdentifier()->IsInBetween (virtualNode->GetChordIdentifier(), requestedIdentifier))
+  {
+    //Hop is past requested identifier and should have been owner
+    return;
+  }
+  if (nextHopNode->GetIpAddress() == currentHop->GetIpAddress() && nextHopNode->GetPort() == currentHop->GetPort())
+  {
+    return;
+  }
+  Ptr<ChordIdentifier> nextHopIdentifier = nextHopNode->GetChordIdentifier();
+  if (!nextHopIdentifier->IsInBetween (currentHop->GetChordIdentifier(), requestedIdentifier)
+      && (nextHopIdentifier->IsEqual (virtualNode->GetChordIdentifier()) || nextHopIdentifier->IsInBetween (virtualNode->GetChordIdentifier(), requestedIdentifier)))
+  {
+    //No progress towards key
+    NS_LOG_INFO ("Dropping referral to " << nextHopNode->GetIpAddress() << ", no progress towards key");
+    return;
+  }
+  NS_LOG_INFO ("Lookup referred to " << nextHopNode->GetIpAddress());
+  //Ask next hop. Retries are kept, they bound timeouts of whole lookup. TTL counts referrals.
+  ChordMessage requestMessage = chordTransaction->GetChordMessage();
+  if (DecrementTTL (requestMessage) == false)
+  {
+    //Too many referrals, give up now instead of retrying with spent TTL
+    NotifyLookupFailure (requestedIdentifier, chordTransaction->GetOriginator());
+    virtualNode->RemoveTransaction (chordTransaction->GetTransactionId());
+    return;
+  }
+  chordTransaction->GetRequestTimeoutEvent()->Cancel();
+  chordTransaction->SetChordMessage (requestMessage);
+  chordTransaction->SetNextHop (nextHopNode);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (requestMessage);
+  SendPacket (packet, nextHopNode->GetIpAddress(), nextHopNode->GetPort());
+  Ptr<EventImpl> requestTimeout = m_timerWheel.Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, virtualNode, chordMessage.GetTransactionId());
+  chordTransaction->SetRequestTimeoutEvent (requestTimeout);
+}
+
+void
+ChordIpv4::ProcessLookupBatchReq (ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
+  uint32_t transactionId = chordMessage.GetTransactionId ();
+  std::vector<Ptr<ChordIdentifier> > &requestedIdentifiers = chordMessage.GetLookupBatchReq().requestedIdentifiers;
+  if (m_vNodeMap.GetSize() == 0)
+  {
+    //No vNode exists as yet, drop this request.
+    return;
+  }
+  //Split keys into owned (per vNode), forwarded (per next hop) and unroutable
+  std::map<Ptr<ChordVNode>, std::vector<Ptr<ChordIdentifier> > > ownedMap;
+  std::map<std::pair<uint32_t, uint16_t>, std::vector<Ptr<ChordIdentifier> > > forwardMap;
+  std::vector<Ptr<ChordIdentifier> > unroutedIdentifiers;
+  for (std::vector<Ptr<ChordIdentifier> >::iterator idIter = requestedIdentifiers.begin(); idIter != requestedIdentifiers.end(); idIter++)
+  {
+    Ptr<ChordVNode> virtualNode;
+    if (LookupLocal (*idIter, virtualNode) == true)
+    {
+      ownedMap[virtualNode].push_back (*idIter);
+    }
+    else if (FindNearestVNode ((*idIter)->GetChordKey(), virtualNode) == true)
+    {
+      Ptr<ChordNode> nextHop;
+      FindNextHop ((*idIter)->GetChordKey(), virtualNode, nextHop);
+      forwardMap[std::make_pair (nextHop->GetIpAddress().Get(), nextHop->GetPort())].push_back (*idIter);
+    }
+    else
+    {
+      unroutedIdentifiers.push_back (*idIter);
+    }
+  }
+  //Respond directly to requestor for owned keys
+  for (std::map<Ptr<ChordVNode>, std::vector<Ptr<ChordIdentifier> > >::iterator ownedIter = ownedMap.begin(); ownedIter != ownedMap.end(); ownedIter++)
+  {
+    Ptr<Packet> packet = Create<Packet> ();
+    ChordMessage chordMessageRsp = ChordMessage ();
+    ownedIter->first->PackLookupBatchRsp (requestorNode, transactionId, ownedIter->second, chordMessageRsp);
+    packet->AddHeader (chordMessageRsp);
+    if (packet->GetSize())
+    {
+      NS_LOG_INFO ("Sending LookupBatchRsp with " << ownedIter->second.size() << " keys");
+      SendPacket (packet, requestorNode->GetIpAddress(), requestorNode->GetPort());
+    }
+  }
+  //Forward remaining keys, one message per next hop
+  if (DecrementTTL (chordMessage) == false)
+  {
+    return;
+  }
+  for (std::map<std::pair<uint32_t, uint16_t>, std::vector<Ptr<ChordIdentifier> > >::iterator forwardIter = forwardMap.begin(); forwardIter != forwardMap.end(); forwardIter++)
+  {
+    Ptr<Packet> packet = Create<Packet> ();
+    requestedIdentifiers = forwardIter->second;
+    packet->AddHeader (chordMessage);
+    SendPacket (packet, Ipv4Address (forwardIter->first.first), forwardIter->first.second);
+  }
+  if (unroutedIdentifiers.size() > 0)
+  {
+    Ptr<Packet> packet = Create<Packet> ();
+    requestedIdentifiers = unroutedIdentifiers;
+    packet->AddHeader (chordMessage);
+    SendViaAnyVNode (packet);
+  }
+}
+
+void
+ChordIpv4::ProcessLookupBatchRsp (ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_INFO ("Received Batched Lookup Response");
+  Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
+  Ptr<ChordNode> resolvedNode = chordMessage.GetLookupBatchRsp().resolvedNode;
+  std::vector<Ptr<ChordIdentifier> > &resolvedIdentifiers = chordMessage.GetLookupBatchRsp().resolvedIdentifiers;
+  //Find virtual node which sent this message
+  Ptr<ChordVNode> virtualNode;
+  if (FindVNode (requestorNode->GetChordIdentifier(), virtualNode) == false)
+  {
+    return;
+  }
+  //Find Transaction
+  Ptr<ChordTransaction> chordTransaction;
+  if (virtualNode->FindTransaction (chordMessage.GetTransactionId(), chordTransaction) == false)
+  {
+    //No transaction exists, return from here
+    return;
+  }
+  //Collect slots resolved by this response
+  ChordTransaction::BatchSlotMap &batchSlots = chordTransaction->GetBatchSlots();
+  std::vector<std::pair<uint32_t, uint32_t> > resolvedSlots;
+  for (std::vector<Ptr<ChordIdentifier> >::iterator idIter = resolvedIdentifiers.begin(); idIter != resolvedIdentifiers.end(); idIter++)
+  {
+    if ((*idIter)->GetNumBytes() != ChordKey::NUM_BYTES)
+      continue;
+    std::pair<ChordTransaction::BatchSlotMap::iterator, ChordTransaction::BatchSlotMap::iterator> range = batchSlots.equal_range ((*idIter)->GetChordKey());
+    for (ChordTransaction::BatchSlotMap::iterator slotIter = range.first; slotIter != range.second; slotIter++)
+    {
+      resolvedSlots.push_back (slotIter->second);
+    }
+    batchSlots.erase (range.first, range.second);
+  }
+  if (batchSlots.empty())
+  {
+    //cancel transaction
+    virtualNode->RemoveTransaction (chordTransaction->GetTransactionId());
+  }
+  m_lookupsInFlight -= resolvedSlots.size();
+  for (std::vector<std::pair<uint32_t, uint32_t> >::iterator slotIter = resolvedSlots.begin(); slotIter != resolvedSlots.end(); slotIter++)
+  {
+    CompleteBatchLookup (slotIter->first, slotIter->second, resolvedNode);
+  }
+  //Window has room again
+  DispatchBatchLookups ();
+}
+
+void
+ChordIpv4::ProcessStabilizeReq (ChordMessage &chordMessage)
+{
+  Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
+
+  //Read payload and get vnode identifier
+  Ptr<ChordIdentifier> vNodeIdentifier = chordMessage.GetStabilizeReq().successorIdentifier;
+
+  //Find VNode
+  Ptr<ChordVNode> virtualNode;
+  bool ret = FindVNode(vNodeIdentifier, virtualNode);
+  if (ret == false)
+  {
+    //VNode does not exist here, drop packet
+    return;
+  }
+
+  //Stabilize
+  
+  if (requestorNode->GetChordIdentifier()->IsInBetween(virtualNode->GetPredecessor()->GetChordIdentifier(), virtualNode->GetChordIdentifier()))
+  {
+    //Reset own predecessor
+    Ptr<ChordNode> predecessorNode = Create<ChordNode> (requestorNode);
+    Ptr<ChordNode> oldPredecessorNode = virtualNode->GetPredecessor();
+    virtualNode->SetPredecessor(predecessorNode);
+    ResetMaintenance (virtualNode);
+    //Check if requestor can be our successor as well (bootstrap case)
+    if (virtualNode->GetSuccessor()->GetChordIdentifier()->IsEqual(virtualNode->GetChordIdentifier()))
+    {
+      //Reset Successor as well
+      Ptr<ChordNode> successorNode = Create<ChordNode> (requestorNode);
+      virtualNode->SetSuccessor(successorNode);
+      m_vNodeMap.SetRoutable (virtualNode, true);
+      //Stabilize
+      DoStabilize(virtualNode);
+      DoFixFinger (virtualNode);
+    }
+    NotifyVNodeKeyOwnership (virtualNode->GetVNodeName(), virtualNode->GetChordIdentifier(), virtualNode->GetPredecessor(), oldPredecessorNode->GetChordIdentifier());
+    NS_LOG_INFO("Predecessor changed for VNode");
+  }
+  Ptr<Packet> packet = Create<Packet> ();
+  //Send Response
   ChordMessage chordMessageRsp = ChordMessage ();
   virtualNode->PackStabilizeRsp(requestorNode, chordMessageRsp);
   packet-> AddHeader (chordMessageRsp);
@@ -927,12 +1686,15 @@ ChordIpv4::ProcessStabilizeReq(ChordMessage chordMessage)
 }
 
 void
-ChordIpv4::ProcessStabilizeRsp(ChordMessage chordMessage)
+ChordIpv4::ProcessStabilizeRsp (ChordMessage &chordMessage)
 {
   //Extract info
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
   //Read payload
   Ptr<ChordNode> predecessorNode = chordMessage.GetStabilizeRsp().predecessorNode;
+  //Cached ranges must agree with ring seen by successor
+  m_locationCache.Validate (predecessorNode);
+  ValidateLocationCache (chordMessage.GetStabilizeRsp().successorList);
 
   //Find VNode
   Ptr<ChordVNode> virtualNode;
@@ -943,13 +1705,17 @@ ChordIpv4::ProcessStabilizeRsp(ChordMessage chordMessage)
     return;
   }
 
-  //Reset Successor if needed
-  if (!virtualNode->GetChordIdentifier()->IsEqual(predecessorNode->GetChordIdentifier()))
+  //Reset Successor if needed: only a node in between us and our successor may take its place, otherwise successors
+  //pointing past each other keep restabilizing one another
+  if (!virtualNode->GetChordIdentifier()->IsEqual(predecessorNode->GetChordIdentifier()) &&
+      !virtualNode->GetSuccessor()->GetChordIdentifier()->IsEqual(predecessorNode->GetChordIdentifier()) &&
+      predecessorNode->GetChordIdentifier()->IsInBetween(virtualNode->GetChordIdentifier(), virtualNode->GetSuccessor()->GetChordIdentifier()))
   {
     //We need to reset successor and restabilize new successor
     Ptr<ChordNode> successorNode = Create<ChordNode> (predecessorNode);
     virtualNode->SetSuccessor(successorNode);
-    virtualNode->SetRoutable(true);
+    m_vNodeMap.SetRoutable (virtualNode, true);
+    ResetMaintenance (virtualNode);
     NS_LOG_INFO("Successor changed for VNode");
     //Trigger stabilization
     DoStabilize(virtualNode);
@@ -963,7 +1729,7 @@ ChordIpv4::ProcessStabilizeRsp(ChordMessage chordMessage)
 }
 
 void
-ChordIpv4::ProcessHeartbeatReq(ChordMessage chordMessage)
+ChordIpv4::ProcessHeartbeatReq (ChordMessage &chordMessage)
 {
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
 
@@ -993,7 +1759,7 @@ ChordIpv4::ProcessHeartbeatReq(ChordMessage chordMessage)
 }
 
 void
-ChordIpv4::ProcessHeartbeatRsp(ChordMessage chordMessage)
+ChordIpv4::ProcessHeartbeatRsp (ChordMessage &chordMessage)
 {
   //Extract info
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
@@ -1014,8 +1780,94 @@ ChordIpv4::ProcessHeartbeatRsp(ChordMessage chordMessage)
   virtualNode->SynchPredecessorList (chordMessage.GetHeartbeatRsp().predecessorList);
 }
 
+bool
+ChordIpv4::ProcessStabilizeReq (const ChordMessageView &messageView)
+{
+  Ptr<ChordVNode> virtualNode;
+  if (FindVNode (messageView.GetStabilizeReq().successorIdentifier, virtualNode) == false)
+  {
+    return false;
+  }
+  //Requestor is our predecessor already, predecessor changes go through ChordMessage
+  Ptr<ChordNode> predecessorNode = virtualNode->GetPredecessor();
+  if (predecessorNode == 0 || !messageView.GetRequestorNode().IsSameNode (predecessorNode))
+  {
+    return false;
+  }
+  Ptr<Packet> packet = Create<Packet> ();
+  ChordMessage chordMessageRsp = ChordMessage ();
+  virtualNode->PackStabilizeRsp(predecessorNode, chordMessageRsp);
+  packet-> AddHeader (chordMessageRsp);
+  NS_LOG_INFO ("Sending StabilizeRsp: "<<chordMessageRsp);
+  SendPacket(packet, predecessorNode->GetIpAddress(), predecessorNode->GetPort());
+  return true;
+}
+
+bool
+ChordIpv4::ProcessStabilizeRsp (const ChordMessageView &messageView)
+{
+  const ChordMessageView::StabilizeRsp &stabilizeRsp = messageView.GetStabilizeRsp();
+  Ptr<ChordVNode> virtualNode;
+  if (FindVNode (messageView.GetRequestorNode().identifier, virtualNode) == false)
+  {
+    return false;
+  }
+  //Successor still sees us as its predecessor and its successor list is unchanged, otherwise go through ChordMessage
+  if (!stabilizeRsp.predecessorNode.IsSameNode (virtualNode) || !virtualNode->IsSuccessorListSynched (stabilizeRsp.successorList))
+  {
+    return false;
+  }
+  //Cached ranges must agree with ring seen by successor
+  m_locationCache.Validate (stabilizeRsp.predecessorNode.identifier, stabilizeRsp.predecessorNode.ipAddress, stabilizeRsp.predecessorNode.port);
+  ValidateLocationCache (stabilizeRsp.successorList);
+  //Reset timestamp
+  virtualNode->GetSuccessor()->SetTimestamp(Simulator::Now());
+  return true;
+}
+
+bool
+ChordIpv4::ProcessHeartbeatReq (const ChordMessageView &messageView)
+{
+  Ptr<ChordVNode> virtualNode;
+  if (FindVNode (messageView.GetHeartbeatReq().predecessorIdentifier, virtualNode) == false)
+  {
+    return false;
+  }
+  //Requestor is our successor
+  Ptr<ChordNode> successorNode = virtualNode->GetSuccessor();
+  if (successorNode == 0 || !messageView.GetRequestorNode().IsSameNode (successorNode))
+  {
+    return false;
+  }
+  Ptr<Packet> packet = Create<Packet> ();
+  ChordMessage chordMessageRsp = ChordMessage ();
+  virtualNode->PackHeartbeatRsp(successorNode, chordMessageRsp);
+  packet-> AddHeader (chordMessageRsp);
+  NS_LOG_INFO ("Sending HeartbeatRsp: "<<chordMessageRsp);
+  SendPacket(packet, successorNode->GetIpAddress(), successorNode->GetPort());
+  return true;
+}
+
+bool
+ChordIpv4::ProcessHeartbeatRsp (const ChordMessageView &messageView)
+{
+  Ptr<ChordVNode> virtualNode;
+  if (FindVNode (messageView.GetRequestorNode().identifier, virtualNode) == false)
+  {
+    return false;
+  }
+  //Predecessor list unchanged, otherwise go through ChordMessage
+  if (virtualNode->GetPredecessor() == 0 || !virtualNode->IsPredecessorListSynched (messageView.GetHeartbeatRsp().predecessorList))
+  {
+    return false;
+  }
+  //Reset timestamp
+  virtualNode->GetPredecessor()->SetTimestamp(Simulator::Now());
+  return true;
+}
+
 void
-ChordIpv4::ProcessFingerReq (ChordMessage chordMessage)
+ChordIpv4::ProcessFingerReq (ChordMessage &chordMessage)
 {
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
   Ptr<ChordIdentifier> requestedIdentifier = chordMessage.GetFingerReq().requestedIdentifier;
@@ -1042,9 +1894,13 @@ ChordIpv4::ProcessFingerReq (ChordMessage chordMessage)
     return;
   }
   //Could not resolve finger request, forward to successor
+  if (DecrementTTL (chordMessage) == false)
+  {
+    return;
+  }
   packet->AddHeader(chordMessage);
   Ptr<ChordVNode> vNode;
-  if (FindNearestVNode (requestedIdentifier, vNode) == true)
+  if (FindNearestVNode (requestedIdentifier->GetChordKey(), vNode) == true)
   {
     SendPacket (packet, vNode->GetSuccessor()->GetIpAddress(), vNode->GetSuccessor()->GetPort());
   }
@@ -1055,7 +1911,7 @@ ChordIpv4::ProcessFingerReq (ChordMessage chordMessage)
 }
 
 void
-ChordIpv4::ProcessFingerRsp (ChordMessage chordMessage)
+ChordIpv4::ProcessFingerRsp (ChordMessage &chordMessage)
 {
   //Extract info from packet
   Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
@@ -1064,14 +1920,45 @@ ChordIpv4::ProcessFingerRsp (ChordMessage chordMessage)
   //Find virtual node which sent this message
   Ptr<ChordVNode> virtualNode;
   bool ret = FindVNode(requestorNode->GetChordIdentifier(), virtualNode);
+  ValidateLocationCache (chordMessage.GetFingerRsp().successorList);
   if (ret == true)
   { 
     //Save finger lookup in table
-    Ptr<ChordNode> finger = Create<ChordNode> (fingerNode);
-    virtualNode->GetFingerTable().UpdateNode(fingerNode); 
+    Ptr<ChordNode> finger = SelectFinger (virtualNode, requestedIdentifier, fingerNode, chordMessage.GetFingerRsp().successorList);
+    virtualNode->GetFingerTable().UpdateNode(finger); 
   }
 }
 
+void
+ChordIpv4::ProcessPingReq (ChordMessage &chordMessage)
+{
+  Ptr<ChordNode> requestorNode = chordMessage.GetRequestorNode();
+  if (m_vNodeMap.GetSize() == 0)
+  {
+    //No vNode exists as yet, drop this request.
+    return;
+  }
+  //Any vNode can answer, RTT is measured per node
+  Ptr<ChordVNode> virtualNode = DynamicCast<ChordVNode>(m_vNodeMap.GetMap().begin()->second);
+  Ptr<Packet> packet = Create<Packet> ();
+  ChordMessage chordMessageRsp = ChordMessage ();
+  virtualNode->PackPingRsp (requestorNode, chordMessage.GetPingReq().timestamp, chordMessageRsp);
+  packet->AddHeader (chordMessageRsp);
+  if (packet->GetSize())
+  {
+    SendPacket (packet, requestorNode->GetIpAddress(), requestorNode->GetPort());
+  }
+}
+
+void
+ChordIpv4::ProcessPingRsp (ChordMessage &chordMessage)
+{
+  Ptr<ChordNode> respondingNode = chordMessage.GetPingRsp().respondingNode;
+  Time rtt = Simulator::Now() - chordMessage.GetPingRsp().timestamp;
+  NS_LOG_INFO ("RTT to " << respondingNode->GetIpAddress() << ": " << rtt.GetMilliSeconds() << "ms");
+  m_rttEstimator.Measurement (respondingNode->GetIpAddress(), rtt);
+}
+
 void
 ChordIpv4::HandleRequestTimeout (Ptr<ChordVNode> vNode, uint32_t transactionId)
 {
@@ -1101,6 +1988,20 @@ ChordIpv4::HandleRequestTimeout (Ptr<ChordVNode> vNode, uint32_t transactionId)
       //cancel transaction
       vNode->RemoveTransaction (chordTransaction->GetTransactionId());
     }
+    else if (chordTransaction->GetChordMessage().GetMessageType() == ChordMessage::LOOKUP_BATCH_REQ)
+    {
+      NS_LOG_ERROR ("Batched Lookup Request failed!");
+      ChordTransaction::BatchSlotMap batchSlots;
+      batchSlots.swap (chordTransaction->GetBatchSlots());
+      //cancel transaction
+      vNode->RemoveTransaction (chordTransaction->GetTransactionId());
+      m_lookupsInFlight -= batchSlots.size();
+      for (ChordTransaction::BatchSlotMap::iterator slotIter = batchSlots.begin(); slotIter != batchSlots.end(); slotIter++)
+      {
+        CompleteBatchLookup (slotIter->second.first, slotIter->second.second, 0);
+      }
+      DispatchBatchLookups ();
+    }
     return;
   }
   else
@@ -1108,17 +2009,54 @@ ChordIpv4::HandleRequestTimeout (Ptr<ChordVNode> vNode, uint32_t transactionId)
     //Retransmit
     uint8_t retries = chordTransaction->GetRetries();
     chordTransaction->SetRetries (retries+1);
+    if (chordTransaction->GetChordMessage().GetMessageType() == ChordMessage::LOOKUP_BATCH_REQ)
+    {
+      //Only resend keys which are still unresolved
+      ChordMessage chordMessage = chordTransaction->GetChordMessage();
+      std::vector<Ptr<ChordIdentifier> > &requestedIdentifiers = chordMessage.GetLookupBatchReq().requestedIdentifiers;
+      requestedIdentifiers.clear();
+      ChordTransaction::BatchSlotMap &batchSlots = chordTransaction->GetBatchSlots();
+      for (ChordTransaction::BatchSlotMap::iterator slotIter = batchSlots.begin(); slotIter != batchSlots.end(); slotIter = batchSlots.upper_bound (slotIter->first))
+      {
+        requestedIdentifiers.push_back (Create<ChordIdentifier> (slotIter->first));
+      }
+      chordTransaction->SetChordMessage (chordMessage);
+    }
+    else if (chordTransaction->GetChordMessage().GetMessageType() == ChordMessage::LOOKUP_REQ && (chordTransaction->GetNextHop() != 0 || m_iterativeLookupFallback))
+    {
+      //Recursive lookup got lost on the way, or hop of iterative lookup did not answer: walk the hops ourselves, starting over from own table
+      ChordMessage chordMessage = chordTransaction->GetChordMessage();
+      chordMessage.GetLookupReq().lookupMode = ChordMessage::ITERATIVE_LOOKUP;
+      chordTransaction->SetChordMessage (chordMessage);
+      Ptr<ChordNode> nextHop;
+      FindNextHop (chordMessage.GetLookupReq().requestedIdentifier->GetChordKey(), vNode, nextHop);
+      Ptr<ChordNode> silentHop = chordTransaction->GetNextHop();
+      if (silentHop != 0 && nextHop->GetIpAddress() == silentHop->GetIpAddress() && nextHop->GetPort() == silentHop->GetPort())
+      {
+        //Our finger is the silent hop, go via successor
+        nextHop = vNode->GetSuccessor();
+      }
+      chordTransaction->SetNextHop (nextHop);
+    }
     Ptr<Packet> packet = Create<Packet> ();
     packet->AddHeader (chordTransaction->GetChordMessage());
     if (packet->GetSize())
     {
       NS_LOG_INFO ("Retransmission Req\n" << chordTransaction->GetChordMessage());
-      SendPacket (packet, m_bootStrapIp, m_bootStrapPort);
+      if (chordTransaction->GetNextHop() != 0)
+      {
+        //Iterative lookup
+        SendPacket (packet, chordTransaction->GetNextHop()->GetIpAddress(), chordTransaction->GetNextHop()->GetPort());
+      }
+      else
+      {
+        SendPacket (packet, m_bootStrapIp, m_bootStrapPort);
+      }
     }
     //Reschedule
     //Start transaction timer
-    EventId requestTimeoutId = Simulator::Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, vNode, transactionId);
-    chordTransaction -> SetRequestTimeoutEventId (requestTimeoutId);
+    Ptr<EventImpl> requestTimeout = m_timerWheel.Schedule (chordTransaction->GetRequestTimeout(), &ChordIpv4::HandleRequestTimeout, this, vNode, transactionId);
+    chordTransaction -> SetRequestTimeoutEvent (requestTimeout);
   }
 }
 
@@ -1140,18 +2078,94 @@ ChordIpv4::FindVNode (Ptr<ChordIdentifier> chordIdentifier, Ptr<ChordVNode>& vir
   return true;
 }
 
+bool
+ChordIpv4::FindVNode (const ChordKey &key, Ptr<ChordVNode>& virtualNode)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::map<ChordKey, Ptr<ChordVNode> >::iterator iterator = m_vNodeKeyMap.find (key);
+  if (iterator == m_vNodeKeyMap.end())
+  {
+    return false;
+  }
+  virtualNode = iterator->second;
+  return true;
+}
+
+/*  Logic: Batched lookups in flight are held by transactions of originating vNode. When vNode is deleted, its batched lookups fail
+ *  at once and their window slots are returned, rest of queued keys then go out via remaining vNodes.
+ */
 void
-ChordIpv4::DeleteVNode (Ptr<ChordIdentifier> chordIdentifier)
+ChordIpv4::ReleaseBatchLookups (Ptr<ChordVNode> vNode)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  std::vector<Ptr<ChordTransaction> > transactions;
+  vNode->GetTransactions (transactions);
+  std::vector<std::pair<uint32_t, uint32_t> > releasedSlots;
+  for (std::vector<Ptr<ChordTransaction> >::iterator iter = transactions.begin(); iter != transactions.end(); iter++)
+  {
+    if ((*iter)->GetChordMessage().GetMessageType() != ChordMessage::LOOKUP_BATCH_REQ)
+    {
+      continue;
+    }
+    ChordTransaction::BatchSlotMap &batchSlots = (*iter)->GetBatchSlots();
+    for (ChordTransaction::BatchSlotMap::iterator slotIter = batchSlots.begin(); slotIter != batchSlots.end(); slotIter++)
+    {
+      releasedSlots.push_back (slotIter->second);
+    }
+    batchSlots.clear();
+    vNode->RemoveTransaction ((*iter)->GetTransactionId());
+  }
+  if (releasedSlots.empty())
+  {
+    return;
+  }
+  m_lookupsInFlight -= releasedSlots.size();
+  for (std::vector<std::pair<uint32_t, uint32_t> >::iterator slotIter = releasedSlots.begin(); slotIter != releasedSlots.end(); slotIter++)
+  {
+    CompleteBatchLookup (slotIter->first, slotIter->second, 0);
+  }
+  DispatchBatchLookups ();
+}
 
+void
+ChordIpv4::DeleteVNode (Ptr<ChordIdentifier> chordIdentifier)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<ChordVNode> vNode;
+  if (FindVNode (chordIdentifier, vNode) == true)
+  {
+    //Drop references to shared fingers
+    vNode->GetFingerTable().SetRoutingTable (0);
+  }
+  if (chordIdentifier->GetNumBytes() == ChordKey::NUM_BYTES)
+  {
+    m_vNodeKeyMap.erase (chordIdentifier->GetChordKey());
+  }
   m_vNodeMap.RemoveNode(chordIdentifier);
+  if (vNode != 0)
+  {
+    ReleaseBatchLookups (vNode);
+  }
 }
 
 void
 ChordIpv4::DeleteVNode (std::string vNodeName)
 {
+  Ptr<ChordVNode> vNode;
+  if (FindVNode (vNodeName, vNode) == true)
+  {
+    //Drop references to shared fingers
+    vNode->GetFingerTable().SetRoutingTable (0);
+    if (vNode->GetChordIdentifier()->GetNumBytes() == ChordKey::NUM_BYTES)
+    {
+      m_vNodeKeyMap.erase (vNode->GetChordIdentifier()->GetChordKey());
+    }
+  }
   m_vNodeMap.RemoveNode(vNodeName);
+  if (vNode != 0)
+  {
+    ReleaseBatchLookups (vNode);
+  }
 }
 
 
@@ -1183,6 +2197,31 @@ ChordIpv4::LookupLocal (Ptr<ChordIdentifier> chordIdentifier, Ptr<ChordVNode>& v
   return false;
 }
 
+bool
+ChordIpv4::LookupLocal (const ChordKey &key, Ptr<ChordVNode>& virtualNode)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  //Same as above over vNodes held by ChordKey
+  for (std::map<ChordKey, Ptr<ChordVNode> >::iterator vNodeIter = m_vNodeKeyMap.begin(); vNodeIter != m_vNodeKeyMap.end(); vNodeIter++)
+  {
+    Ptr<ChordVNode> vNode = vNodeIter->second;
+    Ptr<ChordNode> predecessorNode = vNode->GetPredecessor();
+    if (predecessorNode == 0 || predecessorNode->GetChordIdentifier()->GetNumBytes() != ChordKey::NUM_BYTES)
+      continue;
+    ChordKey predecessorKey = predecessorNode->GetChordIdentifier()->GetChordKey();
+    if (key.IsInBetween (predecessorKey, vNodeIter->first))
+    {
+      if (predecessorKey == vNodeIter->first && !predecessorNode->GetChordIdentifier()->IsEqual(vNode->GetSuccessor()->GetChordIdentifier()))
+      {
+        return false;
+      }
+      virtualNode = vNode;
+      return true;
+    }
+  }
+  return false;
+}
+
 bool
 ChordIpv4::CheckOwnership (uint8_t* lookupKey, uint8_t lookupKeyBytes)
 {
@@ -1196,24 +2235,160 @@ ChordIpv4::CheckOwnership (uint8_t* lookupKey, uint8_t lookupKeyBytes)
   return false;
 }
 
+bool
+ChordIpv4::CheckOwnership (const ChordKey &lookupKey)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<ChordIdentifier> lookupIdentifier = Create<ChordIdentifier> (lookupKey);
+  Ptr<ChordVNode> chordVNode;
+  return LookupLocal (lookupIdentifier, chordVNode);
+}
+
+bool
+ChordIpv4::CheckReplicaOwnership (uint8_t* lookupKey, uint8_t lookupKeyBytes, uint8_t replicationFactor)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<ChordIdentifier> lookupIdentifier = Create<ChordIdentifier> (lookupKey, lookupKeyBytes);
+  Ptr<ChordVNode> chordVNode;
+  if (LookupLocal (lookupIdentifier, chordVNode) == true)
+  {
+    return true;
+  }
+  //Copy belongs here if key lies between replicationFactor-th predecessor and first joined vNode at or after key. A vNode farther
+  //on covers key only if this one does.
+  ChordKey key = lookupIdentifier->GetChordKey();
+  std::map<ChordKey, Ptr<ChordVNode> >::iterator vNodeIter = m_vNodeKeyMap.lower_bound (key);
+  for (uint32_t i = 0; i < m_vNodeKeyMap.size(); i++, vNodeIter++)
+  {
+    if (vNodeIter == m_vNodeKeyMap.end())
+    {
+      vNodeIter = m_vNodeKeyMap.begin();
+    }
+    Ptr<ChordVNode> vNode = vNodeIter->second;
+    if (vNode->GetPredecessor() == 0)
+      continue;
+    //Predecessors beyond list are unknown, replicas are kept up to list size
+    uint8_t coveredPredecessors = std::min (replicationFactor, m_maxVNodePredecessorListSize);
+    if (coveredPredecessors == 0)
+    {
+      return false;
+    }
+    std::vector<Ptr<ChordNode> > &predecessorList = vNode->GetPredecessorList();
+    if (predecessorList.size() < coveredPredecessors)
+    {
+      //Ring smaller than replica group or list not filled yet, keep copy
+      return true;
+    }
+    return key.IsInBetween (predecessorList[coveredPredecessors - 1]->GetChordIdentifier()->GetChordKey(), vNodeIter->first);
+  }
+  return false;
+}
+
+bool
+ChordIpv4::GetDHashReplicas (uint8_t* lookupKey, uint8_t lookupKeyBytes, std::vector<InetSocketAddress> &replicas)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<ChordIdentifier> lookupIdentifier = Create<ChordIdentifier> (lookupKey, lookupKeyBytes);
+  Ptr<ChordVNode> chordVNode;
+  if (LookupLocal (lookupIdentifier, chordVNode) == false)
+  {
+    return false;
+  }
+  GetReplicaAddresses (chordVNode, chordVNode->GetSuccessorList(), replicas);
+  return true;
+}
+
+bool
+ChordIpv4::GetDHashOwnedRange (uint8_t* lookupKey, uint8_t lookupKeyBytes, Ptr<ChordIdentifier> &vNodeIdentifier, Ipv4Address &successorIp, uint16_t &successorPort)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  //Owning vNode holds keys up to its identifier, keys after it belong to its successor
+  Ptr<ChordIdentifier> lookupIdentifier = Create<ChordIdentifier> (lookupKey, lookupKeyBytes);
+  Ptr<ChordVNode> chordVNode;
+  if (LookupLocal (lookupIdentifier, chordVNode) == false)
+  {
+    return false;
+  }
+  vNodeIdentifier = chordVNode->GetChordIdentifier();
+  successorIp = chordVNode->GetSuccessor()->GetIpAddress();
+  successorPort = chordVNode->GetSuccessor()->GetDHashPort();
+  return true;
+}
+
 void
 ChordIpv4::SendPacket (Ptr<Packet> packet, Ipv4Address destinationIp, uint16_t destinationPort)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (m_coalescingDepth > 0)
+  {
+    //Append to packet already bound to same node
+    for (std::vector<CoalescedPacket>::iterator iter = m_coalescedPackets.begin(); iter != m_coalescedPackets.end(); iter++)
+    {
+      if (iter->destinationIp != destinationIp || iter->destinationPort != destinationPort)
+      {
+        continue;
+      }
+      if (iter->packet->GetSize() + packet->GetSize() <= m_maxCoalescedPacketSize)
+      {
+        iter->packet->AddAtEnd (packet);
+        return;
+      }
+      //Full, start next one and send it (local delivery may coalesce again and move entries)
+      Ptr<Packet> fullPacket = iter->packet;
+      iter->packet = packet->Copy();
+      m_txTrace (fullPacket);
+      m_socket->SendTo (fullPacket, 0, InetSocketAddress (destinationIp, destinationPort));
+      return;
+    }
+    CoalescedPacket coalescedPacket;
+    coalescedPacket.destinationIp = destinationIp;
+    coalescedPacket.destinationPort = destinationPort;
+    //Callers may send same packet to several nodes
+    coalescedPacket.packet = packet->Copy();
+    m_coalescedPackets.push_back (coalescedPacket);
+    return;
+  }
+  m_txTrace (packet);
   m_socket->SendTo (packet, 0, InetSocketAddress (destinationIp, destinationPort));
 }
 
+void
+ChordIpv4::StartCoalescing ()
+{
+  if (m_coalesceMessages)
+  {
+    m_coalescingDepth++;
+  }
+}
+
+void
+ChordIpv4::FlushCoalescedPackets ()
+{
+  if (m_coalescingDepth == 0 || --m_coalescingDepth > 0)
+  {
+    return;
+  }
+  //Sending may deliver locally and coalesce again
+  std::vector<CoalescedPacket> coalescedPackets;
+  coalescedPackets.swap (m_coalescedPackets);
+  for (std::vector<CoalescedPacket>::iterator iter = coalescedPackets.begin(); iter != coalescedPackets.end(); iter++)
+  {
+    m_txTrace (iter->packet);
+    m_socket->SendTo (iter->packet, 0, InetSocketAddress (iter->destinationIp, iter->destinationPort));
+  }
+}
+
 /*  Logic: We need to send packet via virtual node whose key is nearest to the requested key. Our aim is to minimize lookup hops.
  *
  *  Step 1: Iterate for all virtual nodes and maximize identifier for v-nodes which satisfies: vnode lies inBetween (0,key] <closestVNodeOnRight>
  *  Step 2: If none found in step 1, send to v-node with highest key number <closestVNodeOnLeft>
  */
 bool
-ChordIpv4::FindNearestVNode (Ptr<ChordIdentifier> targetIdentifier, Ptr<ChordVNode> &virtualNode)
+ChordIpv4::FindNearestVNode (const ChordKey &targetKey, Ptr<ChordVNode> &virtualNode)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Ptr<ChordNode> chordNode; 
-  if (m_vNodeMap.FindNearestNode(targetIdentifier, chordNode) != true)
+  if (m_vNodeMap.FindNearestNode(targetKey, chordNode) != true)
   {
     return false;
   }
@@ -1241,15 +2416,29 @@ ChordIpv4::SendViaAnyVNode (Ptr<Packet> packet)
 }
 
 bool
-ChordIpv4::RoutePacket (Ptr<ChordIdentifier> targetIdentifier, Ptr<Packet> packet)
+ChordIpv4::DecrementTTL (ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  //Request loops (e.g. among vNodes of this node during churn) are cut once TTL runs out
+  if (chordMessage.GetTTL() <= 1)
+  {
+    NS_LOG_INFO ("TTL expired, dropping request: " << chordMessage);
+    return false;
+  }
+  chordMessage.SetTTL (chordMessage.GetTTL() - 1);
+  return true;
+}
+
+bool
+ChordIpv4::RoutePacket (const ChordKey &targetKey, Ptr<Packet> packet)
 {
   if (packet->GetSize())
   {
     Ptr<ChordVNode> vNode;
     //Choose best vNode
-    if (FindNearestVNode (targetIdentifier, vNode) == true)
+    if (FindNearestVNode (targetKey, vNode) == true)
     {
-      if (RouteViaFinger (targetIdentifier, vNode, packet) == true)
+      if (RouteViaFinger (targetKey, vNode, packet) == true)
         return true;
     }
     else
@@ -1261,41 +2450,65 @@ ChordIpv4::RoutePacket (Ptr<ChordIdentifier> targetIdentifier, Ptr<Packet> packe
 }
 
 bool
-ChordIpv4::RouteViaFinger (Ptr<ChordIdentifier> targetIdentifier, Ptr<ChordVNode> vNode, Ptr<Packet> packet)
+ChordIpv4::RouteViaFinger (const ChordKey &targetKey, Ptr<ChordVNode> vNode, Ptr<Packet> packet)
 {
   if (packet->GetSize())
   {
     Ptr<ChordNode> remoteNode;
-    //Choose nearest finger
-    if (vNode->GetFingerTable().FindNearestNode(targetIdentifier, remoteNode) == true)
-    {
-      SendPacket (packet, remoteNode->GetIpAddress(), remoteNode->GetPort());
-      return true;
-    }
-    else
-    {
-      //Send to successor
-      SendPacket (packet, vNode->GetSuccessor()->GetIpAddress(), vNode->GetSuccessor()->GetPort());
-      return true;
-    }
+    FindNextHop (targetKey, vNode, remoteNode);
+    SendPacket (packet, remoteNode->GetIpAddress(), remoteNode->GetPort());
+    return true;
   }
   return false;
 }
 
+void
+ChordIpv4::FindNextHop (const ChordKey &targetKey, Ptr<ChordVNode> vNode, Ptr<ChordNode> &nextHop)
+{
+  //Choose nearest finger preceding target, among fingers of all vNodes (SharedFingerRouting) or of this vNode
+  bool found = m_sharedFingerRouting ? m_routingTable.FindNearestNode(targetKey, nextHop) : vNode->GetFingerTable().FindNearestNode(targetKey, nextHop);
+  if (found == false || !nextHop->GetChordIdentifier()->GetChordKey().IsInBetween(vNode->GetChordIdentifier()->GetChordKey(), targetKey))
+  {
+    //None, or nearest one wrapped around past us: target lies in (vNode, successor], send to successor
+    nextHop = vNode->GetSuccessor();
+  }
+}
+
 
 
+/*  Logic: Adaptive maintenance (AdaptiveMaintenance). Each vNode keeps its own stabilize, heartbeat and fix finger rounds; periodic
+ *  timers only run vNodes whose round is due and then sleep until next due round.
+ *
+ *  Step 1: Stabilize round in which successor answered previous round, and both successor and predecessor have answered since
+ *          last reset, backs vNode off: all three intervals double, up to 2^MaxMaintenanceBackoff times configured intervals.
+ *  Step 2: Missed answer (of stabilize or heartbeat), successor/predecessor failure, successor change, new predecessor (join)
+ *          or leave resets vNode to configured intervals (ResetMaintenance). Keep alive count of successor and predecessor
+ *          restarts at configured interval, so detection of a failure hidden by backoff is not cut short. A silent neighbor
+ *          thus keeps vNode at configured intervals until it is declared failed.
+ *  Step 3: Failure is declared after MaxMissedKeepAlives current intervals, as with fixed intervals.
+ */
+
 void
 ChordIpv4::DoPeriodicStabilize()
 {
+  //One packet per remote node for all v-nodes
+  StartCoalescing ();
   //Loop for all v-nodes
   for(ChordNodeMap::iterator vNodeIter = m_vNodeMap.GetMap().begin(); vNodeIter != m_vNodeMap.GetMap().end(); vNodeIter++)
   {
     Ptr<ChordVNode> vNode = DynamicCast<ChordVNode>((*vNodeIter).second);
+    if (m_adaptiveMaintenance && vNode->GetMaintenance().nextStabilize > Simulator::Now())
+    {
+      //Not due yet
+      continue;
+    }
+    Time stabilizeInterval = GetMaintenanceInterval (vNode, m_stabilizeInterval);
     //Check if successor is alive. Shift successor if necessary. If all else fails, send CHORD_FAILURE to user and remove vNode
     //Compare timestamp and check if current successor has died
-    if (vNode->GetSuccessor()->GetTimestamp().GetMilliSeconds() + m_stabilizeInterval.GetMilliSeconds() * m_maxMissedKeepAlives < Simulator::Now().GetMilliSeconds ())
+    if (vNode->GetSuccessor()->GetTimestamp().GetMilliSeconds() + stabilizeInterval.GetMilliSeconds() * m_maxMissedKeepAlives < Simulator::Now().GetMilliSeconds ())
     {
       //Successor has failed
+      m_locationCache.InvalidateNode (vNode->GetSuccessor()->GetIpAddress(), vNode->GetSuccessor()->GetPort());
       //Shift vNode successor
       if (vNode->ShiftSuccessor() == false)
       {
@@ -1304,7 +2517,8 @@ ChordIpv4::DoPeriodicStabilize()
         {
           //Reset successor as self
           vNode -> SetSuccessor (Create<ChordNode> (vNode));
-          vNode -> SetRoutable (false);
+          m_vNodeMap.SetRoutable (vNode, false);
+          ResetMaintenance (vNode);
 
           continue;
         }
@@ -1318,27 +2532,54 @@ ChordIpv4::DoPeriodicStabilize()
         else
           continue;
       }
+      ResetMaintenance (vNode);
+    }
+    else if (m_adaptiveMaintenance)
+    {
+      Time lastReset = vNode->GetMaintenance().lastReset;
+      if (vNode->GetSuccessor()->GetTimestamp().GetMilliSeconds() + stabilizeInterval.GetMilliSeconds() < Simulator::Now().GetMilliSeconds ())
+      {
+        //Successor missed last round
+        ResetMaintenance (vNode);
+      }
+      else if (vNode->GetSuccessor()->GetTimestamp() > lastReset && vNode->GetPredecessor()->GetTimestamp() > lastReset)
+      {
+        //Both neighbors answered since last reset
+        BackOffMaintenance (vNode);
+      }
     }
     //Fire stablize req
     DoStabilize (vNode);
+    vNode->GetMaintenance().nextStabilize = Simulator::Now() + GetMaintenanceInterval (vNode, m_stabilizeInterval);
   }
+  FlushCoalescedPackets ();
   //RescheduleTimer
-  m_stabilizeTimer.Schedule (m_stabilizeInterval);
+  ScheduleMaintenance (m_stabilizeTimer, GetNextMaintenanceDelay (&ChordVNode::MaintenanceState::nextStabilize, m_stabilizeInterval));
 
 }
 
 void
 ChordIpv4::DoPeriodicHeartbeat()
 {
+  //One packet per remote node for all v-nodes
+  StartCoalescing ();
   //Loop for all v-nodes
   for(ChordNodeMap::iterator vNodeIter = m_vNodeMap.GetMap().begin(); vNodeIter != m_vNodeMap.GetMap().end(); vNodeIter++)
   {
     Ptr<ChordVNode> vNode = DynamicCast<ChordVNode>((*vNodeIter).second);
+    if (m_adaptiveMaintenance && vNode->GetMaintenance().nextHeartbeat > Simulator::Now())
+    {
+      //Not due yet
+      continue;
+    }
+    Time heartbeatInterval = GetMaintenanceInterval (vNode, m_heartbeatInterval);
 
-    if (vNode->GetPredecessor()->GetTimestamp().GetMilliSeconds() + m_heartbeatInterval.GetMilliSeconds() * m_maxMissedKeepAlives < Simulator::Now().GetMilliSeconds ())
+    if (vNode->GetPredecessor()->GetTimestamp().GetMilliSeconds() + heartbeatInterval.GetMilliSeconds() * m_maxMissedKeepAlives < Simulator::Now().GetMilliSeconds ())
     {
       Ptr<ChordNode> oldPredecessorNode = vNode->GetPredecessor();
+      ResetMaintenance (vNode);
       //Predecessor has failed
+      m_locationCache.InvalidateNode (oldPredecessorNode->GetIpAddress(), oldPredecessorNode->GetPort());
       //Shift vNode predecessor
       if (vNode->ShiftPredecessor() == false)
       {
@@ -1352,11 +2593,18 @@ ChordIpv4::DoPeriodicHeartbeat()
         NotifyVNodeKeyOwnership (vNode->GetVNodeName(), vNode->GetChordIdentifier(), vNode->GetPredecessor(), oldPredecessorNode->GetChordIdentifier());
       }
     }
+    else if (m_adaptiveMaintenance && vNode->GetPredecessor()->GetTimestamp().GetMilliSeconds() + heartbeatInterval.GetMilliSeconds() < Simulator::Now().GetMilliSeconds ())
+    {
+      //Predecessor missed last round
+      ResetMaintenance (vNode);
+    }
     //Fire stablize req
     DoHeartbeat (vNode);
+    vNode->GetMaintenance().nextHeartbeat = Simulator::Now() + GetMaintenanceInterval (vNode, m_heartbeatInterval);
   }
+  FlushCoalescedPackets ();
   //RescheduleTimer
-  m_heartbeatTimer.Schedule (m_heartbeatInterval);
+  ScheduleMaintenance (m_heartbeatTimer, GetNextMaintenanceDelay (&ChordVNode::MaintenanceState::nextHeartbeat, m_heartbeatInterval));
 
 }
 
@@ -1364,11 +2612,36 @@ ChordIpv4::DoPeriodicHeartbeat()
 void
 ChordIpv4::DoPeriodicFixFinger ()
 {
+  //Forget RTT of nodes no longer probed
+  m_rttEstimator.Audit (MilliSeconds (GetMaxMaintenanceInterval (m_fixFingerInterval).GetMilliSeconds() * m_maxMissedKeepAlives));
+  //One packet per remote node for all v-nodes
+  StartCoalescing ();
+  if (m_adaptiveMaintenance)
+  {
+    Ptr<NormalRandomVariable> interval = CreateObject<NormalRandomVariable> ();
+    interval->SetAttribute ("Variance", DoubleValue(100.0));
+    for(ChordNodeMap::iterator vNodeIter = m_vNodeMap.GetMap().begin(); vNodeIter != m_vNodeMap.GetMap().end(); vNodeIter++)
+    {
+      Ptr<ChordVNode> vNode = DynamicCast<ChordVNode>((*vNodeIter).second);
+      if (vNode->GetMaintenance().nextFixFinger > Simulator::Now())
+      {
+        //Not due yet
+        continue;
+      }
+      DoFixFinger (vNode);
+      interval->SetAttribute ("Mean", DoubleValue(GetMaintenanceInterval (vNode, m_fixFingerInterval).GetMilliSeconds()));
+      vNode->GetMaintenance().nextFixFinger = Simulator::Now() + MilliSeconds(interval->GetInteger());
+    }
+    FlushCoalescedPackets ();
+    ScheduleMaintenance (m_fixFingerTimer, GetNextMaintenanceDelay (&ChordVNode::MaintenanceState::nextFixFinger, m_fixFingerInterval));
+    return;
+  }
   for(ChordNodeMap::iterator vNodeIter = m_vNodeMap.GetMap().begin(); vNodeIter != m_vNodeMap.GetMap().end(); vNodeIter++)
   {
     Ptr<ChordVNode> vNode = DynamicCast<ChordVNode>((*vNodeIter).second);
     DoFixFinger (vNode);
   }
+  FlushCoalescedPackets ();
   //RescheduleTimer
   //Use random variable and introduce variance of 100ms
 
@@ -1378,6 +2651,93 @@ ChordIpv4::DoPeriodicFixFinger ()
   m_fixFingerTimer.Schedule (MilliSeconds(interval->GetInteger()));
 }
 
+Time
+ChordIpv4::GetMaintenanceInterval (Ptr<ChordVNode> vNode, Time interval)
+{
+  if (m_adaptiveMaintenance == false)
+  {
+    return interval;
+  }
+  return MilliSeconds (interval.GetMilliSeconds() << vNode->GetMaintenance().backoff);
+}
+
+void
+ChordIpv4::BackOffMaintenance (Ptr<ChordVNode> vNode)
+{
+  ChordVNode::MaintenanceState &maintenance = vNode->GetMaintenance();
+  if (maintenance.backoff >= m_maxMaintenanceBackoff)
+  {
+    return;
+  }
+  maintenance.backoff++;
+  m_maintenanceIntervalTrace (vNode->GetVNodeName(), GetMaintenanceInterval (vNode, m_stabilizeInterval));
+}
+
+void
+ChordIpv4::ResetMaintenance (Ptr<ChordVNode> vNode)
+{
+  if (m_adaptiveMaintenance == false)
+  {
+    return;
+  }
+  ChordVNode::MaintenanceState &maintenance = vNode->GetMaintenance();
+  maintenance.lastReset = Simulator::Now();
+  if (maintenance.backoff > 0)
+  {
+    maintenance.backoff = 0;
+    //Restart keep alive count at configured intervals
+    vNode->GetSuccessor()->SetTimestamp (Simulator::Now());
+    vNode->GetPredecessor()->SetTimestamp (Simulator::Now());
+    m_maintenanceIntervalTrace (vNode->GetVNodeName(), m_stabilizeInterval);
+  }
+  //Pull next rounds in
+  Time now = Simulator::Now();
+  maintenance.nextStabilize = std::min (maintenance.nextStabilize, now + m_stabilizeInterval);
+  maintenance.nextHeartbeat = std::min (maintenance.nextHeartbeat, now + m_heartbeatInterval);
+  maintenance.nextFixFinger = std::min (maintenance.nextFixFinger, now + m_fixFingerInterval);
+  ScheduleMaintenance (m_stabilizeTimer, std::max (maintenance.nextStabilize - now, Seconds (0)));
+  ScheduleMaintenance (m_heartbeatTimer, std::max (maintenance.nextHeartbeat - now, Seconds (0)));
+  ScheduleMaintenance (m_fixFingerTimer, std::max (maintenance.nextFixFinger - now, Seconds (0)));
+}
+
+void
+ChordIpv4::ScheduleMaintenance (Timer &timer, Time delay)
+{
+  if (timer.IsRunning() && timer.GetDelayLeft() <= delay)
+  {
+    return;
+  }
+  timer.Cancel();
+  timer.Schedule (delay);
+}
+
+Time
+ChordIpv4::GetMaxMaintenanceInterval (Time interval)
+{
+  if (m_adaptiveMaintenance == false)
+  {
+    return interval;
+  }
+  return MilliSeconds (interval.GetMilliSeconds() << m_maxMaintenanceBackoff);
+}
+
+Time
+ChordIpv4::GetNextMaintenanceDelay (Time ChordVNode::MaintenanceState::*nextRound, Time interval)
+{
+  if (m_adaptiveMaintenance == false || m_vNodeMap.GetSize() == 0)
+  {
+    return interval;
+  }
+  //Sleep until earliest due round
+  Time next = Simulator::Now() + GetMaxMaintenanceInterval (interval);
+  for(ChordNodeMap::iterator vNodeIter = m_vNodeMap.GetMap().begin(); vNodeIter != m_vNodeMap.GetMap().end(); vNodeIter++)
+  {
+    Ptr<ChordVNode> vNode = DynamicCast<ChordVNode>((*vNodeIter).second);
+    next = std::min (next, vNode->GetMaintenance().*nextRound);
+  }
+  return std::max (next - Simulator::Now(), interval);
+}
+
 void
 ChordIpv4::DoFixFinger (Ptr<ChordVNode> virtualNode)
 {
@@ -1387,7 +2747,7 @@ ChordIpv4::DoFixFinger (Ptr<ChordVNode> virtualNode)
     return;
   }
   //Remove stale entries from finger table; Remove even if finger request failed in last try. TODO: Use transactions for finger requests??
-  virtualNode->GetFingerTable().Audit (m_fixFingerInterval);
+  virtualNode->GetFingerTable().Audit (GetMaintenanceInterval (virtualNode, m_fixFingerInterval));
 
   virtualNode->GetStats().fingersLookedUp = 0;
 
@@ -1408,6 +2768,8 @@ ChordIpv4::DoFixFinger (Ptr<ChordVNode> virtualNode)
       virtualNode->GetFingerTable().UpdateNode(fingerNode); 
       continue;
     }
+    //Entry made while finger was between this node and a former successor routes past the finger now; drop it (backed off rounds would keep it for long)
+    virtualNode->GetFingerTable().RemoveNode(fingerIdentifier);
     Ptr<Packet> packet = Create<Packet> ();
     ChordMessage chordMessage = ChordMessage ();
     virtualNode->PackFingerReq(fingerIdentifier, chordMessage); 
@@ -1423,6 +2785,95 @@ ChordIpv4::DoFixFinger (Ptr<ChordVNode> virtualNode)
   }
 }
 
+/*  Logic: Any node in finger interval [fingerIdentifier, nextFingerIdentifier) can serve as finger without adding lookup hops
+ *  (Proximity Neighbor Selection). Our aim is to minimize latency of each hop.
+ *
+ *  Step 1: Candidates are resolved finger node and its successors which still lie in finger interval (successor list is ordered).
+ *  Step 2: Choose candidate with lowest measured RTT. Resolved node is kept until some candidate has been measured.
+ *  Step 3: Probe candidates not measured recently, so that next fix finger round can use them.
+ */
+Ptr<ChordNode>
+ChordIpv4::SelectFinger (Ptr<ChordVNode> virtualNode, Ptr<ChordIdentifier> fingerIdentifier, Ptr<ChordNode> fingerNode, std::vector<Ptr<ChordNode> > &successorList)
+{
+  if (m_proximityNeighborSelection == false)
+  {
+    return fingerNode;
+  }
+  //Interval ends at next finger identifier, last finger interval ends at this node
+  Ptr<ChordIdentifier> intervalEnd = virtualNode->GetChordIdentifier();
+  std::vector<Ptr<ChordIdentifier> > &fingerIdentifierList = virtualNode->GetFingerIdentifierList();
+  for (std::vector<Ptr<ChordIdentifier> >::iterator fingerIter = fingerIdentifierList.begin(); fingerIter != fingerIdentifierList.end(); fingerIter++)
+  {
+    if ((*fingerIter)->IsEqual(fingerIdentifier))
+    {
+      if (fingerIter + 1 != fingerIdentifierList.end())
+      {
+        intervalEnd = *(fingerIter + 1);
+      }
+      break;
+    }
+  }
+  Ptr<ChordIdentifier> fingerNodeIdentifier = fingerNode->GetChordIdentifier();
+  if (!fingerNodeIdentifier->IsEqual(fingerIdentifier) && (!fingerNodeIdentifier->IsInBetween(fingerIdentifier, intervalEnd) || fingerNodeIdentifier->IsEqual(intervalEnd)))
+  {
+    //Empty interval, resolved node is already past it
+    return fingerNode;
+  }
+  Ptr<ChordVNode> vNode;
+  if (FindVNode (fingerNodeIdentifier, vNode) == true)
+  {
+    //Own vNode
+    return fingerNode;
+  }
+
+  Ptr<ChordNode> bestNode = fingerNode;
+  Time bestRtt;
+  bool measured = m_rttEstimator.GetEstimatedRtt (fingerNode->GetIpAddress(), bestRtt);
+  DoPing (virtualNode, fingerNode);
+  for (std::vector<Ptr<ChordNode> >::iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    Ptr<ChordNode> candidate = *nodeIter;
+    Ptr<ChordIdentifier> candidateIdentifier = candidate->GetChordIdentifier();
+    if (!candidateIdentifier->IsInBetween(fingerNodeIdentifier, intervalEnd) || candidateIdentifier->IsEqual(intervalEnd))
+    {
+      break;
+    }
+    //Do not route via own vNodes
+    if (FindVNode (candidateIdentifier, vNode) == true)
+    {
+      continue;
+    }
+    DoPing (virtualNode, candidate);
+    Time rtt;
+    if (m_rttEstimator.GetEstimatedRtt (candidate->GetIpAddress(), rtt) == true && (measured == false || rtt < bestRtt))
+    {
+      bestNode = candidate;
+      bestRtt = rtt;
+      measured = true;
+    }
+  }
+  return bestNode;
+}
+
+void
+ChordIpv4::DoPing (Ptr<ChordVNode> virtualNode, Ptr<ChordNode> remoteNode)
+{
+  //At most one probe per node per fix finger round
+  if (m_rttEstimator.StartProbe (remoteNode->GetIpAddress(), MilliSeconds (m_fixFingerInterval.GetMilliSeconds() / 2)) == false)
+  {
+    return;
+  }
+  Ptr<Packet> packet = Create<Packet> ();
+  ChordMessage chordMessage = ChordMessage ();
+  virtualNode->PackPingReq (chordMessage);
+  packet->AddHeader (chordMessage);
+  if (packet->GetSize())
+  {
+    NS_LOG_INFO ("Sending PingReq: " << chordMessage);
+    SendPacket (packet, remoteNode->GetIpAddress(), remoteNode->GetPort());
+  }
+}
+
 void
 ChordIpv4::DoStabilize(Ptr<ChordVNode> virtualNode)
 {
@@ -1504,6 +2955,9 @@ ChordIpv4::DumpVNodeInfo(std::string vNodeName, std::ostream &os)
     virtualNode -> PrintFingerTable (os);
     //virtualNode -> PrintFingerIdentifierList (os);
     os << "Fingers actually looked up: " << virtualNode->GetStats().fingersLookedUp << "\n";
+    os << "Stabilize Interval: " << GetMaintenanceInterval (virtualNode, m_stabilizeInterval).GetMilliSeconds() << "ms\n";
+    os << "Shared Fingers (all vNodes): " << m_routingTable.GetSize() << " entries, " << m_routingTable.GetReferences() << " references\n";
+    os << "Location Cache: " << m_locationCache.GetSize() << " ranges, " << m_lookupStats.cacheHits << " hits, " << m_lookupStats.cacheMisses << " misses\n";
   }
   else
   {
@@ -1511,12 +2965,47 @@ ChordIpv4::DumpVNodeInfo(std::string vNodeName, std::ostream &os)
   }
 }
 
+void
+ChordIpv4::GetLookupStats (ChordLookupStats &stats)
+{
+  stats = m_lookupStats;
+  stats.cacheInvalidations = m_locationCache.GetInvalidations();
+}
+
+void
+ChordIpv4::ValidateLocationCache (std::vector<Ptr<ChordNode> > &nodeList)
+{
+  for (std::vector<Ptr<ChordNode> >::iterator nodeIter = nodeList.begin(); nodeIter != nodeList.end(); nodeIter++)
+  {
+    m_locationCache.Validate (*nodeIter);
+  }
+}
+
+void
+ChordIpv4::ValidateLocationCache (const ChordNodeViewList &nodeList)
+{
+  for (uint32_t j = 0; j < nodeList.GetSize(); j++)
+  {
+    m_locationCache.Validate (nodeList[j].identifier, nodeList[j].ipAddress, nodeList[j].port);
+  }
+}
+
 void
 ChordIpv4::DumpDHashInfo (std::ostream &os)
 {
   m_dHashIpv4->DumpDHashInfo(os);
 }
 
+void
+ChordIpv4::AuditDHashObjects ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_dHashEnable)
+  {
+    m_dHashIpv4->AuditObjects ();
+  }
+}
+
 void
 ChordIpv4::FixFingers (std::string vNodeName)
 {
@@ -1550,7 +3039,7 @@ ChordIpv4::FireTraceRing (std::string vNodeName)
 }
 
 void
-ChordIpv4::ProcessTraceRing(ChordMessage chordMessage)
+ChordIpv4::ProcessTraceRing (ChordMessage &chordMessage)
 {
   //Make Up-call
   NS_LOG_FUNCTION_NOARGS ();
@@ -25,11 +25,20 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
 #include "ns3/timer.h"
+#include "ns3/inet-socket-address.h"
+#include <vector>
+#include <deque>
+#include <map>
 #include "chord-identifier.h"
 #include "chord-node.h"
 #include "chord-vnode.h"
 #include "chord-message.h"
+#include "chord-message-view.h"
 #include "chord-node-table.h"
+#include "chord-timer-wheel.h"
+#include "chord-rtt-estimator.h"
+#include "chord-routing-table.h"
+#include "chord-location-cache.h"
 #include "dhash-ipv4.h"
 
 /* Static defines */
@@ -41,16 +50,30 @@
 #define DEFAULT_HEARTBEAT_INTERVAL 500
 //Fix Finger interval
 #define DEFAULT_FIX_FINGER_INTERVAL 10000
+//Max doublings of Stabilize, Heartbeat and Fix Finger intervals while ring is stable (AdaptiveMaintenance)
+#define DEFAULT_MAX_MAINTENANCE_BACKOFF 4
 // Max missed keep alives (Stabilize and Heartbeat)
 #define DEFAULT_MAX_MISSED_KEEP_ALIVES 4
 //Request timeout
 #define DEFAULT_REQUEST_TIMEOUT 1000
 //Max request retries
 #define DEFAULT_MAX_REQUEST_RETRIES 3
+//Request timeout resolution
+#define DEFAULT_TIMER_WHEEL_RESOLUTION 10
 //Max Successor List Size
 #define DEFAULT_MAX_VNODE_SUCCESSOR_LIST_SIZE 8
 //Max Predecessor List Size
 #define DEFAULT_MAX_VNODE_PREDECESSOR_LIST_SIZE 8
+//Max keys carried in one batched lookup request
+#define DEFAULT_MAX_LOOKUP_BATCH_SIZE 64
+//Max batched lookups awaiting response
+#define DEFAULT_MAX_LOOKUPS_IN_FLIGHT 1024
+//Max size of packet carrying coalesced messages to same node (fits Ethernet MTU with IP/UDP headers)
+#define DEFAULT_MAX_COALESCED_PACKET_SIZE 1400
+//Max key ranges held by lookup location cache
+#define DEFAULT_LOCATION_CACHE_SIZE 1024
+//Lifetime of location cache entries
+#define DEFAULT_LOCATION_CACHE_TIMEOUT 30000
 
 
 namespace ns3 {
@@ -63,6 +86,36 @@ class Packet;
  *  \defgroup chordipv4 ChordIpv4
  */
 
+/**
+ *  \ingroup chordipv4
+ *  \brief Result of one key of batched lookup (see ChordIpv4::LookupKeys)
+ */
+struct ChordLookupResult
+{
+  ChordKey key;
+  bool success;
+  //Owner IP address and Application Port (valid if success)
+  Ipv4Address ipAddress;
+  uint16_t port;
+};
+
+/**
+ *  \ingroup chordipv4
+ *  \brief Lookup counters of ChordIpv4 (see ChordIpv4::GetLookupStats)
+ */
+struct ChordLookupStats
+{
+  //Lookups of remote keys answered from location cache
+  uint64_t cacheHits;
+  //Lookups of remote keys routed through ring
+  uint64_t cacheMisses;
+  //Cache entries dropped on ownership change, successor responses or failures
+  uint64_t cacheInvalidations;
+  //Routed lookups resolved, and sum of their latency (request to response)
+  uint64_t routedLookups;
+  Time routedLatency;
+};
+
 /**
  *  \ingroup chordipv4
  *  \brief Implementation of Chord/DHash DHT (http://pdos.csail.mit.edu/chord/)
@@ -75,6 +128,18 @@ class ChordIpv4 : public Application
 {
   public:
     static TypeId GetTypeId (void);
+    /**
+     *  \brief Signature of MaintenanceInterval trace source
+     *  \param vNodeName Name of VirtualNode(ChordVNode)
+     *  \param stabilizeInterval Current Stabilize interval of VirtualNode(ChordVNode), Heartbeat and Fix Finger intervals are scaled alike
+     */
+    typedef void (* MaintenanceIntervalCallback)(std::string vNodeName, Time stabilizeInterval);
+    /**
+     *  \brief Signature of Lookup trace source
+     *  \param latency Time from lookup request to response
+     *  \param hops Overlay hops taken by request until it reached owner (1 if first node asked was owner)
+     */
+    typedef void (* LookupCallback)(Time latency, uint8_t hops);
   
     ChordIpv4 ();
 
@@ -101,6 +166,14 @@ class ChordIpv4 : public Application
      */
 
     void InsertVNode (std::string vNodeName, uint8_t * key, uint8_t keyBytes);
+    /**
+     *  \brief Insert VirtualNode(ChordVNode) with fixed width identifier
+     *  \param vNodeName Name of VirtualNode(ChordVNode)
+     *  \param key ChordKey (identifier)
+     *
+     *  See InsertVNode (std::string, uint8_t*, uint8_t)
+     */
+    void InsertVNode (std::string vNodeName, const ChordKey &key);
     /**
      *  \brief Lookup owner node of an identifier in Chord Network
      *  \param key Pointer to key array (identifier)
@@ -113,6 +186,24 @@ class ChordIpv4 : public Application
      */
 
     void LookupKey (uint8_t * lookupKey, uint8_t lookupKeyBytes);
+    /**
+     *  \brief Lookup owner node of fixed width identifier in Chord Network
+     *  \param lookupKey ChordKey (identifier)
+     *
+     *  See LookupKey (uint8_t*, uint8_t)
+     */
+    void LookupKey (const ChordKey &lookupKey);
+    /**
+     *  \brief Lookup owner nodes of a set of identifiers in Chord Network
+     *  \param lookupKeys List of ChordKey (identifiers)
+     *
+     *  Keys are queued and resolved through a window of at most MaxLookupsInFlight outstanding lookups. Keys sharing the same next hop are packed
+     *  into one Batched Lookup Request (at most MaxLookupBatchSize keys per message). Intermediate nodes split the batch by next hop, and owner
+     *  VirtualNode(ChordVNode) responds directly for all keys it owns. Retransmission and retry limits are same as for LookupKey.
+     *  Once all keys are resolved (or failed), a single notification upcall is made to function registered via SetLookupBatchCallback, with results
+     *  in order of lookupKeys.
+     */
+    void LookupKeys (const std::vector<ChordKey> &lookupKeys);
     /**
     *  \brief Check whether the any VirtualNode(ChordVNode) running on local physical node owns particular identifier.
     *  \param key Pointer to key array (identifier)
@@ -124,6 +215,24 @@ class ChordIpv4 : public Application
     */
 
     bool CheckOwnership (uint8_t * lookupKey, uint8_t lookupKeyBytes);
+    /**
+     *  \brief Check ownership of fixed width identifier
+     *  \param lookupKey ChordKey (identifier)
+     *  \returns true if local ChordIpv4 is owner of identifier, false if local ChordIpv4 is not owner.
+     */
+    bool CheckOwnership (const ChordKey &lookupKey);
+    /**
+     *  \brief Check whether any local VirtualNode(ChordVNode) is owner or one of the first (replicationFactor - 1) successors of owner of identifier
+     *  \param lookupKey Pointer to key array (identifier)
+     *  \param lookupKeyBytes Number of bytes in key (max 255)
+     *  \param replicationFactor Number of nodes holding a copy of identifier (owner and its successors)
+     *
+     *  \returns true if local ChordIpv4 should hold a copy of identifier. Also true if predecessor list is too short to tell.
+     *
+     *  Only first joined local vNode at or after identifier is checked. replicationFactor is capped at MaxVNodePredecessorListSize,
+     *  as predecessors beyond list are unknown.
+     */
+    bool CheckReplicaOwnership (uint8_t * lookupKey, uint8_t lookupKeyBytes, uint8_t replicationFactor);
     /**
      *  \brief Remove VirtualNode(ChordVNode) from Chord Network
      *  \param vNodeName Name of VirtualNode(ChordVNode)
@@ -148,6 +257,11 @@ class ChordIpv4 : public Application
      *  \param lookupFailureFn This Callback is passed lookup key, numBytes of lookup key, resolved IP and resolved port as parameters.
      */
     void SetLookupFailureCallback (Callback <void, uint8_t*, uint8_t> lookupFailureFn);
+    /**
+     *  \brief Registers Callback function for Batched Lookup completion Notifications.
+     *  \param lookupBatchFn This Callback is passed list of ChordLookupResult, one per key given to LookupKeys.
+     */
+    void SetLookupBatchCallback (Callback <void, std::vector<ChordLookupResult> > lookupBatchFn);
     /**
      *  \brief Registers Callback function for VirtualNode(ChordVNode) key space ownership change notifications.
      *  \param vNodeKeyOwnershipFn This Callback is passed vNodeName, vNode key, numBytes in vNode key, predecessor key, numBytes in predecessor key, oldPredecessor key, numBytes in oldPredecessor key, IP address of predecessor and application port of predecessor.
@@ -171,25 +285,25 @@ class ChordIpv4 : public Application
     //DHash (DHashIpv4) Callbacks
     /**
      *  \brief Registers Callback function for DHashObject Insert Success notification 
-     *  \param insertSuccessFn This Callback is passed object key, numBytes in object key, object array and numBytes in object array as parameters.
+     *  \param insertSuccessFn This Callback is passed object key, numBytes in object key and read-only Packet holding object bytes as parameters.
      *
      *  This upcall is made when DHash (DHashIpv4) layer has succesfully stored the requested object in the Chord Network
      */
-    void SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> insertSuccessFn);
+    void SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > insertSuccessFn);
     /**
      *  \brief Registers Callback function for DHashObject Retrieve Success notifications.
-     *  \param retrieveSuccessFn This Callback is passed object key, numBytes in object key, object array and numBytes in object array as parameters.
+     *  \param retrieveSuccessFn This Callback is passed object key, numBytes in object key and read-only Packet holding object bytes as parameters.
      *
      *  This upcall is made when DHash (DHashIpv4) layer has successfully retrieved object represented by requested key (identifier).
      */
-    void SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> retrieveSuccessFn);
+    void SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > retrieveSuccessFn);
     /**
      *  \brief Registers Callback function for DHashObject Insert Failure notifications.
-     *  \param insertFailureFn This Callback is passed object key, numBytes in object key, object array and numBytes in object array as parameters.
+     *  \param insertFailureFn This Callback is passed object key, numBytes in object key and read-only Packet holding object bytes as parameters.
      *
      *  This upcall is made when DHash (DHashIpv4) layer fails to store the requested object.
      */
-    void SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> insertFailureFn); 
+    void SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > insertFailureFn); 
     /**
      *  \brief Registers Callback function for DHashObject Retrieve Failure notifications.
      *  \param retrieveFailureFn This Callback is passed object key and numBytes in object key as parameters.
@@ -197,13 +311,28 @@ class ChordIpv4 : public Application
      *  This upcall is made when DHash (DHashIpv4) layer fails to retrieve the object represented by requested key (identifier).
      */
     void SetRetrieveFailureCallback (Callback <void, uint8_t*, uint8_t> retrieveFailureFn);
+    /**
+     *  \brief Registers Callback function for objects streamed by a range retrieve (see RetrieveRange).
+     *  \param retrieveRangeFn This Callback is passed range query Id, object key, numBytes in object key and read-only Packet holding object bytes as parameters.
+     *
+     *  This upcall is made for each object found in the requested range, in ring order starting after low key. Erasure coded objects are reported
+     *  when rebuilt, out of order.
+     */
+    void SetRetrieveRangeCallback (Callback <void, uint32_t, uint8_t*, uint8_t, Ptr<const Packet> > retrieveRangeFn);
+    /**
+     *  \brief Registers Callback function for end of range retrieve (see RetrieveRange).
+     *  \param retrieveRangeCompleteFn This Callback is passed range query Id and true if the whole range was covered, false if the query was cut short (failed lookup, unreachable node, timeout).
+     */
+    void SetRetrieveRangeCompleteCallback (Callback <void, uint32_t, bool> retrieveRangeCompleteFn);
 
     //DHash (DHashIpv4) application interface
     /**
      *  \cond
      */
     void DHashLookupKey (uint8_t * lookupKey, uint8_t lookupKeyBytes);
-    void SetDHashLookupSuccessCallback (Callback <void, uint8_t*, uint8_t, Ipv4Address, uint16_t>);
+    void SetDHashLookupSuccessCallback (Callback <void, uint8_t*, uint8_t, Ipv4Address, uint16_t, std::vector<InetSocketAddress> >);
+    bool GetDHashReplicas (uint8_t * lookupKey, uint8_t lookupKeyBytes, std::vector<InetSocketAddress> &replicas);
+    bool GetDHashOwnedRange (uint8_t * lookupKey, uint8_t lookupKeyBytes, Ptr<ChordIdentifier> &vNodeIdentifier, Ipv4Address &successorIp, uint16_t &successorPort);
     void SetDHashLookupFailureCallback (Callback <void, uint8_t*, uint8_t>);
     void SetDHashVNodeKeyOwnershipCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint8_t, uint8_t*, uint8_t, Ipv4Address, uint16_t>);
 
@@ -222,12 +351,40 @@ class ChordIpv4 : public Application
      *  On successful lookup, DHash (DHashIpv4) layer establishes TCP connection with owner node and transfers the given object. Application is then notified of success.
      *  Application is also notified if storage fails (due to failed lookup etc.)
      *  
-     *  DHash (DHashIpv4) layer also runs periodic auditing of objects after configurable interval. During audit, the layer checks ownership of each stored object and transfers any misplaced objects.
+     *  With attribute DHashReplicationFactor r > 1, object is also stored at the first r-1 successors of owner (returned along with lookup response).
+     *  Success is reported as soon as one of these nodes has stored the object.
+     *  With attribute DHashDataFragments 0 < m < r, object is instead erasure coded (see DHashErasureCode) into r fragments of 1/m object size,
+     *  fragment i is stored at i-th of these nodes and success is reported once m fragments are stored.
+     *
+     *  When a VirtualNode(ChordVNode) gets a new predecessor, objects in the key range taken over by the predecessor are handed off to it in one batch (see SetVNodeKeyOwnershipCallback).
+     *  When predecessor fails instead, objects of the key range now owned are copied to current successors. Stored objects are kept sorted on identifier,
+     *  so both cases touch only the affected range. Full audit of stored objects runs on demand (see AuditDHashObjects), or periodically if attribute DHashAuditObjectsTimeout is set.
      *
      *  For transfer of objects, TCP connection is reused if it already exists with remote node. TCP connection(s) are torn down after configurable inactivity interval. 
+     *  Requests queued for the same node while its connection is busy (e.g. a handoff batch) are packed into bulk messages of up to attribute DHashBulkTransferSize bytes.
+     *
+     *  Stored objects are held by the backend named in attribute DHashObjectStore: in memory (DHashMapStore), or in a memory mapped log file per node (DHashLogStore).
      *
      */
     void Insert (uint8_t *key, uint8_t sizeOfKey ,uint8_t *object,uint32_t sizeOfObject);
+    /**
+     *  \brief Insert DHash object represented by fixed width key (identifier)
+     *  \param key ChordKey (identifier)
+     *  \param object Pointer to object byte array
+     *  \param sizeOfObject Number of bytes of object (max 2^32 - 1)
+     *
+     *  See Insert (uint8_t*, uint8_t, uint8_t*, uint32_t)
+     */
+    void Insert (const ChordKey &key, uint8_t *object, uint32_t sizeOfObject);
+    /**
+     *  \brief Insert DHash object held in a Packet
+     *  \param key Pointer to key array (identifier)
+     *  \param sizeOfKey Number of bytes in key (max 255)
+     *  \param object Packet holding object bytes, its buffer is shared with stored and transferred object instead of copied
+     *
+     *  See Insert (uint8_t*, uint8_t, uint8_t*, uint32_t)
+     */
+    void Insert (uint8_t *key, uint8_t sizeOfKey, Ptr<const Packet> object);
     /**
      *  \brief Retrieves object from Chord/DHash (DHashIpv4) network represented by given key (identifier)
      *  \param key Pointer to key array (identifier)
@@ -237,9 +394,53 @@ class ChordIpv4 : public Application
      *  On successful lookup, DHash (DHashIpv4) layer establishes TCP connection with owner and requests transfer of object. On successful retrieval, application is notified of success and given the object pointer.
      *  On failure to retrieve object (due to failed lookup, non-existent object etc.), application is notified of failure.
      *
+     *  With attribute DHashReplicationFactor r > 1, request is sent in parallel to owner and its first r-1 successors. First object received is reported,
+     *  failure is reported only if none of them returns the object. For erasure coded objects, object is reconstructed from first m distinct fragments received.
+     *
      *  TCP connections are bounded by inactivity timer and failure is reported to application if object transfer stalls.
      */
     void Retrieve (uint8_t* key, uint8_t sizeOfKey);
+    /**
+     *  \brief Retrieves object represented by fixed width key (identifier)
+     *  \param key ChordKey (identifier)
+     *
+     *  See Retrieve (uint8_t*, uint8_t)
+     */
+    void Retrieve (const ChordKey &key);
+    /**
+     *  \brief Retrieves all objects with identifier in (lowKey, highKey], taken clockwise (lowKey == highKey covers the whole ring)
+     *  \param lowKey Pointer to key array of low end of range (excluded)
+     *  \param highKey Pointer to key array of high end of range (included)
+     *  \param sizeOfKey Number of bytes in both keys (max 255)
+     *  \returns range query Id passed to range retrieve callbacks
+     *
+     *  On invocation, DHash (DHashIpv4) layer looks up owner of the first key after lowKey. Owner returns its objects in the range, then the query moves along
+     *  successors until highKey is covered: each response carries the cursor (last identifier covered) and the node holding the objects after it.
+     *  Each response holds at most attribute DHashRangePageSize objects (and up to DHashBulkTransferSize bytes), so neither side holds more than one page of
+     *  the range. Objects are passed to the application as they arrive (see SetRetrieveRangeCallback), end of query is reported once (see SetRetrieveRangeCompleteCallback).
+     *
+     *  Only owners answer, so each object is reported once. Owner of an erasure coded object holds one fragment of it, which is sent in the page; the
+     *  object is then rebuilt from fragments of its replica group (as by Retrieve) and reported once rebuilt, possibly after objects of later pages.
+     *  End of query is reported after all rebuilds, and is a failure if any of them failed.
+     */
+    uint32_t RetrieveRange (uint8_t* lowKey, uint8_t* highKey, uint8_t sizeOfKey);
+    /**
+     *  \brief Retrieves all objects with fixed width identifier in (lowKey, highKey]
+     *  \param lowKey ChordKey of low end of range (excluded)
+     *  \param highKey ChordKey of high end of range (included)
+     *  \returns range query Id
+     *
+     *  See RetrieveRange (uint8_t*, uint8_t*, uint8_t)
+     */
+    uint32_t RetrieveRange (const ChordKey &lowKey, const ChordKey &highKey);
+    /**
+     *  \brief Audits all DHash objects stored on this node
+     *
+     *  Checks ownership of each stored object and transfers any misplaced objects. Owner re-sends its objects to current successors, restoring replicas lost to churn.
+     *  For erasure coded objects the owner rebuilds the object from m fragments and sends fresh fragments to current successors.
+     *  Key range handoff does not depend on audit; this is a consistency check, e.g. after failure of successors.
+     */
+    void AuditDHashObjects (void);
 
     //Diagnostics Interface
     /**
@@ -248,6 +449,14 @@ class ChordIpv4 : public Application
      *  \param os Output stream
      */
     void DumpVNodeInfo (std::string vNodeName, std::ostream &os);
+    /**
+     *  \brief Reads lookup counters
+     *  \param stats ChordLookupStats (return result)
+     *
+     *  Lookups (LookupKey, LookupKeys, DHash lookups) of keys not owned locally are first tried on location cache (attribute LocationCacheSize),
+     *  which keeps key ranges (predecessor, owner] learnt from lookup responses. A hit resolves at once, without any message.
+     */
+    void GetLookupStats (ChordLookupStats &stats);
     /**
      *  \brief Fires Trace Ring packet
      *  \param vNodeName VirtualNode(ChordVNode) name
@@ -287,6 +496,11 @@ class ChordIpv4 : public Application
     uint16_t m_listeningPort;
     uint16_t m_applicationPort;
     uint16_t m_dHashPort;
+    uint8_t m_dHashReplicationFactor;
+    uint8_t m_dHashDataFragments;
+    uint32_t m_dHashBulkTransferSize;
+    uint32_t m_dHashRangePageSize;
+    std::string m_dHashObjectStore;
     Ptr<DHashIpv4> m_dHashIpv4;
 
     uint8_t m_maxVNodeSuccessorListSize;
@@ -295,6 +509,11 @@ class ChordIpv4 : public Application
     bool isBootStrapNode;
 
     ChordNodeTable m_vNodeMap;
+    //vNodes by ChordKey, for allocation free lookups from ChordMessageView
+    std::map<ChordKey, Ptr<ChordVNode> > m_vNodeKeyMap;
+    //Finger entries of all vNodes
+    ChordRoutingTable m_routingTable;
+    bool m_sharedFingerRouting;
 
     //Timers
     Timer m_stabilizeTimer;
@@ -303,6 +522,19 @@ class ChordIpv4 : public Application
     Time m_heartbeatInterval;
     Timer m_fixFingerTimer;
     Time m_fixFingerInterval;
+    //Adaptive maintenance
+    bool m_adaptiveMaintenance;
+    uint8_t m_maxMaintenanceBackoff;
+    TracedCallback<std::string, Time> m_maintenanceIntervalTrace;
+    //Packets sent, routed lookups resolved
+    TracedCallback<Ptr<const Packet> > m_txTrace;
+    TracedCallback<Time, uint8_t> m_lookupTrace;
+    //Proximity neighbor selection
+    bool m_proximityNeighborSelection;
+    ChordRttEstimator m_rttEstimator;
+    //Lookup mode
+    bool m_recursiveLookup;
+    bool m_iterativeLookupFallback;
   
 
     Time m_requestTimeout;
@@ -311,6 +543,41 @@ class ChordIpv4 : public Application
     uint8_t m_maxMissedKeepAlives;
 
     uint8_t m_maxRequestRetries;
+    //Request timeouts of all transactions
+    ChordTimerWheel m_timerWheel;
+    Time m_timerWheelResolution;
+
+    //Batched lookups
+    struct LookupBatch
+    {
+      std::vector<ChordLookupResult> results;
+      uint32_t pending;
+    };
+    std::map<uint32_t, LookupBatch> m_lookupBatchMap;
+    uint32_t m_nextLookupBatchId;
+    //Queued (batchId, position) slots not yet sent
+    std::deque<std::pair<uint32_t, uint32_t> > m_pendingBatchLookups;
+    uint32_t m_lookupsInFlight;
+    uint32_t m_maxLookupsInFlight;
+    uint16_t m_maxLookupBatchSize;
+    //Coalesced messages, per destination in order of first message
+    struct CoalescedPacket
+    {
+      Ipv4Address destinationIp;
+      uint16_t destinationPort;
+      Ptr<Packet> packet;
+    };
+    bool m_coalesceMessages;
+    uint32_t m_maxCoalescedPacketSize;
+    uint32_t m_coalescingDepth;
+    std::vector<CoalescedPacket> m_coalescedPackets;
+    //Lookup location cache
+    ChordLocationCache m_locationCache;
+    uint32_t m_locationCacheSize;
+    Time m_locationCacheTimeout;
+    ChordLookupStats m_lookupStats;
+    void ValidateLocationCache (std::vector<Ptr<ChordNode> > &nodeList);
+    void ValidateLocationCache (const ChordNodeViewList &nodeList);
 
     void StabilizeTimerExpire();
     void HeartBeatTimerExpire();
@@ -319,75 +586,114 @@ class ChordIpv4 : public Application
     void DoPeriodicStabilize();
     void DoPeriodicHeartbeat();
     void DoPeriodicFixFinger();
+    Time GetMaintenanceInterval (Ptr<ChordVNode> vNode, Time interval);
+    Time GetMaxMaintenanceInterval (Time interval);
+    void BackOffMaintenance (Ptr<ChordVNode> vNode);
+    void ResetMaintenance (Ptr<ChordVNode> vNode);
+    void ScheduleMaintenance (Timer &timer, Time delay);
+    Time GetNextMaintenanceDelay (Time ChordVNode::MaintenanceState::*nextRound, Time interval);
 
     //Callbacks
     Callback<void, std::string, uint8_t*, uint8_t> m_joinSuccessFn;
     Callback<void, uint8_t*, uint8_t, Ipv4Address, uint16_t> m_lookupSuccessFn;
     Callback<void, uint8_t*, uint8_t> m_lookupFailureFn;
+    Callback<void, std::vector<ChordLookupResult> > m_lookupBatchFn;
     Callback<void, std::string, uint8_t*, uint8_t, uint8_t*, uint8_t, uint8_t*, uint8_t, Ipv4Address, uint16_t> m_vNodeKeyOwnershipFn;
     Callback<void, std::string, uint8_t*, uint8_t> m_traceRingFn;
     Callback<void, std::string, uint8_t*, uint8_t> m_vNodeFailureFn;
     //DHash (DHashIpv4) callbacks
-    Callback<void, uint8_t*, uint8_t, Ipv4Address, uint16_t> m_dHashLookupSuccessFn;
+    Callback<void, uint8_t*, uint8_t, Ipv4Address, uint16_t, std::vector<InetSocketAddress> > m_dHashLookupSuccessFn;
     Callback<void, uint8_t*, uint8_t> m_dHashLookupFailureFn;
 
     //dHash-user Interface callbacks
-    Callback<void, uint8_t*, uint8_t, uint8_t*, uint32_t> m_insertSuccessFn;
-    Callback<void, uint8_t*, uint8_t, uint8_t*, uint32_t> m_retrieveSuccessFn;
-    Callback<void, uint8_t*, uint8_t, uint8_t*, uint32_t> m_insertFailureFn;
+    Callback<void, uint8_t*, uint8_t, Ptr<const Packet> > m_insertSuccessFn;
+    Callback<void, uint8_t*, uint8_t, Ptr<const Packet> > m_retrieveSuccessFn;
+    Callback<void, uint8_t*, uint8_t, Ptr<const Packet> > m_insertFailureFn;
     Callback<void, uint8_t*, uint8_t> m_retrieveFailureFn;
+    Callback<void, uint32_t, uint8_t*, uint8_t, Ptr<const Packet> > m_retrieveRangeFn;
+    Callback<void, uint32_t, bool> m_retrieveRangeCompleteFn;
     Callback <void, uint8_t*, uint8_t, uint8_t*, uint8_t, uint8_t*, uint8_t, Ipv4Address, uint16_t> m_dHashVNodeKeyOwnershipFn;
 
     //Upcall (notify) methods
     void NotifyJoinSuccess (std::string vNodeName, Ptr<ChordIdentifier> chordIdentifier);
-    void NotifyLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<ChordNode> resolvedNode, ChordTransaction::Originator originator);
+    void NotifyLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<ChordNode> resolvedNode, std::vector<Ptr<ChordNode> > &successorList, ChordTransaction::Originator originator);
     void NotifyLookupFailure (Ptr<ChordIdentifier> chordIdentifier, ChordTransaction::Originator originator);
+    void NotifyLookupBatch (std::vector<ChordLookupResult> &results);
     void NotifyVNodeKeyOwnership (std::string vNodeName, Ptr<ChordIdentifier> chordIdentifier, Ptr<ChordNode> predecessorNode, Ptr<ChordIdentifier> oldPredecessorIdentifier);
     void NotifyTraceRing (std::string vNodeName, Ptr<ChordIdentifier> chordIdentifier);
     void NotifyVNodeFailure (std::string vNodeName, Ptr<ChordIdentifier> chordIdentifier);
     //DHash (DHashIpv4) Notifications
-    void NotifyDHashLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ipv4Address ipAddress, uint16_t port);
+    void NotifyDHashLookupSuccess (Ptr<ChordIdentifier> lookupIdentifier, Ptr<ChordNode> resolvedNode, std::vector<Ptr<ChordNode> > &successorList);
+    void GetReplicaAddresses (Ptr<ChordNode> ownerNode, std::vector<Ptr<ChordNode> > &successorList, std::vector<InetSocketAddress> &replicas);
     void NotifyDHashLookupFailure (Ptr<ChordIdentifier> chordIdentifier);
     //DHash (DHashIpv4) User Notifications
-    void NotifyInsertSuccess (uint8_t* key, uint8_t keyBytes, uint8_t* object, uint32_t objectBytes);
-    void NotifyRetrieveSuccess (uint8_t* key, uint8_t keyBytes, uint8_t* object, uint32_t objectBytes);
-    void NotifyInsertFailure (uint8_t* key, uint8_t keyBytes, uint8_t* object, uint32_t objectBytes);
+    void NotifyInsertSuccess (uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object);
+    void NotifyRetrieveSuccess (uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object);
+    void NotifyInsertFailure (uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object);
     void NotifyRetrieveFailure (uint8_t* key, uint8_t keyBytes);
+    void NotifyRetrieveRange (uint32_t queryId, uint8_t* key, uint8_t keyBytes, Ptr<const Packet> object);
+    void NotifyRetrieveRangeComplete (uint32_t queryId, bool success);
 
     //Message processing methods
     void ProcessUdpPacket (Ptr<Socket> socket);
-    void ProcessJoinReq (ChordMessage chordMessage);
-    void ProcessJoinRsp (ChordMessage chordMessage);
-    void ProcessLeaveReq (ChordMessage chordMessage);
-    void ProcessLeaveRsp (ChordMessage chordMessage);
-    void ProcessLookupReq (ChordMessage chordMessage);
-    void ProcessLookupRsp (ChordMessage chordMessage);
-    void ProcessStabilizeReq (ChordMessage chordMessage);
-    void ProcessStabilizeRsp (ChordMessage chordMessage);
-    void ProcessHeartbeatReq (ChordMessage chordMessage);
-    void ProcessHeartbeatRsp (ChordMessage chordMessage);
-    void ProcessFingerReq (ChordMessage chordMessage);
-    void ProcessFingerRsp (ChordMessage chordMessage);
-    void ProcessTraceRing (ChordMessage chordMessage);
+    void ProcessJoinReq (ChordMessage &chordMessage);
+    void ProcessJoinRsp (ChordMessage &chordMessage);
+    void ProcessLeaveReq (ChordMessage &chordMessage);
+    void ProcessLeaveRsp (ChordMessage &chordMessage);
+    void ProcessLookupReq (ChordMessage &chordMessage);
+    void ProcessLookupRsp (ChordMessage &chordMessage);
+    void ProcessLookupReferral (ChordMessage &chordMessage);
+    void ProcessLookupBatchReq (ChordMessage &chordMessage);
+    void ProcessLookupBatchRsp (ChordMessage &chordMessage);
+    void ProcessStabilizeReq (ChordMessage &chordMessage);
+    void ProcessStabilizeRsp (ChordMessage &chordMessage);
+    void ProcessHeartbeatReq (ChordMessage &chordMessage);
+    void ProcessHeartbeatRsp (ChordMessage &chordMessage);
+    void ProcessFingerReq (ChordMessage &chordMessage);
+    void ProcessFingerRsp (ChordMessage &chordMessage);
+    void ProcessPingReq (ChordMessage &chordMessage);
+    void ProcessPingRsp (ChordMessage &chordMessage);
+    void ProcessTraceRing (ChordMessage &chordMessage);
+    //Fast path for hot messages decoded in place, these return false if message must be handled by full ChordMessage path
+    bool ProcessMessageView (const ChordMessageView &messageView);
+    bool ProcessLookupReq (const ChordMessageView &messageView);
+    bool ProcessStabilizeReq (const ChordMessageView &messageView);
+    bool ProcessStabilizeRsp (const ChordMessageView &messageView);
+    bool ProcessHeartbeatReq (const ChordMessageView &messageView);
+    bool ProcessHeartbeatRsp (const ChordMessageView &messageView);
+    //Owner reply to lookup request, shared by both paths
+    void SendLookupRsp (Ptr<ChordVNode> virtualNode, Ptr<ChordNode> requestorNode, uint32_t transactionId, uint8_t numSuccessors, uint8_t ttl);
 
 
     void DoLookup (Ptr<ChordIdentifier> requestedIdentifier, ChordTransaction::Originator orginator);
     void DoStabilize (Ptr<ChordVNode> virtualNode);
     void DoHeartbeat (Ptr<ChordVNode> virtualNode);
     void DoFixFinger (Ptr<ChordVNode> virtualNode);
+    void DoPing (Ptr<ChordVNode> virtualNode, Ptr<ChordNode> remoteNode);
+    Ptr<ChordNode> SelectFinger (Ptr<ChordVNode> virtualNode, Ptr<ChordIdentifier> fingerIdentifier, Ptr<ChordNode> fingerNode, std::vector<Ptr<ChordNode> > &successorList);
+    void DispatchBatchLookups ();
+    void SendLookupBatchReq (Ptr<ChordVNode> virtualNode, Ipv4Address nextHopIp, uint16_t nextHopPort, std::vector<std::pair<uint32_t, uint32_t> > &slots);
+    void CompleteBatchLookup (uint32_t batchId, uint32_t position, Ptr<ChordNode> resolvedNode);
+    void ReleaseBatchLookups (Ptr<ChordVNode> vNode);
 
     bool FindVNode (Ptr<ChordIdentifier> chordIdentifier, Ptr<ChordVNode>& virtualNode);
     bool FindVNode (std::string vNodeName, Ptr<ChordVNode>& virtualNode);
+    bool FindVNode (const ChordKey &key, Ptr<ChordVNode>& virtualNode);
     void DeleteVNode (Ptr<ChordIdentifier> chordIdentifier);
     void DeleteVNode (std::string vNodeName);
     bool LookupLocal (Ptr<ChordIdentifier> chordIdentifier, Ptr<ChordVNode>& virtualNode);
+    bool LookupLocal (const ChordKey &key, Ptr<ChordVNode>& virtualNode);
     
     //Send/Routing Methods
     void SendPacket (Ptr<Packet> packet, Ipv4Address destinationIp, uint16_t destinationPort);
-    bool FindNearestVNode (Ptr<ChordIdentifier> targetIdentifier, Ptr<ChordVNode> &virtualNode);
+    void StartCoalescing ();
+    void FlushCoalescedPackets ();
+    bool FindNearestVNode (const ChordKey &targetKey, Ptr<ChordVNode> &virtualNode);
     bool SendViaAnyVNode (Ptr<Packet> packet);
-    bool RoutePacket (Ptr<ChordIdentifier> targetIdentifier, Ptr<Packet> packet);
-    bool RouteViaFinger (Ptr<ChordIdentifier> targetIdentifier, Ptr<ChordVNode> vNode, Ptr<Packet> packet);
+    bool DecrementTTL (ChordMessage &chordMessage);
+    bool RoutePacket (const ChordKey &targetKey, Ptr<Packet> packet);
+    bool RouteViaFinger (const ChordKey &targetKey, Ptr<ChordVNode> vNode, Ptr<Packet> packet);
+    void FindNextHop (const ChordKey &targetKey, Ptr<ChordVNode> vNode, Ptr<ChordNode> &nextHop);
 
     //Timeouts
     void HandleRequestTimeout (Ptr<ChordVNode> chordVNode, uint32_t transactionId);
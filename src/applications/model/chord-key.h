@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_KEY_H
+#define CHORD_KEY_H
+
+#include <stdint.h>
+#include <array>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordKey
+ *  \brief Fixed width (160 bit, SHA-1 sized) value type key.
+ *
+ *  Key is held as three 64-bit words (least significant word first), so comparisons and
+ *  ring interval tests run word-wise and no heap memory is needed. Byte form follows
+ *  ChordIdentifier convention (little-endian).
+ */
+class ChordKey
+{
+  public:
+  /**
+   *  \brief Number of bytes in key
+   */
+  static constexpr uint8_t NUM_BYTES = 20;
+  /**
+   *  \brief Number of 64-bit words used to hold key
+   */
+  static constexpr uint8_t NUM_WORDS = (NUM_BYTES + 7) / 8;
+
+  /**
+   *  \brief Constructor, creates zero key
+   */
+  ChordKey ()
+  {
+    m_words.fill (0);
+  }
+  /**
+   *  \brief Constructor to store key
+   *  \param key Pointer to key array of NUM_BYTES bytes (little-endian)
+   */
+  explicit ChordKey (const uint8_t* key)
+  {
+    SetKey (key);
+  }
+
+  /**
+   *  \brief Stores key
+   *  \param key Pointer to key array of NUM_BYTES bytes (little-endian)
+   */
+  void SetKey (const uint8_t* key)
+  {
+    m_words.fill (0);
+    for (uint8_t i = 0; i < NUM_BYTES; i++)
+    {
+      m_words[i / 8] |= (uint64_t) key[i] << (8 * (i % 8));
+    }
+  }
+  /**
+   *  \brief Copies key into byte array
+   *  \param key Pointer to array of at least NUM_BYTES bytes (return result)
+   */
+  void GetKey (uint8_t* key) const
+  {
+    for (uint8_t i = 0; i < NUM_BYTES; i++)
+    {
+      key[i] = (uint8_t) (m_words[i / 8] >> (8 * (i % 8)));
+    }
+  }
+  /**
+   *  \returns 64-bit word of key at index (0 is least significant)
+   */
+  uint64_t GetWord (uint8_t index) const
+  {
+    NS_ASSERT (index < NUM_WORDS);
+    return m_words[index];
+  }
+
+  /**
+   *  \brief Three-way comparison
+   *  \param key ChordKey to compare with
+   *  \returns negative, zero or positive value if key is less, equal or greater than given key
+   */
+  int Compare (const ChordKey &key) const
+  {
+    for (int i = NUM_WORDS - 1; i >= 0; i--)
+    {
+      if (m_words[i] != key.m_words[i])
+        return (m_words[i] < key.m_words[i]) ? -1 : 1;
+    }
+    return 0;
+  }
+  /**
+   *  \returns true if keys are equal
+   */
+  bool IsEqual (const ChordKey &key) const
+  {
+    return m_words == key.m_words;
+  }
+  /**
+   *  \returns true if key is less than given key
+   */
+  bool IsLess (const ChordKey &key) const
+  {
+    return Compare (key) < 0;
+  }
+  /**
+   *  \returns true if key is greater than given key
+   */
+  bool IsGreater (const ChordKey &key) const
+  {
+    return Compare (key) > 0;
+  }
+  /**
+   *  \brief Tests if key lies in between interval (keyLow,keyHigh] taken on a circular space.
+   *  \param keyLow low key
+   *  \param keyHigh high key
+   *  \returns true if key lies in given range, otherwise returns false
+   */
+  bool IsInBetween (const ChordKey &keyLow, const ChordKey &keyHigh) const
+  {
+    int order = keyHigh.Compare (keyLow);
+    if (order > 0)
+    {
+      //No wrap-around
+      return IsGreater (keyLow) && !IsGreater (keyHigh);
+    }
+    else if (order < 0)
+    {
+      //Wrap-around, key lies either on left or on right of 0
+      return IsGreater (keyLow) || !IsGreater (keyHigh);
+    }
+    //Everything is in between! (except keyHigh)
+    return !IsEqual (keyHigh);
+  }
+  /**
+   *  \brief Adds power of two to key (key + 2^(powerOfTwo)), modulo 2^(8*NUM_BYTES)
+   *  \param powerOfTwo Power of two to add
+   */
+  void AddPowerOfTwo (uint16_t powerOfTwo)
+  {
+    NS_ASSERT (powerOfTwo < NUM_BYTES * 8);
+    uint8_t word = powerOfTwo / 64;
+    uint64_t prevVal = m_words[word];
+    m_words[word] += (uint64_t) 1 << (powerOfTwo % 64);
+    //Propagate carry
+    while (m_words[word] < prevVal && ++word < NUM_WORDS)
+    {
+      prevVal = m_words[word];
+      m_words[word]++;
+    }
+    //Wrap around in partial top word
+    m_words[NUM_WORDS - 1] &= TopWordMask ();
+  }
+
+  private:
+  /**
+   *  \cond
+   */
+  static uint64_t TopWordMask ()
+  {
+    return (NUM_BYTES % 8 == 0) ? ~(uint64_t) 0 : (((uint64_t) 1 << (8 * (NUM_BYTES % 8))) - 1);
+  }
+
+  std::array<uint64_t, NUM_WORDS> m_words;
+  /**
+   *  \endcond
+   */
+}; //class ChordKey
+
+inline bool operator < (const ChordKey &keyL, const ChordKey &keyR)
+{
+  return keyL.IsLess (keyR);
+}
+
+inline bool operator == (const ChordKey &keyL, const ChordKey &keyR)
+{
+  return keyL.IsEqual (keyR);
+}
+
+inline bool operator != (const ChordKey &keyL, const ChordKey &keyR)
+{
+  return !keyL.IsEqual (keyR);
+}
+
+} //namespace ns3
+
+#endif //CHORD_KEY_H
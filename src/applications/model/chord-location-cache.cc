@@ -0,0 +1,283 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "chord-location-cache.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+NS_LOG_COMPONENT_DEFINE ("ChordLocationCache");
+
+namespace ns3 {
+
+ChordLocationCache::ChordLocationCache ()
+  : m_maxSize (0),
+    m_invalidations (0)
+{
+}
+
+ChordLocationCache::~ChordLocationCache ()
+{
+}
+
+void
+ChordLocationCache::SetMaxSize (uint32_t maxSize)
+{
+  m_maxSize = maxSize;
+  while (m_cacheMap.size () > m_maxSize)
+  {
+    Erase (m_cacheMap.find (m_lruList.back ()));
+  }
+}
+
+void
+ChordLocationCache::SetTimeout (Time timeout)
+{
+  m_timeout = timeout;
+}
+
+void
+ChordLocationCache::Insert (Ptr<ChordIdentifier> predecessorIdentifier, Ptr<ChordNode> ownerNode, std::vector<Ptr<ChordNode> > &successorList, uint8_t numSuccessors)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ChordKey predecessorKey, ownerKey;
+  if (m_maxSize == 0 || !GetKey (predecessorIdentifier, predecessorKey) || !GetKey (ownerNode->GetChordIdentifier (), ownerKey) ||
+      predecessorKey == ownerKey)
+  {
+    //Disabled, identifier width not cached, or owner is alone in ring (range is whole ring)
+    return;
+  }
+  //Older entries overlapping new range are out of date
+  RemoveOverlapping (predecessorKey, ownerKey);
+
+  CacheEntry entry;
+  entry.predecessorKey = predecessorKey;
+  entry.ownerNode = ownerNode;
+  entry.successorList = successorList;
+  entry.numSuccessors = numSuccessors;
+  entry.timestamp = Simulator::Now ();
+  m_lruList.push_front (ownerKey);
+  entry.lruIterator = m_lruList.begin ();
+  m_cacheMap.insert (std::make_pair (ownerKey, entry));
+  if (m_cacheMap.size () > m_maxSize)
+  {
+    //Evict least recently used
+    Erase (m_cacheMap.find (m_lruList.back ()));
+  }
+}
+
+bool
+ChordLocationCache::Find (Ptr<ChordIdentifier> identifier, uint8_t numSuccessors, Ptr<ChordNode> &ownerNode, std::vector<Ptr<ChordNode> > &successorList)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ChordKey key;
+  if (!GetKey (identifier, key))
+  {
+    return false;
+  }
+  CacheMap::iterator iterator = FindEntry (key);
+  if (iterator == m_cacheMap.end ())
+  {
+    return false;
+  }
+  if (iterator->second.timestamp + m_timeout < Simulator::Now ())
+  {
+    //Expired
+    Erase (iterator);
+    return false;
+  }
+  if (iterator->second.numSuccessors < numSuccessors)
+  {
+    return false;
+  }
+  m_lruList.splice (m_lruList.begin (), m_lruList, iterator->second.lruIterator);
+  ownerNode = iterator->second.ownerNode;
+  successorList = iterator->second.successorList;
+  return true;
+}
+
+void
+ChordLocationCache::Validate (Ptr<ChordNode> chordNode)
+{
+  ChordKey key;
+  if (GetKey (chordNode->GetChordIdentifier (), key))
+  {
+    Validate (key, chordNode->GetIpAddress (), chordNode->GetPort ());
+  }
+}
+
+void
+ChordLocationCache::Validate (const ChordKey &identifier, Ipv4Address ipAddress, uint16_t port)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CacheMap::iterator iterator = FindEntry (identifier);
+  if (iterator == m_cacheMap.end ())
+  {
+    return;
+  }
+  Ptr<ChordNode> ownerNode = iterator->second.ownerNode;
+  if (iterator->first != identifier)
+  {
+    //Node joined inside cached range, it owns part of range now
+    NS_LOG_INFO ("Cached range split by node at " << ipAddress);
+    Erase (iterator);
+    m_invalidations++;
+  }
+  else if (ownerNode->GetIpAddress () != ipAddress || ownerNode->GetPort () != port)
+  {
+    Erase (iterator);
+    m_invalidations++;
+  }
+}
+
+void
+ChordLocationCache::InvalidateRange (Ptr<ChordIdentifier> identifierLow, Ptr<ChordIdentifier> identifierHigh)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ChordKey keyLow, keyHigh;
+  if (GetKey (identifierLow, keyLow) && GetKey (identifierHigh, keyHigh))
+  {
+    m_invalidations += RemoveOverlapping (keyLow, keyHigh);
+  }
+}
+
+void
+ChordLocationCache::InvalidateIdentifier (Ptr<ChordIdentifier> identifier)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ChordKey key;
+  if (!GetKey (identifier, key))
+  {
+    return;
+  }
+  CacheMap::iterator iterator = FindEntry (key);
+  if (iterator != m_cacheMap.end ())
+  {
+    Erase (iterator);
+    m_invalidations++;
+  }
+}
+
+void
+ChordLocationCache::InvalidateNode (Ipv4Address ipAddress, uint16_t port)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (CacheMap::iterator iterator = m_cacheMap.begin (); iterator != m_cacheMap.end (); )
+  {
+    if (iterator->second.ownerNode->GetIpAddress () == ipAddress && iterator->second.ownerNode->GetPort () == port)
+    {
+      Erase (iterator++);
+      m_invalidations++;
+    }
+    else
+      ++iterator;
+  }
+}
+
+void
+ChordLocationCache::Clear (void)
+{
+  m_cacheMap.clear ();
+  m_lruList.clear ();
+}
+
+uint32_t
+ChordLocationCache::GetSize (void) const
+{
+  return m_cacheMap.size ();
+}
+
+uint64_t
+ChordLocationCache::GetInvalidations (void) const
+{
+  return m_invalidations;
+}
+
+bool
+ChordLocationCache::GetKey (Ptr<ChordIdentifier> identifier, ChordKey &key)
+{
+  if (identifier->GetNumBytes () != ChordKey::NUM_BYTES)
+  {
+    return false;
+  }
+  key = identifier->GetChordKey ();
+  return true;
+}
+
+/*  Logic: Ranges are disjoint and each ends at its owner, so the only range which can hold an identifier is the one of
+ *  first owner at or after identifier (wrapping around to lowest owner).
+ */
+
+ChordLocationCache::CacheMap::iterator
+ChordLocationCache::FindEntry (const ChordKey &key)
+{
+  if (m_cacheMap.empty ())
+  {
+    return m_cacheMap.end ();
+  }
+  CacheMap::iterator iterator = m_cacheMap.lower_bound (key);
+  if (iterator == m_cacheMap.end ())
+  {
+    iterator = m_cacheMap.begin ();
+  }
+  if (key.IsInBetween (iterator->second.predecessorKey, iterator->first))
+  {
+    return iterator;
+  }
+  return m_cacheMap.end ();
+}
+
+/*  Logic: A cached range overlaps (low, high] if its owner lies in (low, high], these follow low in map order, or else if
+ *  it holds high itself.
+ */
+
+uint32_t
+ChordLocationCache::RemoveOverlapping (const ChordKey &keyLow, const ChordKey &keyHigh)
+{
+  uint32_t removed = 0;
+  CacheMap::iterator iterator = m_cacheMap.upper_bound (keyLow);
+  while (!m_cacheMap.empty ())
+  {
+    if (iterator == m_cacheMap.end ())
+    {
+      iterator = m_cacheMap.begin ();
+    }
+    if (!iterator->first.IsInBetween (keyLow, keyHigh))
+    {
+      break;
+    }
+    Erase (iterator++);
+    removed++;
+  }
+  iterator = FindEntry (keyHigh);
+  if (iterator != m_cacheMap.end ())
+  {
+    Erase (iterator);
+    removed++;
+  }
+  return removed;
+}
+
+void
+ChordLocationCache::Erase (CacheMap::iterator iterator)
+{
+  m_lruList.erase (iterator->second.lruIterator);
+  m_cacheMap.erase (iterator);
+}
+
+} //namespace ns3
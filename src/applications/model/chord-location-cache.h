@@ -0,0 +1,154 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_LOCATION_CACHE_H
+#define CHORD_LOCATION_CACHE_H
+
+#include <stdint.h>
+#include <map>
+#include <list>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "chord-identifier.h"
+#include "chord-key.h"
+#include "chord-node.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordLocationCache
+ *  \brief Bounded cache of resolved key ranges
+ *
+ *  Each entry maps key range (predecessor, owner] of a remote VirtualNode(ChordVNode) to that node, as learnt from lookup responses, so that
+ *  lookups of keys in a cached range resolve without routing. Ranges are kept disjoint. Least recently used entry is evicted once cache is full,
+ *  and entries expire after a timeout. Only ChordKey::NUM_BYTES wide identifiers are cached, others always miss.
+ */
+class ChordLocationCache
+{
+  public:
+    ChordLocationCache ();
+    ~ChordLocationCache ();
+
+    /**
+     *  \brief Sets bound on number of entries (0 disables cache)
+     *  \param maxSize Max entries
+     */
+    void SetMaxSize (uint32_t maxSize);
+    /**
+     *  \brief Sets lifetime of entries
+     *  \param timeout Time after insertion at which entry is dropped
+     */
+    void SetTimeout (Time timeout);
+    /**
+     *  \brief Caches range (predecessorIdentifier, ownerNode] resolved by lookup. Cached ranges overlapping it are replaced.
+     *  \param predecessorIdentifier Ptr to ChordIdentifier of predecessor of owner
+     *  \param ownerNode Ptr to owner ChordNode
+     *  \param successorList Successors of owner returned along with lookup response
+     *  \param numSuccessors Number of successors requested by lookup (successorList may be shorter on small rings)
+     */
+    void Insert (Ptr<ChordIdentifier> predecessorIdentifier, Ptr<ChordNode> ownerNode, std::vector<Ptr<ChordNode> > &successorList, uint8_t numSuccessors);
+    /**
+     *  \brief Finds owner of identifier
+     *  \param identifier Ptr to requested ChordIdentifier
+     *  \param numSuccessors Number of successors of owner needed
+     *  \param ownerNode Ptr to owner ChordNode (return result)
+     *  \param successorList Successors of owner (return result)
+     *  \returns true on hit, false if no valid entry covers identifier (or entry was cached with fewer successors)
+     */
+    bool Find (Ptr<ChordIdentifier> identifier, uint8_t numSuccessors, Ptr<ChordNode> &ownerNode, std::vector<Ptr<ChordNode> > &successorList);
+    /**
+     *  \brief Checks cached ranges against a node reported by remote node (successor lists etc.)
+     *  \param chordNode Ptr to ChordNode
+     *
+     *  A node lying inside a cached range, or owner identifier seen at another address, means entry is stale and it is dropped.
+     */
+    void Validate (Ptr<ChordNode> chordNode);
+    /**
+     *  \brief Checks cached ranges against a node reported by remote node, without allocating
+     *  \param identifier ChordKey of node
+     *  \param ipAddress IP address of node
+     *  \param port Chord port of node
+     */
+    void Validate (const ChordKey &identifier, Ipv4Address ipAddress, uint16_t port);
+    /**
+     *  \brief Drops entries overlapping range (identifierLow, identifierHigh]
+     *  \param identifierLow Ptr to low ChordIdentifier
+     *  \param identifierHigh Ptr to high ChordIdentifier
+     */
+    void InvalidateRange (Ptr<ChordIdentifier> identifierLow, Ptr<ChordIdentifier> identifierHigh);
+    /**
+     *  \brief Drops entry covering identifier
+     *  \param identifier Ptr to ChordIdentifier
+     */
+    void InvalidateIdentifier (Ptr<ChordIdentifier> identifier);
+    /**
+     *  \brief Drops entries owned by node at given address
+     *  \param ipAddress IP address of node
+     *  \param port Chord port of node
+     */
+    void InvalidateNode (Ipv4Address ipAddress, uint16_t port);
+    /**
+     *  \brief Clears all entries
+     */
+    void Clear (void);
+    /**
+     *  \returns Number of entries held
+     */
+    uint32_t GetSize (void) const;
+    /**
+     *  \returns Number of entries dropped as stale since start (expired and evicted entries not counted)
+     */
+    uint64_t GetInvalidations (void) const;
+
+  private:
+    /**
+     *  \cond
+     */
+    struct CacheEntry
+    {
+      ChordKey predecessorKey;
+      Ptr<ChordNode> ownerNode;
+      std::vector<Ptr<ChordNode> > successorList;
+      uint8_t numSuccessors;
+      Time timestamp;
+      std::list<ChordKey>::iterator lruIterator;
+    };
+    //Keyed on owner identifier
+    typedef std::map<ChordKey, CacheEntry> CacheMap;
+
+    static bool GetKey (Ptr<ChordIdentifier> identifier, ChordKey &key);
+    CacheMap::iterator FindEntry (const ChordKey &key);
+    uint32_t RemoveOverlapping (const ChordKey &keyLow, const ChordKey &keyHigh);
+    void Erase (CacheMap::iterator iterator);
+
+    CacheMap m_cacheMap;
+    //Most recently used first
+    std::list<ChordKey> m_lruList;
+    uint32_t m_maxSize;
+    Time m_timeout;
+    uint64_t m_invalidations;
+    /**
+     *  \endcond
+     */
+}; //class ChordLocationCache
+
+} //namespace ns3
+
+#endif //CHORD_LOCATION_CACHE_H
@@ -0,0 +1,266 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "chord-message-view.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ChordMessageView");
+
+NS_OBJECT_ENSURE_REGISTERED (ChordMessageView);
+
+ChordNodeView::ChordNodeView ()
+  : port (0),
+    applicationPort (0),
+    dHashPort (0)
+{
+}
+
+bool
+ChordNodeView::Deserialize (Buffer::Iterator &start)
+{
+  if (start.ReadU8 () != ChordKey::NUM_BYTES)
+  {
+    return false;
+  }
+  uint8_t key[ChordKey::NUM_BYTES];
+  start.Read (key, ChordKey::NUM_BYTES);
+  identifier.SetKey (key);
+  ipAddress = Ipv4Address (start.ReadNtohU32 ());
+  port = start.ReadNtohU16 ();
+  applicationPort = start.ReadNtohU16 ();
+  dHashPort = start.ReadNtohU16 ();
+  return true;
+}
+
+bool
+ChordNodeView::IsSameNode (Ptr<ChordNode> chordNode) const
+{
+  Ptr<ChordIdentifier> chordIdentifier = chordNode->GetChordIdentifier ();
+  return chordIdentifier->GetNumBytes () == ChordKey::NUM_BYTES &&
+         chordIdentifier->GetChordKey () == identifier &&
+         chordNode->GetIpAddress () == ipAddress &&
+         chordNode->GetPort () == port;
+}
+
+Ptr<ChordNode>
+ChordNodeView::CreateNode (void) const
+{
+  return Create<ChordNode> (Create<ChordIdentifier> (identifier), ipAddress, port, applicationPort, dHashPort);
+}
+
+ChordMessageView::ChordMessageView ()
+  : m_messageType (ChordMessage::STABILIZE_REQ),
+    m_ttl (0),
+    m_transactionId (0),
+    m_size (0)
+{
+  m_lookupReq.numSuccessors = 0;
+  m_lookupReq.lookupMode = ChordMessage::RECURSIVE_LOOKUP;
+}
+
+ChordMessageView::~ChordMessageView ()
+{
+}
+
+TypeId
+ChordMessageView::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ChordMessageView")
+    .SetParent<Header> ()
+    .AddConstructor<ChordMessageView> ()
+    ;
+  return tid;
+}
+
+TypeId
+ChordMessageView::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+ChordMessageView::Print (std::ostream &os) const
+{
+  os << "MessageType: " << (uint16_t) m_messageType << " TransactionId: " << m_transactionId << " TTL: " << (uint16_t) m_ttl;
+  os << " Requestor: " << m_requestorNode.ipAddress << ":" << m_requestorNode.port;
+}
+
+uint32_t
+ChordMessageView::GetSerializedSize (void) const
+{
+  return m_size;
+}
+
+void
+ChordMessageView::Serialize (Buffer::Iterator start) const
+{
+  NS_ASSERT_MSG (false, "ChordMessageView is decode only, pack ChordMessage instead");
+}
+
+/*  Logic: Fields are read in ChordMessage wire order. Any message type or identifier width the view can not hold aborts decoding
+ *  (returns 0) before anything is acted upon, so caller can decode same bytes again with ChordMessage.
+ */
+
+uint32_t
+ChordMessageView::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_messageType = (ChordMessage::MessageType) i.ReadU8 ();
+  switch (m_messageType)
+  {
+    case ChordMessage::STABILIZE_REQ:
+    case ChordMessage::STABILIZE_RSP:
+    case ChordMessage::HEARTBEAT_REQ:
+    case ChordMessage::HEARTBEAT_RSP:
+    case ChordMessage::LOOKUP_REQ:
+      break;
+    default:
+      return 0;
+  }
+  m_ttl = i.ReadU8 ();
+  m_transactionId = i.ReadNtohU32 ();
+  if (!m_requestorNode.Deserialize (i))
+  {
+    return 0;
+  }
+  bool ret = false;
+  switch (m_messageType)
+  {
+    case ChordMessage::STABILIZE_REQ:
+      ret = DeserializeKey (i, m_stabilizeReq.successorIdentifier);
+      break;
+    case ChordMessage::STABILIZE_RSP:
+      ret = m_stabilizeRsp.predecessorNode.Deserialize (i) && DeserializeNodeList (i, m_stabilizeRsp.successorList);
+      break;
+    case ChordMessage::HEARTBEAT_REQ:
+      ret = DeserializeKey (i, m_heartbeatReq.predecessorIdentifier);
+      break;
+    case ChordMessage::HEARTBEAT_RSP:
+      ret = m_heartbeatRsp.successorNode.Deserialize (i) && DeserializeNodeList (i, m_heartbeatRsp.predecessorList);
+      break;
+    case ChordMessage::LOOKUP_REQ:
+      ret = DeserializeKey (i, m_lookupReq.requestedIdentifier);
+      if (ret)
+      {
+        m_lookupReq.numSuccessors = i.ReadU8 ();
+        m_lookupReq.lookupMode = i.ReadU8 ();
+      }
+      break;
+    default:
+      break;
+  }
+  if (!ret)
+  {
+    return 0;
+  }
+  m_size = i.GetDistanceFrom (start);
+  return m_size;
+}
+
+ChordMessage::MessageType
+ChordMessageView::GetMessageType (void) const
+{
+  return m_messageType;
+}
+
+uint32_t
+ChordMessageView::GetTransactionId (void) const
+{
+  return m_transactionId;
+}
+
+uint8_t
+ChordMessageView::GetTTL (void) const
+{
+  return m_ttl;
+}
+
+const ChordNodeView&
+ChordMessageView::GetRequestorNode (void) const
+{
+  return m_requestorNode;
+}
+
+const ChordMessageView::StabilizeReq&
+ChordMessageView::GetStabilizeReq (void) const
+{
+  NS_ASSERT (m_messageType == ChordMessage::STABILIZE_REQ);
+  return m_stabilizeReq;
+}
+
+const ChordMessageView::StabilizeRsp&
+ChordMessageView::GetStabilizeRsp (void) const
+{
+  NS_ASSERT (m_messageType == ChordMessage::STABILIZE_RSP);
+  return m_stabilizeRsp;
+}
+
+const ChordMessageView::HeartbeatReq&
+ChordMessageView::GetHeartbeatReq (void) const
+{
+  NS_ASSERT (m_messageType == ChordMessage::HEARTBEAT_REQ);
+  return m_heartbeatReq;
+}
+
+const ChordMessageView::HeartbeatRsp&
+ChordMessageView::GetHeartbeatRsp (void) const
+{
+  NS_ASSERT (m_messageType == ChordMessage::HEARTBEAT_RSP);
+  return m_heartbeatRsp;
+}
+
+const ChordMessageView::LookupReq&
+ChordMessageView::GetLookupReq (void) const
+{
+  NS_ASSERT (m_messageType == ChordMessage::LOOKUP_REQ);
+  return m_lookupReq;
+}
+
+bool
+ChordMessageView::DeserializeKey (Buffer::Iterator &start, ChordKey &key)
+{
+  if (start.ReadU8 () != ChordKey::NUM_BYTES)
+  {
+    return false;
+  }
+  uint8_t keyBytes[ChordKey::NUM_BYTES];
+  start.Read (keyBytes, ChordKey::NUM_BYTES);
+  key.SetKey (keyBytes);
+  return true;
+}
+
+bool
+ChordMessageView::DeserializeNodeList (Buffer::Iterator &start, ChordNodeViewList &nodeList)
+{
+  nodeList.Clear ();
+  uint8_t listSize = start.ReadU8 ();
+  for (uint8_t j = 0; j < listSize; j++)
+  {
+    ChordNodeView node;
+    if (!node.Deserialize (start))
+    {
+      return false;
+    }
+    nodeList.PushBack (node);
+  }
+  return true;
+}
+
+} //namespace ns3
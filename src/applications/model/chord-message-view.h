@@ -0,0 +1,272 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_MESSAGE_VIEW_H
+#define CHORD_MESSAGE_VIEW_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/header.h"
+#include "ns3/ipv4-address.h"
+#include "chord-key.h"
+#include "chord-node.h"
+#include "chord-message.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordInlineVector
+ *  \brief Vector holding up to N elements inline, spilling to heap beyond that
+ *
+ *  Used for lists decoded from packets, which are nearly always short, so that decoding them needs no heap memory.
+ *  Capacity is kept across Clear(), a reused instance does not allocate again.
+ */
+template <typename T, uint32_t N>
+class ChordInlineVector
+{
+  public:
+    ChordInlineVector ()
+      : m_size (0)
+    {
+    }
+    /**
+     *  \brief Appends element
+     *  \param element Element to append
+     */
+    void PushBack (const T &element)
+    {
+      if (m_size < N)
+      {
+        m_inline[m_size] = element;
+      }
+      else
+      {
+        if (m_size == N)
+        {
+          //Spill, overflow vector keeps its capacity across Clear()
+          m_overflow.clear ();
+        }
+        m_overflow.push_back (element);
+      }
+      m_size++;
+    }
+    /**
+     *  \brief Removes all elements
+     */
+    void Clear (void)
+    {
+      m_size = 0;
+    }
+    /**
+     *  \returns Number of elements
+     */
+    uint32_t GetSize (void) const
+    {
+      return m_size;
+    }
+    /**
+     *  \returns true if no element is held
+     */
+    bool IsEmpty (void) const
+    {
+      return m_size == 0;
+    }
+    /**
+     *  \param index Index of element (less than GetSize())
+     *  \returns Element at index
+     */
+    const T& operator[] (uint32_t index) const
+    {
+      NS_ASSERT (index < m_size);
+      return (index < N) ? m_inline[index] : m_overflow[index - N];
+    }
+
+  private:
+    /**
+     *  \cond
+     */
+    T m_inline[N];
+    std::vector<T> m_overflow;
+    uint32_t m_size;
+    /**
+     *  \endcond
+     */
+}; //class ChordInlineVector
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordNodeView
+ *  \brief Decoded ChordNode held by value (fixed width ChordKey identifier)
+ */
+class ChordNodeView
+{
+  public:
+    ChordNodeView ();
+    /**
+     *  \brief Decodes packed ChordNode (see ChordNode::Serialize)
+     *  \param start Buffer::Iterator of packed structure
+     *  \returns false if identifier is not ChordKey::NUM_BYTES long (node can not be held by value)
+     */
+    bool Deserialize (Buffer::Iterator &start);
+    /**
+     *  \param chordNode Ptr to ChordNode
+     *  \returns true if chordNode has same identifier, IP address and port
+     */
+    bool IsSameNode (Ptr<ChordNode> chordNode) const;
+    /**
+     *  \returns New ChordNode with contents of view
+     */
+    Ptr<ChordNode> CreateNode (void) const;
+
+    ChordKey identifier;
+    Ipv4Address ipAddress;
+    uint16_t port;
+    uint16_t applicationPort;
+    uint16_t dHashPort;
+}; //class ChordNodeView
+
+/**
+ *  \brief List of ChordNodeView(s), held inline up to default successor/predecessor list size
+ */
+typedef ChordInlineVector<ChordNodeView, 8> ChordNodeViewList;
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordMessageView
+ *  \brief Read-only decoding of ChordMessage for hot maintenance and lookup messages
+ *
+ *  Parses same wire format as ChordMessage, but identifiers are held as ChordKey and nodes as ChordNodeView by value and lists
+ *  in ChordNodeViewList, so decoding into a reused (or stack) instance does no heap allocation. Supports STABILIZE_REQ, STABILIZE_RSP,
+ *  HEARTBEAT_REQ, HEARTBEAT_RSP and LOOKUP_REQ carrying ChordKey::NUM_BYTES identifiers; Deserialize returns 0 for anything else, such
+ *  messages are to be decoded with ChordMessage. View can not be serialized, responses are packed with ChordMessage.
+ */
+class ChordMessageView : public Header
+{
+  public:
+    ChordMessageView ();
+    virtual ~ChordMessageView ();
+
+    static TypeId GetTypeId (void);
+    TypeId GetInstanceTypeId (void) const;
+    /**
+     *  \brief Prints ChordMessageView
+     *  \param os Output Stream
+     */
+    void Print (std::ostream &os) const;
+    /**
+     *  \returns Size in bytes of decoded message
+     */
+    uint32_t GetSerializedSize (void) const;
+    /**
+     *  \brief Not supported, view is decode only
+     */
+    void Serialize (Buffer::Iterator start) const;
+    /**
+     *  \brief Decodes packed ChordMessage
+     *  \param start Buffer::Iterator
+     *  \returns Size of message, or 0 if message type or identifier width is not supported
+     */
+    uint32_t Deserialize (Buffer::Iterator start);
+
+    /**
+     *  \returns ChordMessage::MessageType
+     */
+    ChordMessage::MessageType GetMessageType (void) const;
+    /**
+     *  \returns Transaction Id
+     */
+    uint32_t GetTransactionId (void) const;
+    /**
+     *  \returns Time to live
+     */
+    uint8_t GetTTL (void) const;
+    /**
+     *  \returns Requestor node
+     */
+    const ChordNodeView& GetRequestorNode (void) const;
+
+    /**
+     *  \cond
+     */
+    struct StabilizeReq
+    {
+      ChordKey successorIdentifier;
+    };
+    struct StabilizeRsp
+    {
+      ChordNodeView predecessorNode;
+      ChordNodeViewList successorList;
+    };
+    struct HeartbeatReq
+    {
+      ChordKey predecessorIdentifier;
+    };
+    struct HeartbeatRsp
+    {
+      ChordNodeView successorNode;
+      ChordNodeViewList predecessorList;
+    };
+    struct LookupReq
+    {
+      ChordKey requestedIdentifier;
+      uint8_t numSuccessors;
+      uint8_t lookupMode;
+    };
+    /**
+     *  \endcond
+     */
+
+    const StabilizeReq& GetStabilizeReq (void) const;
+    const StabilizeRsp& GetStabilizeRsp (void) const;
+    const HeartbeatReq& GetHeartbeatReq (void) const;
+    const HeartbeatRsp& GetHeartbeatRsp (void) const;
+    const LookupReq& GetLookupReq (void) const;
+
+  private:
+    /**
+     *  \cond
+     */
+    static bool DeserializeKey (Buffer::Iterator &start, ChordKey &key);
+    static bool DeserializeNodeList (Buffer::Iterator &start, ChordNodeViewList &nodeList);
+
+    ChordMessage::MessageType m_messageType;
+    uint8_t m_ttl;
+    uint32_t m_transactionId;
+    ChordNodeView m_requestorNode;
+    uint32_t m_size;
+
+    StabilizeReq m_stabilizeReq;
+    StabilizeRsp m_stabilizeRsp;
+    HeartbeatReq m_heartbeatReq;
+    HeartbeatRsp m_heartbeatRsp;
+    LookupReq m_lookupReq;
+    /**
+     *  \endcond
+     */
+}; //class ChordMessageView
+
+static inline std::ostream& operator<< (std::ostream& os, const ChordMessageView& message)
+{
+  message.Print (os);
+  return os;
+}
+
+} //namespace ns3
+
+#endif //CHORD_MESSAGE_VIEW_H
@@ -29,6 +29,7 @@ NS_OBJECT_ENSURE_REGISTERED (ChordMessage);
 ChordMessage::ChordMessage ()
 {
   m_transactionId = 0;
+  m_ttl = DEFAULT_CHORD_MESSAGE_TTL;
 }
 
 ChordMessage::~ChordMessage ()
@@ -93,6 +94,21 @@ ChordMessage::GetSerializedSize (void) const
     case LOOKUP_RSP:
       size += m_message.lookupRsp.GetSerializedSize ();
       break;
+    case LOOKUP_BATCH_REQ:
+      size += m_message.lookupBatchReq.GetSerializedSize ();
+      break;
+    case LOOKUP_BATCH_RSP:
+      size += m_message.lookupBatchRsp.GetSerializedSize ();
+      break;
+    case PING_REQ:
+      size += m_message.pingReq.GetSerializedSize ();
+      break;
+    case PING_RSP:
+      size += m_message.pingRsp.GetSerializedSize ();
+      break;
+    case LOOKUP_REFERRAL:
+      size += m_message.lookupReferral.GetSerializedSize ();
+      break;
      case TRACE_RING:
       size += m_message.traceRing.GetSerializedSize ();
       break;
@@ -111,7 +127,7 @@ ChordMessage::Print (std::ostream &os) const
   os << "TransactionId: " << m_transactionId<<"\n";
   os << "Requestor Node: " << "\n";
   m_chordNode->Print (os);
-  os << "TTL : " << m_ttl << "\n";
+  os << "TTL : " << (uint16_t) m_ttl << "\n";
   os << "Payload:: \n";
   switch (m_messageType)
   {
@@ -151,6 +167,21 @@ ChordMessage::Print (std::ostream &os) const
     case LOOKUP_RSP:
       m_message.lookupRsp.Print (os);
       break;
+    case LOOKUP_BATCH_REQ:
+      m_message.lookupBatchReq.Print (os);
+      break;
+    case LOOKUP_BATCH_RSP:
+      m_message.lookupBatchRsp.Print (os);
+      break;
+    case PING_REQ:
+      m_message.pingReq.Print (os);
+      break;
+    case PING_RSP:
+      m_message.pingRsp.Print (os);
+      break;
+    case LOOKUP_REFERRAL:
+      m_message.lookupReferral.Print (os);
+      break;
     case TRACE_RING:
       m_message.traceRing.Print (os);
       break;
@@ -206,6 +237,21 @@ ChordMessage::Serialize (Buffer::Iterator start) const
     case LOOKUP_RSP:
       m_message.lookupRsp.Serialize (i);
       break;
+    case LOOKUP_BATCH_REQ:
+      m_message.lookupBatchReq.Serialize (i);
+      break;
+    case LOOKUP_BATCH_RSP:
+      m_message.lookupBatchRsp.Serialize (i);
+      break;
+    case PING_REQ:
+      m_message.pingReq.Serialize (i);
+      break;
+    case PING_RSP:
+      m_message.pingRsp.Serialize (i);
+      break;
+    case LOOKUP_REFERRAL:
+      m_message.lookupReferral.Serialize (i);
+      break;
     case TRACE_RING:
       m_message.traceRing.Serialize (i);
       break;
@@ -264,6 +310,21 @@ ChordMessage::Deserialize (Buffer::Iterator start)
     case LOOKUP_RSP:
       size += m_message.lookupRsp.Deserialize (i);
       break;
+    case LOOKUP_BATCH_REQ:
+      size += m_message.lookupBatchReq.Deserialize (i);
+      break;
+    case LOOKUP_BATCH_RSP:
+      size += m_message.lookupBatchRsp.Deserialize (i);
+      break;
+    case PING_REQ:
+      size += m_message.pingReq.Deserialize (i);
+      break;
+    case PING_RSP:
+      size += m_message.pingRsp.Deserialize (i);
+      break;
+    case LOOKUP_REFERRAL:
+      size += m_message.lookupReferral.Deserialize (i);
+      break;
     case TRACE_RING:
       size += m_message.traceRing.Deserialize (i);
       break;
@@ -526,7 +587,12 @@ uint32_t
 ChordMessage::FingerRsp::GetSerializedSize (void) const
 {
   uint32_t size;
-  size = requestedIdentifier->GetSerializedSize() + fingerNode->GetSerializedSize();
+  size = requestedIdentifier->GetSerializedSize() + fingerNode->GetSerializedSize() + sizeof (uint8_t);
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    Ptr<ChordNode> node = *nodeIter;
+    size = size + node->GetSerializedSize();
+  }
   return size; 
 }
 
@@ -537,6 +603,14 @@ ChordMessage::FingerRsp::Print (std::ostream &os) const
   os << "requestedIdentifier: " << requestedIdentifier << "\n";
   os << "Finger Node: " << "\n";
   fingerNode->Print (os);
+  os << "successorListSize: " << successorListSize << "\n";
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    Ptr<ChordNode> node = *nodeIter;
+    os << "***\n";
+    os << "Successor Node: " << "\n";
+    node->Print (os);
+  }
 }
 
 void
@@ -544,6 +618,14 @@ ChordMessage::FingerRsp::Serialize (Buffer::Iterator &start) const
 {
   requestedIdentifier->Serialize(start);
   fingerNode->Serialize (start);
+  //Write successor list size
+  start.WriteU8(successorListSize);
+  //Write entire list
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    Ptr<ChordNode> node = *nodeIter;
+    node->Serialize (start);
+  }
 }
 
 uint32_t
@@ -553,6 +635,15 @@ ChordMessage::FingerRsp::Deserialize (Buffer::Iterator &start)
   requestedIdentifier->Deserialize(start);
   fingerNode = Create<ChordNode> ();
   fingerNode->Deserialize (start);
+  //Deserialize successor list
+  successorListSize = start.ReadU8 ();
+  for (int i=0; i<successorListSize; i++)
+  {
+    //Store in list
+    Ptr<ChordNode> chordNode = Create<ChordNode> ();
+    chordNode->Deserialize (start);
+    successorList.push_back (chordNode);
+  }
   return GetSerializedSize ();
 }
 /* HEARTBEAT_REQ */
@@ -650,7 +741,7 @@ uint32_t
 ChordMessage::LookupReq::GetSerializedSize (void) const
 {
   uint32_t size;
-  size = requestedIdentifier->GetSerializedSize();
+  size = requestedIdentifier->GetSerializedSize() + sizeof (uint8_t) + sizeof (uint8_t);
   return size; 
 }
 
@@ -659,12 +750,16 @@ ChordMessage::LookupReq::Print (std::ostream &os) const
 {
   os << "LookupReq: \n";
   os << "requestedIdentifier: " << requestedIdentifier << "\n";
+  os << "numSuccessors: " << (uint16_t) numSuccessors << "\n";
+  os << "lookupMode: " << (uint16_t) lookupMode << "\n";
 }
 
 void
 ChordMessage::LookupReq::Serialize (Buffer::Iterator &start) const
 {
   requestedIdentifier->Serialize(start);
+  start.WriteU8 (numSuccessors);
+  start.WriteU8 (lookupMode);
 }
 
 uint32_t
@@ -672,6 +767,8 @@ ChordMessage::LookupReq::Deserialize (Buffer::Iterator &start)
 {
   requestedIdentifier = Create<ChordIdentifier> ();
   requestedIdentifier->Deserialize(start);
+  numSuccessors = start.ReadU8 ();
+  lookupMode = start.ReadU8 ();
   return GetSerializedSize ();
 }
 /* LOOKUP_RSP */
@@ -679,7 +776,11 @@ uint32_t
 ChordMessage::LookupRsp::GetSerializedSize (void) const
 {
   uint32_t size;
-  size = resolvedNode->GetSerializedSize();
+  size = resolvedNode->GetSerializedSize() + predecessorIdentifier->GetSerializedSize() + sizeof (uint8_t);
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    size = size + (*nodeIter)->GetSerializedSize();
+  }
   return size; 
 }
 
@@ -689,12 +790,26 @@ ChordMessage::LookupRsp::Print (std::ostream &os) const
   os << "LookupRsp: \n";
   os << "Resolved Node: " << "\n";
   resolvedNode->Print (os);
+  os << "predecessorIdentifier: " << predecessorIdentifier << "\n";
+  os << "successorListSize: " << (uint16_t) successorListSize << "\n";
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    os << "***\n";
+    os << "Successor Node: " << "\n";
+    (*nodeIter)->Print (os);
+  }
 }
 
 void
 ChordMessage::LookupRsp::Serialize (Buffer::Iterator &start) const
 {
   resolvedNode->Serialize (start);
+  predecessorIdentifier->Serialize (start);
+  start.WriteU8 (successorListSize);
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = successorList.begin(); nodeIter != successorList.end(); nodeIter++)
+  {
+    (*nodeIter)->Serialize (start);
+  }
 }
 
 uint32_t
@@ -702,6 +817,216 @@ ChordMessage::LookupRsp::Deserialize (Buffer::Iterator &start)
 {
   resolvedNode = Create<ChordNode> ();
   resolvedNode->Deserialize (start);
+  predecessorIdentifier = Create<ChordIdentifier> ();
+  predecessorIdentifier->Deserialize (start);
+  successorListSize = start.ReadU8 ();
+  for (int i=0; i<successorListSize; i++)
+  {
+    Ptr<ChordNode> chordNode = Create<ChordNode> ();
+    chordNode->Deserialize (start);
+    successorList.push_back (chordNode);
+  }
+  return GetSerializedSize ();
+}
+
+/* LOOKUP_BATCH_REQ */
+uint32_t
+ChordMessage::LookupBatchReq::GetSerializedSize (void) const
+{
+  uint32_t size;
+  size = sizeof (uint16_t);
+  for (std::vector<Ptr<ChordIdentifier> >::const_iterator idIter = requestedIdentifiers.begin(); idIter != requestedIdentifiers.end(); idIter++)
+  {
+    size = size + (*idIter)->GetSerializedSize();
+  }
+  return size; 
+}
+
+void
+ChordMessage::LookupBatchReq::Print (std::ostream &os) const
+{
+  os << "LookupBatchReq: \n";
+  os << "numIdentifiers: " << requestedIdentifiers.size() << "\n";
+  for (std::vector<Ptr<ChordIdentifier> >::const_iterator idIter = requestedIdentifiers.begin(); idIter != requestedIdentifiers.end(); idIter++)
+  {
+    os << "requestedIdentifier: " << *idIter << "\n";
+  }
+}
+
+void
+ChordMessage::LookupBatchReq::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU16 (requestedIdentifiers.size());
+  for (std::vector<Ptr<ChordIdentifier> >::const_iterator idIter = requestedIdentifiers.begin(); idIter != requestedIdentifiers.end(); idIter++)
+  {
+    (*idIter)->Serialize(start);
+  }
+}
+
+uint32_t
+ChordMessage::LookupBatchReq::Deserialize (Buffer::Iterator &start)
+{
+  uint16_t numIdentifiers = start.ReadNtohU16 ();
+  requestedIdentifiers.clear ();
+  requestedIdentifiers.reserve (numIdentifiers);
+  for (uint16_t i=0; i<numIdentifiers; i++)
+  {
+    Ptr<ChordIdentifier> identifier = Create<ChordIdentifier> ();
+    identifier->Deserialize(start);
+    requestedIdentifiers.push_back (identifier);
+  }
+  return GetSerializedSize ();
+}
+/* LOOKUP_BATCH_RSP */
+uint32_t
+ChordMessage::LookupBatchRsp::GetSerializedSize (void) const
+{
+  uint32_t size;
+  size = resolvedNode->GetSerializedSize() + sizeof (uint16_t);
+  for (std::vector<Ptr<ChordIdentifier> >::const_iterator idIter = resolvedIdentifiers.begin(); idIter != resolvedIdentifiers.end(); idIter++)
+  {
+    size = size + (*idIter)->GetSerializedSize();
+  }
+  return size; 
+}
+
+void
+ChordMessage::LookupBatchRsp::Print (std::ostream &os) const
+{
+  os << "LookupBatchRsp: \n";
+  os << "Resolved Node: " << "\n";
+  resolvedNode->Print (os);
+  os << "numIdentifiers: " << resolvedIdentifiers.size() << "\n";
+  for (std::vector<Ptr<ChordIdentifier> >::const_iterator idIter = resolvedIdentifiers.begin(); idIter != resolvedIdentifiers.end(); idIter++)
+  {
+    os << "resolvedIdentifier: " << *idIter << "\n";
+  }
+}
+
+void
+ChordMessage::LookupBatchRsp::Serialize (Buffer::Iterator &start) const
+{
+  resolvedNode->Serialize (start);
+  start.WriteHtonU16 (resolvedIdentifiers.size());
+  for (std::vector<Ptr<ChordIdentifier> >::const_iterator idIter = resolvedIdentifiers.begin(); idIter != resolvedIdentifiers.end(); idIter++)
+  {
+    (*idIter)->Serialize(start);
+  }
+}
+
+uint32_t
+ChordMessage::LookupBatchRsp::Deserialize (Buffer::Iterator &start)
+{
+  resolvedNode = Create<ChordNode> ();
+  resolvedNode->Deserialize (start);
+  uint16_t numIdentifiers = start.ReadNtohU16 ();
+  resolvedIdentifiers.clear ();
+  resolvedIdentifiers.reserve (numIdentifiers);
+  for (uint16_t i=0; i<numIdentifiers; i++)
+  {
+    Ptr<ChordIdentifier> identifier = Create<ChordIdentifier> ();
+    identifier->Deserialize(start);
+    resolvedIdentifiers.push_back (identifier);
+  }
+  return GetSerializedSize ();
+}
+
+/* PING_REQ */
+uint32_t
+ChordMessage::PingReq::GetSerializedSize (void) const
+{
+  uint32_t size;
+  size = sizeof (uint64_t);
+  return size; 
+}
+
+void
+ChordMessage::PingReq::Print (std::ostream &os) const
+{
+  os << "PingReq: \n";
+  os << "timestamp: " << timestamp << "\n";
+}
+
+void
+ChordMessage::PingReq::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU64 (timestamp.GetNanoSeconds ());
+}
+
+uint32_t
+ChordMessage::PingReq::Deserialize (Buffer::Iterator &start)
+{
+  timestamp = NanoSeconds (start.ReadNtohU64 ());
+  return GetSerializedSize ();
+}
+
+/* PING_RSP */
+uint32_t
+ChordMessage::PingRsp::GetSerializedSize (void) const
+{
+  uint32_t size;
+  size = sizeof (uint64_t) + respondingNode->GetSerializedSize();
+  return size; 
+}
+
+void
+ChordMessage::PingRsp::Print (std::ostream &os) const
+{
+  os << "PingRsp: \n";
+  os << "timestamp: " << timestamp << "\n";
+  os << "Responding Node: " << "\n";
+  respondingNode->Print (os);
+}
+
+void
+ChordMessage::PingRsp::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU64 (timestamp.GetNanoSeconds ());
+  respondingNode->Serialize (start);
+}
+
+uint32_t
+ChordMessage::PingRsp::Deserialize (Buffer::Iterator &start)
+{
+  timestamp = NanoSeconds (start.ReadNtohU64 ());
+  respondingNode = Create<ChordNode> ();
+  respondingNode->Deserialize (start);
+  return GetSerializedSize ();
+}
+
+/* LOOKUP_REFERRAL */
+uint32_t
+ChordMessage::LookupReferral::GetSerializedSize (void) const
+{
+  uint32_t size;
+  size = referringNode->GetSerializedSize() + nextHopNode->GetSerializedSize();
+  return size; 
+}
+
+void
+ChordMessage::LookupReferral::Print (std::ostream &os) const
+{
+  os << "LookupReferral: \n";
+  os << "Referring Node: " << "\n";
+  referringNode->Print (os);
+  os << "Next Hop Node: " << "\n";
+  nextHopNode->Print (os);
+}
+
+void
+ChordMessage::LookupReferral::Serialize (Buffer::Iterator &start) const
+{
+  referringNode->Serialize (start);
+  nextHopNode->Serialize (start);
+}
+
+uint32_t
+ChordMessage::LookupReferral::Deserialize (Buffer::Iterator &start)
+{
+  referringNode = Create<ChordNode> ();
+  referringNode->Deserialize (start);
+  nextHopNode = Create<ChordNode> ();
+  nextHopNode->Deserialize (start);
   return GetSerializedSize ();
 }
 
@@ -27,6 +27,9 @@
 #include "chord-identifier.h"
 #include "chord-node.h"
 
+/* Hops a request may be forwarded before it is dropped */
+#define DEFAULT_CHORD_MESSAGE_TTL 64
+
 namespace ns3 {
 
  /**  
@@ -50,9 +53,21 @@ class ChordMessage : public Header
       LOOKUP_RSP = 10,
       LEAVE_REQ = 11,
       LEAVE_RSP = 12,
+      LOOKUP_BATCH_REQ = 13,
+      LOOKUP_BATCH_RSP = 14,
+      PING_REQ = 15,
+      PING_RSP = 16,
+      LOOKUP_REFERRAL = 17,
       TRACE_RING = 20,
     };
 
+    enum LookupMode {
+      //Hops forward request, owner replies to requestor
+      RECURSIVE_LOOKUP = 0,
+      //Hops refer requestor to next hop
+      ITERATIVE_LOOKUP = 1,
+    };
+
     ChordMessage ();
     virtual ~ChordMessage ();
 
@@ -76,7 +91,8 @@ class ChordMessage : public Header
     /**
      *  \brief Sets TTL
      *  \param ttl time to live before request is dropped
-     *  Coming Soon!
+     *
+     *  Requests start with DEFAULT_CHORD_MESSAGE_TTL; ChordIpv4 decrements it on each forward
      */
     void SetTTL(uint8_t ttl)
     {
@@ -249,6 +265,13 @@ class ChordMessage : public Header
         :  fingerNode   :
         |               |
         +-+-+-+-+-+-+-+-+
+        |successorList- |
+        |     Size      |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        : successorNode :
+        |     List      |
+        +-+-+-+-+-+-+-+-+
       
         HEARTBEAT_REQ Payload:
         0 1 2 3 4 5 6 7 8 
@@ -275,7 +298,11 @@ class ChordMessage : public Header
         +-+-+-+-+-+-+-+-+
         |               |
         : requestor-    :
-        | Identifier    |
+        | Identifier    :
+        +-+-+-+-+-+-+-+-+
+        |numSuccessors  |
+        +-+-+-+-+-+-+-+-+
+        |  lookupMode   |
         +-+-+-+-+-+-+-+-+
      
         LOOKUP_RSP Payload:
@@ -285,6 +312,77 @@ class ChordMessage : public Header
         : resolvedNode  :
         |               |
         +-+-+-+-+-+-+-+-+
+        |               |
+        : predecessor-  :
+        | Identifier    |
+        +-+-+-+-+-+-+-+-+
+        |successorList- |
+        |     Size      |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        : successorNode :
+        |     List      |
+        +-+-+-+-+-+-+-+-+
+     
+        LOOKUP_BATCH_REQ Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |  numIdentif-  |
+        +    iers       +
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        : requested-    :
+        | Identifiers   |
+        +-+-+-+-+-+-+-+-+
+     
+        LOOKUP_BATCH_RSP Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |               |
+        : resolvedNode  :
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |  numIdentif-  |
+        +    iers       +
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        : resolved-     :
+        | Identifiers   |
+        +-+-+-+-+-+-+-+-+
+     
+        PING_REQ Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :   timestamp   :
+        |               |
+        +-+-+-+-+-+-+-+-+
+     
+        PING_RSP Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :   timestamp   :
+        |  (echoed)     |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :respondingNode :
+        |               |
+        +-+-+-+-+-+-+-+-+
+     
+        LOOKUP_REFERRAL Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |               |
+        : referringNode :
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :  nextHopNode  :
+        |               |
+        +-+-+-+-+-+-+-+-+
      
         TRACE_RING Payload:
         0 1 2 3 4 5 6 7 8 
@@ -353,6 +451,9 @@ class ChordMessage : public Header
     {
       Ptr<ChordIdentifier> requestedIdentifier;
       Ptr<ChordNode> fingerNode;
+      //Successors of fingerNode (proximity neighbor selection candidates)
+      uint8_t successorListSize;
+      std::vector<Ptr<ChordNode> > successorList;
       void Print (std::ostream &os) const; 
       uint32_t GetSerializedSize (void) const;
       void Serialize (Buffer::Iterator &start) const;
@@ -382,6 +483,10 @@ class ChordMessage : public Header
     struct LookupReq
     {
       Ptr<ChordIdentifier> requestedIdentifier;
+      //Number of successors of resolved node to return (DHash replicas)
+      uint8_t numSuccessors;
+      //ChordMessage::LookupMode
+      uint8_t lookupMode;
       void Print (std::ostream &os) const; 
       uint32_t GetSerializedSize (void) const;
       void Serialize (Buffer::Iterator &start) const;
@@ -391,6 +496,62 @@ class ChordMessage : public Header
     struct LookupRsp
     {
       Ptr<ChordNode> resolvedNode;
+      //Predecessor of resolved node, resolved node owns (predecessor, resolvedNode]
+      Ptr<ChordIdentifier> predecessorIdentifier;
+      uint8_t successorListSize;
+      std::vector<Ptr<ChordNode> > successorList;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct LookupBatchReq
+    {
+      std::vector<Ptr<ChordIdentifier> > requestedIdentifiers;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct LookupBatchRsp
+    {
+      Ptr<ChordNode> resolvedNode;
+      std::vector<Ptr<ChordIdentifier> > resolvedIdentifiers;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+ 
+    struct PingReq
+    {
+      //Send time at requestor
+      Time timestamp;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct PingRsp
+    {
+      //Send time of PingReq, echoed
+      Time timestamp;
+      Ptr<ChordNode> respondingNode;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct LookupReferral
+    {
+      //Node which was asked (iterative lookup)
+      Ptr<ChordNode> referringNode;
+      //Node to ask next
+      Ptr<ChordNode> nextHopNode;
       void Print (std::ostream &os) const; 
       uint32_t GetSerializedSize (void) const;
       void Serialize (Buffer::Iterator &start) const;
@@ -444,6 +605,11 @@ class ChordMessage : public Header
       HeartbeatRsp heartbeatRsp;
       LookupReq lookupReq;
       LookupRsp lookupRsp;
+      LookupBatchReq lookupBatchReq;
+      LookupBatchRsp lookupBatchRsp;
+      PingReq pingReq;
+      PingRsp pingRsp;
+      LookupReferral lookupReferral;
       TraceRing traceRing;
     } m_message;
     /**
@@ -644,6 +810,86 @@ class ChordMessage : public Header
       return m_message.lookupRsp;
     } 
 
+    /**
+     *  \returns LookupBatchReq structure
+     */    
+    LookupBatchReq& GetLookupBatchReq ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = LOOKUP_BATCH_REQ;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == LOOKUP_BATCH_REQ);
+      }
+      return m_message.lookupBatchReq;
+    }
+
+    /**
+     *  \returns LookupBatchRsp structure
+     */    
+    LookupBatchRsp& GetLookupBatchRsp ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = LOOKUP_BATCH_RSP;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == LOOKUP_BATCH_RSP);
+      }
+      return m_message.lookupBatchRsp;
+    }
+
+    /**
+     *  \returns PingReq structure
+     */    
+    PingReq& GetPingReq ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = PING_REQ;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == PING_REQ);
+      }
+      return m_message.pingReq;
+    }
+
+    /**
+     *  \returns PingRsp structure
+     */    
+    PingRsp& GetPingRsp ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = PING_RSP;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == PING_RSP);
+      }
+      return m_message.pingRsp;
+    }
+
+    /**
+     *  \returns LookupReferral structure
+     */    
+    LookupReferral& GetLookupReferral ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = LOOKUP_REFERRAL;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == LOOKUP_REFERRAL);
+      }
+      return m_message.lookupReferral;
+    }
+
     /**
      *  \returns TraceRing structure
      */    
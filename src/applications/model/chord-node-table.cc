@@ -26,6 +26,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("ChordNodeTable");
 
 ChordNodeTable::ChordNodeTable ()
+  : m_routingTable (0)
 {
 }
 
@@ -37,7 +38,10 @@ void
 ChordNodeTable::DoDispose()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  ReleaseRoutes ();
   m_nodeMap.clear();
+  m_routableNodeMap.clear();
+  m_timestampMap.clear();
   m_nodeNameMap.clear();
 }
 
@@ -45,19 +49,36 @@ void
 ChordNodeTable::UpdateNode(Ptr<ChordNode> &chordNode)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  ChordIdentifier chordIdentifier = *(PeekPointer(chordNode->GetChordIdentifier()));
-  ChordNodeMap::iterator iterator = m_nodeMap.find (chordIdentifier);
+  ChordKey chordKey = chordNode->GetChordIdentifier()->GetChordKey();
+  ChordNodeMap::iterator iterator = m_nodeMap.find (chordKey);
   if (iterator == m_nodeMap.end())
   {
+    if (m_routingTable != 0)
+    {
+      //Share entry with other tables of this node
+      chordNode = m_routingTable->AddRoute (chordNode);
+    }
     //add it
-    m_nodeMap.insert(std::make_pair(chordIdentifier, chordNode));
-    //Timestamp
-    chordNode->SetTimestamp(Simulator::Now());
+    iterator = m_nodeMap.insert(std::make_pair(chordKey, chordNode)).first;
+  }
+  else if (iterator->second->GetIpAddress() != chordNode->GetIpAddress() || iterator->second->GetPort() != chordNode->GetPort())
+  {
+    //Identifier now reached via another node (finger entries). Entry may be shared with other vNodes, update it in place.
+    iterator->second->SetAddress (chordNode);
+    iterator->second->SetRoutable (chordNode->GetRoutable());
+    chordNode = iterator->second;
+  }
+  //Timestamp, kept per table (shared entry is not refreshed for other vNodes)
+  m_timestampMap[chordKey] = Simulator::Now();
+
+  //Routable index
+  if (iterator->second->GetRoutable())
+  {
+    m_routableNodeMap[chordKey] = iterator->second;
   }
   else
   {
-    //Update Time stamp
-    iterator->second->SetTimestamp(Simulator::Now());  
+    m_routableNodeMap.erase (chordKey);
   }
   
   //Name map
@@ -85,8 +106,8 @@ bool
 ChordNodeTable::FindNode (Ptr<ChordIdentifier> &chordId, Ptr<ChordNode> &chordNode)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  ChordIdentifier chordIdentifier = *(PeekPointer(chordId));
-  ChordNodeMap::iterator iterator = m_nodeMap.find (chordIdentifier);
+  ChordKey chordKey = chordId->GetChordKey();
+  ChordNodeMap::iterator iterator = m_nodeMap.find (chordKey);
   if (iterator == m_nodeMap.end())
   {
     return false;
@@ -112,8 +133,8 @@ void
 ChordNodeTable::RemoveNode (Ptr<ChordIdentifier> &chordId)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  ChordIdentifier chordIdentifier = *(PeekPointer(chordId));
-  ChordNodeMap::iterator iterator = m_nodeMap.find (chordIdentifier);
+  ChordKey chordKey = chordId->GetChordKey();
+  ChordNodeMap::iterator iterator = m_nodeMap.find (chordKey);
   if (iterator == m_nodeMap.end())
   {
     return;
@@ -129,6 +150,12 @@ ChordNodeTable::RemoveNode (Ptr<ChordIdentifier> &chordId)
     }
   }
 
+  if (m_routingTable != 0)
+  {
+    m_routingTable->RemoveRoute (chordKey);
+  }
+  m_routableNodeMap.erase (chordKey);
+  m_timestampMap.erase (chordKey);
   m_nodeMap.erase (iterator);
 }
 
@@ -143,84 +170,81 @@ ChordNodeTable::RemoveNode (std::string &name)
   }
 
   //remove from node table
-  ChordNodeMap::iterator iter = m_nodeMap.find (iterator->second->GetChordIdentifier());
+  ChordKey chordKey = iterator->second->GetChordIdentifier()->GetChordKey();
+  ChordNodeMap::iterator iter = m_nodeMap.find (chordKey);
   if (iter != m_nodeMap.end())
   {
+    if (m_routingTable != 0)
+    {
+      m_routingTable->RemoveRoute (chordKey);
+    }
     m_nodeMap.erase (iter);
   }
+  m_routableNodeMap.erase (chordKey);
+  m_timestampMap.erase (chordKey);
 
   m_nodeNameMap.erase (iterator);
 }
 
+void
+ChordNodeTable::SetRoutable (Ptr<ChordNode> chordNode, bool routable)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  chordNode->SetRoutable (routable);
+  ChordKey chordKey = chordNode->GetChordIdentifier()->GetChordKey();
+  ChordNodeMap::iterator iterator = m_nodeMap.find (chordKey);
+  if (iterator == m_nodeMap.end())
+  {
+    //Not in table, UpdateNode will index it on insertion
+    return;
+  }
+  if (routable)
+  {
+    m_routableNodeMap[chordKey] = iterator->second;
+  }
+  else
+  {
+    m_routableNodeMap.erase (chordKey);
+  }
+}
+
 /*  Logic: We need to find node whose key is nearest to the requested key. Our aim is to minimize lookup hops.
  *
- *  Step 1: Iterate for all nodes and maximize identifier for nodes which satisfy: node lies inBetween (0,key] <closestNodeOnRight>
- *  Step 2: If none found in step 1, send to node with highest key number <closestNodeOnLeft>
+ *  m_routableNodeMap holds only routable nodes, ordered on identifier. upper_bound gives first node > key, so its
+ *  predecessor in map is the closest node in (0,key] <closestNodeOnRight>. If key precedes all nodes, we wrap around
+ *  to node with highest key number <closestNodeOnLeft>.
+ *
+ *  Nodes whose routable flag was cleared without going through SetRoutable are dropped from index as they are met.
  */
 
 bool
 ChordNodeTable::FindNearestNode (Ptr<ChordIdentifier> &targetIdentifier, Ptr<ChordNode> &chordNode)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-  Ptr<ChordNode> closestNodeOnRight = 0;
-  Ptr<ChordNode> closestNodeOnLeft = 0;
-  Ptr<ChordNode> nearestNode = 0;
-  Ptr<ChordIdentifier> zeroIdentifier = Create<ChordIdentifier> ();
-  uint8_t* key;
-  key = (uint8_t *) malloc(sizeof(uint8_t) * targetIdentifier->GetNumBytes());
-  memset (key, 0 , targetIdentifier->GetNumBytes());
-  zeroIdentifier->SetKey (key, targetIdentifier->GetNumBytes());
-  free (key);
+  return FindNearestNode (targetIdentifier->GetChordKey(), chordNode);
+}
 
-  //Step: 1
-  for(ChordNodeMap::iterator nodeIter = m_nodeMap.begin(); nodeIter != m_nodeMap.end(); nodeIter++)
-  {
-    Ptr<ChordNode> node = (*nodeIter).second;
-    if (node->GetRoutable() == false)
-      continue;
-    if (node->GetChordIdentifier()->IsInBetween(zeroIdentifier, targetIdentifier))
-    {
-      if (closestNodeOnRight == 0)
-      {
-        //Initialize
-        closestNodeOnRight = node;
-      }
-      else if (node->GetChordIdentifier()->IsGreater(closestNodeOnRight->GetChordIdentifier()))
-      {
-        //Maximize
-        closestNodeOnRight = node;
-      }
-    }
-    //Store greatest key node as well
-    if (closestNodeOnLeft == 0)
-    {
-      //Initialize
-      closestNodeOnLeft = node;
-    }
-    else if (node->GetChordIdentifier()->IsGreater(closestNodeOnLeft->GetChordIdentifier()))
-    {
-      //Maximize
-      closestNodeOnLeft = node;
-    }
-  }
-  //Step 2:
-  if (closestNodeOnRight == 0)
+bool
+ChordNodeTable::FindNearestNode (const ChordKey &targetKey, Ptr<ChordNode> &chordNode)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ChordNodeMap::iterator iterator = m_routableNodeMap.upper_bound (targetKey);
+  while (!m_routableNodeMap.empty())
   {
-    if (closestNodeOnLeft != 0)
+    //Step counter-clockwise, wrap around at lowest identifier
+    if (iterator == m_routableNodeMap.begin())
     {
-      nearestNode = closestNodeOnLeft;
+      iterator = m_routableNodeMap.end();
     }
-    else
+    iterator--;
+    if (iterator->second->GetRoutable())
     {
-      return false;
+      chordNode = iterator->second;
+      return true;
     }
+    //Stale entry
+    m_routableNodeMap.erase (iterator++);
   }
-  else if (closestNodeOnRight != 0)
-  {
-    nearestNode = closestNodeOnRight;
-  }
-  chordNode = nearestNode;
-  return true;
+  return false;
 }
 
 uint32_t
@@ -241,7 +265,10 @@ void
 ChordNodeTable::Clear()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  ReleaseRoutes ();
   m_nodeMap.clear();
+  m_routableNodeMap.clear();
+  m_timestampMap.clear();
   m_nodeNameMap.clear();
 }
 
@@ -250,10 +277,16 @@ ChordNodeTable::Audit (Time auditInterval)
 {
   for (ChordNodeMap::iterator nodeIter = m_nodeMap.begin(); nodeIter != m_nodeMap.end(); )
   {
-    Ptr<ChordNode> node = (*nodeIter).second;
-    if (node->GetTimestamp().GetMilliSeconds() + auditInterval.GetMilliSeconds() < Simulator::Now().GetMilliSeconds())
+    Time timestamp = m_timestampMap[nodeIter->first];
+    if (timestamp.GetMilliSeconds() + auditInterval.GetMilliSeconds() < Simulator::Now().GetMilliSeconds())
     {
       //Remove stale entry
+      if (m_routingTable != 0)
+      {
+        m_routingTable->RemoveRoute (nodeIter->first);
+      }
+      m_routableNodeMap.erase (nodeIter->first);
+      m_timestampMap.erase (nodeIter->first);
       m_nodeMap.erase (nodeIter++);
     }
     else
@@ -261,5 +294,37 @@ ChordNodeTable::Audit (Time auditInterval)
   }
 }
 
+void
+ChordNodeTable::SetRoutingTable (ChordRoutingTable *routingTable)
+{
+  ReleaseRoutes ();
+  m_routingTable = routingTable;
+  if (m_routingTable == 0)
+  {
+    return;
+  }
+  for (ChordNodeMap::iterator nodeIter = m_nodeMap.begin(); nodeIter != m_nodeMap.end(); nodeIter++)
+  {
+    nodeIter->second = m_routingTable->AddRoute (nodeIter->second);
+    if (m_routableNodeMap.find (nodeIter->first) != m_routableNodeMap.end())
+    {
+      m_routableNodeMap[nodeIter->first] = nodeIter->second;
+    }
+  }
+}
+
+void
+ChordNodeTable::ReleaseRoutes ()
+{
+  if (m_routingTable == 0)
+  {
+    return;
+  }
+  for (ChordNodeMap::iterator nodeIter = m_nodeMap.begin(); nodeIter != m_nodeMap.end(); nodeIter++)
+  {
+    m_routingTable->RemoveRoute (nodeIter->first);
+  }
+}
+
 } //namespace ns3
 
@@ -21,18 +21,21 @@
 
 #include "chord-identifier.h"
 #include "chord-node.h"
+#include "chord-routing-table.h"
 #include "ns3/object.h"
 #include <map>
 
 namespace ns3 {
 
-typedef std::map<ChordIdentifier, Ptr<ChordNode> > ChordNodeMap;
+typedef std::map<ChordKey, Ptr<ChordNode> > ChordNodeMap;
 typedef std::map<std::string, Ptr<ChordNode> > ChordNodeNameMap;
 
 /**
  *  \ingroup chordipv4
  *  \class ChordNodeTable
  *  \brief Class to store and operate on ChordNode map
+ *
+ *  Map is ordered on fixed width ChordKey of node identifiers, so lookups do not copy or allocate identifiers.
  */
 
 class ChordNodeTable : public Object
@@ -48,7 +51,8 @@ class ChordNodeTable : public Object
      *  \brief Updates ChordNode in map
      *  \param Ptr to ChordNode
      *
-     *  Updates timestamp of already existing ChordNode with same identifier or adds new ChordNode to map
+     *  Updates timestamp of already existing ChordNode with same identifier or adds new ChordNode to map. If address or port
+     *  changed, existing ChordNode is updated in place (it may be shared through ChordRoutingTable) and returned in chordNode.
      */
     void UpdateNode (Ptr<ChordNode> &ChordNode);
     /**
@@ -75,18 +79,44 @@ class ChordNodeTable : public Object
      *  \param name Name of ChordNode
      */
     void RemoveNode (std::string &name);
+    /**
+     *  \brief Marks ChordNode as routable/unroutable and updates routable index
+     *  \param chordNode Ptr to ChordNode
+     *  \param routable true if ChordNode can be used for routing
+     *
+     *  Routability of nodes stored in table must be changed through this method, so that FindNearestNode stays consistent
+     */
+    void SetRoutable (Ptr<ChordNode> chordNode, bool routable);
     /**
      *  \brief Finds nearest ChordNode to the given identifier, taken on a circular space
      *  \param targetIdentifier Ptr to target ChordIdentifier
      *  \param chordNode Ptr to ChordNode (return result)
      *  \returns true on success, otherwise false (if no ChordNode in map is routable)
+     *
+     *  Returns routable ChordNode with greatest identifier not exceeding target, wrapping around to greatest identifier in table.
+     *  Runs in O(log n) using ring-ordered routable index.
      */
     bool FindNearestNode (Ptr<ChordIdentifier> &targetIdentifier, Ptr<ChordNode> &chordNode);
     /**
-     *  \brief Removes all ChordNode's which have not been updated since auditInterval
+     *  \brief Finds nearest ChordNode to the given key, taken on a circular space
+     *  \param targetKey Target ChordKey
+     *  \param chordNode Ptr to ChordNode (return result)
+     *  \returns true on success, otherwise false (if no ChordNode in map is routable)
+     */
+    bool FindNearestNode (const ChordKey &targetKey, Ptr<ChordNode> &chordNode);
+    /**
+     *  \brief Removes all ChordNode's which have not been updated through this table since auditInterval
      *  \param auditInterval audit interval
      */
     void Audit (Time auditInterval);
+    /**
+     *  \brief Registers entries of this table in node-level routing table
+     *  \param routingTable Pointer to ChordRoutingTable, or 0 to stop sharing
+     *
+     *  Entries are shared with other tables using the same ChordRoutingTable and their references are dropped as they are
+     *  removed from this table. Routing table must outlive this table, or be detached (0) first.
+     */
+    void SetRoutingTable (ChordRoutingTable *routingTable);
     /**
      *  \brief Clears ChordNode map
      */
@@ -106,8 +136,13 @@ class ChordNodeTable : public Object
     /**
      *  \cond
      */
+    void ReleaseRoutes ();
+
     ChordNodeMap m_nodeMap;
+    ChordNodeMap m_routableNodeMap;
+    std::map<ChordKey, Time> m_timestampMap;
     ChordNodeNameMap m_nodeNameMap;
+    ChordRoutingTable *m_routingTable;
     /**
      *  \endcond
      */
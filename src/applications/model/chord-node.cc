@@ -62,6 +62,7 @@ ChordNode::ChordNode ()
 {
   NS_LOG_FUNCTION_NOARGS();
   m_name = "";
+  m_routable = true;
 }
 
 ChordNode::~ChordNode ()
@@ -89,6 +90,15 @@ ChordNode::SetRoutable (bool routable)
   m_routable = routable;
 } 
 
+void
+ChordNode::SetAddress (Ptr<ChordNode> chordNode)
+{
+  m_address = chordNode->GetIpAddress();
+  m_port = chordNode->GetPort();
+  m_applicationPort = chordNode->GetApplicationPort();
+  m_dHashPort = chordNode->GetDHashPort();
+}
+
 bool
 ChordNode::GetRoutable ()
 {
@@ -78,6 +78,11 @@ class ChordNode : public Object
      *  This node will not be selected for routing if this flag is false
      */
     void SetRoutable (bool routable);
+    /**
+     *  \brief Copies address and ports of another ChordNode with same identifier
+     *  \param chordNode Ptr to ChordNode to copy from
+     */
+    void SetAddress (Ptr<ChordNode> chordNode);
 
     //retrieval
     /** 
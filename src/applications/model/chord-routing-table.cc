@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "chord-routing-table.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("ChordRoutingTable");
+
+namespace ns3 {
+
+ChordRoutingTable::ChordRoutingTable ()
+  : m_references (0)
+{
+}
+
+ChordRoutingTable::~ChordRoutingTable ()
+{
+}
+
+Ptr<ChordNode>
+ChordRoutingTable::AddRoute (Ptr<ChordNode> chordNode)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_references++;
+  ChordKey chordKey = chordNode->GetChordIdentifier ()->GetChordKey ();
+  RouteMap::iterator iterator = m_routeMap.find (chordKey);
+  if (iterator == m_routeMap.end ())
+  {
+    RouteEntry entry;
+    entry.chordNode = chordNode;
+    entry.references = 1;
+    m_routeMap.insert (std::make_pair (chordKey, entry));
+    return chordNode;
+  }
+  iterator->second.references++;
+  if (iterator->second.chordNode->GetIpAddress () != chordNode->GetIpAddress () || iterator->second.chordNode->GetPort () != chordNode->GetPort ())
+  {
+    //Identifier now reached via another node (finger entries), update shared entry so all vNodes follow it
+    iterator->second.chordNode->SetAddress (chordNode);
+  }
+  return iterator->second.chordNode;
+}
+
+void
+ChordRoutingTable::RemoveRoute (const ChordKey &chordKey)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  RouteMap::iterator iterator = m_routeMap.find (chordKey);
+  if (iterator == m_routeMap.end ())
+  {
+    return;
+  }
+  m_references--;
+  if (--iterator->second.references == 0)
+  {
+    m_routeMap.erase (iterator);
+  }
+}
+
+bool
+ChordRoutingTable::FindNearestNode (Ptr<ChordIdentifier> targetIdentifier, Ptr<ChordNode> &chordNode)
+{
+  return FindNearestNode (targetIdentifier->GetChordKey (), chordNode);
+}
+
+bool
+ChordRoutingTable::FindNearestNode (const ChordKey &targetKey, Ptr<ChordNode> &chordNode)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_routeMap.empty ())
+  {
+    return false;
+  }
+  RouteMap::iterator iterator = m_routeMap.upper_bound (targetKey);
+  for (uint32_t i = 0; i < m_routeMap.size (); i++)
+  {
+    //Step counter-clockwise, wrap around at lowest identifier
+    if (iterator == m_routeMap.begin ())
+    {
+      iterator = m_routeMap.end ();
+    }
+    iterator--;
+    if (iterator->second.chordNode->GetRoutable ())
+    {
+      chordNode = iterator->second.chordNode;
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+ChordRoutingTable::Clear (void)
+{
+  m_routeMap.clear ();
+  m_references = 0;
+}
+
+uint32_t
+ChordRoutingTable::GetSize (void) const
+{
+  return m_routeMap.size ();
+}
+
+uint32_t
+ChordRoutingTable::GetReferences (void) const
+{
+  return m_references;
+}
+
+} //namespace ns3
@@ -0,0 +1,107 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_ROUTING_TABLE_H
+#define CHORD_ROUTING_TABLE_H
+
+#include <stdint.h>
+#include <map>
+#include "chord-identifier.h"
+#include "chord-node.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordRoutingTable
+ *  \brief Routing entries shared by all ChordVNode(s) of a physical node
+ *
+ *  Finger tables of all vNodes (ChordNodeTable::SetRoutingTable) register their entries here. An entry held by several vNodes
+ *  is stored once (same ChordNode object) and reference counted, and lookups search the fingers of all vNodes at once.
+ *  Liveness is not shared: each ChordNodeTable keeps its own timestamps for Audit.
+ */
+class ChordRoutingTable
+{
+  public:
+    ChordRoutingTable ();
+    ~ChordRoutingTable ();
+
+    /**
+     *  \brief Adds reference to routing entry
+     *  \param chordNode Ptr to ChordNode
+     *  \returns Shared ChordNode stored for identifier of chordNode
+     *
+     *  Existing entry with same identifier is shared. If address or port changed, the shared entry is updated in place.
+     */
+    Ptr<ChordNode> AddRoute (Ptr<ChordNode> chordNode);
+    /**
+     *  \brief Drops reference to routing entry; entry is removed with its last reference
+     *  \param chordKey ChordKey of entry identifier
+     */
+    void RemoveRoute (const ChordKey &chordKey);
+    /**
+     *  \brief Finds nearest routing entry to the given identifier, taken on a circular space
+     *  \param targetIdentifier Ptr to target ChordIdentifier
+     *  \param chordNode Ptr to ChordNode (return result)
+     *  \returns true on success, otherwise false (if no entry is routable)
+     *
+     *  Returns routable ChordNode with greatest identifier not exceeding target, wrapping around to greatest identifier, as
+     *  ChordNodeTable::FindNearestNode.
+     */
+    bool FindNearestNode (Ptr<ChordIdentifier> targetIdentifier, Ptr<ChordNode> &chordNode);
+    /**
+     *  \brief Finds nearest routing entry to the given key, taken on a circular space
+     *  \param targetKey Target ChordKey
+     *  \param chordNode Ptr to ChordNode (return result)
+     *  \returns true on success, otherwise false (if no entry is routable)
+     */
+    bool FindNearestNode (const ChordKey &targetKey, Ptr<ChordNode> &chordNode);
+    /**
+     *  \brief Clears all entries
+     */
+    void Clear (void);
+    /**
+     *  \returns Number of distinct entries held
+     */
+    uint32_t GetSize (void) const;
+    /**
+     *  \returns Number of references held by all vNodes
+     */
+    uint32_t GetReferences (void) const;
+
+  private:
+    /**
+     *  \cond
+     */
+    struct RouteEntry
+    {
+      Ptr<ChordNode> chordNode;
+      uint32_t references;
+    };
+    typedef std::map<ChordKey, RouteEntry> RouteMap;
+
+    RouteMap m_routeMap;
+    uint32_t m_references;
+    /**
+     *  \endcond
+     */
+}; //class ChordRoutingTable
+
+} //namespace ns3
+
+#endif //CHORD_ROUTING_TABLE_H
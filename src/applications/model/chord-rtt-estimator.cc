@@ -0,0 +1,128 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "chord-rtt-estimator.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("ChordRttEstimator");
+
+namespace ns3 {
+
+ChordRttEstimator::ChordRttEstimator ()
+  : m_gain (0.125),
+    m_gain2 (0.25)
+{
+}
+
+ChordRttEstimator::~ChordRttEstimator ()
+{
+}
+
+void
+ChordRttEstimator::Measurement (Ipv4Address address, Time rtt)
+{
+  NS_LOG_FUNCTION (address << rtt);
+  RttMap::iterator iterator = m_rttMap.find (address);
+  if (iterator == m_rttMap.end ())
+  {
+    RttEntry entry;
+    entry.samples = 0;
+    iterator = m_rttMap.insert (std::make_pair (address, entry)).first;
+  }
+  RttEntry &entry = iterator->second;
+  if (entry.samples)
+  {
+    //Not first
+    Time err = rtt - entry.estimatedRtt;
+    entry.estimatedRtt += Seconds (err.GetSeconds () * m_gain);
+    Time difference = Abs (err) - entry.variance;
+    entry.variance += Seconds (difference.GetSeconds () * m_gain2);
+  }
+  else
+  {
+    //First sample
+    entry.estimatedRtt = rtt;
+    entry.variance = Seconds (rtt.GetSeconds () / 2);
+  }
+  entry.samples++;
+  entry.lastMeasurement = Simulator::Now ();
+}
+
+bool
+ChordRttEstimator::GetEstimatedRtt (Ipv4Address address, Time &rtt)
+{
+  RttMap::iterator iterator = m_rttMap.find (address);
+  if (iterator == m_rttMap.end () || iterator->second.samples == 0)
+  {
+    return false;
+  }
+  rtt = iterator->second.estimatedRtt;
+  return true;
+}
+
+bool
+ChordRttEstimator::StartProbe (Ipv4Address address, Time probeInterval)
+{
+  RttMap::iterator iterator = m_rttMap.find (address);
+  if (iterator == m_rttMap.end ())
+  {
+    RttEntry entry;
+    entry.samples = 0;
+    entry.lastProbe = Simulator::Now ();
+    m_rttMap.insert (std::make_pair (address, entry));
+    return true;
+  }
+  if (iterator->second.lastProbe + probeInterval > Simulator::Now ())
+  {
+    return false;
+  }
+  iterator->second.lastProbe = Simulator::Now ();
+  return true;
+}
+
+void
+ChordRttEstimator::Audit (Time auditInterval)
+{
+  for (RttMap::iterator rttIter = m_rttMap.begin (); rttIter != m_rttMap.end (); )
+  {
+    //Node which stopped answering probes, or left
+    Time lastSeen = rttIter->second.samples ? rttIter->second.lastMeasurement : rttIter->second.lastProbe;
+    if (lastSeen + auditInterval < Simulator::Now ())
+    {
+      m_rttMap.erase (rttIter++);
+    }
+    else
+      ++rttIter;
+  }
+}
+
+void
+ChordRttEstimator::Clear (void)
+{
+  m_rttMap.clear ();
+}
+
+uint32_t
+ChordRttEstimator::GetSize (void) const
+{
+  return m_rttMap.size ();
+}
+
+} //namespace ns3
@@ -0,0 +1,101 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_RTT_ESTIMATOR_H
+#define CHORD_RTT_ESTIMATOR_H
+
+#include <stdint.h>
+#include <map>
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordRttEstimator
+ *  \brief Per-node round trip time estimates
+ *
+ *  Keeps a mean-deviation estimate (as ndn::RttMeanDeviation: gain 1/8 on smoothed RTT, 1/4 on deviation) for every remote node
+ *  (Ipv4Address) measured. Samples are fed from request/response timestamps, see ChordMessage PING_REQ/PING_RSP.
+ */
+class ChordRttEstimator
+{
+  public:
+    ChordRttEstimator ();
+    ~ChordRttEstimator ();
+
+    /**
+     *  \brief Adds RTT sample of remote node
+     *  \param address Ipv4Address of remote node
+     *  \param rtt Measured round trip time
+     */
+    void Measurement (Ipv4Address address, Time rtt);
+    /**
+     *  \brief Finds smoothed RTT of remote node
+     *  \param address Ipv4Address of remote node
+     *  \param rtt Smoothed round trip time (return result)
+     *  \returns true if remote node was measured, otherwise false
+     */
+    bool GetEstimatedRtt (Ipv4Address address, Time &rtt);
+    /**
+     *  \brief Records probe to remote node, unless one was already sent within probeInterval
+     *  \param address Ipv4Address of remote node
+     *  \param probeInterval Min time between probes to same node
+     *  \returns true if probe should be sent, otherwise false
+     */
+    bool StartProbe (Ipv4Address address, Time probeInterval);
+    /**
+     *  \brief Removes nodes not measured since auditInterval
+     *  \param auditInterval audit interval
+     */
+    void Audit (Time auditInterval);
+    /**
+     *  \brief Clears all estimates
+     */
+    void Clear (void);
+    /**
+     *  \returns Number of nodes held
+     */
+    uint32_t GetSize (void) const;
+
+  private:
+    /**
+     *  \cond
+     */
+    struct RttEntry
+    {
+      Time estimatedRtt;
+      Time variance;
+      uint32_t samples;
+      Time lastMeasurement;
+      Time lastProbe;
+    };
+    typedef std::map<Ipv4Address, RttEntry> RttMap;
+
+    RttMap m_rttMap;
+    double m_gain;
+    double m_gain2;
+    /**
+     *  \endcond
+     */
+}; //class ChordRttEstimator
+
+} //namespace ns3
+
+#endif //CHORD_RTT_ESTIMATOR_H
@@ -0,0 +1,250 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "chord-timer-wheel.h"
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("ChordTimerWheel");
+
+namespace ns3 {
+
+ChordTimerWheel::ChordTimerWheel ()
+  : m_currentTick (0),
+    m_size (0),
+    m_resolution (MilliSeconds (10)),
+    m_tickEventTick (0),
+    m_inTick (false),
+    m_generation (0)
+{
+}
+
+ChordTimerWheel::~ChordTimerWheel ()
+{
+  Clear ();
+}
+
+void
+ChordTimerWheel::SetResolution (Time resolution)
+{
+  NS_ASSERT (m_size == 0 && resolution.IsStrictlyPositive ());
+  m_resolution = resolution;
+}
+
+Time
+ChordTimerWheel::GetResolution (void) const
+{
+  return m_resolution;
+}
+
+uint32_t
+ChordTimerWheel::GetSize (void) const
+{
+  return m_size;
+}
+
+uint64_t
+ChordTimerWheel::GetNowTick (void) const
+{
+  return Simulator::Now ().GetTimeStep () / m_resolution.GetTimeStep ();
+}
+
+Ptr<EventImpl>
+ChordTimerWheel::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_size == 0)
+  {
+    //Wheel was idle, bring it up to date
+    m_currentTick = GetNowTick ();
+  }
+  //Round deadline up to tick
+  int64_t step = m_resolution.GetTimeStep ();
+  WheelTimer timer;
+  timer.expiryTick = (Simulator::Now ().GetTimeStep () + delay.GetTimeStep () + step - 1) / step;
+  if (timer.expiryTick <= m_currentTick)
+  {
+    timer.expiryTick = m_currentTick + 1;
+  }
+  timer.event = Ptr<EventImpl> (event, false);
+  Insert (timer);
+  m_size++;
+  //Bring tick event forward if needed, never past next cascade point
+  uint64_t tick = std::min<uint64_t> (timer.expiryTick, (m_currentTick | (NUM_SLOTS - 1)) + 1);
+  if (!m_inTick && (!m_tickEvent.IsRunning () || tick < m_tickEventTick))
+  {
+    ScheduleTick (tick);
+  }
+  return timer.event;
+}
+
+void
+ChordTimerWheel::Insert (WheelTimer &timer)
+{
+  //Level is chosen by distance from current tick, slot by absolute expiry tick
+  uint64_t placementTick = timer.expiryTick;
+  uint64_t maxDistance = ((uint64_t) 1 << (LEVEL_BITS * NUM_LEVELS)) - 1;
+  if (placementTick - m_currentTick > maxDistance)
+  {
+    //Beyond wheel span, park at far end and re-insert on expiry
+    placementTick = m_currentTick + maxDistance;
+  }
+  uint64_t distance = placementTick - m_currentTick;
+  uint8_t level = 0;
+  while (level < NUM_LEVELS - 1 && distance >= ((uint64_t) 1 << (LEVEL_BITS * (level + 1))))
+  {
+    level++;
+  }
+  uint8_t index = (placementTick >> (LEVEL_BITS * level)) & (NUM_SLOTS - 1);
+  m_slots[level][index].push_back (timer);
+}
+
+void
+ChordTimerWheel::Cascade (uint8_t level, uint8_t index)
+{
+  WheelSlot slot;
+  slot.swap (m_slots[level][index]);
+  for (WheelSlot::iterator timerIter = slot.begin (); timerIter != slot.end (); timerIter++)
+  {
+    if (timerIter->event->IsCancelled ())
+    {
+      m_size--;
+      continue;
+    }
+    Insert (*timerIter);
+  }
+}
+
+void
+ChordTimerWheel::DoTick (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_inTick = true;
+  m_currentTick = m_tickEventTick;
+  //Move timers down when lower level wraps
+  if ((m_currentTick & (NUM_SLOTS - 1)) == 0)
+  {
+    for (uint8_t level = 1; level < NUM_LEVELS; level++)
+    {
+      uint8_t index = (m_currentTick >> (LEVEL_BITS * level)) & (NUM_SLOTS - 1);
+      Cascade (level, index);
+      if (index != 0)
+        break;
+    }
+  }
+  //Fire expired timers
+  uint32_t generation = m_generation;
+  WheelSlot slot;
+  slot.swap (m_slots[0][m_currentTick & (NUM_SLOTS - 1)]);
+  for (WheelSlot::iterator timerIter = slot.begin (); timerIter != slot.end (); timerIter++)
+  {
+    if (timerIter->event->IsCancelled ())
+    {
+      m_size--;
+    }
+    else if (timerIter->expiryTick > m_currentTick)
+    {
+      //Parked timer, not yet due
+      Insert (*timerIter);
+    }
+    else
+    {
+      m_size--;
+      timerIter->event->Invoke ();
+      if (generation != m_generation)
+      {
+        //Wheel was cleared by handler
+        break;
+      }
+    }
+  }
+  m_inTick = false;
+  ScheduleNextTick ();
+}
+
+bool
+ChordTimerWheel::PurgeSlot (WheelSlot &slot)
+{
+  //Drop cancelled timers, returns true if any live timer remains
+  uint32_t live = 0;
+  for (uint32_t i = 0; i < slot.size (); i++)
+  {
+    if (slot[i].event->IsCancelled ())
+    {
+      m_size--;
+      continue;
+    }
+    if (live != i)
+    {
+      slot[live] = slot[i];
+    }
+    live++;
+  }
+  slot.resize (live);
+  return live > 0;
+}
+
+void
+ChordTimerWheel::ScheduleNextTick (void)
+{
+  if (m_size == 0)
+  {
+    //Idle, next Schedule restarts ticking
+    return;
+  }
+  //Next busy tick in lowest level, or next cascade point
+  uint64_t boundaryTick = (m_currentTick | (NUM_SLOTS - 1)) + 1;
+  uint64_t tick;
+  for (tick = m_currentTick + 1; tick < boundaryTick; tick++)
+  {
+    if (PurgeSlot (m_slots[0][tick & (NUM_SLOTS - 1)]))
+      break;
+    if (m_size == 0)
+      return;
+  }
+  ScheduleTick (tick);
+}
+
+void
+ChordTimerWheel::ScheduleTick (uint64_t tick)
+{
+  m_tickEvent.Cancel ();
+  m_tickEventTick = tick;
+  Time tickTime = TimeStep (tick * m_resolution.GetTimeStep ());
+  Time delay = tickTime > Simulator::Now () ? tickTime - Simulator::Now () : Time ();
+  m_tickEvent = Simulator::Schedule (delay, &ChordTimerWheel::DoTick, this);
+}
+
+void
+ChordTimerWheel::Clear (void)
+{
+  m_tickEvent.Cancel ();
+  for (uint8_t level = 0; level < NUM_LEVELS; level++)
+  {
+    for (uint8_t index = 0; index < NUM_SLOTS; index++)
+    {
+      m_slots[level][index].clear ();
+    }
+  }
+  m_size = 0;
+  m_generation++;
+}
+
+} //namespace ns3
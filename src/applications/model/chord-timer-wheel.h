@@ -0,0 +1,135 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHORD_TIMER_WHEEL_H
+#define CHORD_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class ChordTimerWheel
+ *  \brief Hierarchical timer wheel for request timeouts
+ *
+ *  Holds deadlines of many timers (four levels of 64 slots, i.e. 2^24 ticks of given resolution) and drives them from a single
+ *  simulator event. Expiry is rounded up to the next tick, so a timer never fires early and fires at most one resolution late.
+ *
+ *  A timer is cancelled by calling Cancel () on the EventImpl returned by Schedule. Cancelled timers are dropped when their slot is
+ *  next visited, and the tick event is not rescheduled while only cancelled timers remain at the lowest level.
+ */
+class ChordTimerWheel
+{
+  public:
+    ChordTimerWheel ();
+    ~ChordTimerWheel ();
+
+    /**
+     *  \brief Sets tick resolution. Must be called while wheel is empty.
+     *  \param resolution Tick length
+     */
+    void SetResolution (Time resolution);
+    /**
+     *  \returns Tick resolution
+     */
+    Time GetResolution (void) const;
+    /**
+     *  \brief Schedules event to run after delay
+     *  \param delay Delay from now
+     *  \param event EventImpl to invoke (wheel takes ownership)
+     *  \returns EventImpl, Cancel () on it cancels the timer
+     */
+    Ptr<EventImpl> Schedule (Time const &delay, EventImpl *event);
+    /**
+     *  \brief Schedules member method to run after delay
+     *
+     *  See Schedule (Time const&, EventImpl*)
+     */
+    template <typename MEM, typename OBJ, typename T1, typename T2>
+    Ptr<EventImpl> Schedule (Time const &delay, MEM memPtr, OBJ obj, T1 a1, T2 a2)
+    {
+      return Schedule (delay, MakeEvent (memPtr, obj, a1, a2));
+    }
+    /**
+     *  \brief See Schedule (Time const&, EventImpl*)
+     */
+    template <typename MEM, typename OBJ, typename T1>
+    Ptr<EventImpl> Schedule (Time const &delay, MEM memPtr, OBJ obj, T1 a1)
+    {
+      return Schedule (delay, MakeEvent (memPtr, obj, a1));
+    }
+    /**
+     *  \returns Number of timers held (including cancelled timers not yet dropped)
+     */
+    uint32_t GetSize (void) const;
+    /**
+     *  \brief Drops all timers without invoking them and stops tick event
+     */
+    void Clear (void);
+
+  private:
+    /**
+     *  \cond
+     */
+    ChordTimerWheel (const ChordTimerWheel &);
+    ChordTimerWheel& operator= (const ChordTimerWheel &);
+
+    enum
+    {
+      LEVEL_BITS = 6,
+      NUM_SLOTS = 1 << LEVEL_BITS,
+      NUM_LEVELS = 4,
+    };
+    struct WheelTimer
+    {
+      uint64_t expiryTick;
+      Ptr<EventImpl> event;
+    };
+    typedef std::vector<WheelTimer> WheelSlot;
+
+    void Insert (WheelTimer &timer);
+    void Cascade (uint8_t level, uint8_t index);
+    void DoTick (void);
+    void ScheduleTick (uint64_t tick);
+    void ScheduleNextTick (void);
+    uint64_t GetNowTick (void) const;
+    bool PurgeSlot (WheelSlot &slot);
+
+    WheelSlot m_slots[NUM_LEVELS][NUM_SLOTS];
+    uint64_t m_currentTick;
+    uint32_t m_size;
+    Time m_resolution;
+    EventId m_tickEvent;
+    uint64_t m_tickEventTick;
+    bool m_inTick;
+    uint32_t m_generation;
+    /**
+     *  \endcond
+     */
+}; //class ChordTimerWheel
+
+} //namespace ns3
+
+#endif //CHORD_TIMER_WHEEL_H
@@ -18,6 +18,7 @@
 
 #include "chord-transaction.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 
 
 namespace ns3 {
@@ -31,7 +32,8 @@ ChordTransaction::ChordTransaction (uint32_t transactionId, ChordMessage chordMe
   m_chordMessage = chordMessage;
   m_requestTimeout = requestTimeout;
   m_maxRetries = maxRequestRetries;
-  m_requestTimeoutEventId = EventId ();
+  m_retries = 0;
+  m_startTime = Simulator::Now ();
 }
 
 ChordTransaction::~ChordTransaction ()
@@ -44,7 +46,10 @@ ChordTransaction::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS();
   //cancel timer if running
-  Simulator::Cancel(m_requestTimeoutEventId);
+  if (m_requestTimeoutEvent != 0)
+  {
+    m_requestTimeoutEvent->Cancel();
+  }
 }
 
 void
@@ -62,10 +67,10 @@ ChordTransaction::SetMaxRetries (uint8_t maxRetries)
 }
 
 void
-ChordTransaction::SetRequestTimeoutEventId (EventId eventId)
+ChordTransaction::SetRequestTimeoutEvent (Ptr<EventImpl> event)
 {
   NS_LOG_FUNCTION_NOARGS();
-  m_requestTimeoutEventId = eventId;
+  m_requestTimeoutEvent = event;
 }
 
 uint32_t
@@ -104,11 +109,11 @@ ChordTransaction::GetChordMessage ()
   return m_chordMessage;
 }
 
-EventId
-ChordTransaction::GetRequestTimeoutEventId ()
+Ptr<EventImpl>
+ChordTransaction::GetRequestTimeoutEvent ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return m_requestTimeoutEventId;
+  return m_requestTimeoutEvent;
 }
 
 void 
@@ -135,4 +140,34 @@ ChordTransaction::SetRequestedIdentifier (Ptr<ChordIdentifier> requestedIdentifi
   m_requestedIdentifier = requestedIdentifier;
 }
 
+void
+ChordTransaction::SetChordMessage (ChordMessage chordMessage)
+{
+  m_chordMessage = chordMessage;
+}
+
+ChordTransaction::BatchSlotMap&
+ChordTransaction::GetBatchSlots ()
+{
+  return m_batchSlots;
+}
+
+void
+ChordTransaction::SetNextHop (Ptr<ChordNode> nextHop)
+{
+  m_nextHop = nextHop;
+}
+
+Ptr<ChordNode>
+ChordTransaction::GetNextHop ()
+{
+  return m_nextHop;
+}
+
+Time
+ChordTransaction::GetStartTime ()
+{
+  return m_startTime;
+}
+
 } //namespace ns3
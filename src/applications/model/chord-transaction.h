@@ -20,10 +20,13 @@
 #define CHORD_TRANSACTION_H
 
 #include <vector>
+#include <map>
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/timer.h"
+#include "ns3/event-impl.h"
 #include "chord-message.h"
+#include "chord-key.h"
 
 
 namespace ns3 {
@@ -43,6 +46,11 @@ class ChordTransaction : public Object
       DHASH = 2,
     };
 
+    /**
+     *  \brief Maps key carried by batched lookup to its (batchId, position) slots at originator
+     */
+    typedef std::multimap<ChordKey, std::pair<uint32_t, uint32_t> > BatchSlotMap;
+
     /**
      *  \brief Constructor
      *  \param transactionId
@@ -67,15 +75,25 @@ class ChordTransaction : public Object
      */
     void SetMaxRetries (uint8_t maxRetries);
     /**
-     *  \brief Set eventId of retransmission event
-     *  \param eventid
+     *  \brief Set retransmission timer (see ChordTimerWheel)
+     *  \param event
      */
-    void SetRequestTimeoutEventId (EventId eventId);
+    void SetRequestTimeoutEvent (Ptr<EventImpl> event);
     /**
      *  \brief Set Requested Identifier
      *  \param requestedIdentifier ChordIdentifier
      */
     void SetRequestedIdentifier (Ptr<ChordIdentifier> requestedIdentifier);
+    /**
+     *  \brief Replace request ChordMessage used for retransmissions
+     *  \param chordMessage ChordMessage
+     */
+    void SetChordMessage (ChordMessage chordMessage);
+    /**
+     *  \brief Set node currently asked by iterative lookup
+     *  \param nextHop ChordNode
+     */
+    void SetNextHop (Ptr<ChordNode> nextHop);
 
     //Retrieval
     /**
@@ -99,9 +117,9 @@ class ChordTransaction : public Object
      */
     ChordMessage GetChordMessage ();
     /**
-     *  \returns Timeout eventId
+     *  \returns Retransmission timer
      */
-    EventId GetRequestTimeoutEventId ();
+    Ptr<EventImpl> GetRequestTimeoutEvent ();
     /**
      *  \brief Sets request originator
      *  \param originator
@@ -115,6 +133,18 @@ class ChordTransaction : public Object
      *  \return Ptr to requested ChordIdentifier
      */
     Ptr<ChordIdentifier> GetRequestedIdentifier ();
+    /**
+     *  \returns Batch slots still waiting for response (batched lookups only)
+     */
+    BatchSlotMap& GetBatchSlots ();
+    /**
+     *  \returns Node currently asked by iterative lookup (0 if recursive)
+     */
+    Ptr<ChordNode> GetNextHop ();
+    /**
+     *  \returns Time transaction was created (lookup latency)
+     */
+    Time GetStartTime ();
 
   private:
     /**
@@ -122,7 +152,7 @@ class ChordTransaction : public Object
      */ 
     Ptr<ChordIdentifier> m_requestedIdentifier;
     Time  m_requestTimeout;
-    EventId m_requestTimeoutEventId;
+    Ptr<EventImpl> m_requestTimeoutEvent;
     uint32_t m_transactionId;
     uint8_t m_retries;
     uint8_t m_maxRetries;
@@ -130,6 +160,11 @@ class ChordTransaction : public Object
     ChordMessage m_chordMessage;
     //Originator of this transaction
     ChordTransaction::Originator m_originator;
+    //Unresolved keys of batched lookup
+    BatchSlotMap m_batchSlots;
+    //Hop asked by iterative lookup
+    Ptr<ChordNode> m_nextHop;
+    Time m_startTime;
     /**
      *  \endcond
      */
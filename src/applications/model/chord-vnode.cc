@@ -34,6 +34,7 @@ ChordVNode::ChordVNode (Ptr<ChordNode> node, uint8_t maxSuccessorListSize, uint8
   m_predecessor = 0;
   m_maxSuccessorListSize = maxSuccessorListSize;
   m_maxPredecessorListSize = maxPredecessorListSize;
+  m_maintenance.backoff = 0;
   PopulateFingerIdentifierList ();
 }
 
@@ -174,6 +175,15 @@ ChordVNode::RemoveAllTransactions ()
   m_transactionMap.clear();
 }
 
+void
+ChordVNode::GetTransactions (std::vector<Ptr<ChordTransaction> > &transactions)
+{
+  for (ChordTransactionMap::iterator iterator = m_transactionMap.begin(); iterator != m_transactionMap.end(); iterator++)
+  {
+    transactions.push_back (iterator->second);
+  }
+}
+
 uint32_t
 ChordVNode::GetNextTransactionId ()
 {
@@ -245,17 +255,48 @@ ChordVNode::PackLookupReq(Ptr<ChordIdentifier> requestedIdentifier, ChordMessage
   chordMessage.SetMessageType (ChordMessage::LOOKUP_REQ);
   chordMessage.SetRequestorNode (this);
   chordMessage.GetLookupReq().requestedIdentifier = requestedIdentifier;
+  chordMessage.GetLookupReq().numSuccessors = 0;
+  chordMessage.GetLookupReq().lookupMode = ChordMessage::RECURSIVE_LOOKUP;
   chordMessage.SetTransactionId (GetNextTransactionId());
 }
 
 void
-ChordVNode::PackLookupRsp(Ptr<ChordNode> requestorNode, uint32_t transactionId, ChordMessage &chordMessage)
+ChordVNode::PackLookupRsp(Ptr<ChordNode> requestorNode, uint32_t transactionId, uint8_t numSuccessors, ChordMessage &chordMessage)
 {
   NS_LOG_FUNCTION_NOARGS ();
   chordMessage.SetMessageType (ChordMessage::LOOKUP_RSP);
   chordMessage.SetRequestorNode (requestorNode);
   chordMessage.SetTransactionId (transactionId);
   chordMessage.GetLookupRsp().resolvedNode = this;
+  //Own identifier if predecessor is not known yet (range unknown)
+  chordMessage.GetLookupRsp().predecessorIdentifier = (m_predecessor != 0) ? m_predecessor->GetChordIdentifier() : GetChordIdentifier();
+  //Head of successor list (replica holders)
+  for (std::vector<Ptr<ChordNode> >::iterator nodeIter = m_successorList.begin(); nodeIter != m_successorList.end() && chordMessage.GetLookupRsp().successorList.size() < numSuccessors; nodeIter++)
+  {
+    chordMessage.GetLookupRsp().successorList.push_back (*nodeIter);
+  }
+  chordMessage.GetLookupRsp().successorListSize = chordMessage.GetLookupRsp().successorList.size();
+}
+
+void
+ChordVNode::PackLookupBatchReq(std::vector<Ptr<ChordIdentifier> > &requestedIdentifiers, ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  chordMessage.SetMessageType (ChordMessage::LOOKUP_BATCH_REQ);
+  chordMessage.SetRequestorNode (this);
+  chordMessage.GetLookupBatchReq().requestedIdentifiers = requestedIdentifiers;
+  chordMessage.SetTransactionId (GetNextTransactionId());
+}
+
+void
+ChordVNode::PackLookupBatchRsp(Ptr<ChordNode> requestorNode, uint32_t transactionId, std::vector<Ptr<ChordIdentifier> > &resolvedIdentifiers, ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  chordMessage.SetMessageType (ChordMessage::LOOKUP_BATCH_RSP);
+  chordMessage.SetRequestorNode (requestorNode);
+  chordMessage.SetTransactionId (transactionId);
+  chordMessage.GetLookupBatchRsp().resolvedNode = this;
+  chordMessage.GetLookupBatchRsp().resolvedIdentifiers = resolvedIdentifiers;
 }
 
 void
@@ -309,6 +350,43 @@ ChordVNode::PackFingerRsp (Ptr<ChordNode> requestorNode, Ptr<ChordIdentifier> re
   chordMessage.SetRequestorNode (requestorNode);
   chordMessage.GetFingerRsp().requestedIdentifier = requestedIdentifier;
   chordMessage.GetFingerRsp().fingerNode = this;
+  //Pack successor list
+  chordMessage.GetFingerRsp().successorListSize = m_successorList.size();
+  for (std::vector<Ptr<ChordNode> >::const_iterator nodeIter = m_successorList.begin(); nodeIter != m_successorList.end(); nodeIter++)
+  {
+    Ptr<ChordNode> node = *nodeIter;
+    chordMessage.GetFingerRsp().successorList.push_back (node);
+  }
+}
+
+void
+ChordVNode::PackPingReq (ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  chordMessage.SetMessageType (ChordMessage::PING_REQ);
+  chordMessage.SetRequestorNode (this);
+  chordMessage.GetPingReq().timestamp = Simulator::Now();
+}
+
+void
+ChordVNode::PackPingRsp (Ptr<ChordNode> requestorNode, Time timestamp, ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  chordMessage.SetMessageType (ChordMessage::PING_RSP);
+  chordMessage.SetRequestorNode (requestorNode);
+  chordMessage.GetPingRsp().timestamp = timestamp;
+  chordMessage.GetPingRsp().respondingNode = this;
+}
+
+void
+ChordVNode::PackLookupReferral (Ptr<ChordNode> requestorNode, uint32_t transactionId, Ptr<ChordNode> nextHopNode, ChordMessage &chordMessage)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  chordMessage.SetMessageType (ChordMessage::LOOKUP_REFERRAL);
+  chordMessage.SetRequestorNode (requestorNode);
+  chordMessage.SetTransactionId (transactionId);
+  chordMessage.GetLookupReferral().referringNode = this;
+  chordMessage.GetLookupReferral().nextHopNode = nextHopNode;
 }
 
 void 
@@ -457,12 +535,63 @@ ChordVNode::SynchPredecessorList (std::vector<Ptr<ChordNode> > &predecessorList)
   }
 }
 
+bool
+ChordVNode::IsSuccessorListSynched (const ChordNodeViewList &successorList)
+{
+  return IsNodeListSynched (m_successorList, successorList, m_maxSuccessorListSize);
+}
+
+bool
+ChordVNode::IsPredecessorListSynched (const ChordNodeViewList &predecessorList)
+{
+  return IsNodeListSynched (m_predecessorList, predecessorList, m_maxPredecessorListSize);
+}
+
+/*  Logic: Mirrors SynchSuccessorList/SynchPredecessorList. Stored list is head followed by received entries up to wrap around
+ *  (our own identifier) or max list size; a single received entry only replaces 2nd position of a longer stored list.
+ */
+
+bool
+ChordVNode::IsNodeListSynched (std::vector<Ptr<ChordNode> > &nodeList, const ChordNodeViewList &receivedList, uint8_t maxListSize)
+{
+  if (receivedList.IsEmpty () || GetChordIdentifier()->GetNumBytes () != ChordKey::NUM_BYTES)
+  {
+    return false;
+  }
+  ChordKey ownKey = GetChordIdentifier()->GetChordKey ();
+  if (nodeList.size() > 1 && receivedList.GetSize () == 1)
+  {
+    return receivedList[0].identifier == ownKey || receivedList[0].IsSameNode (nodeList[1]);
+  }
+  uint32_t count = 0;
+  for (uint32_t j = 0; j < receivedList.GetSize () && count < maxListSize; j++)
+  {
+    if (receivedList[j].identifier == ownKey)
+    {
+      //Wrap around has occurred
+      break;
+    }
+    if (nodeList.size() <= count + 1 || !receivedList[j].IsSameNode (nodeList[count + 1]))
+    {
+      return false;
+    }
+    count++;
+  }
+  return nodeList.size() == count + 1;
+}
+
 ChordVNode::VNodeStats&
 ChordVNode::GetStats ()
 {
   return m_stats;
 }
 
+ChordVNode::MaintenanceState&
+ChordVNode::GetMaintenance ()
+{
+  return m_maintenance;
+}
+
 void
 ChordVNode::PrintSuccessorList (std::ostream &os)
 {
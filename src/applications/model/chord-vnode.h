@@ -29,6 +29,7 @@
 #include "ns3/chord-identifier.h"
 #include "ns3/chord-node.h"
 #include "ns3/chord-message.h"
+#include "ns3/chord-message-view.h"
 #include "ns3/chord-transaction.h"
 #include "ns3/chord-node-table.h"
 
@@ -105,6 +106,18 @@ class ChordVNode : public ChordNode
      *  \param predecessorList
      */
     void SynchPredecessorList (std::vector<Ptr<ChordNode> > &predecessorList);
+    /**
+     *  \brief Checks whether SynchSuccessorList would leave successor list as it is
+     *  \param successorList Successor list decoded from STABILIZE_RSP
+     *  \returns true if stored list already matches, false if it needs to be synched
+     */
+    bool IsSuccessorListSynched (const ChordNodeViewList &successorList);
+    /**
+     *  \brief Checks whether SynchPredecessorList would leave predecessor list as it is
+     *  \param predecessorList Predecessor list decoded from HEARTBEAT_RSP
+     *  \returns true if stored list already matches, false if it needs to be synched
+     */
+    bool IsPredecessorListSynched (const ChordNodeViewList &predecessorList);
 
     //Request packing methods for this VNode
     /**
@@ -123,6 +136,12 @@ class ChordVNode : public ChordNode
      *  \param chordMessage ChordMessage
      */
     void PackLookupReq (Ptr<ChordIdentifier> requestedIdentifier, ChordMessage &chordMessage);
+    /**
+     *  \brief Packs Batched Lookup Request
+     *  \param requestedIdentifiers List of ChordIdentifier
+     *  \param chordMessage ChordMessage
+     */
+    void PackLookupBatchReq (std::vector<Ptr<ChordIdentifier> > &requestedIdentifiers, ChordMessage &chordMessage);
     /**
      *  \brief Packs Stabilize Request
      *  \param chordMessage ChordMessage
@@ -145,6 +164,11 @@ class ChordVNode : public ChordNode
      *  \param chordMessage ChordMessage
      */
     void PackFingerReq (Ptr<ChordIdentifier> requestedIdentifier, ChordMessage &chordMessage);
+    /**
+     *  \brief Packs Ping Request, stamped with current time
+     *  \param chordMessage ChordMessage
+     */
+    void PackPingReq (ChordMessage &chordMessage);
 
     //Response packing methods for this VNode
 
@@ -167,9 +191,18 @@ class ChordVNode : public ChordNode
      *  \brief Packs Lookup Response
      *  \param requestorNode ChordNode
      *  \param transactionId
+     *  \param numSuccessors Number of entries of successor list to include
+     *  \param chordMessage ChordMessage
+     */
+    void PackLookupRsp (Ptr<ChordNode> requestorNode, uint32_t transactionId, uint8_t numSuccessors, ChordMessage &chordMessage);
+    /**
+     *  \brief Packs Batched Lookup Response
+     *  \param requestorNode ChordNode
+     *  \param transactionId
+     *  \param resolvedIdentifiers List of ChordIdentifier owned by this node
      *  \param chordMessage ChordMessage
      */
-    void PackLookupRsp (Ptr<ChordNode> requestorNode, uint32_t transactionId, ChordMessage &chordMessage);
+    void PackLookupBatchRsp (Ptr<ChordNode> requestorNode, uint32_t transactionId, std::vector<Ptr<ChordIdentifier> > &resolvedIdentifiers, ChordMessage &chordMessage);
     /**
      *  \brief Packs Heartbeat Response
      *  \param requestorNode ChordNode
@@ -183,12 +216,27 @@ class ChordVNode : public ChordNode
      */
     void PackStabilizeRsp (Ptr<ChordNode> requestorNode, ChordMessage &chordMessage);
     /**
-     *  \brief Packs Finger Response
+     *  \brief Packs Finger Response (this node and its successor list)
      *  \param requestorNode ChordNode
      *  \param requestedIdentifier ChordIdentifier
      *  \param chordMessage ChordMessage
      */
     void PackFingerRsp (Ptr<ChordNode> requestorNode, Ptr<ChordIdentifier> requestedIdentifier, ChordMessage &chordMessage);
+    /**
+     *  \brief Packs Ping Response
+     *  \param requestorNode ChordNode
+     *  \param timestamp Send time of Ping Request
+     *  \param chordMessage ChordMessage
+     */
+    void PackPingRsp (Ptr<ChordNode> requestorNode, Time timestamp, ChordMessage &chordMessage);
+    /**
+     *  \brief Packs Lookup Referral (answer of non owner to iterative Lookup Request)
+     *  \param requestorNode ChordNode
+     *  \param transactionId
+     *  \param nextHopNode ChordNode to be asked next
+     *  \param chordMessage ChordMessage
+     */
+    void PackLookupReferral (Ptr<ChordNode> requestorNode, uint32_t transactionId, Ptr<ChordNode> nextHopNode, ChordMessage &chordMessage);
 
     //Processing
     /**
@@ -225,6 +273,11 @@ class ChordVNode : public ChordNode
      *  \brief Removes all active transaction
      */
     void RemoveAllTransactions ();
+    /**
+     *  \brief Lists active transactions
+     *  \param transactions Ptr to ChordTransaction(s) (return result)
+     */
+    void GetTransactions (std::vector<Ptr<ChordTransaction> > &transactions);
     /**
      *  \brief Generate new transaction Id
      *  \returns transactionId
@@ -262,11 +315,26 @@ class ChordVNode : public ChordNode
      */
     VNodeStats& GetStats();
 
+    //Adaptive maintenance (ChordIpv4 attribute AdaptiveMaintenance)
+    struct MaintenanceState {
+    uint8_t backoff;
+    Time lastReset;
+    Time nextStabilize;
+    Time nextHeartbeat;
+    Time nextFixFinger;
+    };
+    /**
+     *  \returns ChordVNode::MaintenanceState: maintenance intervals are base intervals times 2^backoff, lastReset is time of last return
+     *  to base intervals, next* are times of next rounds
+     */
+    MaintenanceState& GetMaintenance();
+
   private:
     /**
      *  \cond
      */
     void PopulateFingerIdentifierList ();
+    bool IsNodeListSynched (std::vector<Ptr<ChordNode> > &nodeList, const ChordNodeViewList &receivedList, uint8_t maxListSize);
     uint32_t m_transactionId;
     std::vector<Ptr<ChordNode> > m_successorList;
     std::vector<Ptr<ChordNode> > m_predecessorList;
@@ -283,6 +351,7 @@ class ChordVNode : public ChordNode
     ChordTransactionMap m_transactionMap;
 
     VNodeStats m_stats;
+    MaintenanceState m_maintenance;
 
     /**
      *  \endcond
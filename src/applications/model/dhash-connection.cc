@@ -31,6 +31,7 @@ DHashConnection::DHashConnection (Ipv4Address ipAddress, uint16_t port, Ptr<Sock
   m_rxState = RX_IDLE;
   m_totalTxBytes = 0;
   m_currentTxBytes = 0;
+  m_currentRxPacket = Create<Packet> ();
   m_lastActivityTime = Simulator::Now();
 }
 
@@ -43,6 +44,7 @@ DHashConnection::DHashConnection ()
   m_rxState = RX_IDLE;
   m_totalTxBytes = 0;
   m_currentTxBytes = 0;
+  m_currentRxPacket = Create<Packet> ();
   m_lastActivityTime = Simulator::Now();
 }
 DHashConnection::DHashConnection (const DHashConnection &connection)
@@ -55,6 +57,7 @@ DHashConnection::DHashConnection (const DHashConnection &connection)
   m_rxState = RX_IDLE;
   m_totalTxBytes = 0;
   m_currentTxBytes = 0;
+  m_currentRxPacket = Create<Packet> ();
   m_lastActivityTime = Simulator::Now();
 }
 
@@ -152,14 +155,18 @@ DHashConnection::WriteTCPBuffer (Ptr<Socket> socket, uint32_t txSpace)
 
   //Transmit m_currentTxPacket
   uint32_t availTxBytes = socket->GetTxAvailable ();
-  // 2 Things: Either full packet fits or we have to fragment
+  // 2 Things: Either rest of packet fits or we have to fragment
   if ((m_totalTxBytes-m_currentTxBytes) <= availTxBytes)
   {
-    //Send entire packet at once and remove current packet from queue
-    socket->Send (m_currentTxPacket, 0);
+    //Send rest of packet and remove current packet from queue
+    socket->Send (m_currentTxBytes == 0 ? m_currentTxPacket : m_currentTxPacket->CreateFragment (m_currentTxBytes, m_totalTxBytes - m_currentTxBytes), 0);
     m_txPacketList.erase (m_txPacketList.begin());
     m_totalTxBytes = 0;
     m_currentTxBytes = 0;    
+    if (!m_txReadyFn.IsNull())
+    {
+      m_txReadyFn (this);
+    }
     return;
   }
   else
@@ -170,55 +177,51 @@ DHashConnection::WriteTCPBuffer (Ptr<Socket> socket, uint32_t txSpace)
   }
 }
 
+uint32_t
+DHashConnection::GetTxQueueSize ()
+{
+  return m_txPacketList.size();
+}
+
 void
 DHashConnection::ReadTCPBuffer (Ptr<Socket> socket)
 {
   m_lastActivityTime = Simulator::Now();
   uint32_t availRxBytes = socket->GetRxAvailable();
-  Ptr<Packet> packet = socket->Recv(availRxBytes, 0);
+  m_currentRxPacket->AddAtEnd (socket->Recv(availRxBytes, 0));
 
-  while (availRxBytes > 0)
+  Ptr<Packet> messagePacket;
+  while ((messagePacket = AssembleMessage ()) != 0)
   {
-    Ptr<Packet> messagePacket = AssembleMessage(packet, availRxBytes);
-    if (messagePacket != NULL)
-    {
-      m_recvFn (messagePacket, this);
-    }
+    m_recvFn (messagePacket, this);
   }
-
 }
 
 Ptr<Packet>
-DHashConnection::AssembleMessage (Ptr<Packet>& packet, uint32_t &availRxBytes)
+DHashConnection::AssembleMessage ()
 {
   if (m_rxState == RX_IDLE)
   { 
-    //Receive new packet
+    //Receive new packet, length header may be split across reads
     DHashHeader dHashHeader = DHashHeader ();
-    packet->RemoveHeader(dHashHeader);
-    availRxBytes = availRxBytes - dHashHeader.GetSerializedSize();
+    if (m_currentRxPacket->GetSize() < dHashHeader.GetSerializedSize())
+    {
+      return 0;
+    }
+    m_currentRxPacket->RemoveHeader(dHashHeader);
     m_totalRxBytes = dHashHeader.GetLength();
-    m_currentRxBytes = 0;
-    m_currentRxPacket = Create<Packet> ();
     m_rxState = RECEIVING;
   }
-  if ((m_totalRxBytes-m_currentRxBytes) <=  packet->GetSize())
-  {  
-    //Deliver message
-    m_currentRxPacket->AddAtEnd(packet->CreateFragment(0, m_totalRxBytes-m_currentRxBytes));
-    //remove bytes
-    packet->RemoveAtStart (m_totalRxBytes-m_currentRxBytes);
-    availRxBytes = availRxBytes - (m_totalRxBytes-m_currentRxBytes);
-    m_rxState = RX_IDLE;
-    return m_currentRxPacket; 
-  }
-  else
+  if (m_currentRxPacket->GetSize() < m_totalRxBytes)
   {
-    //concat received packet
-    m_currentRxPacket->AddAtEnd (packet);
-    availRxBytes = 0;
-    return NULL;
+    //Wait for rest of message
+    return 0;
   }
+  //Deliver message, keep bytes of following messages
+  Ptr<Packet> messagePacket = m_currentRxPacket->CreateFragment (0, m_totalRxBytes);
+  m_currentRxPacket->RemoveAtStart (m_totalRxBytes);
+  m_rxState = RX_IDLE;
+  return messagePacket;
 }
 
 void
@@ -227,6 +230,12 @@ DHashConnection::SetRecvCallback (Callback<void, Ptr<Packet>, Ptr<DHashConnectio
   m_recvFn = recvFn;
 }
 
+void
+DHashConnection::SetTxReadyCallback (Callback<void, Ptr<DHashConnection> > txReadyFn)
+{
+  m_txReadyFn = txReadyFn;
+}
+
 Time
 DHashConnection::GetLastActivityTime ()
 {
@@ -85,8 +85,14 @@ class DHashConnection : public Object
      *  \brief Writes data on socket based on available space info
      *  \param Ptr to Socket
      *  \param txSpace
+     *
+     *  Called from socket send callback, writes (part of) one queued packet. Once a packet is completely written, Tx Ready upcall is made (see SetTxReadyCallback).
      */
     void WriteTCPBuffer (Ptr<Socket> socket, uint32_t txSpace);
+    /**
+     *  \returns Number of queued packets not yet completely written to socket
+     */
+    uint32_t GetTxQueueSize ();
     /**
      *  \brief Read data from socket
      *  \param socket Ptr to Socket
@@ -100,6 +106,13 @@ class DHashConnection : public Object
      *  This upcall is made whenever complete DHashMessage is received
      */
     void SetRecvCallback (Callback<void, Ptr<Packet>, Ptr<DHashConnection> > recvFn);
+    /**
+     *  \brief Registers Tx Ready Callback function
+     *  \param txReadyFn Callback
+     *
+     *  This upcall is made whenever a queued packet has been completely written to socket. Used to pace bulk transfers.
+     */
+    void SetTxReadyCallback (Callback<void, Ptr<DHashConnection> > txReadyFn);
     
   private:
 
@@ -133,10 +146,12 @@ class DHashConnection : public Object
     uint32_t m_totalTxBytes;
     uint32_t m_currentTxBytes;
 
+    Callback<void, Ptr<DHashConnection> > m_txReadyFn;
+
     RxState m_rxState;
-    //rx counters
+    //Length of message being received
     uint32_t m_totalRxBytes;
-    uint32_t m_currentRxBytes;
+    //Received bytes not yet delivered (partial length header or message)
     Ptr<Packet> m_currentRxPacket;
     Callback<void, Ptr<Packet>, Ptr<DHashConnection> > m_recvFn;
     /**
@@ -144,12 +159,10 @@ class DHashConnection : public Object
      */  
     //Assembly of rx packet
     /**
-     *  \brief Assembles DHashMessage
-     *  \param packet Ptr to Packet
-     *  \param availRxBytes
-     *  \returns Ptr to complete DHashMessage Packet
+     *  \brief Assembles DHashMessage from received bytes
+     *  \returns Ptr to complete DHashMessage Packet, 0 if more bytes are needed
      */
-    Ptr<Packet> AssembleMessage (Ptr<Packet>& packet, uint32_t& availRxBytes);
+    Ptr<Packet> AssembleMessage ();
 
     //Operators
     friend bool operator < (const DHashConnection &connectionL, const DHashConnection &connectionR);
@@ -0,0 +1,302 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dhash-erasure-code.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <string.h>
+#include <algorithm>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("DHashErasureCode");
+
+namespace ns3 {
+
+bool DHashErasureCode::m_tablesReady = false;
+uint8_t DHashErasureCode::m_log[256];
+uint8_t DHashErasureCode::m_exp[512];
+uint8_t DHashErasureCode::m_mul[256][256];
+uint8_t DHashErasureCode::m_mulLow[256][16];
+uint8_t DHashErasureCode::m_mulHigh[256][16];
+
+DHashErasureCode::DHashErasureCode (uint8_t dataFragments)
+  : m_dataFragments (dataFragments),
+#ifdef __SSSE3__
+    m_vectorized (true)
+#else
+    m_vectorized (false)
+#endif
+{
+  NS_ASSERT (dataFragments > 0);
+  InitTables ();
+}
+
+void
+DHashErasureCode::InitTables (void)
+{
+  if (m_tablesReady)
+  {
+    return;
+  }
+  //Generator 2 of x^8 + x^4 + x^3 + x^2 + 1
+  uint16_t value = 1;
+  for (uint16_t i = 0; i < 255; i++)
+  {
+    m_exp[i] = value;
+    m_log[value] = i;
+    value <<= 1;
+    if (value & 0x100)
+    {
+      value ^= 0x11d;
+    }
+  }
+  //Doubled so that exp[log a + log b] needs no modulo
+  for (uint16_t i = 255; i < 512; i++)
+  {
+    m_exp[i] = m_exp[i - 255];
+  }
+  m_log[0] = 0;
+  for (uint16_t a = 0; a < 256; a++)
+  {
+    for (uint16_t b = 0; b < 256; b++)
+    {
+      m_mul[a][b] = (a == 0 || b == 0) ? 0 : m_exp[m_log[a] + m_log[b]];
+    }
+    for (uint8_t x = 0; x < 16; x++)
+    {
+      m_mulLow[a][x] = m_mul[a][x];
+      m_mulHigh[a][x] = m_mul[a][x << 4];
+    }
+  }
+  m_tablesReady = true;
+}
+
+uint8_t
+DHashErasureCode::Multiply (uint8_t a, uint8_t b)
+{
+  InitTables ();
+  return m_mul[a][b];
+}
+
+uint8_t
+DHashErasureCode::Inverse (uint8_t a)
+{
+  NS_ASSERT (a != 0);
+  InitTables ();
+  return m_exp[255 - m_log[a]];
+}
+
+uint8_t
+DHashErasureCode::GetDataFragments (void) const
+{
+  return m_dataFragments;
+}
+
+void
+DHashErasureCode::SetVectorized (bool vectorized)
+{
+#ifdef __SSSE3__
+  m_vectorized = vectorized;
+#endif
+}
+
+bool
+DHashErasureCode::IsVectorized (void) const
+{
+  return m_vectorized;
+}
+
+uint32_t
+DHashErasureCode::GetFragmentSize (uint32_t sizeOfObject) const
+{
+  return (sizeOfObject + m_dataFragments - 1) / m_dataFragments;
+}
+
+uint8_t
+DHashErasureCode::GetCoefficient (uint8_t fragmentIndex, uint8_t column) const
+{
+  //Identity for data fragments, Cauchy 1 / (x + y) with x = fragmentIndex, y = column for parity fragments
+  if (fragmentIndex < m_dataFragments)
+  {
+    return fragmentIndex == column ? 1 : 0;
+  }
+  return Inverse (fragmentIndex ^ column);
+}
+
+void
+DHashErasureCode::MultiplyAdd (uint8_t coefficient, const uint8_t *src, uint8_t *dst, uint32_t length) const
+{
+  //dst ^= coefficient * src
+  if (coefficient == 0)
+  {
+    return;
+  }
+  uint32_t i = 0;
+#ifdef __SSSE3__
+  if (m_vectorized)
+  {
+    __m128i low = _mm_loadu_si128 ((const __m128i *) m_mulLow[coefficient]);
+    __m128i high = _mm_loadu_si128 ((const __m128i *) m_mulHigh[coefficient]);
+    __m128i mask = _mm_set1_epi8 (0x0f);
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i s = _mm_loadu_si128 ((const __m128i *) (src + i));
+      __m128i product = _mm_xor_si128 (_mm_shuffle_epi8 (low, _mm_and_si128 (s, mask)),
+                                       _mm_shuffle_epi8 (high, _mm_and_si128 (_mm_srli_epi64 (s, 4), mask)));
+      __m128i d = _mm_loadu_si128 ((const __m128i *) (dst + i));
+      _mm_storeu_si128 ((__m128i *) (dst + i), _mm_xor_si128 (d, product));
+    }
+  }
+#endif
+  const uint8_t *row = m_mul[coefficient];
+  for (; i < length; i++)
+  {
+    dst[i] ^= row[src[i]];
+  }
+}
+
+void
+DHashErasureCode::CopyDataFragment (uint8_t column, const uint8_t *object, uint32_t sizeOfObject, uint32_t fragmentSize, uint8_t *dst) const
+{
+  //Copy slice of object, zero padding beyond end
+  uint32_t offset = column * fragmentSize;
+  uint32_t length = 0;
+  if (offset < sizeOfObject)
+  {
+    length = sizeOfObject - offset < fragmentSize ? sizeOfObject - offset : fragmentSize;
+    memcpy (dst, object + offset, length);
+  }
+  memset (dst + length, 0, fragmentSize - length);
+}
+
+void
+DHashErasureCode::Encode (uint8_t fragmentIndex, const uint8_t *object, uint32_t sizeOfObject, uint8_t *fragment) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t fragmentSize = GetFragmentSize (sizeOfObject);
+  if (fragmentIndex < m_dataFragments)
+  {
+    CopyDataFragment (fragmentIndex, object, sizeOfObject, fragmentSize, fragment);
+    return;
+  }
+  memset (fragment, 0, fragmentSize);
+  std::vector<uint8_t> padded;
+  for (uint8_t column = 0; column < m_dataFragments; column++)
+  {
+    const uint8_t *data = object + column * fragmentSize;
+    if ((column + 1) * fragmentSize > sizeOfObject)
+    {
+      //Last (partial) data fragment
+      padded.resize (fragmentSize);
+      CopyDataFragment (column, object, sizeOfObject, fragmentSize, &padded[0]);
+      data = &padded[0];
+    }
+    MultiplyAdd (GetCoefficient (fragmentIndex, column), data, fragment, fragmentSize);
+  }
+}
+
+bool
+DHashErasureCode::Decode (const std::vector<uint8_t> &fragmentIndices, const std::vector<const uint8_t*> &fragments, uint32_t sizeOfObject, uint8_t *object) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint8_t m = m_dataFragments;
+  if (fragmentIndices.size () < m || fragments.size () < m)
+  {
+    return false;
+  }
+  uint32_t fragmentSize = GetFragmentSize (sizeOfObject);
+  //Rows of generator matrix for received fragments, inverted by Gauss-Jordan elimination
+  std::vector<uint8_t> matrix (m * m);
+  std::vector<uint8_t> inverse (m * m, 0);
+  for (uint8_t row = 0; row < m; row++)
+  {
+    for (uint8_t k = 0; k < row; k++)
+    {
+      if (fragmentIndices[k] == fragmentIndices[row])
+      {
+        return false;
+      }
+    }
+    for (uint8_t column = 0; column < m; column++)
+    {
+      matrix[row * m + column] = GetCoefficient (fragmentIndices[row], column);
+    }
+    inverse[row * m + row] = 1;
+  }
+  for (uint8_t column = 0; column < m; column++)
+  {
+    uint8_t pivot = column;
+    while (pivot < m && matrix[pivot * m + column] == 0)
+    {
+      pivot++;
+    }
+    if (pivot == m)
+    {
+      return false;
+    }
+    if (pivot != column)
+    {
+      for (uint8_t k = 0; k < m; k++)
+      {
+        std::swap (matrix[pivot * m + k], matrix[column * m + k]);
+        std::swap (inverse[pivot * m + k], inverse[column * m + k]);
+      }
+    }
+    uint8_t scale = Inverse (matrix[column * m + column]);
+    for (uint8_t k = 0; k < m; k++)
+    {
+      matrix[column * m + k] = m_mul[scale][matrix[column * m + k]];
+      inverse[column * m + k] = m_mul[scale][inverse[column * m + k]];
+    }
+    for (uint8_t row = 0; row < m; row++)
+    {
+      uint8_t factor = matrix[row * m + column];
+      if (row == column || factor == 0)
+      {
+        continue;
+      }
+      for (uint8_t k = 0; k < m; k++)
+      {
+        matrix[row * m + k] ^= m_mul[factor][matrix[column * m + k]];
+        inverse[row * m + k] ^= m_mul[factor][inverse[column * m + k]];
+      }
+    }
+  }
+  //Data fragment j = sum over k of inverse[j][k] * fragment k
+  std::vector<uint8_t> data (fragmentSize);
+  for (uint8_t column = 0; column < m; column++)
+  {
+    uint32_t offset = column * fragmentSize;
+    if (offset >= sizeOfObject)
+    {
+      break;
+    }
+    memset (&data[0], 0, fragmentSize);
+    for (uint8_t k = 0; k < m; k++)
+    {
+      MultiplyAdd (inverse[column * m + k], fragments[k], &data[0], fragmentSize);
+    }
+    uint32_t length = sizeOfObject - offset < fragmentSize ? sizeOfObject - offset : fragmentSize;
+    memcpy (object + offset, &data[0], length);
+  }
+  return true;
+}
+
+} //namespace ns3
@@ -0,0 +1,118 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DHASH_ERASURE_CODE_H
+#define DHASH_ERASURE_CODE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class DHashErasureCode
+ *  \brief Systematic Reed-Solomon code over GF(2^8) for DHash objects
+ *
+ *  Object is zero padded and cut into m data fragments of equal size. Fragment i < m is data fragment i, fragment i >= m is a parity
+ *  fragment computed with row (i - m) of a Cauchy matrix. Any m fragments with distinct indices reconstruct the object; at most 256 - m
+ *  parity fragments exist.
+ *
+ *  Encode and decode reduce to dst ^= c * src over whole fragments. With SSSE3 this is done 16 bytes at a time using split nibble
+ *  product tables (pshufb), otherwise one lookup per byte in the 256 entry product row of c.
+ */
+class DHashErasureCode
+{
+  public:
+    /**
+     *  \brief Constructor
+     *  \param dataFragments Number of fragments (m) needed to reconstruct object
+     */
+    DHashErasureCode (uint8_t dataFragments);
+
+    /**
+     *  \returns Number of fragments needed to reconstruct object
+     */
+    uint8_t GetDataFragments (void) const;
+    /**
+     *  \param sizeOfObject Number of bytes in object
+     *  \returns Number of bytes in each fragment
+     */
+    uint32_t GetFragmentSize (uint32_t sizeOfObject) const;
+    /**
+     *  \brief Computes one fragment of object
+     *  \param fragmentIndex Index of fragment (max 255)
+     *  \param object Pointer to object byte array
+     *  \param sizeOfObject Number of bytes in object
+     *  \param fragment Output array of GetFragmentSize (sizeOfObject) bytes
+     */
+    void Encode (uint8_t fragmentIndex, const uint8_t *object, uint32_t sizeOfObject, uint8_t *fragment) const;
+    /**
+     *  \brief Reconstructs object from m fragments
+     *  \param fragmentIndices Indices of fragments (at least m, distinct, first m are used)
+     *  \param fragments Pointers to fragment byte arrays, in same order as fragmentIndices
+     *  \param sizeOfObject Number of bytes in object
+     *  \param object Output array of sizeOfObject bytes
+     *  \returns false if fewer than m fragments are given or indices repeat
+     */
+    bool Decode (const std::vector<uint8_t> &fragmentIndices, const std::vector<const uint8_t*> &fragments, uint32_t sizeOfObject, uint8_t *object) const;
+    /**
+     *  \brief Selects multiply-add kernel (for benchmarking)
+     *  \param vectorized Use SSSE3 kernel if compiled in
+     */
+    void SetVectorized (bool vectorized);
+    /**
+     *  \returns true if SSSE3 kernel is in use
+     */
+    bool IsVectorized (void) const;
+
+    /**
+     *  \brief Product in GF(2^8) (polynomial 0x11d)
+     */
+    static uint8_t Multiply (uint8_t a, uint8_t b);
+    /**
+     *  \brief Multiplicative inverse in GF(2^8), a must be non-zero
+     */
+    static uint8_t Inverse (uint8_t a);
+
+  private:
+    /**
+     *  \cond
+     */
+    uint8_t GetCoefficient (uint8_t fragmentIndex, uint8_t column) const;
+    void MultiplyAdd (uint8_t coefficient, const uint8_t *src, uint8_t *dst, uint32_t length) const;
+    void CopyDataFragment (uint8_t column, const uint8_t *object, uint32_t sizeOfObject, uint32_t fragmentSize, uint8_t *dst) const;
+    static void InitTables (void);
+
+    uint8_t m_dataFragments;
+    bool m_vectorized;
+
+    static bool m_tablesReady;
+    static uint8_t m_log[256];
+    static uint8_t m_exp[512];
+    static uint8_t m_mul[256][256];
+    static uint8_t m_mulLow[256][16];
+    static uint8_t m_mulHigh[256][16];
+    /**
+     *  \endcond
+     */
+}; //class DHashErasureCode
+
+} //namespace ns3
+
+#endif //DHASH_ERASURE_CODE_H
@@ -25,6 +25,8 @@
 #include "ns3/timer.h"
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include <sstream>
 #include "chord-identifier.h"
 #include "dhash-ipv4.h"
 #include "dhash-message.h"
@@ -59,10 +61,45 @@ DHashIpv4::GetTypeId (void)
                  MakeTimeAccessor (&DHashIpv4::m_inactivityTimeout),
                  MakeTimeChecker ())
   .AddAttribute ("AuditObjectsTimeout",
-                 "Timeout value for auditing objects in milli seconds",
+                 "Interval of periodic object audit in milli seconds (0 audits only on demand, see AuditObjects)",
                  TimeValue (MilliSeconds (DEFAULT_AUDIT_OBJECTS_TIMEOUT)),
                  MakeTimeAccessor (&DHashIpv4::m_auditObjectsTimeout),
                  MakeTimeChecker ())
+  .AddAttribute ("RequestTimeout",
+                 "Timeout value for response to store/retrieve request in milli seconds",
+                 TimeValue (MilliSeconds (DEFAULT_DHASH_REQUEST_TIMEOUT)),
+                 MakeTimeAccessor (&DHashIpv4::m_requestTimeout),
+                 MakeTimeChecker ())
+  .AddAttribute ("TimerWheelResolution",
+                 "Tick of request timeout timer wheel in milli seconds",
+                 TimeValue (MilliSeconds (DEFAULT_DHASH_TIMER_WHEEL_RESOLUTION)),
+                 MakeTimeAccessor (&DHashIpv4::m_timerWheelResolution),
+                 MakeTimeChecker ())
+  .AddAttribute ("ReplicationFactor",
+                 "Number of nodes storing each object (owner and its successors)",
+                 UintegerValue (DEFAULT_DHASH_REPLICATION_FACTOR),
+                 MakeUintegerAccessor (&DHashIpv4::m_replicationFactor),
+                 MakeUintegerChecker<uint8_t> (1))
+  .AddAttribute ("DataFragments",
+                 "Fragments needed to reconstruct an erasure coded object (0 or not less than ReplicationFactor stores whole copies)",
+                 UintegerValue (DEFAULT_DHASH_DATA_FRAGMENTS),
+                 MakeUintegerAccessor (&DHashIpv4::m_dataFragments),
+                 MakeUintegerChecker<uint8_t> ())
+  .AddAttribute ("BulkTransferSize",
+                 "Max bytes of store/retrieve requests to one node packed into a single bulk message (0 sends each request in its own message)",
+                 UintegerValue (DEFAULT_DHASH_BULK_TRANSFER_SIZE),
+                 MakeUintegerAccessor (&DHashIpv4::m_bulkTransferSize),
+                 MakeUintegerChecker<uint32_t> ())
+  .AddAttribute ("RangePageSize",
+                 "Max objects returned in one response to a range retrieve, the query resumes after the last one",
+                 UintegerValue (DEFAULT_DHASH_RANGE_PAGE_SIZE),
+                 MakeUintegerAccessor (&DHashIpv4::m_rangePageSize),
+                 MakeUintegerChecker<uint32_t> (1))
+  .AddAttribute ("ObjectStore",
+                 "TypeId of storage backend for objects (ns3::DHashMapStore keeps them in memory, ns3::DHashLogStore in a memory mapped log file)",
+                 StringValue (DEFAULT_DHASH_OBJECT_STORE),
+                 MakeStringAccessor (&DHashIpv4::m_objectStoreType),
+                 MakeStringChecker ())
   ;
   return tid;
 }
@@ -72,11 +109,24 @@ DHashIpv4::Start(Ptr<ChordIpv4> chordIpv4)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_transactionId = 0;
+  m_rangeQueryId = 1;
   m_chordApplication = chordIpv4;
+  if (m_objectStore == 0)
+  {
+    ObjectFactory factory;
+    factory.SetTypeId (m_objectStoreType);
+    m_objectStore = factory.Create<DHashObjectStore> ();
+    std::ostringstream name;
+    m_localIpAddress.Print (name);
+    name << "-" << m_dHashPort;
+    m_objectStore->Open (name.str());
+  }
   if (m_socket == 0)
   {
     TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
     m_socket = Socket::CreateSocket (chordIpv4->GetNode(), tid);
+    //Accepted sockets inherit this, see SendDHashRequest
+    m_socket->SetAttribute ("DelAckCount", UintegerValue (1));
     InetSocketAddress local = InetSocketAddress (m_localIpAddress, m_dHashPort);
     m_socket->Bind (local);
     m_socket->SetAcceptCallback (
@@ -98,9 +148,13 @@ DHashIpv4::Start(Ptr<ChordIpv4> chordIpv4)
 
   m_auditConnectionsTimer.SetFunction(&DHashIpv4::DoPeriodicAuditConnections, this);
   m_auditObjectsTimer.SetFunction(&DHashIpv4::DoPeriodicAuditObjects, this);
+  m_timerWheel.SetResolution (m_timerWheelResolution);
   //Start timers
   m_auditConnectionsTimer.Schedule (m_inactivityTimeout);
-  m_auditObjectsTimer.Schedule (m_auditObjectsTimeout);
+  if (m_auditObjectsTimeout.IsStrictlyPositive ())
+  {
+    m_auditObjectsTimer.Schedule (m_auditObjectsTimeout);
+  }
 }
 
 DHashIpv4::DHashIpv4 ()
@@ -121,6 +175,18 @@ DHashIpv4::DoDispose ()
   //Cancel timers
   m_auditConnectionsTimer.Cancel();
   m_auditObjectsTimer.Cancel();
+  m_timerWheel.Clear();
+  for (DHashPendingRequestMap::iterator iterator = m_pendingRequestTable.begin(); iterator != m_pendingRequestTable.end(); iterator++)
+  {
+    Simulator::Cancel ((*iterator).second.flushEvent);
+  }
+  m_pendingRequestTable.clear();
+  if (m_objectStore != 0)
+  {
+    m_objectStore->Dispose();
+    m_objectStore = 0;
+  }
+  Object::DoDispose ();
 }
 
 DHashIpv4::~DHashIpv4 ()
@@ -128,19 +194,19 @@ DHashIpv4::~DHashIpv4 ()
 }
 
 void 
-DHashIpv4::SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> insertSuccessFn)
+DHashIpv4::SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > insertSuccessFn)
 {
   m_insertSuccessFn = insertSuccessFn;
 } 
 
 void 
-DHashIpv4::SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> retrieveSuccessFn)
+DHashIpv4::SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > retrieveSuccessFn)
 {
   m_retrieveSuccessFn = retrieveSuccessFn;
 } 
    
 void 
-DHashIpv4::SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t> insertFailureFn)
+DHashIpv4::SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> > insertFailureFn)
 {
   m_insertFailureFn = insertFailureFn;
 } 
@@ -151,35 +217,100 @@ DHashIpv4::SetRetrieveFailureCallback (Callback <void, uint8_t*, uint8_t> retrie
   m_retrieveFailureFn = retrieveFailureFn;
 }
 
+void 
+DHashIpv4::SetRetrieveRangeCallback (Callback <void, uint32_t, uint8_t*, uint8_t, Ptr<const Packet> > retrieveRangeFn)
+{
+  m_retrieveRangeFn = retrieveRangeFn;
+}
+
+void 
+DHashIpv4::SetRetrieveRangeCompleteCallback (Callback <void, uint32_t, bool> retrieveRangeCompleteFn)
+{
+  m_retrieveRangeCompleteFn = retrieveRangeCompleteFn;
+}
+
 void
 DHashIpv4::NotifyInsertSuccess (Ptr<DHashObject> object)
 {
-  m_insertSuccessFn (object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject(), object->GetSizeOfObject());
+  m_insertSuccessFn (object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject());
 }
 
 void
 DHashIpv4::NotifyRetrieveSuccess (Ptr<DHashObject> object)
 {
-  m_retrieveSuccessFn (object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject(), object->GetSizeOfObject());
+  m_retrieveSuccessFn (object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject());
 }
 
 void
 DHashIpv4::NotifyFailure (Ptr<DHashTransaction> dHashTransaction)
 {
+  if (dHashTransaction->GetOriginator() == DHashTransaction::REPLICA)
+  {
+    //Replica refresh, nothing to report
+    return;
+  }
   if (dHashTransaction->GetDHashMessage().GetMessageType() == DHashMessage::STORE_REQ)
   {
-    NotifyInsertFailure (dHashTransaction->GetDHashMessage().GetStoreReq().dHashObject);
+    NotifyInsertFailure (GetRequestObject (dHashTransaction));
   }
   else if (dHashTransaction->GetDHashMessage().GetMessageType() == DHashMessage::RETRIEVE_REQ)
   {
-    NotifyRetrieveFailure (dHashTransaction->GetObjectIdentifier());
+    //Fragments collected so far may still be enough
+    NotifyRetrieveResult (dHashTransaction, DecodeReplicaGroup (dHashTransaction->GetReplicaGroup()));
+  }
+  else if (dHashTransaction->GetDHashMessage().GetMessageType() == DHashMessage::RETRIEVE_RANGE_REQ)
+  {
+    CompleteRangeQuery (dHashTransaction->GetRangeQuery(), false);
+  }
+}
+
+void
+DHashIpv4::NotifyRetrieveResult (Ptr<DHashTransaction> dHashTransaction, Ptr<DHashObject> object)
+{
+  //Null object reports failure
+  if (dHashTransaction->GetOriginator() == DHashTransaction::REPLICA)
+  {
+    //Fragment repair: store rebuilt object and code it again for current successors
+    if (object != 0)
+    {
+      m_objectStore->Replace (object);
+      ReplicateObject (object);
+    }
+    return;
+  }
+  Ptr<DHashRangeQuery> rangeQuery = dHashTransaction->GetRangeQuery();
+  if (rangeQuery == 0)
+  {
+    if (object != 0)
+    {
+      NotifyRetrieveSuccess (object);
+    }
+    else
+    {
+      NotifyRetrieveFailure (dHashTransaction->GetObjectIdentifier());
+    }
+    return;
+  }
+  //Object of range retrieve rebuilt from fragments
+  if (object != 0)
+  {
+    NotifyRetrieveRange (rangeQuery->queryId, object);
+  }
+  else
+  {
+    rangeQuery->success = false;
+  }
+  rangeQuery->pendingObjects--;
+  if (rangeQuery->scanComplete && rangeQuery->pendingObjects == 0)
+  {
+    NotifyRetrieveRangeComplete (rangeQuery->queryId, rangeQuery->success);
   }
 }
 
 void
 DHashIpv4::NotifyInsertFailure (Ptr<DHashObject> object)
 {
-  m_insertFailureFn (object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject(), object->GetSizeOfObject());
+  m_insertFailureFn (object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject());
 }
 
 void
@@ -188,16 +319,41 @@ DHashIpv4::NotifyRetrieveFailure (Ptr<ChordIdentifier> objectIdentifier)
   m_retrieveFailureFn (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes()); 
 }
 
+void
+DHashIpv4::NotifyRetrieveRange (uint32_t queryId, Ptr<DHashObject> object)
+{
+  m_retrieveRangeFn (queryId, object->GetObjectIdentifier()->GetKey(), object->GetObjectIdentifier()->GetNumBytes(), object->GetObject());
+}
+
+void
+DHashIpv4::NotifyRetrieveRangeComplete (uint32_t queryId, bool success)
+{
+  m_retrieveRangeCompleteFn (queryId, success);
+}
+
 void
 DHashIpv4::Insert (uint8_t *key,uint8_t sizeOfKey ,uint8_t *object,uint32_t sizeOfObject)
 {
   Ptr<ChordIdentifier> objectIdentifier = Create<ChordIdentifier> (key, sizeOfKey);
-  Ptr<DHashObject> dHashObject = Create<DHashObject> (objectIdentifier, object, sizeOfObject);
+  InsertObject (Create<DHashObject> (objectIdentifier, object, sizeOfObject));
+}
+
+void
+DHashIpv4::Insert (uint8_t *key, uint8_t sizeOfKey, Ptr<const Packet> object)
+{
+  Ptr<ChordIdentifier> objectIdentifier = Create<ChordIdentifier> (key, sizeOfKey);
+  InsertObject (Create<DHashObject> (objectIdentifier, object));
+}
+
+void
+DHashIpv4::InsertObject (Ptr<DHashObject> dHashObject)
+{
   //Check local ownership
-  if (m_chordApplication->CheckOwnership (key, sizeOfKey) == true)
+  if (m_chordApplication->CheckOwnership (dHashObject->GetObjectIdentifier()->GetKey(), dHashObject->GetObjectIdentifier()->GetNumBytes()) == true)
   {
     //Store locally  
     AddObject (dHashObject);
+    ReplicateObject (dHashObject);
     NotifyInsertSuccess (dHashObject);  
     return;
   }
@@ -209,20 +365,23 @@ void
 DHashIpv4::Retrieve (uint8_t* key, uint8_t sizeOfKey)
 {
   Ptr<ChordIdentifier> objectIdentifier = Create<ChordIdentifier> (key, sizeOfKey);
-  //Check local ownership
-  if (m_chordApplication->CheckOwnership (key, sizeOfKey) == true)
+  //Search local if we are owner or replica holder
+  Ptr<DHashObject> dHashObject;
+  if (m_chordApplication->CheckReplicaOwnership (key, sizeOfKey, m_replicationFactor) == true && FindObject (objectIdentifier, dHashObject) == true)
   {
-    //Search local
-    Ptr<DHashObject> dHashObject;
-    if (FindObject (objectIdentifier, dHashObject) == true)
+    if (!dHashObject->IsFragment())
     {
       NotifyRetrieveSuccess (dHashObject);
+      return;
     }
-    else
+    if (dHashObject->GetDataFragments() == 1)
     {
-      NotifyRetrieveFailure (objectIdentifier);
+      //Single fragment is enough
+      std::vector<Ptr<DHashObject> > fragments (1, dHashObject);
+      NotifyRetrieveSuccess (DecodeFragments (fragments));
+      return;
     }
-    return;
+    //Local fragment is used along with remote ones, see SendReplicatedRequest
   }
   //Create Message
   DHashMessage dHashMessage = DHashMessage ();
@@ -230,15 +389,265 @@ DHashIpv4::Retrieve (uint8_t* key, uint8_t sizeOfKey)
   //Create Transaction
   Ptr<DHashTransaction> dHashTransaction = Create<DHashTransaction> (dHashMessage.GetTransactionId(), objectIdentifier, dHashMessage);
   AddTransaction (dHashTransaction);
+  SendRetrieveRequest (dHashTransaction);
+}
+
+void
+DHashIpv4::SendRetrieveRequest (Ptr<DHashTransaction> dHashTransaction)
+{
+  Ptr<ChordIdentifier> objectIdentifier = dHashTransaction->GetObjectIdentifier();
+  //Owner without object, ask replica holders
+  std::vector<InetSocketAddress> replicas;
+  bool owner = m_chordApplication->GetDHashReplicas (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes(), replicas);
+  if (owner == true && replicas.size() == 0)
+  {
+    RemoveTransaction (dHashTransaction->GetTransactionId());
+    NotifyRetrieveResult (dHashTransaction, 0);
+    return;
+  }
+  if (owner == true)
+  {
+    SendReplicatedRequest (replicas, dHashTransaction);
+    return;
+  }
   //Lookup identifier
-  m_chordApplication->DHashLookupKey (key, sizeOfKey);
+  m_chordApplication->DHashLookupKey (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes());
+}
+
+void
+DHashIpv4::Insert (const ChordKey &key, uint8_t *object, uint32_t sizeOfObject)
+{
+  uint8_t keyBytes[ChordKey::NUM_BYTES];
+  key.GetKey (keyBytes);
+  Insert (keyBytes, ChordKey::NUM_BYTES, object, sizeOfObject);
+}
+
+void
+DHashIpv4::Retrieve (const ChordKey &key)
+{
+  uint8_t keyBytes[ChordKey::NUM_BYTES];
+  key.GetKey (keyBytes);
+  Retrieve (keyBytes, ChordKey::NUM_BYTES);
+}
+
+uint32_t
+DHashIpv4::RetrieveRange (uint8_t* lowKey, uint8_t* highKey, uint8_t sizeOfKey)
+{
+  Ptr<DHashRangeQuery> rangeQuery = Create<DHashRangeQuery> ();
+  rangeQuery->queryId = m_rangeQueryId++;
+  rangeQuery->cursorIdentifier = Create<ChordIdentifier> (lowKey, sizeOfKey);
+  rangeQuery->highIdentifier = Create<ChordIdentifier> (highKey, sizeOfKey);
+  rangeQuery->lookups = 0;
+  rangeQuery->pendingObjects = 0;
+  rangeQuery->scanComplete = false;
+  rangeQuery->success = true;
+  //Caller gets query Id before any object is reported, even if whole range is held locally
+  Simulator::ScheduleNow (&DHashIpv4::RequestRangePage, this, rangeQuery, Ipv4Address::GetZero(), 0);
+  return rangeQuery->queryId;
+}
+
+uint32_t
+DHashIpv4::RetrieveRange (const ChordKey &lowKey, const ChordKey &highKey)
+{
+  uint8_t lowKeyBytes[ChordKey::NUM_BYTES];
+  uint8_t highKeyBytes[ChordKey::NUM_BYTES];
+  lowKey.GetKey (lowKeyBytes);
+  highKey.GetKey (highKeyBytes);
+  return RetrieveRange (lowKeyBytes, highKeyBytes, ChordKey::NUM_BYTES);
+}
+
+void
+DHashIpv4::RequestRangePage (Ptr<DHashRangeQuery> rangeQuery, Ipv4Address ipAddress, uint16_t port)
+{
+  //Pages held by local vNodes are scanned in place. Zero address means node after cursor is unknown: try local, else look it up.
+  while (ipAddress == Ipv4Address::GetZero() || (ipAddress == m_localIpAddress && port == m_dHashPort))
+  {
+    DHashMessage::RetrieveRangeRsp retrieveRangeRsp;
+    if (ScanRange (rangeQuery->cursorIdentifier, rangeQuery->highIdentifier, m_rangePageSize, retrieveRangeRsp) == false)
+    {
+      ipAddress = Ipv4Address::GetZero();
+      break;
+    }
+    if (DeliverRangePage (rangeQuery, retrieveRangeRsp) == false)
+    {
+      return;
+    }
+    ipAddress = retrieveRangeRsp.nextIpAddress;
+    port = retrieveRangeRsp.nextPort;
+  }
+  //Create Message
+  DHashMessage dHashMessage = DHashMessage ();
+  PackRetrieveRangeReq (rangeQuery->cursorIdentifier, rangeQuery->highIdentifier, dHashMessage);
+  //Transaction is keyed on first identifier after cursor, so lookup of its owner finds it
+  Ptr<ChordIdentifier> nextIdentifier = Create<ChordIdentifier> (rangeQuery->cursorIdentifier);
+  nextIdentifier->AddPowerOfTwo (0);
+  Ptr<DHashTransaction> dHashTransaction = Create<DHashTransaction> (dHashMessage.GetTransactionId(), nextIdentifier, dHashMessage);
+  dHashTransaction->SetRangeQuery (rangeQuery);
+  if (ipAddress == Ipv4Address::GetZero())
+  {
+    if (rangeQuery->lookups >= DHASH_RANGE_MAX_LOOKUPS)
+    {
+      //Ring keeps changing under the query
+      CompleteRangeQuery (rangeQuery, false);
+      return;
+    }
+    rangeQuery->lookups++;
+    AddTransaction (dHashTransaction);
+    m_chordApplication->DHashLookupKey (nextIdentifier->GetKey(), nextIdentifier->GetNumBytes());
+    return;
+  }
+  AddTransaction (dHashTransaction);
+  SendDHashRequest (ipAddress, port, dHashTransaction);
+}
+
+bool
+DHashIpv4::ScanRange (Ptr<ChordIdentifier> cursorIdentifier, Ptr<ChordIdentifier> highIdentifier, uint32_t maxObjects, DHashMessage::RetrieveRangeRsp &retrieveRangeRsp)
+{
+  //Collects owned objects after cursor, up to maxObjects (or m_bulkTransferSize bytes), moving on to successor vNodes held locally.
+  //Returns false if no local vNode owns the identifier after cursor.
+  retrieveRangeRsp.statusTag = DHashMessage::OBJECT_FOUND;
+  retrieveRangeRsp.complete = 0;
+  retrieveRangeRsp.dHashObjects.clear ();
+  retrieveRangeRsp.cursorIdentifier = cursorIdentifier;
+  retrieveRangeRsp.nextIpAddress = m_localIpAddress;
+  retrieveRangeRsp.nextPort = m_dHashPort;
+  bool owner = false;
+  uint32_t scanned = 0;
+  uint32_t bytes = 0;
+  while (true)
+  {
+    Ptr<ChordIdentifier> nextIdentifier = Create<ChordIdentifier> (retrieveRangeRsp.cursorIdentifier);
+    nextIdentifier->AddPowerOfTwo (0);
+    Ptr<ChordIdentifier> vNodeIdentifier;
+    Ipv4Address successorIp;
+    uint16_t successorPort;
+    if (m_chordApplication->GetDHashOwnedRange (nextIdentifier->GetKey(), nextIdentifier->GetNumBytes(), vNodeIdentifier, successorIp, successorPort) == false)
+    {
+      break;
+    }
+    owner = true;
+    //vNode owns (cursor, vNode], range ends here if high lies in it. A vNode alone on the ring owns all of it.
+    bool last = highIdentifier->IsInBetween (retrieveRangeRsp.cursorIdentifier, vNodeIdentifier) || vNodeIdentifier->IsEqual (retrieveRangeRsp.cursorIdentifier);
+    Ptr<ChordIdentifier> endIdentifier = last ? highIdentifier : vNodeIdentifier;
+    std::vector<Ptr<DHashObject> > dHashObjects;
+    m_objectStore->GetRange (retrieveRangeRsp.cursorIdentifier, endIdentifier, dHashObjects, maxObjects - scanned);
+    for (std::vector<Ptr<DHashObject> >::iterator objectIter = dHashObjects.begin(); objectIter != dHashObjects.end(); objectIter++)
+    {
+      Ptr<DHashObject> dHashObject = *objectIter;
+      if (m_bulkTransferSize > 0 && retrieveRangeRsp.dHashObjects.size() > 0 && bytes + dHashObject->GetSizeOfObject() > m_bulkTransferSize)
+      {
+        //Page full, resume here
+        return true;
+      }
+      retrieveRangeRsp.cursorIdentifier = dHashObject->GetObjectIdentifier();
+      scanned++;
+      //Fragment of erasure coded object goes too, requester rebuilds object
+      retrieveRangeRsp.dHashObjects.push_back (dHashObject);
+      bytes += dHashObject->GetSizeOfObject();
+    }
+    if (scanned >= maxObjects)
+    {
+      return true;
+    }
+    //Range of vNode covered
+    retrieveRangeRsp.cursorIdentifier = endIdentifier;
+    if (last)
+    {
+      retrieveRangeRsp.complete = 1;
+      retrieveRangeRsp.nextIpAddress = Ipv4Address::GetZero();
+      retrieveRangeRsp.nextPort = 0;
+      break;
+    }
+    retrieveRangeRsp.nextIpAddress = successorIp;
+    retrieveRangeRsp.nextPort = successorPort;
+  }
+  return owner;
+}
+
+bool
+DHashIpv4::DeliverRangePage (Ptr<DHashRangeQuery> rangeQuery, DHashMessage::RetrieveRangeRsp &retrieveRangeRsp)
+{
+  //Returns true if query goes on with next page
+  for (std::vector<Ptr<DHashObject> >::iterator objectIter = retrieveRangeRsp.dHashObjects.begin(); objectIter != retrieveRangeRsp.dHashObjects.end(); objectIter++)
+  {
+    if ((*objectIter)->IsFragment())
+    {
+      RebuildRangeObject (rangeQuery, *objectIter);
+      continue;
+    }
+    NotifyRetrieveRange (rangeQuery->queryId, *objectIter);
+  }
+  rangeQuery->cursorIdentifier = retrieveRangeRsp.cursorIdentifier;
+  rangeQuery->lookups = 0;
+  if (retrieveRangeRsp.complete)
+  {
+    CompleteRangeQuery (rangeQuery, true);
+    return false;
+  }
+  return true;
+}
+
+/*  Logic: Owner holds a single fragment of an erasure coded object, so range page carries that fragment. Object is rebuilt as by Retrieve:
+ *  fragments are requested from owner and replica holders, fragment of page counts towards the m needed. Query completes once all rebuilds
+ *  of its pages are done (see NotifyRetrieveResult).
+ */
+void
+DHashIpv4::RebuildRangeObject (Ptr<DHashRangeQuery> rangeQuery, Ptr<DHashObject> fragment)
+{
+  if (fragment->GetDataFragments() <= 1)
+  {
+    //Single fragment is enough
+    std::vector<Ptr<DHashObject> > fragments (1, fragment);
+    Ptr<DHashObject> dHashObject = DecodeFragments (fragments);
+    if (dHashObject != 0)
+    {
+      NotifyRetrieveRange (rangeQuery->queryId, dHashObject);
+    }
+    else
+    {
+      rangeQuery->success = false;
+    }
+    return;
+  }
+  DHashMessage dHashMessage = DHashMessage ();
+  PackRetrieveReq (fragment->GetObjectIdentifier(), dHashMessage);
+  Ptr<DHashTransaction> dHashTransaction = Create<DHashTransaction> (dHashMessage.GetTransactionId(), fragment->GetObjectIdentifier(), dHashMessage);
+  dHashTransaction->SetRangeQuery (rangeQuery);
+  //Replica group holding fragment of page until requests are sent, see SendReplicatedRequest
+  Ptr<DHashReplicaGroup> replicaGroup = Create<DHashReplicaGroup> ();
+  replicaGroup->pendingRequests = 1;
+  replicaGroup->requiredResponses = 1;
+  replicaGroup->responses = 0;
+  replicaGroup->notified = false;
+  CollectFragment (replicaGroup, fragment);
+  dHashTransaction->SetReplicaGroup (replicaGroup);
+  rangeQuery->pendingObjects++;
+  AddTransaction (dHashTransaction);
+  SendRetrieveRequest (dHashTransaction);
+}
+
+void
+DHashIpv4::CompleteRangeQuery (Ptr<DHashRangeQuery> rangeQuery, bool success)
+{
+  //End of scan, reported once rebuilds of erasure coded objects are done
+  rangeQuery->scanComplete = true;
+  rangeQuery->success = rangeQuery->success && success;
+  if (rangeQuery->pendingObjects == 0)
+  {
+    NotifyRetrieveRangeComplete (rangeQuery->queryId, rangeQuery->success);
+  }
 }
 
 void
 DHashIpv4::SendDHashRequest (Ipv4Address ipAddress, uint16_t port, Ptr<DHashTransaction> dHashTransaction)
 {
-  Ptr<Packet> packet = Create<Packet> ();
-  packet->AddHeader (dHashTransaction->GetDHashMessage());
+  SendDHashRequest (ipAddress, port, dHashTransaction, dHashTransaction->GetDHashMessage());
+}
+
+void
+DHashIpv4::SendDHashRequest (Ipv4Address ipAddress, uint16_t port, Ptr<DHashTransaction> dHashTransaction, DHashMessage dHashMessage)
+{
+  Ptr<Packet> packet = dHashMessage.CreatePacket ();
   if (packet->GetSize())
   {
     //Set activity flag
@@ -250,16 +659,304 @@ DHashIpv4::SendDHashRequest (Ipv4Address ipAddress, uint16_t port, Ptr<DHashTran
       //Open new connection
       TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
       Ptr<Socket> socket = Socket::CreateSocket(m_chordApplication->GetNode(), tid);
+      //Request/response traffic, ACK every segment. With delayed ACK, a connection whose window collapsed under a burst (e.g. range handoff) sends one message per ACK timeout.
+      socket->SetAttribute ("DelAckCount", UintegerValue (1));
       connection = AddConnection (socket, ipAddress, port);
       socket->Bind ();
       socket->Connect (InetSocketAddress (ipAddress, port));
     }
     dHashTransaction->SetDHashConnection (connection);
+    //Arm request timeout
+    dHashTransaction->SetRequestTimeoutEvent (m_timerWheel.Schedule (m_requestTimeout, &DHashIpv4::HandleRequestTimeout, this, dHashTransaction->GetTransactionId()));
+    if (m_bulkTransferSize > 0)
+    {
+      QueueDHashRequest (connection, dHashMessage);
+      return;
+    }
     connection->SendTCPData(packet);
     return;
   }
 }
 
+void
+DHashIpv4::QueueDHashRequest (Ptr<DHashConnection> dHashConnection, DHashMessage dHashMessage)
+{
+  //Requests queued in the same event, or while connection is busy, share bulk messages
+  DHashPendingRequests &pending = m_pendingRequestTable[dHashConnection];
+  pending.requests.push_back (dHashMessage);
+  if (!pending.flushEvent.IsRunning())
+  {
+    pending.flushEvent = Simulator::ScheduleNow (&DHashIpv4::FlushRequests, this, dHashConnection);
+  }
+}
+
+void
+DHashIpv4::HandleTxReady (Ptr<DHashConnection> dHashConnection)
+{
+  DHashPendingRequestMap::iterator iterator = m_pendingRequestTable.find (dHashConnection);
+  if (iterator != m_pendingRequestTable.end() && !(*iterator).second.flushEvent.IsRunning())
+  {
+    (*iterator).second.flushEvent = Simulator::ScheduleNow (&DHashIpv4::FlushRequests, this, dHashConnection);
+  }
+}
+
+void
+DHashIpv4::FlushRequests (Ptr<DHashConnection> dHashConnection)
+{
+  DHashPendingRequestMap::iterator iterator = m_pendingRequestTable.find (dHashConnection);
+  if (iterator == m_pendingRequestTable.end())
+  {
+    return;
+  }
+  std::deque<DHashMessage> &requests = (*iterator).second.requests;
+  //Flow control: pack only one message ahead of the one being written to socket, so connection always has data for next send callback (see DHashConnection::SetTxReadyCallback)
+  while (requests.size() > 0 && dHashConnection->GetTxQueueSize() < 2)
+  {
+    //Run of requests of same type, up to m_bulkTransferSize bytes. Range retrieves go on their own.
+    DHashMessage::MessageType messageType = requests.front().GetMessageType();
+    uint32_t maxRequests = (messageType == DHashMessage::STORE_REQ || messageType == DHashMessage::RETRIEVE_REQ) ? requests.size() : 1;
+    uint32_t numRequests = 0;
+    uint32_t bulkSize = 0;
+    while (numRequests < maxRequests && requests[numRequests].GetMessageType() == messageType)
+    {
+      uint32_t requestSize = requests[numRequests].GetSerializedSize() + requests[numRequests].GetPayloadSize();
+      if (numRequests > 0 && bulkSize + requestSize > m_bulkTransferSize)
+      {
+        break;
+      }
+      bulkSize += requestSize;
+      numRequests++;
+    }
+    Ptr<Packet> packet;
+    if (numRequests == 1)
+    {
+      packet = requests.front().CreatePacket ();
+    }
+    else
+    {
+      DHashMessage bulkMessage = DHashMessage ();
+      bulkMessage.SetMessageType ((messageType == DHashMessage::STORE_REQ) ? DHashMessage::STORE_BULK_REQ : DHashMessage::RETRIEVE_BULK_REQ);
+      bulkMessage.SetTransactionId (0);
+      for (uint32_t j = 0; j < numRequests; j++)
+      {
+        if (messageType == DHashMessage::STORE_REQ)
+        {
+          bulkMessage.GetStoreBulkReq().transactionIds.push_back (requests[j].GetTransactionId());
+          bulkMessage.GetStoreBulkReq().storeReqs.push_back (requests[j].GetStoreReq());
+        }
+        else
+        {
+          bulkMessage.GetRetrieveBulkReq().transactionIds.push_back (requests[j].GetTransactionId());
+          bulkMessage.GetRetrieveBulkReq().retrieveReqs.push_back (requests[j].GetRetrieveReq());
+        }
+      }
+      packet = bulkMessage.CreatePacket ();
+    }
+    requests.erase (requests.begin(), requests.begin() + numRequests);
+    dHashConnection->SendTCPData (packet);
+  }
+  if (requests.size() == 0)
+  {
+    Simulator::Cancel ((*iterator).second.flushEvent);
+    m_pendingRequestTable.erase (iterator);
+  }
+}
+
+void
+DHashIpv4::SendReplicatedRequest (std::vector<InetSocketAddress> &destinations, Ptr<DHashTransaction> dHashTransaction)
+{
+  DHashMessage dHashMessage = dHashTransaction->GetDHashMessage();
+  bool store = dHashMessage.GetMessageType() == DHashMessage::STORE_REQ;
+  Ptr<DHashObject> dHashObject;
+  if (store)
+  {
+    dHashObject = dHashMessage.GetStoreReq().dHashObject;
+  }
+  //A fragment being moved goes to owner only, a new object is coded if there are enough nodes for m fragments
+  bool fragmentStore = store && !dHashObject->IsFragment() && IsErasureCoded() && destinations.size() >= m_dataFragments;
+  //Fragments already known to a retrieve (fragment of range page)
+  Ptr<DHashReplicaGroup> knownGroup = dHashTransaction->GetReplicaGroup();
+  bool fragmentRetrieve = !store && (IsErasureCoded() || knownGroup != 0);
+  uint32_t numDestinations = (store && dHashObject->IsFragment()) ? 1 : destinations.size();
+  if (numDestinations == 1 && !fragmentRetrieve)
+  {
+    SendDHashRequest (destinations.front().GetIpv4(), destinations.front().GetPort(), dHashTransaction);
+    return;
+  }
+  //Same request (or fragment i of object) to every destination, each with own transaction.
+  //Success is reported on first response, or on m-th fragment stored/received.
+  Ptr<DHashReplicaGroup> replicaGroup = Create<DHashReplicaGroup> ();
+  replicaGroup->pendingRequests = numDestinations;
+  replicaGroup->requiredResponses = fragmentStore ? m_dataFragments : 1;
+  replicaGroup->responses = 0;
+  replicaGroup->notified = false;
+  Ptr<DHashObject> localFragment;
+  if (fragmentStore)
+  {
+    replicaGroup->dHashObject = dHashObject;
+  }
+  else if (fragmentRetrieve)
+  {
+    //Count own fragment, and those already known
+    if (FindObject (dHashTransaction->GetObjectIdentifier(), localFragment) && localFragment->IsFragment())
+    {
+      CollectFragment (replicaGroup, localFragment);
+    }
+    if (knownGroup != 0)
+    {
+      for (std::vector<Ptr<DHashObject> >::iterator fragmentIter = knownGroup->fragments.begin(); fragmentIter != knownGroup->fragments.end(); fragmentIter++)
+      {
+        CollectFragment (replicaGroup, *fragmentIter);
+      }
+    }
+    replicaGroup->responses = replicaGroup->fragments.size();
+  }
+  dHashTransaction->SetReplicaGroup (replicaGroup);
+  for (uint32_t i = 0; i < numDestinations; i++)
+  {
+    Ptr<DHashTransaction> replicaTransaction = dHashTransaction;
+    if (i > 0)
+    {
+      dHashMessage.SetTransactionId (GetNextTransactionId());
+      replicaTransaction = Create<DHashTransaction> (dHashMessage.GetTransactionId(), dHashTransaction->GetObjectIdentifier(), dHashMessage);
+      replicaTransaction->SetOriginator (dHashTransaction->GetOriginator());
+      replicaTransaction->SetReplicaGroup (replicaGroup);
+      replicaTransaction->SetRangeQuery (dHashTransaction->GetRangeQuery());
+      AddTransaction (replicaTransaction);
+    }
+    if (fragmentStore)
+    {
+      //Transaction keeps whole object, wire message carries fragment i
+      dHashMessage.GetStoreReq().dHashObject = EncodeFragment (dHashObject, i);
+    }
+    SendDHashRequest (destinations[i].GetIpv4(), destinations[i].GetPort(), replicaTransaction, dHashMessage);
+  }
+}
+
+bool
+DHashIpv4::ResolveReplicaGroup (Ptr<DHashTransaction> dHashTransaction, bool success)
+{
+  //Returns true if outcome of transaction is to be reported
+  Ptr<DHashReplicaGroup> replicaGroup = dHashTransaction->GetReplicaGroup();
+  if (replicaGroup == 0)
+  {
+    return true;
+  }
+  replicaGroup->pendingRequests--;
+  if (replicaGroup->notified)
+  {
+    return false;
+  }
+  if (success)
+  {
+    replicaGroup->responses++;
+  }
+  //Report success when enough responses arrived, failure when they no longer can
+  if (replicaGroup->responses >= replicaGroup->requiredResponses || replicaGroup->responses + replicaGroup->pendingRequests < replicaGroup->requiredResponses)
+  {
+    replicaGroup->notified = true;
+    return true;
+  }
+  return false;
+}
+
+Ptr<DHashObject>
+DHashIpv4::GetRequestObject (Ptr<DHashTransaction> dHashTransaction)
+{
+  //Whole object, even if fragments were sent
+  Ptr<DHashReplicaGroup> replicaGroup = dHashTransaction->GetReplicaGroup();
+  if (replicaGroup != 0 && replicaGroup->dHashObject != 0)
+  {
+    return replicaGroup->dHashObject;
+  }
+  return dHashTransaction->GetDHashMessage().GetStoreReq().dHashObject;
+}
+
+bool
+DHashIpv4::IsErasureCoded ()
+{
+  return m_dataFragments > 0 && m_dataFragments < m_replicationFactor;
+}
+
+Ptr<DHashObject>
+DHashIpv4::EncodeFragment (Ptr<DHashObject> dHashObject, uint8_t fragmentIndex)
+{
+  DHashErasureCode erasureCode (m_dataFragments);
+  //Coding works on contiguous bytes
+  std::vector<uint8_t> object (dHashObject->GetSizeOfObject());
+  dHashObject->CopyObject (object.size() ? &object[0] : 0);
+  std::vector<uint8_t> fragment (erasureCode.GetFragmentSize (dHashObject->GetSizeOfObject()));
+  erasureCode.Encode (fragmentIndex, object.size() ? &object[0] : 0, dHashObject->GetSizeOfObject(), fragment.size() ? &fragment[0] : 0);
+  Ptr<DHashObject> fragmentObject = Create<DHashObject> (dHashObject->GetObjectIdentifier(), fragment.size() ? &fragment[0] : 0, fragment.size());
+  fragmentObject->SetFragment (fragmentIndex, m_dataFragments, dHashObject->GetSizeOfObject());
+  return fragmentObject;
+}
+
+bool
+DHashIpv4::CollectFragment (Ptr<DHashReplicaGroup> replicaGroup, Ptr<DHashObject> fragment)
+{
+  //Returns true if fragment is new to the group
+  if (replicaGroup == 0)
+  {
+    return false;
+  }
+  for (std::vector<Ptr<DHashObject> >::iterator fragmentIter = replicaGroup->fragments.begin(); fragmentIter != replicaGroup->fragments.end(); fragmentIter++)
+  {
+    if ((*fragmentIter)->GetFragmentIndex() == fragment->GetFragmentIndex())
+    {
+      return false;
+    }
+  }
+  replicaGroup->fragments.push_back (fragment);
+  if (replicaGroup->requiredResponses < fragment->GetDataFragments())
+  {
+    replicaGroup->requiredResponses = fragment->GetDataFragments();
+  }
+  return true;
+}
+
+Ptr<DHashObject>
+DHashIpv4::DecodeReplicaGroup (Ptr<DHashReplicaGroup> replicaGroup)
+{
+  //Null unless group holds m distinct fragments
+  if (replicaGroup == 0 || replicaGroup->fragments.size() == 0 || replicaGroup->fragments.size() < replicaGroup->fragments.front()->GetDataFragments())
+  {
+    return 0;
+  }
+  return DecodeFragments (replicaGroup->fragments);
+}
+
+Ptr<DHashObject>
+DHashIpv4::DecodeFragments (std::vector<Ptr<DHashObject> > &fragments)
+{
+  Ptr<DHashObject> first = fragments.front();
+  DHashErasureCode erasureCode (first->GetDataFragments());
+  uint32_t fragmentSize = erasureCode.GetFragmentSize (first->GetSizeOfCodedObject());
+  std::vector<uint8_t> fragmentIndices;
+  std::vector<std::vector<uint8_t> > fragmentBytes;
+  std::vector<const uint8_t*> fragmentData;
+  for (std::vector<Ptr<DHashObject> >::iterator fragmentIter = fragments.begin(); fragmentIter != fragments.end(); fragmentIter++)
+  {
+    if ((*fragmentIter)->GetSizeOfObject() != fragmentSize)
+    {
+      continue;
+    }
+    fragmentIndices.push_back ((*fragmentIter)->GetFragmentIndex());
+    fragmentBytes.push_back (std::vector<uint8_t> (fragmentSize));
+    (*fragmentIter)->CopyObject (fragmentSize ? &fragmentBytes.back()[0] : 0);
+  }
+  for (uint32_t j = 0; j < fragmentBytes.size(); j++)
+  {
+    fragmentData.push_back (fragmentSize ? &fragmentBytes[j][0] : 0);
+  }
+  std::vector<uint8_t> object (first->GetSizeOfCodedObject());
+  if (erasureCode.Decode (fragmentIndices, fragmentData, object.size(), object.size() ? &object[0] : 0) == false)
+  {
+    return 0;
+  }
+  return Create<DHashObject> (first->GetObjectIdentifier(), object.size() ? &object[0] : 0, object.size());
+}
+
 void
 DHashIpv4::AddTransaction (Ptr<DHashTransaction> dHashTransaction)
 {
@@ -287,6 +984,7 @@ DHashIpv4::RemoveTransaction (uint32_t transactionId)
   {
     return;
   }
+  (*iterator).second->Dispose();
   m_dHashTransactionTable.erase (iterator);
   return;
 }
@@ -301,7 +999,11 @@ DHashIpv4::RemoveActiveTransactions (Ptr<Socket> socket)
     if (dHashTransaction->GetActiveFlag() && dHashTransaction->GetDHashConnection()->GetSocket() == socket)
     {
       //Report failure and remove
-      NotifyFailure (dHashTransaction);
+      if (ResolveReplicaGroup (dHashTransaction, false) == true)
+      {
+        NotifyFailure (dHashTransaction);
+      }
+      dHashTransaction->Dispose();
       m_dHashTransactionTable.erase (iterator++);
     }
     else
@@ -334,50 +1036,70 @@ DHashIpv4::HandleClose (Ptr<Socket> socket)
 
 
 void
-DHashIpv4::HandleLookupSuccess (uint8_t* lookupKey, uint8_t lookupKeyBytes, Ipv4Address ipAddress, uint16_t port)
+DHashIpv4::HandleLookupSuccess (uint8_t* lookupKey, uint8_t lookupKeyBytes, Ipv4Address ipAddress, uint16_t port, std::vector<InetSocketAddress> replicas)
 {
   NS_LOG_INFO ("*******LOOKUP SUCCESS");
   Ptr<ChordIdentifier> objectIdentifier = Create<ChordIdentifier> (lookupKey, lookupKeyBytes);
+  //Owner first, then replica holders
+  std::vector<InetSocketAddress> destinations;
+  destinations.push_back (InetSocketAddress (ipAddress, port));
+  destinations.insert (destinations.end(), replicas.begin(), replicas.end());
   //For all matching transactions, transmit requests
+  std::vector<Ptr<DHashTransaction> > rangeTransactions;
   for (DHashTransactionMap::iterator iterator = m_dHashTransactionTable.begin(); iterator != m_dHashTransactionTable.end(); iterator++)
   {
     Ptr<DHashTransaction> dHashTransaction = (*iterator).second;
     if (objectIdentifier->IsEqual(dHashTransaction->GetObjectIdentifier()))
     {
       //Only transmit for new transactions
-      if (!dHashTransaction->GetActiveFlag())
+      if (dHashTransaction->GetActiveFlag())
       {
-        SendDHashRequest (ipAddress, port, dHashTransaction);
+        continue;
       }
-
+      if (dHashTransaction->GetDHashMessage().GetMessageType() == DHashMessage::RETRIEVE_RANGE_REQ)
+      {
+        rangeTransactions.push_back (dHashTransaction);
+        continue;
+      }
+      SendReplicatedRequest (destinations, dHashTransaction);
     }
   }
+  //Range retrieve pages go to owner only (it may be this node if ring changed since the scan)
+  for (std::vector<Ptr<DHashTransaction> >::iterator txIter = rangeTransactions.begin(); txIter != rangeTransactions.end(); txIter++)
+  {
+    Ptr<DHashRangeQuery> rangeQuery = (*txIter)->GetRangeQuery();
+    RemoveTransaction ((*txIter)->GetTransactionId());
+    RequestRangePage (rangeQuery, ipAddress, port);
+  }
 }
 
 void
 DHashIpv4::HandleLookupFailure (uint8_t* lookupKey, uint8_t lookupKeyBytes)
 {
   Ptr<ChordIdentifier> objectIdentifier = Create<ChordIdentifier> (lookupKey, lookupKeyBytes);
-  //For all matching transactions, report failure
-  for (DHashTransactionMap::iterator iterator = m_dHashTransactionTable.begin(); iterator != m_dHashTransactionTable.end(); )
+  //For all matching transactions waiting on this lookup, report failure
+  std::vector<Ptr<DHashTransaction> > failedTransactions;
+  for (DHashTransactionMap::iterator iterator = m_dHashTransactionTable.begin(); iterator != m_dHashTransactionTable.end(); iterator++)
   {
     Ptr<DHashTransaction> dHashTransaction = (*iterator).second;
     if (objectIdentifier->IsEqual(dHashTransaction->GetObjectIdentifier()))
     {
-      //Report Failure
-      if (dHashTransaction->GetDHashMessage().GetMessageType() == DHashMessage::STORE_REQ)
-      {
-        NotifyInsertFailure (dHashTransaction->GetDHashMessage().GetStoreReq().dHashObject);
-      }
-      else if (dHashTransaction->GetDHashMessage().GetMessageType() == DHashMessage::RETRIEVE_REQ)
+      //Requests of earlier lookups are in flight, leave them to their responses or timers
+      if (dHashTransaction->GetActiveFlag())
       {
-        NotifyRetrieveFailure (objectIdentifier);
+        continue;
       }
-      //Erase transaction
-      m_dHashTransactionTable.erase (iterator++);
+      failedTransactions.push_back (dHashTransaction);
     }
-    else
-      ++iterator;
+  }
+  for (std::vector<Ptr<DHashTransaction> >::iterator txIter = failedTransactions.begin(); txIter != failedTransactions.end(); txIter++)
+  {
+    //Report failure and remove
+    if (ResolveReplicaGroup (*txIter, false) == true)
+    {
+      NotifyFailure (*txIter);
+    }
+    RemoveTransaction ((*txIter)->GetTransactionId());
   }
 }
 
@@ -387,19 +1109,46 @@ DHashIpv4::HandleOwnershipTrigger (uint8_t* vNodeKey, uint8_t vNodeBytes, uint8_
   Ptr<ChordIdentifier> predIdentifier = Create<ChordIdentifier> (predKey, predBytes);
   Ptr<ChordIdentifier> oldPredIdentifier = Create<ChordIdentifier> (oldPredKey, oldPredBytes);
   Ptr<ChordIdentifier> vNodeIdentifier = Create<ChordIdentifier> (vNodeKey, vNodeBytes);
-  
-  //No need to transfer anything if predecessor crashed or left us
-  if (oldPredIdentifier->IsInBetween(predIdentifier, vNodeIdentifier))
+  std::vector<Ptr<DHashObject> > dHashObjects;
+
+  if (oldPredIdentifier->IsEqual(predIdentifier))
+  {
+    return;
+  }
+  //A lone vnode is its own predecessor, it hands off to first node joining it
+  if (!oldPredIdentifier->IsEqual(vNodeIdentifier) && oldPredIdentifier->IsInBetween(predIdentifier, vNodeIdentifier))
   {
+    //Predecessor crashed or left us, nothing to transfer. We now own (pred, oldPred], restore replicas of that range.
+    if (m_replicationFactor > 1)
+    {
+      GetObjectRange (predIdentifier, oldPredIdentifier, dHashObjects);
+      for (std::vector<Ptr<DHashObject> >::iterator objectIter = dHashObjects.begin(); objectIter != dHashObjects.end(); objectIter++)
+      {
+        ReplicateObject (*objectIter);
+      }
+    }
     return;
   }
-  for (DHashObjectMap::iterator iterator = m_dHashObjectTable.begin(); iterator != m_dHashObjectTable.end(); iterator++)
+  //New predecessor owns (oldPred, pred]. Objects are sorted on identifier, so the range is handed off as one batch on a single connection.
+  GetObjectRange (oldPredIdentifier, predIdentifier, dHashObjects);
+  for (std::vector<Ptr<DHashObject> >::iterator objectIter = dHashObjects.begin(); objectIter != dHashObjects.end(); objectIter++)
   {
-    Ptr<DHashObject> dHashObject = (*iterator).second;
+    Ptr<DHashObject> dHashObject = *objectIter;
     Ptr<ChordIdentifier> objectIdentifier = dHashObject->GetObjectIdentifier();
-    if (objectIdentifier->IsInBetween(oldPredIdentifier, predIdentifier))
+    //Transfer object, keep a copy if we remain replica holder. A fragment is kept or moved, copying it would duplicate its index.
+    if (dHashObject->IsFragment())
+    {
+      if (m_chordApplication->CheckReplicaOwnership (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes(), m_replicationFactor) != true)
+      {
+        TransferObject (dHashObject, DHashTransaction::DHASH ,predIp, predPort);
+      }
+    }
+    else if (m_replicationFactor > 1 && m_chordApplication->CheckReplicaOwnership (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes(), m_replicationFactor) == true)
+    {
+      TransferObject (dHashObject, DHashTransaction::REPLICA, predIp, predPort);
+    }
+    else
     {
-      //Transfer object
       TransferObject (dHashObject, DHashTransaction::DHASH ,predIp, predPort);
     }
   }
@@ -409,7 +1158,11 @@ void
 DHashIpv4::ProcessDHashMessage (Ptr<Packet> packet, Ptr<DHashConnection> dHashConnection)
 {
   DHashMessage dHashMessage = DHashMessage ();
-  packet->RemoveHeader (dHashMessage);
+  if (dHashMessage.RemoveFromPacket (packet) == false)
+  {
+    //Malformed, drop
+    return;
+  }
   NS_LOG_INFO (dHashMessage);
   switch (dHashMessage.GetMessageType ())
   {
@@ -425,6 +1178,24 @@ DHashIpv4::ProcessDHashMessage (Ptr<Packet> packet, Ptr<DHashConnection> dHashCo
     case DHashMessage::RETRIEVE_RSP:
       ProcessRetrieveRsp (dHashMessage, dHashConnection);
       break;
+    case DHashMessage::STORE_BULK_REQ:
+      ProcessStoreBulkReq (dHashMessage, dHashConnection);
+      break;
+    case DHashMessage::STORE_BULK_RSP:
+      ProcessStoreBulkRsp (dHashMessage, dHashConnection);
+      break;
+    case DHashMessage::RETRIEVE_BULK_REQ:
+      ProcessRetrieveBulkReq (dHashMessage, dHashConnection);
+      break;
+    case DHashMessage::RETRIEVE_BULK_RSP:
+      ProcessRetrieveBulkRsp (dHashMessage, dHashConnection);
+      break;
+    case DHashMessage::RETRIEVE_RANGE_REQ:
+      ProcessRetrieveRangeReq (dHashMessage, dHashConnection);
+      break;
+    case DHashMessage::RETRIEVE_RANGE_RSP:
+      ProcessRetrieveRangeRsp (dHashMessage, dHashConnection);
+      break;
     default:
       break;
     
@@ -437,13 +1208,11 @@ DHashIpv4::ProcessStoreReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHas
 {
   Ptr<DHashObject> object = dHashMessage.GetStoreReq().dHashObject;
 
-  AddObject (object);
+  StoreObject (object);
   //Send positive response back
-  Ptr<Packet> packet = Create<Packet> ();
   DHashMessage respMessage = DHashMessage();
   PackStoreRsp (dHashMessage.GetTransactionId(), DHashMessage::STORE_SUCCESS, object->GetObjectIdentifier(), respMessage);
-  packet->AddHeader(respMessage);
-  dHashConnection -> SendTCPData (packet);
+  dHashConnection -> SendTCPData (respMessage.CreatePacket ());
   /*
    *
    *  Cannot check ownership and then store. When a new VNode joins, it might not have set its predecessor. 
@@ -481,24 +1250,27 @@ DHashIpv4::ProcessStoreRsp(DHashMessage dHashMessage, Ptr<DHashConnection> dHash
   {
     return;
   }
-  //Notify user
+  //Notify user (once per replica group)
   if (dHashMessage.GetStoreRsp().statusTag == DHashMessage::STORE_SUCCESS)
   {  
-    if (dHashTransaction->GetOriginator() == DHashTransaction::APPLICATION)
-    { 
-      NotifyInsertSuccess (dHashTransaction->GetDHashMessage().GetStoreReq().dHashObject);
-    }
-    else if (dHashTransaction->GetOriginator() == DHashTransaction::DHASH)
+    if (ResolveReplicaGroup (dHashTransaction, true) == true)
     {
-      //Remove object from local store
-      RemoveObject (dHashTransaction->GetObjectIdentifier());
+      if (dHashTransaction->GetOriginator() == DHashTransaction::APPLICATION)
+      { 
+        NotifyInsertSuccess (GetRequestObject (dHashTransaction));
+      }
+      else if (dHashTransaction->GetOriginator() == DHashTransaction::DHASH)
+      {
+        //Remove object from local store
+        RemoveObject (dHashTransaction->GetObjectIdentifier());
+      }
     }
   }   
   else
   {
-    if (dHashTransaction->GetOriginator() == DHashTransaction::APPLICATION)
+    if (ResolveReplicaGroup (dHashTransaction, false) == true && dHashTransaction->GetOriginator() == DHashTransaction::APPLICATION)
     { 
-      NotifyInsertFailure (dHashTransaction->GetDHashMessage().GetStoreReq().dHashObject);
+      NotifyInsertFailure (GetRequestObject (dHashTransaction));
     }
   }
   //Remove transaction
@@ -512,22 +1284,18 @@ DHashIpv4::ProcessRetrieveReq (DHashMessage dHashMessage, Ptr<DHashConnection> d
   Ptr<DHashObject> dHashObject;
   if (FindObject(objectIdentifier, dHashObject) == true)
   {
-    //Send positive response back
-    Ptr<Packet> packet = Create<Packet> ();
+    //Send positive response back, shares buffer of stored object
     DHashMessage respMessage = DHashMessage();
     PackRetrieveRsp (dHashMessage.GetTransactionId(), DHashMessage::OBJECT_FOUND, dHashObject, respMessage);
-    packet->AddHeader(respMessage);
-    dHashConnection -> SendTCPData (packet);
+    dHashConnection -> SendTCPData (respMessage.CreatePacket ());
     return;
   }
   else
   {
-    Ptr<Packet> packet = Create<Packet> ();
     DHashMessage respMessage = DHashMessage();
     //Send negative response back    
     PackRetrieveRsp (dHashMessage.GetTransactionId(), DHashMessage::OBJECT_NOT_FOUND, NULL, respMessage);
-    packet->AddHeader(respMessage);
-    dHashConnection -> SendTCPData (packet);
+    dHashConnection -> SendTCPData (respMessage.CreatePacket ());
     return; 
   }
 }
@@ -540,19 +1308,172 @@ DHashIpv4::ProcessRetrieveRsp(DHashMessage dHashMessage, Ptr<DHashConnection> dH
   {
     return;
   }
-  //Notify user
+  //Notify user, first object (or m-th distinct fragment) found in replica group wins
   if (dHashMessage.GetRetrieveRsp().statusTag == DHashMessage::OBJECT_FOUND)
   {
-    NotifyRetrieveSuccess (dHashMessage.GetRetrieveRsp().dHashObject);
+    Ptr<DHashObject> dHashObject = dHashMessage.GetRetrieveRsp().dHashObject;
+    Ptr<DHashReplicaGroup> replicaGroup = dHashTransaction->GetReplicaGroup();
+    bool success = true;
+    if (dHashObject->IsFragment())
+    {
+      success = CollectFragment (replicaGroup, dHashObject);
+    }
+    else if (replicaGroup != 0)
+    {
+      //Whole copy completes group
+      replicaGroup->requiredResponses = replicaGroup->responses + 1;
+    }
+    if (ResolveReplicaGroup (dHashTransaction, success) == true)
+    {
+      if (dHashObject->IsFragment())
+      {
+        //Group may be complete without this fragment (known before request was sent)
+        dHashObject = DecodeReplicaGroup (replicaGroup);
+      }
+      NotifyRetrieveResult (dHashTransaction, dHashObject);
+    }
   }   
   else
   {
-    NotifyRetrieveFailure (dHashTransaction->GetDHashMessage().GetRetrieveReq().objectIdentifier);
+    if (ResolveReplicaGroup (dHashTransaction, false) == true)
+    {
+      NotifyRetrieveResult (dHashTransaction, DecodeReplicaGroup (dHashTransaction->GetReplicaGroup()));
+    }
   }
   //Remove transaction
   RemoveTransaction (dHashMessage.GetTransactionId()); 
 }
 
+void
+DHashIpv4::ProcessStoreBulkReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection)
+{
+  DHashMessage::StoreBulkReq &storeBulkReq = dHashMessage.GetStoreBulkReq();
+  //Store all objects, answer with one bulk response
+  DHashMessage respMessage = DHashMessage ();
+  respMessage.SetMessageType (DHashMessage::STORE_BULK_RSP);
+  respMessage.SetTransactionId (dHashMessage.GetTransactionId());
+  DHashMessage::StoreBulkRsp &storeBulkRsp = respMessage.GetStoreBulkRsp();
+  for (uint32_t j = 0; j < storeBulkReq.storeReqs.size(); j++)
+  {
+    Ptr<DHashObject> object = storeBulkReq.storeReqs[j].dHashObject;
+    StoreObject (object);
+    DHashMessage::StoreRsp storeRsp;
+    storeRsp.statusTag = DHashMessage::STORE_SUCCESS;
+    storeRsp.objectIdentifier = object->GetObjectIdentifier();
+    storeBulkRsp.transactionIds.push_back (storeBulkReq.transactionIds[j]);
+    storeBulkRsp.storeRsps.push_back (storeRsp);
+  }
+  dHashConnection->SendTCPData (respMessage.CreatePacket ());
+}
+
+void
+DHashIpv4::ProcessStoreBulkRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection)
+{
+  //Each entry completes its own transaction
+  DHashMessage::StoreBulkRsp &storeBulkRsp = dHashMessage.GetStoreBulkRsp();
+  for (uint32_t j = 0; j < storeBulkRsp.storeRsps.size(); j++)
+  {
+    DHashMessage storeRsp = DHashMessage ();
+    storeRsp.SetMessageType (DHashMessage::STORE_RSP);
+    storeRsp.SetTransactionId (storeBulkRsp.transactionIds[j]);
+    storeRsp.GetStoreRsp() = storeBulkRsp.storeRsps[j];
+    ProcessStoreRsp (storeRsp, dHashConnection);
+  }
+}
+
+void
+DHashIpv4::ProcessRetrieveBulkReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection)
+{
+  DHashMessage::RetrieveBulkReq &retrieveBulkReq = dHashMessage.GetRetrieveBulkReq();
+  //Found objects are returned in bulk responses of up to m_bulkTransferSize bytes
+  DHashMessage respMessage = DHashMessage ();
+  respMessage.SetMessageType (DHashMessage::RETRIEVE_BULK_RSP);
+  respMessage.SetTransactionId (dHashMessage.GetTransactionId());
+  uint32_t respSize = 0;
+  for (uint32_t j = 0; j < retrieveBulkReq.retrieveReqs.size(); j++)
+  {
+    DHashMessage::RetrieveRsp retrieveRsp;
+    retrieveRsp.statusTag = DHashMessage::OBJECT_NOT_FOUND;
+    if (FindObject (retrieveBulkReq.retrieveReqs[j].objectIdentifier, retrieveRsp.dHashObject) == true)
+    {
+      retrieveRsp.statusTag = DHashMessage::OBJECT_FOUND;
+    }
+    uint32_t entrySize = sizeof (uint32_t) + retrieveRsp.GetSerializedSize();
+    if (retrieveRsp.statusTag == DHashMessage::OBJECT_FOUND)
+    {
+      entrySize += retrieveRsp.dHashObject->GetSizeOfObject();
+    }
+    if (respSize > 0 && respSize + entrySize > m_bulkTransferSize)
+    {
+      dHashConnection->SendTCPData (respMessage.CreatePacket ());
+      respMessage.GetRetrieveBulkRsp().transactionIds.clear();
+      respMessage.GetRetrieveBulkRsp().retrieveRsps.clear();
+      respSize = 0;
+    }
+    respMessage.GetRetrieveBulkRsp().transactionIds.push_back (retrieveBulkReq.transactionIds[j]);
+    respMessage.GetRetrieveBulkRsp().retrieveRsps.push_back (retrieveRsp);
+    respSize += entrySize;
+  }
+  dHashConnection->SendTCPData (respMessage.CreatePacket ());
+}
+
+void
+DHashIpv4::ProcessRetrieveBulkRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection)
+{
+  //Each entry completes its own transaction
+  DHashMessage::RetrieveBulkRsp &retrieveBulkRsp = dHashMessage.GetRetrieveBulkRsp();
+  for (uint32_t j = 0; j < retrieveBulkRsp.retrieveRsps.size(); j++)
+  {
+    DHashMessage retrieveRsp = DHashMessage ();
+    retrieveRsp.SetMessageType (DHashMessage::RETRIEVE_RSP);
+    retrieveRsp.SetTransactionId (retrieveBulkRsp.transactionIds[j]);
+    retrieveRsp.GetRetrieveRsp() = retrieveBulkRsp.retrieveRsps[j];
+    ProcessRetrieveRsp (retrieveRsp, dHashConnection);
+  }
+}
+
+void
+DHashIpv4::ProcessRetrieveRangeReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection)
+{
+  DHashMessage::RetrieveRangeReq &retrieveRangeReq = dHashMessage.GetRetrieveRangeReq();
+  //One page per request, requester asks for next one
+  DHashMessage respMessage = DHashMessage ();
+  respMessage.SetMessageType (DHashMessage::RETRIEVE_RANGE_RSP);
+  respMessage.SetTransactionId (dHashMessage.GetTransactionId());
+  DHashMessage::RetrieveRangeRsp &retrieveRangeRsp = respMessage.GetRetrieveRangeRsp();
+  uint32_t maxObjects = std::max (retrieveRangeReq.maxObjects, (uint32_t) 1);
+  if (ScanRange (retrieveRangeReq.cursorIdentifier, retrieveRangeReq.highIdentifier, maxObjects, retrieveRangeRsp) == false)
+  {
+    //Identifier after cursor is not ours (any more)
+    retrieveRangeRsp.statusTag = DHashMessage::NOT_OWNER;
+    retrieveRangeRsp.dHashObjects.clear ();
+  }
+  dHashConnection->SendTCPData (respMessage.CreatePacket ());
+}
+
+void
+DHashIpv4::ProcessRetrieveRangeRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection)
+{
+  Ptr<DHashTransaction> dHashTransaction;
+  if (FindTransaction(dHashMessage.GetTransactionId(), dHashTransaction) != true)
+  {
+    return;
+  }
+  Ptr<DHashRangeQuery> rangeQuery = dHashTransaction->GetRangeQuery();
+  RemoveTransaction (dHashMessage.GetTransactionId());
+  DHashMessage::RetrieveRangeRsp &retrieveRangeRsp = dHashMessage.GetRetrieveRangeRsp();
+  if (retrieveRangeRsp.statusTag != DHashMessage::OBJECT_FOUND)
+  {
+    //Ownership moved, look up node after cursor again
+    RequestRangePage (rangeQuery, Ipv4Address::GetZero(), 0);
+    return;
+  }
+  if (DeliverRangePage (rangeQuery, retrieveRangeRsp) == true)
+  {
+    RequestRangePage (rangeQuery, retrieveRangeRsp.nextIpAddress, retrieveRangeRsp.nextPort);
+  }
+}
+
 void
 DHashIpv4::DoPeriodicAuditConnections ()
 {
@@ -562,10 +1483,12 @@ DHashIpv4::DoPeriodicAuditConnections ()
     Ptr<DHashConnection> dHashConnection = (*iterator).second;
     if ((dHashConnection->GetLastActivityTime().GetMilliSeconds() + m_inactivityTimeout.GetMilliSeconds()) < Simulator::Now().GetMilliSeconds())
     {
+      Ptr<Socket> socket = (*iterator).first;
+      iterator++;
       //Remove all active transactions running on this socket
-      RemoveActiveTransactions (dHashConnection->GetSocket());
-      //Remove from table
-      m_dHashConnectionTable.erase (iterator++);
+      RemoveActiveTransactions (socket);
+      //Remove from table, with its unsent requests
+      RemoveConnection (socket);
     }
     else
       ++iterator;
@@ -574,20 +1497,60 @@ DHashIpv4::DoPeriodicAuditConnections ()
   m_auditConnectionsTimer.Schedule (m_inactivityTimeout);
 }
 
+void
+DHashIpv4::HandleRequestTimeout (uint32_t transactionId)
+{
+  Ptr<DHashTransaction> dHashTransaction;
+  if (FindTransaction (transactionId, dHashTransaction) == false)
+  {
+    //Transaction does not exist
+    return;
+  }
+  NS_LOG_ERROR ("DHash request timed out!");
+  //Report failure and remove
+  if (ResolveReplicaGroup (dHashTransaction, false) == true)
+  {
+    NotifyFailure (dHashTransaction);
+  }
+  RemoveTransaction (transactionId);
+}
+
 void
 DHashIpv4::DoPeriodicAuditObjects ()
 {
-  //Transfer objects which don't belong here
-  for (DHashObjectMap::iterator iterator = m_dHashObjectTable.begin(); iterator != m_dHashObjectTable.end(); iterator++)
+  AuditObjects ();
+  //Restart audit timer
+  if (m_auditObjectsTimeout.IsStrictlyPositive ())
+  {
+    m_auditObjectsTimer.Schedule (m_auditObjectsTimeout);
+  }
+}
+
+void
+DHashIpv4::AuditObjects ()
+{
+  //Transfer objects which don't belong here, refresh replicas of objects we own. Objects are only loaded when sent.
+  std::vector<Ptr<ChordIdentifier> > objectIdentifiers;
+  m_objectStore->GetIdentifiers (objectIdentifiers);
+  for (std::vector<Ptr<ChordIdentifier> >::iterator idIter = objectIdentifiers.begin(); idIter != objectIdentifiers.end(); idIter++)
   {
-    Ptr<DHashObject> dHashObject = (*iterator).second;
-    if (m_chordApplication->CheckOwnership (dHashObject->GetObjectIdentifier()->GetKey(), dHashObject->GetObjectIdentifier()->GetNumBytes()) != true)
+    Ptr<ChordIdentifier> objectIdentifier = *idIter;
+    Ptr<DHashObject> dHashObject;
+    if (m_chordApplication->CheckReplicaOwnership (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes(), m_replicationFactor) != true)
     {
-      TransferObject (dHashObject, DHashTransaction::DHASH, Ipv4Address::GetZero(), 0);
+      if (FindObject (objectIdentifier, dHashObject) == true)
+      {
+        TransferObject (dHashObject, DHashTransaction::DHASH, Ipv4Address::GetZero(), 0);
+      }
+    }
+    else if (m_replicationFactor > 1 && m_chordApplication->CheckOwnership (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes()) == true)
+    {
+      if (FindObject (objectIdentifier, dHashObject) == true)
+      {
+        ReplicateObject (dHashObject);
+      }
     }
   }
-  //Restart audit timer
-  m_auditObjectsTimer.Schedule(m_auditObjectsTimeout);
 }
 
 
@@ -626,32 +1589,49 @@ DHashIpv4::PackRetrieveRsp (uint32_t transactionId, uint8_t statusTag, Ptr<DHash
   respMessage.GetRetrieveRsp().dHashObject = dHashObject;
 }
 
+void
+DHashIpv4::PackRetrieveRangeReq (Ptr<ChordIdentifier> cursorIdentifier, Ptr<ChordIdentifier> highIdentifier, DHashMessage& dHashMessage)
+{
+  dHashMessage.SetMessageType (DHashMessage::RETRIEVE_RANGE_REQ);
+  dHashMessage.SetTransactionId (GetNextTransactionId());
+  dHashMessage.GetRetrieveRangeReq().cursorIdentifier = cursorIdentifier;
+  dHashMessage.GetRetrieveRangeReq().highIdentifier = highIdentifier;
+  dHashMessage.GetRetrieveRangeReq().maxObjects = m_rangePageSize;
+}
+
 void
 DHashIpv4::AddObject (Ptr<DHashObject> object)
 {
-  ChordIdentifier chordIdentifier = *(PeekPointer(object->GetObjectIdentifier()));
-  m_dHashObjectTable.insert (std::make_pair(chordIdentifier, object));
+  m_objectStore->Add (object);
 }
 
 
 
+void
+DHashIpv4::StoreObject (Ptr<DHashObject> object)
+{
+  //Object received from peer, its bytes must not pin the received packet
+  object->TrimObject ();
+  //Repaired fragment replaces old one, its index may have changed with the ring
+  Ptr<DHashObject> storedObject;
+  if (object->IsFragment() && FindObject (object->GetObjectIdentifier(), storedObject) && storedObject->IsFragment())
+  {
+    m_objectStore->Replace (object);
+    return;
+  }
+  AddObject (object);
+}
+
 void 
 DHashIpv4::RemoveObject (Ptr<ChordIdentifier> objectIdentifier)
 {
-   m_dHashObjectTable.erase (objectIdentifier);
+  m_objectStore->Remove (objectIdentifier);
 }
 
 bool
 DHashIpv4::FindObject (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject>& dHashObject)
 {
-  ChordIdentifier chordIdentifier = *(PeekPointer(objectIdentifier));
-  DHashObjectMap::iterator iterator = m_dHashObjectTable.find (chordIdentifier);
-  if (iterator == m_dHashObjectTable.end())
-  {
-    return false;
-  } 
-  dHashObject = (*iterator).second;
-  return true;
+  return m_objectStore->Find (objectIdentifier, dHashObject);
 }
 
 
@@ -675,6 +1655,64 @@ DHashIpv4::TransferObject (Ptr<DHashObject> dHashObject, DHashTransaction::Origi
   SendDHashRequest (ipAddress, port, dHashTransaction);
 }
 
+void
+DHashIpv4::ReplicateObject (Ptr<DHashObject> dHashObject)
+{
+  if (m_replicationFactor <= 1)
+  {
+    return;
+  }
+  if (dHashObject->IsFragment())
+  {
+    //Owner only holds fragment 0, object is rebuilt before fragments are sent
+    RepairFragments (dHashObject);
+    return;
+  }
+  //Copy owned object to successors of owning vNode
+  std::vector<InetSocketAddress> replicas;
+  m_chordApplication->GetDHashReplicas (dHashObject->GetObjectIdentifier()->GetKey(), dHashObject->GetObjectIdentifier()->GetNumBytes(), replicas);
+  if (IsErasureCoded() && replicas.size() + 1 >= m_dataFragments)
+  {
+    //Keep fragment 0 in place of object, successor i gets fragment i
+    m_objectStore->Replace (EncodeFragment (dHashObject, 0));
+    for (uint32_t i = 0; i < replicas.size(); i++)
+    {
+      TransferObject (EncodeFragment (dHashObject, i + 1), DHashTransaction::REPLICA, replicas[i].GetIpv4(), replicas[i].GetPort());
+    }
+    return;
+  }
+  for (std::vector<InetSocketAddress>::iterator replicaIter = replicas.begin(); replicaIter != replicas.end(); replicaIter++)
+  {
+    TransferObject (dHashObject, DHashTransaction::REPLICA, replicaIter->GetIpv4(), replicaIter->GetPort());
+  }
+}
+
+void
+DHashIpv4::RepairFragments (Ptr<DHashObject> fragment)
+{
+  //Fetch fragments from successors, result is handled in NotifyRetrieveResult
+  Ptr<ChordIdentifier> objectIdentifier = fragment->GetObjectIdentifier();
+  std::vector<InetSocketAddress> replicas;
+  m_chordApplication->GetDHashReplicas (objectIdentifier->GetKey(), objectIdentifier->GetNumBytes(), replicas);
+  if (replicas.size() == 0)
+  {
+    return;
+  }
+  DHashMessage dHashMessage = DHashMessage ();
+  PackRetrieveReq (objectIdentifier, dHashMessage);
+  Ptr<DHashTransaction> dHashTransaction = Create<DHashTransaction> (dHashMessage.GetTransactionId(), objectIdentifier, dHashMessage);
+  dHashTransaction->SetOriginator (DHashTransaction::REPLICA);
+  AddTransaction (dHashTransaction);
+  SendReplicatedRequest (replicas, dHashTransaction);
+}
+
+void
+DHashIpv4::GetObjectRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &dHashObjects)
+{
+  //Objects in (low, high] taken clockwise, see ChordIdentifier::IsInBetween
+  m_objectStore->GetRange (lowIdentifier, highIdentifier, dHashObjects, 0);
+}
+
 Ptr<DHashConnection>
 DHashIpv4::AddConnection (Ptr<Socket> socket, Ipv4Address ipAddress, uint16_t port)
 {
@@ -682,6 +1720,7 @@ DHashIpv4::AddConnection (Ptr<Socket> socket, Ipv4Address ipAddress, uint16_t po
   Ptr<DHashConnection> dHashConnection = Create<DHashConnection> (ipAddress, port, socket);
   socket->SetRecvCallback (MakeCallback(&DHashConnection::ReadTCPBuffer, dHashConnection));
   dHashConnection->SetRecvCallback(MakeCallback(&DHashIpv4::ProcessDHashMessage, this));
+  dHashConnection->SetTxReadyCallback(MakeCallback(&DHashIpv4::HandleTxReady, this));
 
   socket->SetCloseCallbacks (MakeCallback(&DHashIpv4::HandleClose, this),
                              MakeCallback(&DHashIpv4::HandleClose, this));
@@ -726,6 +1765,13 @@ DHashIpv4::RemoveConnection (Ptr<Socket> socket)
   {
     return;
   }
+  //Drop requests not yet sent, their transactions time out
+  DHashPendingRequestMap::iterator pendingIter = m_pendingRequestTable.find ((*iterator).second);
+  if (pendingIter != m_pendingRequestTable.end())
+  {
+    Simulator::Cancel ((*pendingIter).second.flushEvent);
+    m_pendingRequestTable.erase (pendingIter);
+  }
 
   m_dHashConnectionTable.erase (iterator);
   return;
@@ -744,7 +1790,7 @@ DHashIpv4::DumpDHashInfo (std::ostream &os)
   //Dump stats
   os << "**** Info for DHash Layer ****\n";
   os << "Active TCP Connections: " << m_dHashConnectionTable.size() << "\n";
-  os << "Stored DHash Objects: " << m_dHashObjectTable.size() << "\n";
+  os << "Stored DHash Objects: " << m_objectStore->GetSize() << "\n";
   os << "Pending Transactions: " << m_dHashTransactionTable.size() << "\n";
 }
 
@@ -32,14 +32,26 @@
 #include "chord-identifier.h"
 #include "dhash-message.h"
 #include "dhash-object.h"
+#include "dhash-object-store.h"
 #include "dhash-connection.h"
 #include "dhash-transaction.h"
+#include "chord-timer-wheel.h"
+#include "dhash-erasure-code.h"
 #include <map>
 #include <vector>
+#include <deque>
 
 /* Static defines */
 #define DEFAULT_CONNECTION_INACTIVITY_TIMEOUT 10000
-#define DEFAULT_AUDIT_OBJECTS_TIMEOUT 600000
+#define DEFAULT_AUDIT_OBJECTS_TIMEOUT 0
+#define DEFAULT_DHASH_REQUEST_TIMEOUT 10000
+#define DEFAULT_DHASH_TIMER_WHEEL_RESOLUTION 10
+#define DEFAULT_DHASH_REPLICATION_FACTOR 1
+#define DEFAULT_DHASH_DATA_FRAGMENTS 0
+#define DEFAULT_DHASH_BULK_TRANSFER_SIZE 65536
+#define DEFAULT_DHASH_OBJECT_STORE "ns3::DHashMapStore"
+#define DEFAULT_DHASH_RANGE_PAGE_SIZE 64
+#define DHASH_RANGE_MAX_LOOKUPS 3
 
 namespace ns3 {
 
@@ -78,6 +90,14 @@ class DHashIpv4 : public Object
      *  See ChordIpv4::Insert
      */
     void Insert(uint8_t *key,uint8_t sizeOfKey ,uint8_t *object,uint32_t sizeOfObject);    
+    /**
+     *  \brief See ChordIpv4::Insert (const ChordKey&, uint8_t*, uint32_t)
+     */
+    void Insert (const ChordKey &key, uint8_t *object, uint32_t sizeOfObject);
+    /**
+     *  \brief See ChordIpv4::Insert (uint8_t*, uint8_t, Ptr<const Packet>)
+     */
+    void Insert (uint8_t *key, uint8_t sizeOfKey, Ptr<const Packet> object);
      /**
      *  \brief Retrieves object from Chord/DHash (DHashIpv4) network represented by given key (identifier)
      *  \param key Pointer to key array (identifier)
@@ -87,22 +107,52 @@ class DHashIpv4 : public Object
      */
 
     void Retrieve (uint8_t* key, uint8_t sizeOfKey);
+    /**
+     *  \brief See ChordIpv4::Retrieve (const ChordKey&)
+     */
+    void Retrieve (const ChordKey &key);
+    /**
+     *  \brief Retrieves all objects with identifier in (lowKey, highKey], page by page along successors
+     *  \param lowKey Pointer to key array of low end of range (excluded)
+     *  \param highKey Pointer to key array of high end of range (included)
+     *  \param sizeOfKey Number of bytes in both keys (max 255)
+     *  \returns range query Id
+     *
+     *  See ChordIpv4::RetrieveRange
+     */
+    uint32_t RetrieveRange (uint8_t* lowKey, uint8_t* highKey, uint8_t sizeOfKey);
+    /**
+     *  \brief See ChordIpv4::RetrieveRange (const ChordKey&, const ChordKey&)
+     */
+    uint32_t RetrieveRange (const ChordKey &lowKey, const ChordKey &highKey);
     /**
      *  \brief See ChordIpv4::SetInsertSuccessCallback
      */
-    void SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t>);
+    void SetInsertSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> >);
     /**
      *  \brief See ChordIpv4::SetRetrieveSuccessCallback
      */
-    void SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t>);
+    void SetRetrieveSuccessCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> >);
     /**
      *  \brief See ChordIpv4::SetInsertFailureCallback
      */
-    void SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, uint8_t*, uint32_t>); 
+    void SetInsertFailureCallback (Callback <void, uint8_t*, uint8_t, Ptr<const Packet> >); 
     /**
      *  \brief See ChordIpv4::SetRetrieveFailureCallback
      */
     void SetRetrieveFailureCallback (Callback <void, uint8_t*, uint8_t>);
+    /**
+     *  \brief See ChordIpv4::SetRetrieveRangeCallback
+     */
+    void SetRetrieveRangeCallback (Callback <void, uint32_t, uint8_t*, uint8_t, Ptr<const Packet> >);
+    /**
+     *  \brief See ChordIpv4::SetRetrieveRangeCompleteCallback
+     */
+    void SetRetrieveRangeCompleteCallback (Callback <void, uint32_t, bool>);
+    /**
+     *  \brief See ChordIpv4::AuditDHashObjects
+     */
+    void AuditObjects (void);
 
     //Diagnostics interface
     /**
@@ -125,15 +175,26 @@ class DHashIpv4 : public Object
     //Periodic processes
     void DoPeriodicAuditConnections ();
     void DoPeriodicAuditObjects ();
+    //Timeouts
+    void HandleRequestTimeout (uint32_t transactionId);
 
     
   private:
-    typedef std::map<ChordIdentifier, Ptr<DHashObject> > DHashObjectMap;
-    DHashObjectMap m_dHashObjectTable;
+    //Stored objects, backend named by m_objectStoreType
+    Ptr<DHashObjectStore> m_objectStore;
+    std::string m_objectStoreType;
     typedef std::map<Ptr<Socket>, Ptr<DHashConnection> > DHashConnectionMap;
     DHashConnectionMap m_dHashConnectionTable;
     typedef std::map<uint32_t, Ptr<DHashTransaction> > DHashTransactionMap;
     DHashTransactionMap m_dHashTransactionTable;
+    //Requests waiting for connection to drain, packed into bulk messages by FlushRequests
+    struct DHashPendingRequests
+    {
+      std::deque<DHashMessage> requests;
+      EventId flushEvent;
+    };
+    typedef std::map<Ptr<DHashConnection>, DHashPendingRequests> DHashPendingRequestMap;
+    DHashPendingRequestMap m_pendingRequestTable;
 
     Ptr<ChordIpv4> m_chordApplication;
     Ipv4Address m_localIpAddress;
@@ -144,17 +205,47 @@ class DHashIpv4 : public Object
     Timer m_auditConnectionsTimer;
     Time m_auditObjectsTimeout;
     Timer m_auditObjectsTimer;
+    Time m_requestTimeout;
+    //Request timeouts of active transactions
+    ChordTimerWheel m_timerWheel;
+    Time m_timerWheelResolution;
+    //Owner and (m_replicationFactor - 1) successors store each object
+    uint8_t m_replicationFactor;
+    //If 0 < m_dataFragments < m_replicationFactor, each of these nodes stores one erasure coded fragment instead
+    uint8_t m_dataFragments;
+    //Max bytes of requests packed into one bulk message, 0 sends each request on its own
+    uint32_t m_bulkTransferSize;
+    //Max objects in one response to a range retrieve
+    uint32_t m_rangePageSize;
 
     uint32_t m_transactionId;
+    uint32_t m_rangeQueryId;
     //Callbacks
-    Callback<void, uint8_t*, uint8_t, uint8_t*, uint32_t> m_insertSuccessFn;
-    Callback<void, uint8_t*, uint8_t, uint8_t*, uint32_t> m_retrieveSuccessFn;
-    Callback<void, uint8_t*, uint8_t, uint8_t*, uint32_t> m_insertFailureFn;
+    Callback<void, uint8_t*, uint8_t, Ptr<const Packet> > m_insertSuccessFn;
+    Callback<void, uint8_t*, uint8_t, Ptr<const Packet> > m_retrieveSuccessFn;
+    Callback<void, uint8_t*, uint8_t, Ptr<const Packet> > m_insertFailureFn;
     Callback<void, uint8_t*, uint8_t> m_retrieveFailureFn;
+    Callback<void, uint32_t, uint8_t*, uint8_t, Ptr<const Packet> > m_retrieveRangeFn;
+    Callback<void, uint32_t, bool> m_retrieveRangeCompleteFn;
 
 
 
     void SendDHashRequest (Ipv4Address ipAddress, uint16_t port, Ptr<DHashTransaction> dHashTransaction);
+    void SendDHashRequest (Ipv4Address ipAddress, uint16_t port, Ptr<DHashTransaction> dHashTransaction, DHashMessage dHashMessage);
+    void SendReplicatedRequest (std::vector<InetSocketAddress> &destinations, Ptr<DHashTransaction> dHashTransaction);
+    void SendRetrieveRequest (Ptr<DHashTransaction> dHashTransaction);
+    void QueueDHashRequest (Ptr<DHashConnection> dHashConnection, DHashMessage dHashMessage);
+    void FlushRequests (Ptr<DHashConnection> dHashConnection);
+    void HandleTxReady (Ptr<DHashConnection> dHashConnection);
+    bool ResolveReplicaGroup (Ptr<DHashTransaction> dHashTransaction, bool success);
+    Ptr<DHashObject> GetRequestObject (Ptr<DHashTransaction> dHashTransaction);
+
+    //Erasure coding
+    bool IsErasureCoded ();
+    Ptr<DHashObject> EncodeFragment (Ptr<DHashObject> dHashObject, uint8_t fragmentIndex);
+    bool CollectFragment (Ptr<DHashReplicaGroup> replicaGroup, Ptr<DHashObject> fragment);
+    Ptr<DHashObject> DecodeFragments (std::vector<Ptr<DHashObject> > &fragments);
+    Ptr<DHashObject> DecodeReplicaGroup (Ptr<DHashReplicaGroup> replicaGroup);
 
     //Connection Layer
     Ptr<DHashConnection> AddConnection (Ptr<Socket> socket, Ipv4Address ipAddress, uint16_t port);
@@ -165,9 +256,20 @@ class DHashIpv4 : public Object
 
     //Object repository
     void AddObject (Ptr<DHashObject> object);
+    void StoreObject (Ptr<DHashObject> object);
     bool FindObject (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject>& dHashObject);
     void RemoveObject (Ptr<ChordIdentifier> objectIdentifier);
     void TransferObject (Ptr<DHashObject> dHashObject, DHashTransaction::Originator originator, Ipv4Address ipAddress, uint16_t port);
+    void ReplicateObject (Ptr<DHashObject> dHashObject);
+    void RepairFragments (Ptr<DHashObject> fragment);
+    void GetObjectRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &dHashObjects);
+
+    //Range retrieve
+    void RequestRangePage (Ptr<DHashRangeQuery> rangeQuery, Ipv4Address ipAddress, uint16_t port);
+    bool ScanRange (Ptr<ChordIdentifier> cursorIdentifier, Ptr<ChordIdentifier> highIdentifier, uint32_t maxObjects, DHashMessage::RetrieveRangeRsp &retrieveRangeRsp);
+    bool DeliverRangePage (Ptr<DHashRangeQuery> rangeQuery, DHashMessage::RetrieveRangeRsp &retrieveRangeRsp);
+    void RebuildRangeObject (Ptr<DHashRangeQuery> rangeQuery, Ptr<DHashObject> fragment);
+    void CompleteRangeQuery (Ptr<DHashRangeQuery> rangeQuery, bool success);
 
     //Transaction Layer
     void AddTransaction (Ptr<DHashTransaction> dHashTransaction);
@@ -175,12 +277,17 @@ class DHashIpv4 : public Object
     void RemoveTransaction (uint32_t transactionId);
     void RemoveActiveTransactions (Ptr<Socket> socket);
 
+    void InsertObject (Ptr<DHashObject> dHashObject);
+
     //Notifications
     void NotifyInsertSuccess (Ptr<DHashObject> object);
     void NotifyRetrieveSuccess (Ptr<DHashObject> object);
+    void NotifyRetrieveResult (Ptr<DHashTransaction> dHashTransaction, Ptr<DHashObject> object);
     void NotifyFailure (Ptr<DHashTransaction> dHashTransaction);
     void NotifyInsertFailure (Ptr<DHashObject> object);
     void NotifyRetrieveFailure (Ptr<ChordIdentifier> objectIdentifier);
+    void NotifyRetrieveRange (uint32_t queryId, Ptr<DHashObject> object);
+    void NotifyRetrieveRangeComplete (uint32_t queryId, bool success);
 
 
     //Packing methods
@@ -188,6 +295,7 @@ class DHashIpv4 : public Object
     void PackStoreRsp (uint32_t transactionId, uint8_t statusTag, Ptr<ChordIdentifier> objectIdentifier, DHashMessage& respMessage);
     void PackRetrieveReq (Ptr<ChordIdentifier> objectIdentifier, DHashMessage& dHashMessage);
     void PackRetrieveRsp (uint32_t transactionId, uint8_t statusTag, Ptr<DHashObject> dHashObject, DHashMessage& respMessage);
+    void PackRetrieveRangeReq (Ptr<ChordIdentifier> cursorIdentifier, Ptr<ChordIdentifier> highIdentifier, DHashMessage& dHashMessage);
 
 
     //Processing methods
@@ -195,11 +303,17 @@ class DHashIpv4 : public Object
     void ProcessStoreRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
     void ProcessRetrieveReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
     void ProcessRetrieveRsp(DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
+    void ProcessStoreBulkReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
+    void ProcessStoreBulkRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
+    void ProcessRetrieveBulkReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
+    void ProcessRetrieveBulkRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
+    void ProcessRetrieveRangeReq (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
+    void ProcessRetrieveRangeRsp (DHashMessage dHashMessage, Ptr<DHashConnection> dHashConnection);
 
 
     //Lookup handle
     void HandleLookupFailure (uint8_t* lookupKey, uint8_t lookupKeyBytes);
-    void HandleLookupSuccess (uint8_t* lookupKey, uint8_t lookupKeyBytes, Ipv4Address ipAddress, uint16_t port);
+    void HandleLookupSuccess (uint8_t* lookupKey, uint8_t lookupKeyBytes, Ipv4Address ipAddress, uint16_t port, std::vector<InetSocketAddress> replicas);
    
 
     uint32_t GetNextTransactionId ();
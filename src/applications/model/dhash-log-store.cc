@@ -0,0 +1,387 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "dhash-log-store.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DHashLogStore");
+NS_OBJECT_ENSURE_REGISTERED (DHashLogStore);
+
+//Records start on 8 byte boundaries
+#define DHASH_LOG_ALIGNMENT 8
+//Log file starts with this many bytes and doubles when full
+#define DHASH_LOG_INITIAL_SIZE (1 << 20)
+//Dead records are reclaimed once they exceed live records and this many bytes
+#define DHASH_LOG_MIN_COMPACT_SIZE (1 << 20)
+//Faulting on a record maps in this many bytes of log around it (Linux fault_around_bytes)
+#define DHASH_LOG_FAULT_AROUND (1 << 16)
+
+TypeId
+DHashLogStore::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DHashLogStore")
+    .SetParent<DHashObjectStore> ()
+    .AddConstructor<DHashLogStore> ()
+    .AddAttribute ("Directory",
+                   "Directory of log files",
+                   StringValue ("/tmp"),
+                   MakeStringAccessor (&DHashLogStore::m_directory),
+                   MakeStringChecker ())
+    .AddAttribute ("MaxResidentBytes",
+                   "Bytes of log written or read after which mapped pages are released (0 leaves paging to the kernel)",
+                   UintegerValue (1 << 24),
+                   MakeUintegerAccessor (&DHashLogStore::m_maxResidentBytes),
+                   MakeUintegerChecker<uint64_t> ())
+    ;
+  return tid;
+}
+
+DHashLogStore::DHashLogStore ()
+  : m_fd (-1),
+    m_base (0),
+    m_capacity (0),
+    m_writeOffset (0),
+    m_deadBytes (0),
+    m_touchedBytes (0)
+{
+}
+
+DHashLogStore::~DHashLogStore ()
+{
+}
+
+void
+DHashLogStore::DoDispose (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_base != 0)
+  {
+    munmap (m_base, m_capacity);
+    m_base = 0;
+  }
+  if (m_fd >= 0)
+  {
+    close (m_fd);
+    m_fd = -1;
+  }
+  m_index.clear ();
+  DHashObjectStore::DoDispose ();
+}
+
+void
+DHashLogStore::Open (std::string name)
+{
+  NS_LOG_FUNCTION (name);
+  NS_ASSERT (m_fd < 0);
+  m_name = name;
+  m_fd = OpenFile ();
+  MapFile (DHASH_LOG_INITIAL_SIZE);
+}
+
+int
+DHashLogStore::OpenFile (void)
+{
+  //Unique name: parallel runs may use the same directory and node addresses
+  std::string path = m_directory + "/dhash-XXXXXX";
+  std::vector<char> buffer (path.begin (), path.end ());
+  buffer.push_back ('\0');
+  int fd = mkstemp (&buffer[0]);
+  NS_ABORT_MSG_IF (fd < 0, "DHashLogStore::OpenFile cannot create log for " << m_name << " in " << m_directory);
+  //Scratch file, space is freed once closed
+  unlink (&buffer[0]);
+  return fd;
+}
+
+void
+DHashLogStore::MapFile (uint64_t capacity)
+{
+  if (m_base != 0)
+  {
+    munmap (m_base, m_capacity);
+    m_base = 0;
+  }
+  NS_ABORT_MSG_IF (ftruncate (m_fd, capacity) != 0, "DHashLogStore::MapFile cannot grow log for " << m_name);
+  void *base = mmap (0, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  NS_ABORT_MSG_IF (base == MAP_FAILED, "DHashLogStore::MapFile mmap failed");
+  //Records are looked up in key order, not log order: no read-ahead
+  madvise (base, capacity, MADV_RANDOM);
+  m_base = (uint8_t *) base;
+  m_capacity = capacity;
+}
+
+void
+DHashLogStore::Touch (uint64_t bytes)
+{
+  if (m_maxResidentBytes == 0)
+  {
+    return;
+  }
+  m_touchedBytes += bytes;
+  if (m_touchedBytes > m_maxResidentBytes)
+  {
+    //Drop pages from our address space, they stay in page cache (or on disk once written back)
+    madvise (m_base, m_capacity, MADV_DONTNEED);
+    m_touchedBytes = 0;
+  }
+}
+
+ChordKey
+DHashLogStore::GetIndexKey (Ptr<ChordIdentifier> objectIdentifier)
+{
+  NS_ABORT_MSG_IF (objectIdentifier->GetNumBytes () != ChordKey::NUM_BYTES, "DHashLogStore needs identifiers of ChordKey::NUM_BYTES bytes");
+  return ChordKey (objectIdentifier->GetKey ());
+}
+
+uint64_t
+DHashLogStore::GetRecordSize (uint64_t offset) const
+{
+  RecordHeader header;
+  memcpy (&header, m_base + offset, sizeof (header));
+  uint64_t size = sizeof (header) + header.keyBytes + header.sizeOfObject;
+  return (size + DHASH_LOG_ALIGNMENT - 1) & ~((uint64_t) DHASH_LOG_ALIGNMENT - 1);
+}
+
+uint64_t
+DHashLogStore::Append (Ptr<DHashObject> object)
+{
+  NS_ASSERT_MSG (m_base != 0, "DHashLogStore used before Open");
+  Ptr<ChordIdentifier> objectIdentifier = object->GetObjectIdentifier ();
+  RecordHeader header;
+  header.sizeOfObject = object->GetSizeOfObject ();
+  header.sizeOfCodedObject = object->GetSizeOfCodedObject ();
+  header.keyBytes = objectIdentifier->GetNumBytes ();
+  header.dataFragments = object->GetDataFragments ();
+  header.fragmentIndex = object->GetFragmentIndex ();
+  header.reserved = 0;
+  uint64_t size = sizeof (header) + header.keyBytes + header.sizeOfObject;
+  size = (size + DHASH_LOG_ALIGNMENT - 1) & ~((uint64_t) DHASH_LOG_ALIGNMENT - 1);
+  if (m_writeOffset + size > m_capacity)
+  {
+    uint64_t capacity = m_capacity;
+    while (m_writeOffset + size > capacity)
+    {
+      capacity *= 2;
+    }
+    MapFile (capacity);
+  }
+  uint64_t offset = m_writeOffset;
+  uint8_t *record = m_base + offset;
+  memcpy (record, &header, sizeof (header));
+  memcpy (record + sizeof (header), objectIdentifier->GetKey (), header.keyBytes);
+  object->CopyObject (record + sizeof (header) + header.keyBytes);
+  m_writeOffset += size;
+  Touch (size);
+  return offset;
+}
+
+Ptr<DHashObject>
+DHashLogStore::Load (uint64_t offset)
+{
+  RecordHeader header;
+  uint8_t *record = m_base + offset;
+  memcpy (&header, record, sizeof (header));
+  Ptr<ChordIdentifier> objectIdentifier = Create<ChordIdentifier> (record + sizeof (header), header.keyBytes);
+  Ptr<Packet> packet = Create<Packet> (record + sizeof (header) + header.keyBytes, header.sizeOfObject);
+  Ptr<DHashObject> object = Create<DHashObject> (objectIdentifier, packet);
+  if (header.dataFragments != 0)
+  {
+    object->SetFragment (header.fragmentIndex, header.dataFragments, header.sizeOfCodedObject);
+  }
+  Touch (std::max<uint64_t> (sizeof (header) + header.keyBytes + header.sizeOfObject, DHASH_LOG_FAULT_AROUND));
+  return object;
+}
+
+void
+DHashLogStore::Release (uint64_t offset)
+{
+  m_deadBytes += GetRecordSize (offset);
+  Touch (DHASH_LOG_FAULT_AROUND);
+  if (m_deadBytes >= DHASH_LOG_MIN_COMPACT_SIZE && m_deadBytes > m_writeOffset - m_deadBytes)
+  {
+    Compact ();
+  }
+}
+
+void
+DHashLogStore::Compact (void)
+{
+  NS_LOG_FUNCTION (m_writeOffset << m_deadBytes);
+  //Copy live records in key order into new log
+  uint64_t liveBytes = m_writeOffset - m_deadBytes;
+  uint64_t capacity = DHASH_LOG_INITIAL_SIZE;
+  while (capacity < liveBytes)
+  {
+    capacity *= 2;
+  }
+  int fd = OpenFile ();
+  NS_ABORT_MSG_IF (ftruncate (fd, capacity) != 0, "DHashLogStore::Compact cannot grow log for " << m_name);
+  void *base = mmap (0, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  NS_ABORT_MSG_IF (base == MAP_FAILED, "DHashLogStore::Compact mmap failed");
+  madvise (base, capacity, MADV_RANDOM);
+  uint64_t writeOffset = 0;
+  uint64_t copiedBytes = 0;
+  for (DHashLogIndex::iterator iterator = m_index.begin (); iterator != m_index.end (); iterator++)
+  {
+    uint64_t size = GetRecordSize (iterator->second);
+    memcpy ((uint8_t *) base + writeOffset, m_base + iterator->second, size);
+    iterator->second = writeOffset;
+    writeOffset += size;
+    copiedBytes += size + std::max<uint64_t> (size, DHASH_LOG_FAULT_AROUND);
+    if (m_maxResidentBytes != 0 && copiedBytes > m_maxResidentBytes)
+    {
+      //Reads of old log and writes of new log both map pages, release as we go
+      madvise (m_base, m_capacity, MADV_DONTNEED);
+      madvise (base, capacity, MADV_DONTNEED);
+      copiedBytes = 0;
+    }
+  }
+  munmap (m_base, m_capacity);
+  close (m_fd);
+  m_fd = fd;
+  m_base = (uint8_t *) base;
+  m_capacity = capacity;
+  m_writeOffset = writeOffset;
+  m_deadBytes = 0;
+  m_touchedBytes = 0;
+  Touch (copiedBytes);
+}
+
+bool
+DHashLogStore::Add (Ptr<DHashObject> object)
+{
+  ChordKey key = GetIndexKey (object->GetObjectIdentifier ());
+  if (m_index.find (key) != m_index.end ())
+  {
+    return false;
+  }
+  m_index.insert (std::make_pair (key, Append (object)));
+  return true;
+}
+
+void
+DHashLogStore::Replace (Ptr<DHashObject> object)
+{
+  ChordKey key = GetIndexKey (object->GetObjectIdentifier ());
+  uint64_t offset = Append (object);
+  DHashLogIndex::iterator iterator = m_index.find (key);
+  if (iterator == m_index.end ())
+  {
+    m_index.insert (std::make_pair (key, offset));
+    return;
+  }
+  uint64_t oldOffset = iterator->second;
+  iterator->second = offset;
+  Release (oldOffset);
+}
+
+bool
+DHashLogStore::Find (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject> &object)
+{
+  DHashLogIndex::iterator iterator = m_index.find (GetIndexKey (objectIdentifier));
+  if (iterator == m_index.end ())
+  {
+    return false;
+  }
+  object = Load (iterator->second);
+  return true;
+}
+
+void
+DHashLogStore::Remove (Ptr<ChordIdentifier> objectIdentifier)
+{
+  DHashLogIndex::iterator iterator = m_index.find (GetIndexKey (objectIdentifier));
+  if (iterator == m_index.end ())
+  {
+    return;
+  }
+  uint64_t offset = iterator->second;
+  m_index.erase (iterator);
+  Release (offset);
+}
+
+void
+DHashLogStore::GetRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &objects, uint32_t maxObjects)
+{
+  //Index order is identifier order, so range is one or two (wrap-around) runs, see DHashMapStore::GetRange
+  uint32_t limit = objects.size () + maxObjects;
+  ChordKey lowKey = GetIndexKey (lowIdentifier);
+  ChordKey highKey = GetIndexKey (highIdentifier);
+  DHashLogIndex::iterator lowIter = m_index.upper_bound (lowKey);
+  DHashLogIndex::iterator highIter = m_index.upper_bound (highKey);
+  if (lowKey < highKey)
+  {
+    for (DHashLogIndex::iterator iterator = lowIter; iterator != highIter && (maxObjects == 0 || objects.size () < limit); iterator++)
+    {
+      objects.push_back (Load (iterator->second));
+    }
+    return;
+  }
+  for (DHashLogIndex::iterator iterator = lowIter; iterator != m_index.end (); iterator++)
+  {
+    if (maxObjects != 0 && objects.size () >= limit)
+    {
+      return;
+    }
+    objects.push_back (Load (iterator->second));
+  }
+  for (DHashLogIndex::iterator iterator = m_index.begin (); iterator != highIter && (maxObjects == 0 || objects.size () < limit); iterator++)
+  {
+    if (iterator->first == lowKey)
+    {
+      //low == high, whole ring except high
+      break;
+    }
+    objects.push_back (Load (iterator->second));
+  }
+}
+
+void
+DHashLogStore::GetIdentifiers (std::vector<Ptr<ChordIdentifier> > &objectIdentifiers)
+{
+  for (DHashLogIndex::iterator iterator = m_index.begin (); iterator != m_index.end (); iterator++)
+  {
+    objectIdentifiers.push_back (Create<ChordIdentifier> (iterator->first));
+  }
+}
+
+uint32_t
+DHashLogStore::GetSize (void)
+{
+  return m_index.size ();
+}
+
+uint64_t
+DHashLogStore::GetLogSize (void) const
+{
+  return m_writeOffset;
+}
+
+} //namespace ns3
@@ -0,0 +1,107 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DHASH_LOG_STORE_H
+#define DHASH_LOG_STORE_H
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include "chord-key.h"
+#include "dhash-object-store.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class DHashLogStore
+ *  \brief DHashObjectStore keeping objects in an append-only log file mapped into memory
+ *
+ *  Each node appends records (fragment info, key, object bytes) to its own log file under attribute Directory; only an ordered
+ *  ChordKey to log offset index stays on the heap. Find and GetRange copy objects out of the mapping. Once attribute MaxResidentBytes
+ *  of log has been written or read (a read counts as the fault-around window it maps in), mapped pages are released (madvise), so
+ *  resident memory stays bounded and the kernel pages log out to disk under memory pressure. Removed and replaced records are reclaimed by rewriting live records into a new log when they
+ *  take up more than half of it.
+ *
+ *  Log is scratch space of one run: file gets a unique name (mkstemp), is unlinked once open and is not reloaded. Object identifiers must be ChordKey::NUM_BYTES long.
+ */
+class DHashLogStore : public DHashObjectStore
+{
+  public:
+    static TypeId GetTypeId (void);
+    DHashLogStore ();
+    virtual ~DHashLogStore ();
+    virtual void DoDispose (void);
+
+    virtual void Open (std::string name);
+    virtual bool Add (Ptr<DHashObject> object);
+    virtual void Replace (Ptr<DHashObject> object);
+    virtual bool Find (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject> &object);
+    virtual void Remove (Ptr<ChordIdentifier> objectIdentifier);
+    virtual void GetRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &objects, uint32_t maxObjects);
+    virtual void GetIdentifiers (std::vector<Ptr<ChordIdentifier> > &objectIdentifiers);
+    virtual uint32_t GetSize (void);
+
+    /**
+     *  \returns Bytes of log in use (live and dead records)
+     */
+    uint64_t GetLogSize (void) const;
+
+  private:
+    /**
+     *  \cond
+     */
+    struct RecordHeader
+    {
+      uint32_t sizeOfObject;
+      uint32_t sizeOfCodedObject;
+      uint8_t keyBytes;
+      uint8_t dataFragments;
+      uint8_t fragmentIndex;
+      uint8_t reserved;
+    };
+    typedef std::map<ChordKey, uint64_t> DHashLogIndex;
+
+    ChordKey GetIndexKey (Ptr<ChordIdentifier> objectIdentifier);
+    uint64_t Append (Ptr<DHashObject> object);
+    Ptr<DHashObject> Load (uint64_t offset);
+    uint64_t GetRecordSize (uint64_t offset) const;
+    int OpenFile (void);
+    void MapFile (uint64_t capacity);
+    void Touch (uint64_t bytes);
+    void Release (uint64_t offset);
+    void Compact (void);
+
+    std::string m_directory;
+    uint64_t m_maxResidentBytes;
+    std::string m_name;
+    int m_fd;
+    uint8_t *m_base;
+    uint64_t m_capacity;
+    uint64_t m_writeOffset;
+    uint64_t m_deadBytes;
+    uint64_t m_touchedBytes;
+    DHashLogIndex m_index;
+    /**
+     *  \endcond
+     */
+}; //class DHashLogStore
+
+} //namespace ns3
+
+#endif //DHASH_LOG_STORE_H
@@ -121,6 +121,24 @@ DHashMessage::GetSerializedSize (void) const
     case RETRIEVE_RSP:
       size += m_message.retrieveRsp.GetSerializedSize ();
       break;
+    case STORE_BULK_REQ:
+      size += m_message.storeBulkReq.GetSerializedSize ();
+      break;
+    case STORE_BULK_RSP:
+      size += m_message.storeBulkRsp.GetSerializedSize ();
+      break;
+    case RETRIEVE_BULK_REQ:
+      size += m_message.retrieveBulkReq.GetSerializedSize ();
+      break;
+    case RETRIEVE_BULK_RSP:
+      size += m_message.retrieveBulkRsp.GetSerializedSize ();
+      break;
+    case RETRIEVE_RANGE_REQ:
+      size += m_message.retrieveRangeReq.GetSerializedSize ();
+      break;
+    case RETRIEVE_RANGE_RSP:
+      size += m_message.retrieveRangeRsp.GetSerializedSize ();
+      break;
     default:
       NS_ASSERT (false);
   }
@@ -149,6 +167,24 @@ DHashMessage::Print (std::ostream &os) const
     case RETRIEVE_RSP:
       m_message.retrieveRsp.Print (os);
       break;
+    case STORE_BULK_REQ:
+      m_message.storeBulkReq.Print (os);
+      break;
+    case STORE_BULK_RSP:
+      m_message.storeBulkRsp.Print (os);
+      break;
+    case RETRIEVE_BULK_REQ:
+      m_message.retrieveBulkReq.Print (os);
+      break;
+    case RETRIEVE_BULK_RSP:
+      m_message.retrieveBulkRsp.Print (os);
+      break;
+    case RETRIEVE_RANGE_REQ:
+      m_message.retrieveRangeReq.Print (os);
+      break;
+    case RETRIEVE_RANGE_RSP:
+      m_message.retrieveRangeRsp.Print (os);
+      break;
     default:
       break;
   }
@@ -176,6 +212,24 @@ DHashMessage::Serialize (Buffer::Iterator start) const
     case RETRIEVE_RSP:
       m_message.retrieveRsp.Serialize (i);
       break;
+    case STORE_BULK_REQ:
+      m_message.storeBulkReq.Serialize (i);
+      break;
+    case STORE_BULK_RSP:
+      m_message.storeBulkRsp.Serialize (i);
+      break;
+    case RETRIEVE_BULK_REQ:
+      m_message.retrieveBulkReq.Serialize (i);
+      break;
+    case RETRIEVE_BULK_RSP:
+      m_message.retrieveBulkRsp.Serialize (i);
+      break;
+    case RETRIEVE_RANGE_REQ:
+      m_message.retrieveRangeReq.Serialize (i);
+      break;
+    case RETRIEVE_RANGE_RSP:
+      m_message.retrieveRangeRsp.Serialize (i);
+      break;
     default:
       NS_ASSERT (false);
   }
@@ -205,12 +259,122 @@ DHashMessage::Deserialize (Buffer::Iterator start)
     case RETRIEVE_RSP:
       size += m_message.retrieveRsp.Deserialize (i);
       break;
+    case STORE_BULK_REQ:
+      size += m_message.storeBulkReq.Deserialize (i);
+      break;
+    case STORE_BULK_RSP:
+      size += m_message.storeBulkRsp.Deserialize (i);
+      break;
+    case RETRIEVE_BULK_REQ:
+      size += m_message.retrieveBulkReq.Deserialize (i);
+      break;
+    case RETRIEVE_BULK_RSP:
+      size += m_message.retrieveBulkRsp.Deserialize (i);
+      break;
+    case RETRIEVE_RANGE_REQ:
+      size += m_message.retrieveRangeReq.Deserialize (i);
+      break;
+    case RETRIEVE_RANGE_RSP:
+      size += m_message.retrieveRangeRsp.Deserialize (i);
+      break;
     default:
       NS_ASSERT (false);
   }
   return size;
 }
 
+Ptr<Packet>
+DHashMessage::CreatePacket (void) const
+{
+  std::vector<Ptr<DHashObject> > objects;
+  GetObjects (objects);
+  if (objects.empty ())
+  {
+    Ptr<Packet> packet = Create<Packet> ();
+    packet->AddHeader (*this);
+    return packet;
+  }
+  //Message is prepended to buffer of first object, further objects are chained behind it
+  Ptr<Packet> packet = objects[0]->GetObject ()->Copy ();
+  for (uint32_t j = 1; j < objects.size (); j++)
+  {
+    packet->AddAtEnd (objects[j]->GetObject ());
+  }
+  packet->AddHeader (*this);
+  return packet;
+}
+
+bool
+DHashMessage::RemoveFromPacket (Ptr<Packet> packet)
+{
+  packet->RemoveHeader (*this);
+  std::vector<Ptr<DHashObject> > objects;
+  GetObjects (objects);
+  uint32_t offset = 0;
+  for (uint32_t j = 0; j < objects.size (); j++)
+  {
+    uint32_t sizeOfObject = objects[j]->GetSizeOfObject ();
+    if (offset + sizeOfObject > packet->GetSize ())
+    {
+      NS_LOG_WARN ("Truncated object bytes");
+      return false;
+    }
+    objects[j]->SetObject (packet->CreateFragment (offset, sizeOfObject));
+    offset += sizeOfObject;
+  }
+  return true;
+}
+
+uint32_t
+DHashMessage::GetPayloadSize (void) const
+{
+  std::vector<Ptr<DHashObject> > objects;
+  GetObjects (objects);
+  uint32_t size = 0;
+  for (uint32_t j = 0; j < objects.size (); j++)
+  {
+    size += objects[j]->GetSizeOfObject ();
+  }
+  return size;
+}
+
+void
+DHashMessage::GetObjects (std::vector<Ptr<DHashObject> > &objects) const
+{
+  switch (m_messageType)
+  {
+    case STORE_REQ:
+      objects.push_back (m_message.storeReq.dHashObject);
+      break;
+    case RETRIEVE_RSP:
+      if (m_message.retrieveRsp.statusTag == OBJECT_FOUND)
+      {
+        objects.push_back (m_message.retrieveRsp.dHashObject);
+      }
+      break;
+    case STORE_BULK_REQ:
+      for (uint32_t j = 0; j < m_message.storeBulkReq.storeReqs.size (); j++)
+      {
+        objects.push_back (m_message.storeBulkReq.storeReqs[j].dHashObject);
+      }
+      break;
+    case RETRIEVE_BULK_RSP:
+      for (uint32_t j = 0; j < m_message.retrieveBulkRsp.retrieveRsps.size (); j++)
+      {
+        if (m_message.retrieveBulkRsp.retrieveRsps[j].statusTag == OBJECT_FOUND)
+        {
+          objects.push_back (m_message.retrieveBulkRsp.retrieveRsps[j].dHashObject);
+        }
+      }
+      break;
+    case RETRIEVE_RANGE_RSP:
+      objects.insert (objects.end (), m_message.retrieveRangeRsp.dHashObjects.begin (), m_message.retrieveRangeRsp.dHashObjects.end ());
+      break;
+    default:
+      break;
+  }
+}
+
 /* Message Payloads */
 
 
@@ -350,4 +514,308 @@ DHashMessage::RetrieveRsp::Deserialize (Buffer::Iterator &start)
   return GetSerializedSize();
 }
 
+/* STORE_BULK_REQ */
+uint32_t
+DHashMessage::StoreBulkReq::GetSerializedSize (void) const
+{
+  uint32_t size = sizeof (uint32_t);
+  for (uint32_t j = 0; j < storeReqs.size (); j++)
+  {
+    size += sizeof (uint32_t) + storeReqs[j].GetSerializedSize ();
+  }
+  return size; 
+}
+
+void
+DHashMessage::StoreBulkReq::Print (std::ostream &os) const
+{
+  os << "StoreBulkReq: \n";
+  os << "Entries: " << storeReqs.size () << "\n";
+  for (uint32_t j = 0; j < storeReqs.size (); j++)
+  {
+    os << "TransactionId: " << transactionIds[j] << "\n";
+    storeReqs[j].Print (os);
+  }
+}
+
+void
+DHashMessage::StoreBulkReq::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU32 (storeReqs.size ());
+  for (uint32_t j = 0; j < storeReqs.size (); j++)
+  {
+    start.WriteHtonU32 (transactionIds[j]);
+    storeReqs[j].Serialize (start);
+  }
+}
+
+uint32_t
+DHashMessage::StoreBulkReq::Deserialize (Buffer::Iterator &start)
+{
+  uint32_t numEntries = start.ReadNtohU32 ();
+  transactionIds.resize (numEntries);
+  storeReqs.resize (numEntries);
+  for (uint32_t j = 0; j < numEntries; j++)
+  {
+    transactionIds[j] = start.ReadNtohU32 ();
+    storeReqs[j].Deserialize (start);
+  }
+  return GetSerializedSize();
+}
+
+/* STORE_BULK_RSP */
+uint32_t
+DHashMessage::StoreBulkRsp::GetSerializedSize (void) const
+{
+  uint32_t size = sizeof (uint32_t);
+  for (uint32_t j = 0; j < storeRsps.size (); j++)
+  {
+    size += sizeof (uint32_t) + storeRsps[j].GetSerializedSize ();
+  }
+  return size; 
+}
+
+void
+DHashMessage::StoreBulkRsp::Print (std::ostream &os) const
+{
+  os << "StoreBulkRsp: \n";
+  os << "Entries: " << storeRsps.size () << "\n";
+  for (uint32_t j = 0; j < storeRsps.size (); j++)
+  {
+    os << "TransactionId: " << transactionIds[j] << "\n";
+    storeRsps[j].Print (os);
+  }
+}
+
+void
+DHashMessage::StoreBulkRsp::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU32 (storeRsps.size ());
+  for (uint32_t j = 0; j < storeRsps.size (); j++)
+  {
+    start.WriteHtonU32 (transactionIds[j]);
+    storeRsps[j].Serialize (start);
+  }
+}
+
+uint32_t
+DHashMessage::StoreBulkRsp::Deserialize (Buffer::Iterator &start)
+{
+  uint32_t numEntries = start.ReadNtohU32 ();
+  transactionIds.resize (numEntries);
+  storeRsps.resize (numEntries);
+  for (uint32_t j = 0; j < numEntries; j++)
+  {
+    transactionIds[j] = start.ReadNtohU32 ();
+    storeRsps[j].Deserialize (start);
+  }
+  return GetSerializedSize();
+}
+
+/* RETRIEVE_BULK_REQ */
+uint32_t
+DHashMessage::RetrieveBulkReq::GetSerializedSize (void) const
+{
+  uint32_t size = sizeof (uint32_t);
+  for (uint32_t j = 0; j < retrieveReqs.size (); j++)
+  {
+    size += sizeof (uint32_t) + retrieveReqs[j].GetSerializedSize ();
+  }
+  return size; 
+}
+
+void
+DHashMessage::RetrieveBulkReq::Print (std::ostream &os) const
+{
+  os << "RetrieveBulkReq: \n";
+  os << "Entries: " << retrieveReqs.size () << "\n";
+  for (uint32_t j = 0; j < retrieveReqs.size (); j++)
+  {
+    os << "TransactionId: " << transactionIds[j] << "\n";
+    retrieveReqs[j].Print (os);
+  }
+}
+
+void
+DHashMessage::RetrieveBulkReq::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU32 (retrieveReqs.size ());
+  for (uint32_t j = 0; j < retrieveReqs.size (); j++)
+  {
+    start.WriteHtonU32 (transactionIds[j]);
+    retrieveReqs[j].Serialize (start);
+  }
+}
+
+uint32_t
+DHashMessage::RetrieveBulkReq::Deserialize (Buffer::Iterator &start)
+{
+  uint32_t numEntries = start.ReadNtohU32 ();
+  transactionIds.resize (numEntries);
+  retrieveReqs.resize (numEntries);
+  for (uint32_t j = 0; j < numEntries; j++)
+  {
+    transactionIds[j] = start.ReadNtohU32 ();
+    retrieveReqs[j].Deserialize (start);
+  }
+  return GetSerializedSize();
+}
+
+/* RETRIEVE_BULK_RSP */
+uint32_t
+DHashMessage::RetrieveBulkRsp::GetSerializedSize (void) const
+{
+  uint32_t size = sizeof (uint32_t);
+  for (uint32_t j = 0; j < retrieveRsps.size (); j++)
+  {
+    size += sizeof (uint32_t) + retrieveRsps[j].GetSerializedSize ();
+  }
+  return size; 
+}
+
+void
+DHashMessage::RetrieveBulkRsp::Print (std::ostream &os) const
+{
+  os << "RetrieveBulkRsp: \n";
+  os << "Entries: " << retrieveRsps.size () << "\n";
+  for (uint32_t j = 0; j < retrieveRsps.size (); j++)
+  {
+    os << "TransactionId: " << transactionIds[j] << "\n";
+    retrieveRsps[j].Print (os);
+  }
+}
+
+void
+DHashMessage::RetrieveBulkRsp::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteHtonU32 (retrieveRsps.size ());
+  for (uint32_t j = 0; j < retrieveRsps.size (); j++)
+  {
+    start.WriteHtonU32 (transactionIds[j]);
+    retrieveRsps[j].Serialize (start);
+  }
+}
+
+uint32_t
+DHashMessage::RetrieveBulkRsp::Deserialize (Buffer::Iterator &start)
+{
+  uint32_t numEntries = start.ReadNtohU32 ();
+  transactionIds.resize (numEntries);
+  retrieveRsps.resize (numEntries);
+  for (uint32_t j = 0; j < numEntries; j++)
+  {
+    transactionIds[j] = start.ReadNtohU32 ();
+    retrieveRsps[j].Deserialize (start);
+  }
+  return GetSerializedSize();
+}
+
+/* RETRIEVE_RANGE_REQ */
+uint32_t
+DHashMessage::RetrieveRangeReq::GetSerializedSize (void) const
+{
+  uint32_t size;
+  size = cursorIdentifier->GetSerializedSize() + highIdentifier->GetSerializedSize() + sizeof (uint32_t);
+  return size; 
+}
+
+void
+DHashMessage::RetrieveRangeReq::Print (std::ostream &os) const
+{
+  os << "RetrieveRangeReq: \n";
+  os << "Cursor Identifier: " << cursorIdentifier;
+  os << "High Identifier: " << highIdentifier;
+  os << "Max Objects: " << maxObjects << "\n";
+}
+
+void
+DHashMessage::RetrieveRangeReq::Serialize (Buffer::Iterator &start) const
+{
+  cursorIdentifier->Serialize (start);
+  highIdentifier->Serialize (start);
+  start.WriteHtonU32 (maxObjects);
+}
+
+uint32_t
+DHashMessage::RetrieveRangeReq::Deserialize (Buffer::Iterator &start)
+{
+  cursorIdentifier = Create<ChordIdentifier> ();
+  cursorIdentifier->Deserialize (start);
+  highIdentifier = Create<ChordIdentifier> ();
+  highIdentifier->Deserialize (start);
+  maxObjects = start.ReadNtohU32 ();
+  return GetSerializedSize();
+}
+
+/* RETRIEVE_RANGE_RSP */
+uint32_t
+DHashMessage::RetrieveRangeRsp::GetSerializedSize (void) const
+{
+  uint32_t size = sizeof (uint8_t);
+  if (statusTag == DHashMessage::OBJECT_FOUND)
+  {
+    size += sizeof (uint8_t) + cursorIdentifier->GetSerializedSize() + sizeof (uint32_t) + sizeof (uint16_t) + sizeof (uint32_t);
+    for (uint32_t j = 0; j < dHashObjects.size (); j++)
+    {
+      size += dHashObjects[j]->GetSerializedSize ();
+    }
+  }
+  return size; 
+}
+
+void
+DHashMessage::RetrieveRangeRsp::Print (std::ostream &os) const
+{
+  os << "RetrieveRangeRsp: \n";
+  os << "Status: \n" << statusTag;
+  if (statusTag == DHashMessage::OBJECT_FOUND)
+  {
+    os << "Complete: " << (uint16_t) complete << "\n";
+    os << "Cursor Identifier: " << cursorIdentifier;
+    os << "Next: " << nextIpAddress << ":" << nextPort << "\n";
+    os << "Objects: " << dHashObjects.size () << "\n";
+  }
+}
+
+void
+DHashMessage::RetrieveRangeRsp::Serialize (Buffer::Iterator &start) const
+{
+  start.WriteU8 (statusTag);
+  if (statusTag == DHashMessage::OBJECT_FOUND)
+  {
+    start.WriteU8 (complete);
+    cursorIdentifier->Serialize (start);
+    start.WriteHtonU32 (nextIpAddress.Get ());
+    start.WriteHtonU16 (nextPort);
+    start.WriteHtonU32 (dHashObjects.size ());
+    for (uint32_t j = 0; j < dHashObjects.size (); j++)
+    {
+      dHashObjects[j]->Serialize (start);
+    }
+  }
+}
+
+uint32_t
+DHashMessage::RetrieveRangeRsp::Deserialize (Buffer::Iterator &start)
+{
+  statusTag = (Status) start.ReadU8();
+  dHashObjects.clear ();
+  if (statusTag == DHashMessage::OBJECT_FOUND)
+  {
+    complete = start.ReadU8 ();
+    cursorIdentifier = Create<ChordIdentifier> ();
+    cursorIdentifier->Deserialize (start);
+    nextIpAddress = Ipv4Address (start.ReadNtohU32 ());
+    nextPort = start.ReadNtohU16 ();
+    uint32_t numObjects = start.ReadNtohU32 ();
+    dHashObjects.resize (numObjects);
+    for (uint32_t j = 0; j < numObjects; j++)
+    {
+      dHashObjects[j] = Create<DHashObject> ();
+      dHashObjects[j]->Deserialize (start);
+    }
+  }
+  return GetSerializedSize();
+}
+
 } //namespace ns3
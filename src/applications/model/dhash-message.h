@@ -93,6 +93,12 @@ class DHashMessage : public Header
       STORE_RSP = 2,
       RETRIEVE_REQ = 3,
       RETRIEVE_RSP = 4,    
+      STORE_BULK_REQ = 5,
+      STORE_BULK_RSP = 6,
+      RETRIEVE_BULK_REQ = 7,
+      RETRIEVE_BULK_RSP = 8,
+      RETRIEVE_RANGE_REQ = 9,
+      RETRIEVE_RANGE_RSP = 10,
     };
 
     enum Status {
@@ -181,6 +187,10 @@ class DHashMessage : public Header
         +-+-+-+-+-+-+-+-+
         |    Payload    |
         +-+-+-+-+-+-+-+-+
+        |               |
+        :  object bytes :    (of each dHashObject in Payload, in order, see CreatePacket)
+        |               |
+        +-+-+-+-+-+-+-+-+
         
         STORE_REQ Payload:
         0 1 2 3 4 5 6 7 8 
@@ -218,6 +228,79 @@ class DHashMessage : public Header
         |               |
         +-+-+-+-+-+-+-+-+
 
+        STORE_BULK_REQ, STORE_BULK_RSP, RETRIEVE_BULK_REQ, RETRIEVE_BULK_RSP Payload:
+        (transactionId of bulk message is unused, each entry carries its own)
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |               |
+        |               |
+        |  numEntries   |
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        |               |
+        | transactionId |
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :  Payload of   :
+        |  STORE_REQ,   |
+        |  STORE_RSP,   |
+        | RETRIEVE_REQ, |
+        | RETRIEVE_RSP  |
+        |               |
+        +-+-+-+-+-+-+-+-+
+        :     ....      :
+        +-+-+-+-+-+-+-+-+
+
+        RETRIEVE_RANGE_REQ Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :   cursor-     :    (excluded)
+        |  Identifier   |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :    high-      :    (included)
+        |  Identifier   |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        |               |
+        |  maxObjects   |
+        |               |
+        +-+-+-+-+-+-+-+-+
+
+        RETRIEVE_RANGE_RSP Payload:
+        0 1 2 3 4 5 6 7 8 
+        +-+-+-+-+-+-+-+-+
+        |   statusTag   |
+        +-+-+-+-+-+-+-+-+    (rest only if statusTag is OBJECT_FOUND)
+        |   complete    |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :   cursor-     :    (range covered up to here)
+        |  Identifier   |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        |               |
+        |  nextIpAddr   |
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        |   nextPort    |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        |               |
+        |  numObjects   |
+        |               |
+        +-+-+-+-+-+-+-+-+
+        |               |
+        :  dHashObject  :
+        |               |
+        +-+-+-+-+-+-+-+-+
+        :     ....      :
+        +-+-+-+-+-+-+-+-+
+
         \endverbatim
 
      */
@@ -227,6 +310,22 @@ class DHashMessage : public Header
      *  \param start Buffer::Iterator 
      */
     uint32_t Deserialize (Buffer::Iterator start);
+    /**
+     *  \brief Creates packet holding DHashMessage followed by object bytes of carried DHashObject (s). Object buffers are
+     *  shared with packet, not copied.
+     *  \returns Ptr to Packet
+     */
+    Ptr<Packet> CreatePacket (void) const;
+    /**
+     *  \brief Unpacks DHashMessage from packet, carried DHashObject (s) get fragments of packet as object bytes
+     *  \param packet Packet holding DHashMessage (see CreatePacket)
+     *  \returns true if packet held all object bytes, otherwise false
+     */
+    bool RemoveFromPacket (Ptr<Packet> packet);
+    /**
+     *  \returns Number of object bytes carried after packed DHashMessage
+     */
+    uint32_t GetPayloadSize (void) const;
 
 
     struct StoreReq
@@ -267,6 +366,70 @@ class DHashMessage : public Header
       uint32_t Deserialize (Buffer::Iterator &start);
     };
 
+    struct StoreBulkReq
+    {
+      std::vector<uint32_t> transactionIds;
+      std::vector<StoreReq> storeReqs;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct StoreBulkRsp
+    {
+      std::vector<uint32_t> transactionIds;
+      std::vector<StoreRsp> storeRsps;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct RetrieveBulkReq
+    {
+      std::vector<uint32_t> transactionIds;
+      std::vector<RetrieveReq> retrieveReqs;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct RetrieveBulkRsp
+    {
+      std::vector<uint32_t> transactionIds;
+      std::vector<RetrieveRsp> retrieveRsps;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct RetrieveRangeReq
+    {
+      Ptr<ChordIdentifier> cursorIdentifier;
+      Ptr<ChordIdentifier> highIdentifier;
+      uint32_t maxObjects;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
+
+    struct RetrieveRangeRsp
+    {
+      uint8_t statusTag;
+      uint8_t complete;
+      Ptr<ChordIdentifier> cursorIdentifier;
+      Ipv4Address nextIpAddress;
+      uint16_t nextPort;
+      std::vector<Ptr<DHashObject> > dHashObjects;
+      void Print (std::ostream &os) const; 
+      uint32_t GetSerializedSize (void) const;
+      void Serialize (Buffer::Iterator &start) const;
+      uint32_t Deserialize (Buffer::Iterator &start);
+    };
    
   private:
     struct
@@ -275,8 +438,20 @@ class DHashMessage : public Header
       StoreRsp storeRsp;
       RetrieveReq retrieveReq;
       RetrieveRsp retrieveRsp;
+      StoreBulkReq storeBulkReq;
+      StoreBulkRsp storeBulkRsp;
+      RetrieveBulkReq retrieveBulkReq;
+      RetrieveBulkRsp retrieveBulkRsp;
+      RetrieveRangeReq retrieveRangeReq;
+      RetrieveRangeRsp retrieveRangeRsp;
     } m_message;
 
+    /**
+     *  \brief Collects carried DHashObject (s) in packing order
+     *  \param objects vector of DHashObject (return result)
+     */
+    void GetObjects (std::vector<Ptr<DHashObject> > &objects) const;
+
   public:
     /**
     *  \returns StoreReq structure
@@ -342,6 +517,96 @@ class DHashMessage : public Header
       }
       return m_message.retrieveRsp;
     }    
+    /**
+     *  \returns StoreBulkReq structure
+     */    
+    StoreBulkReq& GetStoreBulkReq ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = STORE_BULK_REQ;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == STORE_BULK_REQ);
+      }
+      return m_message.storeBulkReq;
+    }
+    /**
+     *  \returns StoreBulkRsp structure
+     */    
+    StoreBulkRsp& GetStoreBulkRsp ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = STORE_BULK_RSP;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == STORE_BULK_RSP);
+      }
+      return m_message.storeBulkRsp;
+    }
+    /**
+     *  \returns RetrieveBulkReq structure
+     */    
+    RetrieveBulkReq& GetRetrieveBulkReq ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = RETRIEVE_BULK_REQ;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == RETRIEVE_BULK_REQ);
+      }
+      return m_message.retrieveBulkReq;
+    }
+    /**
+     *  \returns RetrieveBulkRsp structure
+     */    
+    RetrieveBulkRsp& GetRetrieveBulkRsp ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = RETRIEVE_BULK_RSP;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == RETRIEVE_BULK_RSP);
+      }
+      return m_message.retrieveBulkRsp;
+    }
+    /**
+     *  \returns RetrieveRangeReq structure
+     */    
+    RetrieveRangeReq& GetRetrieveRangeReq ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = RETRIEVE_RANGE_REQ;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == RETRIEVE_RANGE_REQ);
+      }
+      return m_message.retrieveRangeReq;
+    }
+    /**
+     *  \returns RetrieveRangeRsp structure
+     */    
+    RetrieveRangeRsp& GetRetrieveRangeRsp ()
+    {
+      if (m_messageType == 0)
+      {
+        m_messageType = RETRIEVE_RANGE_RSP;
+      }
+      else
+      {
+        NS_ASSERT (m_messageType == RETRIEVE_RANGE_RSP);
+      }
+      return m_message.retrieveRangeRsp;
+    }
 
  
 }; //class ChordMessage
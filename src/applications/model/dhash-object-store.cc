@@ -0,0 +1,151 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dhash-object-store.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DHashObjectStore");
+NS_OBJECT_ENSURE_REGISTERED (DHashObjectStore);
+NS_OBJECT_ENSURE_REGISTERED (DHashMapStore);
+
+TypeId
+DHashObjectStore::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DHashObjectStore")
+    .SetParent<Object> ()
+    ;
+  return tid;
+}
+
+DHashObjectStore::~DHashObjectStore ()
+{
+}
+
+TypeId
+DHashMapStore::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DHashMapStore")
+    .SetParent<DHashObjectStore> ()
+    .AddConstructor<DHashMapStore> ()
+    ;
+  return tid;
+}
+
+DHashMapStore::DHashMapStore ()
+{
+}
+
+DHashMapStore::~DHashMapStore ()
+{
+}
+
+void
+DHashMapStore::DoDispose (void)
+{
+  m_objectMap.clear ();
+  DHashObjectStore::DoDispose ();
+}
+
+void
+DHashMapStore::Open (std::string name)
+{
+}
+
+bool
+DHashMapStore::Add (Ptr<DHashObject> object)
+{
+  ChordIdentifier chordIdentifier = *(PeekPointer(object->GetObjectIdentifier()));
+  return m_objectMap.insert (std::make_pair(chordIdentifier, object)).second;
+}
+
+void
+DHashMapStore::Replace (Ptr<DHashObject> object)
+{
+  m_objectMap[*(PeekPointer(object->GetObjectIdentifier()))] = object;
+}
+
+bool
+DHashMapStore::Find (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject> &object)
+{
+  DHashObjectMap::iterator iterator = m_objectMap.find (*(PeekPointer(objectIdentifier)));
+  if (iterator == m_objectMap.end())
+  {
+    return false;
+  }
+  object = (*iterator).second;
+  return true;
+}
+
+void
+DHashMapStore::Remove (Ptr<ChordIdentifier> objectIdentifier)
+{
+  m_objectMap.erase (*(PeekPointer(objectIdentifier)));
+}
+
+void
+DHashMapStore::GetRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &objects, uint32_t maxObjects)
+{
+  //Map order is identifier order, so range is one or two (wrap-around) runs.
+  uint32_t limit = objects.size () + maxObjects;
+  DHashObjectMap::iterator lowIter = m_objectMap.upper_bound (*PeekPointer (lowIdentifier));
+  DHashObjectMap::iterator highIter = m_objectMap.upper_bound (*PeekPointer (highIdentifier));
+  if (lowIdentifier->IsLess (highIdentifier))
+  {
+    for (DHashObjectMap::iterator iterator = lowIter; iterator != highIter && (maxObjects == 0 || objects.size () < limit); iterator++)
+    {
+      objects.push_back ((*iterator).second);
+    }
+    return;
+  }
+  for (DHashObjectMap::iterator iterator = lowIter; iterator != m_objectMap.end(); iterator++)
+  {
+    if (maxObjects != 0 && objects.size () >= limit)
+    {
+      return;
+    }
+    objects.push_back ((*iterator).second);
+  }
+  for (DHashObjectMap::iterator iterator = m_objectMap.begin(); iterator != highIter && (maxObjects == 0 || objects.size () < limit); iterator++)
+  {
+    if ((*iterator).first == *PeekPointer (lowIdentifier))
+    {
+      //low == high, whole ring except high
+      break;
+    }
+    objects.push_back ((*iterator).second);
+  }
+}
+
+void
+DHashMapStore::GetIdentifiers (std::vector<Ptr<ChordIdentifier> > &objectIdentifiers)
+{
+  for (DHashObjectMap::iterator iterator = m_objectMap.begin(); iterator != m_objectMap.end(); iterator++)
+  {
+    objectIdentifiers.push_back ((*iterator).second->GetObjectIdentifier());
+  }
+}
+
+uint32_t
+DHashMapStore::GetSize (void)
+{
+  return m_objectMap.size();
+}
+
+} //namespace ns3
@@ -0,0 +1,129 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Pennsylvania
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DHASH_OBJECT_STORE_H
+#define DHASH_OBJECT_STORE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "chord-identifier.h"
+#include "dhash-object.h"
+
+namespace ns3 {
+
+/**
+ *  \ingroup chordipv4
+ *  \class DHashObjectStore
+ *  \brief Storage backend of DHashIpv4
+ *
+ *  Holds DHashObject (s) stored at a node, ordered on identifier so key ranges (ownership handoff) are scanned in order.
+ *  Backend is chosen with DHashIpv4 attribute ObjectStore (ChordIpv4 attribute DHashObjectStore) by TypeId name.
+ */
+class DHashObjectStore : public Object
+{
+  public:
+    static TypeId GetTypeId (void);
+    virtual ~DHashObjectStore ();
+
+    /**
+     *  \brief Prepares store before first use
+     *  \param name Name unique to node (e.g. address and port), used by file backed stores
+     */
+    virtual void Open (std::string name) = 0;
+    /**
+     *  \brief Stores object, unless an object with same identifier is held
+     *  \param object DHashObject
+     *  \returns true if object was stored
+     */
+    virtual bool Add (Ptr<DHashObject> object) = 0;
+    /**
+     *  \brief Stores object in place of object with same identifier
+     *  \param object DHashObject
+     */
+    virtual void Replace (Ptr<DHashObject> object) = 0;
+    /**
+     *  \brief Finds object
+     *  \param objectIdentifier Ptr to ChordIdentifier of object
+     *  \param object DHashObject (return result)
+     *  \returns true if object is held, otherwise false
+     */
+    virtual bool Find (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject> &object) = 0;
+    /**
+     *  \brief Removes object
+     *  \param objectIdentifier Ptr to ChordIdentifier of object
+     */
+    virtual void Remove (Ptr<ChordIdentifier> objectIdentifier) = 0;
+    /**
+     *  \brief Collects objects with identifier in (low, high] taken clockwise, see ChordIdentifier::IsInBetween
+     *  \param lowIdentifier low end of range (excluded)
+     *  \param highIdentifier high end of range (included)
+     *  \param objects vector of DHashObject (return result), in ring order starting after lowIdentifier
+     *  \param maxObjects Stop after this many objects (0 collects all). Range scans resume after the last object returned.
+     */
+    virtual void GetRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &objects, uint32_t maxObjects) = 0;
+    /**
+     *  \brief Collects identifiers of all objects, in identifier order
+     *  \param objectIdentifiers vector of ChordIdentifier (return result)
+     */
+    virtual void GetIdentifiers (std::vector<Ptr<ChordIdentifier> > &objectIdentifiers) = 0;
+    /**
+     *  \returns Number of objects held
+     */
+    virtual uint32_t GetSize (void) = 0;
+}; //class DHashObjectStore
+
+/**
+ *  \ingroup chordipv4
+ *  \class DHashMapStore
+ *  \brief DHashObjectStore keeping objects in memory (default)
+ */
+class DHashMapStore : public DHashObjectStore
+{
+  public:
+    static TypeId GetTypeId (void);
+    DHashMapStore ();
+    virtual ~DHashMapStore ();
+    virtual void DoDispose (void);
+
+    virtual void Open (std::string name);
+    virtual bool Add (Ptr<DHashObject> object);
+    virtual void Replace (Ptr<DHashObject> object);
+    virtual bool Find (Ptr<ChordIdentifier> objectIdentifier, Ptr<DHashObject> &object);
+    virtual void Remove (Ptr<ChordIdentifier> objectIdentifier);
+    virtual void GetRange (Ptr<ChordIdentifier> lowIdentifier, Ptr<ChordIdentifier> highIdentifier, std::vector<Ptr<DHashObject> > &objects, uint32_t maxObjects);
+    virtual void GetIdentifiers (std::vector<Ptr<ChordIdentifier> > &objectIdentifiers);
+    virtual uint32_t GetSize (void);
+
+  private:
+    /**
+     *  \cond
+     */
+    typedef std::map<ChordIdentifier, Ptr<DHashObject> > DHashObjectMap;
+    DHashObjectMap m_objectMap;
+    /**
+     *  \endcond
+     */
+}; //class DHashMapStore
+
+} //namespace ns3
+
+#endif //DHASH_OBJECT_STORE_H
@@ -20,6 +20,8 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include <stdlib.h>
+#include <string.h>
+#include <vector>
 #include "dhash-object.h"
 
 NS_LOG_COMPONENT_DEFINE ("DHashObject");
@@ -33,18 +35,15 @@ DHashObject:: DHashObject(uint8_t *key,uint8_t sizeOfKey ,uint8_t *object,uint32
   //Save identifier
   m_objectIdentifier = Create<ChordIdentifier> (key, sizeOfKey);
 
-  //Allocate memory to store the object
-  m_object = (uint8_t *) malloc(sizeOfObject * sizeof (uint8_t));
-  NS_ABORT_MSG_IF (m_object == 0,"DHashObject:: DHashObject() malloc failed");
-
-  //Copy entire object to this area
-  for (uint32_t i=0; i<sizeOfObject; i++)
-  {
-    m_object[i] = object[i];
-  }
+  //Copy object once into packet buffer, shared from here on
+  m_object = Create<Packet> (object, sizeOfObject);
 
   //Save numBytes
   m_sizeOfObject = sizeOfObject;
+  //Whole object
+  m_fragmentIndex = 0;
+  m_dataFragments = 0;
+  m_sizeOfCodedObject = 0;
 }
 
 DHashObject::DHashObject(Ptr<ChordIdentifier> identifier,uint8_t *object,uint32_t sizeOfObject)
@@ -53,26 +52,38 @@ DHashObject::DHashObject(Ptr<ChordIdentifier> identifier,uint8_t *object,uint32_
 
   m_objectIdentifier = identifier;
 
-  //Allocate memory to store the object
-  m_object = (uint8_t *) malloc(sizeOfObject * sizeof (uint8_t));
-  NS_ABORT_MSG_IF (m_object == 0,"DHashObject:: DHashObject() malloc failed");
-
-  //Copy entire object to this area
-  for (uint32_t i=0; i<sizeOfObject; i++)
-  {
-    m_object[i] = object[i];
-  }
+  //Copy object once into packet buffer, shared from here on
+  m_object = Create<Packet> (object, sizeOfObject);
 
   //Save numBytes
   m_sizeOfObject = sizeOfObject;
+  //Whole object
+  m_fragmentIndex = 0;
+  m_dataFragments = 0;
+  m_sizeOfCodedObject = 0;
 
 }
 
+DHashObject::DHashObject(Ptr<ChordIdentifier> identifier,Ptr<const Packet> object)
+{
+  NS_LOG_FUNCTION_NOARGS();
+
+  m_objectIdentifier = identifier;
+  //Own handle on same buffer (copy-on-write), caller may go on using its packet
+  m_object = object->Copy ();
+  m_sizeOfObject = object->GetSize ();
+  //Whole object
+  m_fragmentIndex = 0;
+  m_dataFragments = 0;
+  m_sizeOfCodedObject = 0;
+}
 
 DHashObject::DHashObject ()
 {
-  m_object = 0;
   m_sizeOfObject = 0;
+  m_fragmentIndex = 0;
+  m_dataFragments = 0;
+  m_sizeOfCodedObject = 0;
 }
 
 DHashObject::~DHashObject ()
@@ -84,20 +95,55 @@ void
 DHashObject::DoDispose (void)
 {
   NS_LOG_FUNCTION_NOARGS();
-  //Free memory
-  if (m_object != 0)
+  //Release buffer
+  m_object = 0;
+  std::vector<uint8_t> ().swap (m_objectBytes);
+  m_sizeOfObject = 0;
+}
+
+Ptr<const Packet>
+DHashObject::GetObject ()
+{
+  if (m_object == 0 && !m_objectBytes.empty ())
   {
-    free (m_object);
-    m_object = 0;
-    m_sizeOfObject = 0; 
+    //Trimmed object, sent packet gets its own copy
+    return Create<Packet> (&m_objectBytes[0], m_objectBytes.size ());
   }
+  return m_object;
+}
 
+void
+DHashObject::SetObject (Ptr<const Packet> object)
+{
+  NS_ASSERT (object->GetSize () == m_sizeOfObject);
+  m_object = object;
+  std::vector<uint8_t> ().swap (m_objectBytes);
 }
 
-uint8_t*
-DHashObject::GetObject ()
+void
+DHashObject::CopyObject (uint8_t *buffer)
 {
-  return m_object;
+  if (m_object != 0)
+  {
+    m_object->CopyData (buffer, m_sizeOfObject);
+  }
+  else if (!m_objectBytes.empty ())
+  {
+    memcpy (buffer, &m_objectBytes[0], m_objectBytes.size ());
+  }
+}
+
+void
+DHashObject::TrimObject (void)
+{
+  if (m_object == 0 || m_sizeOfObject == 0)
+  {
+    return;
+  }
+  std::vector<uint8_t> object (m_sizeOfObject);
+  m_object->CopyData (&object[0], m_sizeOfObject);
+  m_objectBytes.swap (object);
+  m_object = 0;
 }
 
 Ptr<ChordIdentifier>
@@ -113,6 +159,38 @@ DHashObject::GetSizeOfObject()
   return  m_sizeOfObject;
 }
 
+void
+DHashObject::SetFragment (uint8_t fragmentIndex, uint8_t dataFragments, uint32_t sizeOfCodedObject)
+{
+  m_fragmentIndex = fragmentIndex;
+  m_dataFragments = dataFragments;
+  m_sizeOfCodedObject = sizeOfCodedObject;
+}
+
+bool
+DHashObject::IsFragment ()
+{
+  return m_dataFragments != 0;
+}
+
+uint8_t
+DHashObject::GetFragmentIndex ()
+{
+  return m_fragmentIndex;
+}
+
+uint8_t
+DHashObject::GetDataFragments ()
+{
+  return m_dataFragments;
+}
+
+uint32_t
+DHashObject::GetSizeOfCodedObject ()
+{
+  return m_sizeOfCodedObject;
+}
+
 void
 DHashObject::Serialize (Buffer::Iterator &start)
 {
@@ -121,12 +199,15 @@ DHashObject::Serialize (Buffer::Iterator &start)
   //Serialize the chord identifier
   m_objectIdentifier->Serialize(start);
 
-  //Serialize the object
+  //Serialize size of object, bytes follow message
   start.WriteHtonU32 (m_sizeOfObject);
 
-  for (uint32_t j=0 ; j<m_sizeOfObject; j++)
+  //Serialize fragment info
+  start.WriteU8 (m_dataFragments);
+  if (m_dataFragments != 0)
   {
-    start.WriteU8 ( m_object[j]);
+    start.WriteU8 (m_fragmentIndex);
+    start.WriteHtonU32 (m_sizeOfCodedObject);
   }
 
 }
@@ -135,25 +216,21 @@ uint32_t
 DHashObject::Deserialize (Buffer::Iterator &start)
 {
   NS_LOG_FUNCTION_NOARGS();
-  uint32_t j;
-
 
   m_objectIdentifier = Create<ChordIdentifier> ();
   m_objectIdentifier->Deserialize(start);
 
+  //Object bytes are attached later (SetObject)
   m_sizeOfObject = start.ReadNtohU32();
+  m_object = 0;
+  std::vector<uint8_t> ().swap (m_objectBytes);
 
-  //Allocate memory for the object
-  if (m_object == 0)
+  m_dataFragments = start.ReadU8 ();
+  if (m_dataFragments != 0)
   {
-    m_object = (uint8_t *) malloc(m_sizeOfObject * sizeof (uint8_t));
-    NS_ABORT_MSG_IF ( m_object == 0,"  DHashObject::Deserialize malloc failed");
+    m_fragmentIndex = start.ReadU8 ();
+    m_sizeOfCodedObject = start.ReadNtohU32 ();
   }
-  /* Retrieve object from buffer */
-  for (j=0; j< m_sizeOfObject;j++)
-  {
-    m_object[j] = start.ReadU8 ();
-  }  
 
   return GetSerializedSize ();
 }
@@ -162,7 +239,11 @@ uint32_t
 DHashObject::GetSerializedSize ()
 {
   uint32_t size;
-  size =  m_objectIdentifier->GetSerializedSize() + sizeof(uint32_t) + m_sizeOfObject;
+  size =  m_objectIdentifier->GetSerializedSize() + sizeof(uint32_t) + sizeof(uint8_t);
+  if (m_dataFragments != 0)
+  {
+    size += sizeof(uint8_t) + sizeof(uint32_t);
+  }
   return size;
 }
 
@@ -171,11 +252,20 @@ DHashObject::Print (std::ostream &os)
 {
   m_objectIdentifier->Print (os);
   os << "Bytes: " << (uint16_t)  m_sizeOfObject << "\n";
+  if (m_dataFragments != 0)
+  {
+    os << "Fragment: " << (uint16_t) m_fragmentIndex << " of " << (uint16_t) m_dataFragments << " needed, coded object bytes: " << m_sizeOfCodedObject << "\n";
+  }
   os << "Object: \n";
   os << "[ ";
-  for (uint32_t j=0;j< m_sizeOfObject;j++)
+  if (m_object != 0 || !m_objectBytes.empty ())
   {
-    os << std::hex << "0x" <<(uint32_t)  m_object[j] << " ";
+    std::vector<uint8_t> object (m_sizeOfObject);
+    CopyObject (object.size() ? &object[0] : 0);
+    for (uint32_t j=0;j< m_sizeOfObject;j++)
+    {
+      os << std::hex << "0x" <<(uint32_t)  object[j] << " ";
+    }
   }
   os << std::dec << "]\n";
 }
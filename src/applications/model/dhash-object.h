@@ -20,15 +20,20 @@
 
 #include <stdint.h>
 #include <ostream>
+#include <vector>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 #include "ns3/buffer.h"
+#include "ns3/packet.h"
 #include "chord-identifier.h"
 
 namespace ns3 {
 /** 
  *  \ingroup chordipv4
  *  \class DHashObject
+ *
+ *  Object bytes are held in a Packet, so copies of object (store, transfer, retrieve) share same buffer instead of copying it.
+ *  Packed DHashObject carries only its header, object bytes follow DHashMessage in packet (see DHashMessage::CreatePacket).
  */
 class DHashObject : public Object
 {
@@ -49,6 +54,12 @@ class DHashObject : public Object
    *  \param sizeOfObject Number of bytes in object array (max 2^32 - 1)
    */
   DHashObject(Ptr<ChordIdentifier> identifier,uint8_t *object,uint32_t sizeOfObject);
+  /**
+   *  \brief Constructor
+   *  \param identifier ChordIdentifier of DHashObject
+   *  \param object Packet holding object bytes, its buffer is shared (not copied)
+   */
+  DHashObject(Ptr<ChordIdentifier> identifier,Ptr<const Packet> object);
   DHashObject();
   
   virtual ~DHashObject ();
@@ -73,11 +84,18 @@ class DHashObject : public Object
         |  sizeOfObject |
         |               |
         +-+-+-+-+-+-+-+-+
+        | dataFragments |
+        +-+-+-+-+-+-+-+-+
+        | fragmentIndex |    (only if dataFragments > 0)
+        +-+-+-+-+-+-+-+-+
         |               |
-        :  object array :
+        |  sizeOfCoded  |    (only if dataFragments > 0)
+        |    Object     |
         |               |
         +-+-+-+-+-+-+-+-+
         \endverbatim    
+     *
+     *  Object bytes (sizeOfObject) are not packed here, see DHashMessage::CreatePacket
     */
   void Serialize (Buffer::Iterator &start);
   /**
@@ -86,7 +104,7 @@ class DHashObject : public Object
    */
   uint32_t Deserialize (Buffer::Iterator &start);
   /**
-   *  \returns Size of packed structure
+   *  \returns Size of packed structure (without object bytes)
    */
   uint32_t GetSerializedSize ();
   void Print (std::ostream &os); 
@@ -97,21 +115,67 @@ class DHashObject : public Object
    */
   Ptr<ChordIdentifier> GetObjectIdentifier(void);
   /**
-   *  \returns Pointer to object array
+   *  \returns Read-only Packet holding object bytes (new Packet for each call once object is trimmed, see TrimObject)
+   */
+  Ptr<const Packet> GetObject(void);
+  /**
+   *  \brief Attaches object bytes to unpacked DHashObject
+   *  \param object Packet (fragment of received packet) holding sizeOfObject bytes
    */
-  uint8_t* GetObject(void);
+  void SetObject (Ptr<const Packet> object);
+  /**
+   *  \brief Copies object bytes to contiguous array
+   *  \param buffer Array of at least sizeOfObject bytes
+   */
+  void CopyObject (uint8_t *buffer);
+  /**
+   *  \brief Moves object bytes into an array of their own size
+   *
+   *  Object bytes of a received DHashObject are a fragment of the received packet, which keeps the whole packet buffer alive.
+   *  A new Packet would not help, as ns-3 hands out recycled buffers of the largest packet size. Call before storing the object.
+   */
+  void TrimObject (void);
   /**
    *  \returns Number of bytes in object array
    */
   uint32_t GetSizeOfObject(void);
+
+  //Erasure coding
+  /**
+   *  \brief Marks object as fragment of an erasure coded object (see DHashErasureCode)
+   *  \param fragmentIndex Index of this fragment
+   *  \param dataFragments Number of fragments needed to reconstruct coded object
+   *  \param sizeOfCodedObject Number of bytes in coded object
+   */
+  void SetFragment (uint8_t fragmentIndex, uint8_t dataFragments, uint32_t sizeOfCodedObject);
+  /**
+   *  \returns true if object holds a fragment instead of whole object
+   */
+  bool IsFragment (void);
+  /**
+   *  \returns Index of fragment
+   */
+  uint8_t GetFragmentIndex (void);
+  /**
+   *  \returns Number of fragments needed to reconstruct coded object
+   */
+  uint8_t GetDataFragments (void);
+  /**
+   *  \returns Number of bytes in coded object
+   */
+  uint32_t GetSizeOfCodedObject (void);
     
   private:
   /**
    *  \cond
    */
   Ptr<ChordIdentifier> m_objectIdentifier;
-  uint8_t  *m_object;
+  Ptr<const Packet> m_object;
+  std::vector<uint8_t> m_objectBytes;
   uint32_t m_sizeOfObject;
+  uint8_t m_fragmentIndex;
+  uint8_t m_dataFragments;
+  uint32_t m_sizeOfCodedObject;
   /**
    *  \endcond
    */
@@ -26,6 +26,7 @@ DHashTransaction::DHashTransaction (uint32_t transactionId, Ptr<ChordIdentifier>
   m_dHashMessage = dHashMessage;
   m_objectIdentifier = objectIdentifier;
   m_activeFlag = false;
+  m_originator = DHashTransaction::APPLICATION;
 }
 
 DHashTransaction::~DHashTransaction ()
@@ -36,6 +37,12 @@ DHashTransaction::~DHashTransaction ()
 void
 DHashTransaction::DoDispose()
 {
+  //cancel timer if running
+  if (m_requestTimeoutEvent != 0)
+  {
+    m_requestTimeoutEvent->Cancel();
+  }
+  Object::DoDispose ();
 }
 
 void
@@ -85,6 +92,41 @@ DHashTransaction::SetOriginator (DHashTransaction::Originator originator)
 {
   m_originator = originator;
 }
+void
+DHashTransaction::SetRequestTimeoutEvent (Ptr<EventImpl> event)
+{
+  //Replace previous timer, if any
+  if (m_requestTimeoutEvent != 0)
+  {
+    m_requestTimeoutEvent->Cancel();
+  }
+  m_requestTimeoutEvent = event;
+}
+
+void
+DHashTransaction::SetReplicaGroup (Ptr<DHashReplicaGroup> replicaGroup)
+{
+  m_replicaGroup = replicaGroup;
+}
+
+Ptr<DHashReplicaGroup>
+DHashTransaction::GetReplicaGroup ()
+{
+  return m_replicaGroup;
+}
+
+void
+DHashTransaction::SetRangeQuery (Ptr<DHashRangeQuery> rangeQuery)
+{
+  m_rangeQuery = rangeQuery;
+}
+
+Ptr<DHashRangeQuery>
+DHashTransaction::GetRangeQuery ()
+{
+  return m_rangeQuery;
+}
+
 void
 DHashTransaction::SetDHashConnection (Ptr<DHashConnection> dHashConnection)
 {
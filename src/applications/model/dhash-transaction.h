@@ -21,11 +21,57 @@
 
 #include "ns3/object.h"
 #include "ns3/timer.h"
+#include "ns3/event-impl.h"
+#include "ns3/simple-ref-count.h"
 #include "dhash-message.h"
 #include "dhash-connection.h"
+#include "dhash-object.h"
+#include <vector>
 
 namespace ns3 {
 
+/**
+ *  \ingroup chordipv4
+ *  \brief State shared by requests sent in parallel to owner and replica holders of one DHashObject
+ */
+struct DHashReplicaGroup : public SimpleRefCount<DHashReplicaGroup>
+{
+  //Requests still waiting for a response
+  uint8_t pendingRequests;
+  //Successful responses needed before success is reported (1, or m for erasure coded objects)
+  uint8_t requiredResponses;
+  //Successful responses so far
+  uint8_t responses;
+  //Outcome already reported
+  bool notified;
+  //Whole object of a fragmented store
+  Ptr<DHashObject> dHashObject;
+  //Distinct fragments received by a retrieve
+  std::vector<Ptr<DHashObject> > fragments;
+};
+
+/**
+ *  \ingroup chordipv4
+ *  \brief State of a range retrieve, handed from the transaction of one page request to the next
+ */
+struct DHashRangeQuery : public SimpleRefCount<DHashRangeQuery>
+{
+  //Id reported to application
+  uint32_t queryId;
+  //Range is covered up to cursor (included)
+  Ptr<ChordIdentifier> cursorIdentifier;
+  //High end of range (included)
+  Ptr<ChordIdentifier> highIdentifier;
+  //Lookups of the node after cursor since last progress (a NOT_OWNER response triggers another one)
+  uint8_t lookups;
+  //Erasure coded objects of delivered pages still being rebuilt from fragments
+  uint32_t pendingObjects;
+  //Last page delivered, or query cut short
+  bool scanComplete;
+  //Whole range covered and every rebuild succeeded
+  bool success;
+};
+
 /**
  *  \ingroup chordipv4
  *  \class DHashTransaction
@@ -40,6 +86,7 @@ class DHashTransaction : public Object
     enum Originator {
       APPLICATION = 1,
       DHASH = 2,
+      REPLICA = 3,
     };
 
     /**
@@ -77,6 +124,26 @@ class DHashTransaction : public Object
      *  \brief Set originator of transaction
      */
     void SetOriginator (DHashTransaction::Originator originator);
+    /**
+     *  \brief Set request timeout timer (see ChordTimerWheel)
+     */
+    void SetRequestTimeoutEvent (Ptr<EventImpl> event);
+    /**
+     *  \brief Set replica group of transaction (null if request is sent to single node)
+     */
+    void SetReplicaGroup (Ptr<DHashReplicaGroup> replicaGroup);
+    /**
+     *  \returns Ptr to DHashReplicaGroup
+     */
+    Ptr<DHashReplicaGroup> GetReplicaGroup ();
+    /**
+     *  \brief Set range retrieve this transaction requests a page of, or rebuilds an erasure coded object for (null for other requests)
+     */
+    void SetRangeQuery (Ptr<DHashRangeQuery> rangeQuery);
+    /**
+     *  \returns Ptr to DHashRangeQuery
+     */
+    Ptr<DHashRangeQuery> GetRangeQuery ();
     /**
      *  \returns DHashTransaction::Originator
      */
@@ -99,6 +166,9 @@ class DHashTransaction : public Object
     Ptr<ChordIdentifier> m_objectIdentifier;
     Ptr<DHashConnection> m_dHashConnection;
     DHashTransaction::Originator m_originator;
+    Ptr<EventImpl> m_requestTimeoutEvent;
+    Ptr<DHashReplicaGroup> m_replicaGroup;
+    Ptr<DHashRangeQuery> m_rangeQuery;
     /**
      *  \endcond
      */
@@ -31,23 +31,18 @@
 namespace nfd {
 namespace cs {
 
+class IndexNode;
+
 /** \brief an Entry in ContentStore implementation
  *
- *  An Entry is either a stored Entry which contains a Data packet and related attributes,
- *  or a query Entry which contains a Name that is LessComparable to other stored/query Entry
- *  and is used to lookup a container of entries.
+ *  An EntryImpl contains a Data packet and related attributes. It is stored in a Table,
+ *  which indexes it under the Data Name.
  *
  *  \note This type is internal to this specific ContentStore implementation.
  */
 class EntryImpl : public Entry
 {
 public:
-  /** \brief construct Entry for query
-   *  \note Name is implicitly convertible to Entry, so that Name can be passed to
-   *        lookup functions on a container of Entry
-   */
-  EntryImpl(const Name& name);
-
   /** \brief construct Entry for storage
    */
   EntryImpl(shared_ptr<const Data> data, bool isUnsolicited);
@@ -55,15 +50,10 @@ public:
   void
   unsetUnsolicited();
 
-  bool
-  operator<(const EntryImpl& other) const;
-
 private:
-  bool
-  isQuery() const;
+  IndexNode* m_node; ///< Table index node of Data Name
 
-private:
-  Name m_queryName;
+  friend class Table;
 };
 
 } // namespace cs
@@ -36,9 +36,13 @@ namespace nfd {
 namespace cs {
 
 class EntryImpl;
+class Table;
 
-typedef std::set<EntryImpl> Table;
-typedef Table::const_iterator iterator;
+/** \brief refers to a stored Entry
+ *
+ *  An iterator stays valid until its Entry is erased from the Table.
+ */
+typedef std::list<EntryImpl>::const_iterator iterator;
 
 } // namespace cs
 } // namespace nfd
@@ -50,12 +50,14 @@ struct EntryInfo
   scheduler::EventId moveStaleEventId;
 };
 
+/** \brief orders Table iterators by Entry address, which does not change while stored
+ */
 struct EntryItComparator
 {
   bool
   operator()(const iterator& a, const iterator& b) const
   {
-    return *a < *b;
+    return std::less<const EntryImpl*>()(&*a, &*b);
   }
 };
 
@@ -0,0 +1,376 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2017,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cs-table.hpp"
+
+namespace nfd {
+namespace cs {
+
+IndexNode::IndexNode(name_tree::HashValue h, size_t depth, const Name* name, IndexNode* parent)
+  : hash(h)
+  , depth(depth)
+  , parent(parent)
+  , name(name)
+  , next(nullptr)
+{
+}
+
+/** \return whether an entry of node comes before a child of node in canonical order
+ *
+ *  Full Name of the entry is node prefix followed by the implicit digest,
+ *  which sorts before components of any other type.
+ */
+static bool
+isEntryBeforeChild(const EntryImpl& entry, const IndexNode& child)
+{
+  const name::Component& component = child.getComponent();
+  return !component.isImplicitSha256Digest() ||
+         entry.getFullName()[-1].compare(component) <= 0;
+}
+
+/** \brief visits entries whose full Name starts with node prefix, in canonical order
+ *  \tparam Visitor functor with signature bool Visitor(iterator), returns true to stop
+ *  \return whether visitor stopped
+ */
+template<typename Visitor>
+static bool
+visitForward(const IndexNode& node, const Visitor& visit)
+{
+  auto entry = node.entries.begin();
+  auto child = node.children.begin();
+  while (entry != node.entries.end() || child != node.children.end()) {
+    if (entry != node.entries.end() &&
+        (child == node.children.end() || isEntryBeforeChild(**entry, *child))) {
+      if (visit(*entry)) {
+        return true;
+      }
+      ++entry;
+    }
+    else {
+      if (visitForward(*child, visit)) {
+        return true;
+      }
+      ++child;
+    }
+  }
+  return false;
+}
+
+/** \brief visits entries whose full Name starts with node prefix, in reverse canonical order
+ *  \sa visitForward
+ */
+template<typename Visitor>
+static bool
+visitBackward(const IndexNode& node, const Visitor& visit)
+{
+  auto entry = node.entries.rbegin();
+  auto child = node.children.rbegin();
+  while (entry != node.entries.rend() || child != node.children.rend()) {
+    if (entry != node.entries.rend() &&
+        (child == node.children.rend() || !isEntryBeforeChild(**entry, *child))) {
+      if (visit(*entry)) {
+        return true;
+      }
+      ++entry;
+    }
+    else {
+      if (visitBackward(*child, visit)) {
+        return true;
+      }
+      ++child;
+    }
+  }
+  return false;
+}
+
+Table::Table()
+  : m_nNodes(0)
+{
+  m_buckets.resize(m_options.initialSize);
+  m_root = new IndexNode(name_tree::computeHash(Name()), 0, nullptr, nullptr);
+  this->attachNode(m_root);
+}
+
+Table::~Table()
+{
+  for (IndexNode* head : m_buckets) {
+    while (head != nullptr) {
+      IndexNode* next = head->next;
+      delete head;
+      head = next;
+    }
+  }
+}
+
+std::pair<iterator, bool>
+Table::insert(const Data& data, bool isUnsolicited)
+{
+  const Name& name = data.getName();
+  size_t depth = name.size();
+  name_tree::HashSequence hashes = name_tree::computeHashes(name);
+
+  IndexNode* node = this->findNode(name, depth, hashes[depth]);
+  if (node == nullptr) {
+    // create nodes below the longest prefix that has one, they refer to the Name of the new entry
+    do {
+      --depth;
+      node = this->findNode(name, depth, hashes[depth]);
+    } while (node == nullptr);
+
+    for (++depth; depth <= name.size(); ++depth) {
+      IndexNode* child = new IndexNode(hashes[depth], depth, &name, node);
+      node->children.insert(*child);
+      this->attachNode(child);
+      node = child;
+    }
+  }
+
+  // implicit digest is only computed if another Data has same Name
+  auto pos = node->entries.begin();
+  if (!node->entries.empty()) {
+    const name::Component& digest = data.getFullName()[-1];
+    for (; pos != node->entries.end(); ++pos) {
+      int cmp = (*pos)->getFullName()[-1].compare(digest);
+      if (cmp == 0) {
+        return {*pos, false};
+      }
+      if (cmp > 0) {
+        break;
+      }
+    }
+  }
+
+  m_entries.emplace_front(data.shared_from_this(), isUnsolicited);
+  iterator it = m_entries.begin();
+  const_cast<EntryImpl&>(*it).m_node = node;
+  node->entries.insert(pos, it);
+  return {it, true};
+}
+
+void
+Table::erase(iterator it)
+{
+  const Name* name = &it->getName();
+  IndexNode* node = it->m_node;
+  node->entries.erase(std::find(node->entries.begin(), node->entries.end(), it));
+
+  // delete nodes left without entries, and let others stop referring to the Name
+  while (node != m_root) {
+    IndexNode* parent = node->parent;
+    if (node->entries.empty() && node->children.empty()) {
+      parent->children.erase(parent->children.iterator_to(*node));
+      this->detachNode(node);
+      delete node;
+    }
+    else if (node->name == name) {
+      node->name = node->entries.empty() ? node->children.begin()->name :
+                                           &node->entries.front()->getName();
+    }
+    node = parent;
+  }
+
+  m_entries.erase(it);
+}
+
+std::vector<iterator>
+Table::findUnder(const Name& prefix, size_t limit) const
+{
+  std::vector<iterator> found;
+  if (limit == 0) {
+    return found;
+  }
+
+  iterator exact = this->findExact(prefix);
+  if (exact != this->end()) {
+    found.push_back(exact);
+  }
+
+  const IndexNode* node = this->findNode(prefix, prefix.size(), name_tree::computeHash(prefix));
+  if (node != nullptr && found.size() < limit) {
+    visitForward(*node, [&] (iterator it) {
+      found.push_back(it);
+      return found.size() >= limit;
+    });
+  }
+  return found;
+}
+
+iterator
+Table::findLeftmost(const Interest& interest) const
+{
+  const Name& prefix = interest.getName();
+
+  // Data whose full Name equals Interest Name sorts before Data under Interest Name
+  iterator match = this->findExact(prefix);
+  if (match != this->end() && match->canSatisfy(interest)) {
+    return match;
+  }
+
+  match = this->end();
+  const IndexNode* node = this->findNode(prefix, prefix.size(), name_tree::computeHash(prefix));
+  if (node != nullptr) {
+    visitForward(*node, [&] (iterator it) {
+      if (!it->canSatisfy(interest)) {
+        return false;
+      }
+      match = it;
+      return true;
+    });
+  }
+  return match;
+}
+
+iterator
+Table::findRightmost(const Interest& interest) const
+{
+  const Name& prefix = interest.getName();
+  iterator match = this->end();
+  auto visit = [&] (iterator it) {
+    if (!it->canSatisfy(interest)) {
+      return false;
+    }
+    match = it;
+    return true;
+  };
+
+  const IndexNode* node = this->findNode(prefix, prefix.size(), name_tree::computeHash(prefix));
+  if (node != nullptr) {
+    bool isAmongExact = false;
+    auto entry = node->entries.rbegin();
+    auto child = node->children.rbegin();
+    while (entry != node->entries.rend() || child != node->children.rend()) {
+      if (entry != node->entries.rend() &&
+          (child == node->children.rend() || !isEntryBeforeChild(**entry, *child))) {
+        // Data Name equals Interest Name: search everything to the left from the right
+        isAmongExact = true;
+        if (visit(*entry)) {
+          return match;
+        }
+        ++entry;
+      }
+      else {
+        if (isAmongExact ? visitBackward(*child, visit) : visitForward(*child, visit)) {
+          return match;
+        }
+        ++child;
+      }
+    }
+  }
+
+  iterator exact = this->findExact(prefix);
+  if (exact != this->end() && visit(exact)) {
+    return match;
+  }
+  return this->end();
+}
+
+IndexNode*
+Table::findNode(const Name& name, size_t prefixLen, name_tree::HashValue h) const
+{
+  for (IndexNode* node = m_buckets[h % m_buckets.size()]; node != nullptr; node = node->next) {
+    if (node->hash == h && node->depth == prefixLen &&
+        (prefixLen == 0 || name.compare(0, prefixLen, *node->name, 0, prefixLen) == 0)) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+iterator
+Table::findExact(const Name& fullName) const
+{
+  if (fullName.empty() || !fullName[-1].isImplicitSha256Digest()) {
+    return this->end();
+  }
+
+  size_t prefixLen = fullName.size() - 1;
+  const IndexNode* node = this->findNode(fullName, prefixLen,
+                                         name_tree::computeHash(fullName, prefixLen));
+  if (node == nullptr) {
+    return this->end();
+  }
+
+  for (iterator it : node->entries) {
+    if (it->getFullName()[-1] == fullName[-1]) {
+      return it;
+    }
+  }
+  return this->end();
+}
+
+void
+Table::attachNode(IndexNode* node)
+{
+  size_t bucket = node->hash % m_buckets.size();
+  node->next = m_buckets[bucket];
+  m_buckets[bucket] = node;
+  ++m_nNodes;
+
+  if (m_nNodes > m_options.expandLoadFactor * m_buckets.size()) {
+    this->resize(static_cast<size_t>(m_options.expandFactor * m_buckets.size()));
+  }
+}
+
+void
+Table::detachNode(IndexNode* node)
+{
+  IndexNode** link = &m_buckets[node->hash % m_buckets.size()];
+  while (*link != node) {
+    BOOST_ASSERT(*link != nullptr);
+    link = &(*link)->next;
+  }
+  *link = node->next;
+  node->next = nullptr;
+  --m_nNodes;
+
+  if (m_nNodes < m_options.shrinkLoadFactor * m_buckets.size()) {
+    this->resize(std::max(m_options.minSize,
+                          static_cast<size_t>(m_options.shrinkFactor * m_buckets.size())));
+  }
+}
+
+void
+Table::resize(size_t newNBuckets)
+{
+  if (m_buckets.size() == newNBuckets) {
+    return;
+  }
+
+  std::vector<IndexNode*> oldBuckets(newNBuckets, nullptr);
+  oldBuckets.swap(m_buckets);
+
+  for (IndexNode* head : oldBuckets) {
+    while (head != nullptr) {
+      IndexNode* next = head->next;
+      size_t bucket = head->hash % m_buckets.size();
+      head->next = m_buckets[bucket];
+      m_buckets[bucket] = head;
+      head = next;
+    }
+  }
+}
+
+} // namespace cs
+} // namespace nfd
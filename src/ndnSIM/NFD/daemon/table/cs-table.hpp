@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2014-2017,  Regents of the University of California,
+ *                           Arizona Board of Regents,
+ *                           Colorado State University,
+ *                           University Pierre & Marie Curie, Sorbonne University,
+ *                           Washington University in St. Louis,
+ *                           Beijing Institute of Technology,
+ *                           The University of Memphis.
+ *
+ * This file is part of NFD (Named Data Networking Forwarding Daemon).
+ * See AUTHORS.md for complete list of NFD authors and contributors.
+ *
+ * NFD is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NFD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NFD, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NFD_DAEMON_TABLE_CS_TABLE_HPP
+#define NFD_DAEMON_TABLE_CS_TABLE_HPP
+
+#include "cs-internal.hpp"
+#include "cs-entry-impl.hpp"
+#include "name-tree-hashtable.hpp"
+
+#include <boost/container/small_vector.hpp>
+#include <boost/intrusive/set.hpp>
+
+namespace nfd {
+namespace cs {
+
+typedef boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>,
+                                        boost::intrusive::optimize_size<true>> IndexNodeHook;
+
+/** \brief a node of the Table index, for one prefix of the Names of stored Data
+ *
+ *  A node exists while at least one stored Data Name starts with its prefix.
+ */
+class IndexNode : public IndexNodeHook, noncopyable
+{
+public:
+  IndexNode(name_tree::HashValue h, size_t depth, const Name* name, IndexNode* parent);
+
+  /** \return last component of the prefix
+   *  \pre depth > 0
+   */
+  const name::Component&
+  getComponent() const
+  {
+    return (*name)[depth - 1];
+  }
+
+  struct ComponentLess
+  {
+    bool
+    operator()(const IndexNode& a, const IndexNode& b) const
+    {
+      return a.getComponent().compare(b.getComponent()) < 0;
+    }
+
+    bool
+    operator()(const name::Component& a, const IndexNode& b) const
+    {
+      return a.compare(b.getComponent()) < 0;
+    }
+
+    bool
+    operator()(const IndexNode& a, const name::Component& b) const
+    {
+      return a.getComponent().compare(b) < 0;
+    }
+  };
+
+  typedef boost::intrusive::set<IndexNode,
+                                boost::intrusive::compare<ComponentLess>,
+                                boost::intrusive::constant_time_size<false>> Children;
+
+public:
+  const name_tree::HashValue hash;
+  const size_t depth;
+  IndexNode* const parent;
+
+  /** \brief Name of a stored Data under the prefix, the node does not copy the prefix
+   *
+   *  nullptr for the root node.
+   */
+  const Name* name;
+
+  IndexNode* next; ///< next node in hashtable bucket
+
+  /** \brief entries of Data with this Name, in implicit digest order
+   */
+  boost::container::small_vector<iterator, 1> entries;
+
+  /** \brief nodes one component longer, in component order
+   */
+  Children children;
+};
+
+/** \brief the storage of ContentStore
+ *
+ *  Entries are kept in a list that is not sorted, so that iterators stay valid while other
+ *  entries are inserted or erased.  They are found through an index of the Name prefixes
+ *  of stored Data: a hashtable using NameTree hashes (computeHashes) leads to the node of
+ *  a prefix in one lookup, and nodes are linked to their children in component order, so that
+ *  entries under a prefix can be visited in the canonical order of their full Names.
+ */
+class Table : noncopyable
+{
+public:
+  Table();
+
+  ~Table();
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  iterator
+  begin() const
+  {
+    return m_entries.begin();
+  }
+
+  iterator
+  end() const
+  {
+    return m_entries.end();
+  }
+
+  /** \brief inserts an entry for \p data, unless an entry with same full Name exists
+   *  \return the entry, and whether it is new
+   */
+  std::pair<iterator, bool>
+  insert(const Data& data, bool isUnsolicited);
+
+  /** \brief erases an entry
+   */
+  void
+  erase(iterator it);
+
+  /** \return entries whose full Name starts with \p prefix, at most \p limit of them,
+   *          in canonical order of full Names
+   */
+  std::vector<iterator>
+  findUnder(const Name& prefix, size_t limit) const;
+
+  /** \brief finds leftmost Data that can satisfy \p interest
+   *  \return the entry, or end() if not found
+   */
+  iterator
+  findLeftmost(const Interest& interest) const;
+
+  /** \brief finds rightmost Data that can satisfy \p interest
+   *
+   *  Sub-namespaces one component longer than Interest Name are visited from the right, and the
+   *  leftmost match within the first sub-namespace that has one is returned.  Data whose Name
+   *  equals Interest Name, and any to their left, are searched from the right.
+   *
+   *  \return the entry, or end() if not found
+   */
+  iterator
+  findRightmost(const Interest& interest) const;
+
+private:
+  /** \return node of \p name.getPrefix(prefixLen), or nullptr
+   */
+  IndexNode*
+  findNode(const Name& name, size_t prefixLen, name_tree::HashValue h) const;
+
+  /** \return the entry whose full Name equals \p fullName, or end()
+   *          if not found or \p fullName does not end with an implicit digest
+   */
+  iterator
+  findExact(const Name& fullName) const;
+
+  void
+  attachNode(IndexNode* node);
+
+  void
+  detachNode(IndexNode* node);
+
+  void
+  resize(size_t newNBuckets);
+
+private:
+  std::list<EntryImpl> m_entries;
+  IndexNode* m_root;
+  std::vector<IndexNode*> m_buckets;
+  name_tree::HashtableOptions m_options;
+  size_t m_nNodes;
+};
+
+} // namespace cs
+} // namespace nfd
+
+#endif // NFD_DAEMON_TABLE_CS_TABLE_HPP
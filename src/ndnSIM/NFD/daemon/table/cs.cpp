@@ -24,7 +24,6 @@
  */
 
 #include "cs.hpp"
-#include "core/algorithm.hpp"
 #include "core/logger.hpp"
 
 #include <ndn-cxx/lp/tags.hpp>
@@ -71,7 +70,7 @@ Cs::insert(const Data& data, bool isUnsolicited)
 
   iterator it;
   bool isNewEntry = false;
-  std::tie(it, isNewEntry) = m_table.emplace(data.shared_from_this(), isUnsolicited);
+  std::tie(it, isNewEntry) = m_table.insert(data, isUnsolicited);
   EntryImpl& entry = const_cast<EntryImpl&>(*it);
 
   entry.updateStaleTime();
@@ -94,18 +93,12 @@ Cs::erase(const Name& prefix, size_t limit, const AfterEraseCallback& cb)
 {
   BOOST_ASSERT(static_cast<bool>(cb));
 
-  iterator first = m_table.lower_bound(prefix);
-  iterator last = m_table.end();
-  if (prefix.size() > 0) {
-    last = m_table.lower_bound(prefix.getSuccessor());
-  }
-
-  size_t nErased = 0;
-  while (first != last && nErased < limit) {
-    m_policy->beforeErase(first);
-    first = m_table.erase(first);
-    ++nErased;
+  std::vector<iterator> entries = m_table.findUnder(prefix, limit);
+  for (iterator it : entries) {
+    m_policy->beforeErase(it);
+    m_table.erase(it);
   }
+  size_t nErased = entries.size();
 
   if (cb) {
     cb(nErased);
@@ -128,21 +121,9 @@ Cs::find(const Interest& interest,
   bool isRightmost = interest.getChildSelector() == 1;
   NFD_LOG_DEBUG("find " << prefix << (isRightmost ? " R" : " L"));
 
-  iterator first = m_table.lower_bound(prefix);
-  iterator last = m_table.end();
-  if (prefix.size() > 0) {
-    last = m_table.lower_bound(prefix.getSuccessor());
-  }
-
-  iterator match = last;
-  if (isRightmost) {
-    match = this->findRightmost(interest, first, last);
-  }
-  else {
-    match = this->findLeftmost(interest, first, last);
-  }
-
-  if (match == last) {
+  iterator match = isRightmost ? m_table.findRightmost(interest) :
+                                 m_table.findLeftmost(interest);
+  if (match == m_table.end()) {
     NFD_LOG_DEBUG("  no-match");
     missCallback(interest);
     return;
@@ -152,50 +133,6 @@ Cs::find(const Interest& interest,
   hitCallback(interest, match->getData());
 }
 
-iterator
-Cs::findLeftmost(const Interest& interest, iterator first, iterator last) const
-{
-  return std::find_if(first, last, bind(&cs::EntryImpl::canSatisfy, _1, interest));
-}
-
-iterator
-Cs::findRightmost(const Interest& interest, iterator first, iterator last) const
-{
-  // Each loop visits a sub-namespace under a prefix one component longer than Interest Name.
-  // If there is a match in that sub-namespace, the leftmost match is returned;
-  // otherwise, loop continues.
-
-  size_t interestNameLength = interest.getName().size();
-  for (iterator right = last; right != first;) {
-    iterator prev = std::prev(right);
-
-    // special case: [first,prev] have exact Names
-    if (prev->getName().size() == interestNameLength) {
-      NFD_LOG_TRACE("  find-among-exact " << prev->getName());
-      iterator matchExact = this->findRightmostAmongExact(interest, first, right);
-      return matchExact == right ? last : matchExact;
-    }
-
-    Name prefix = prev->getName().getPrefix(interestNameLength + 1);
-    iterator left = m_table.lower_bound(prefix);
-
-    // normal case: [left,right) are under one-component-longer prefix
-    NFD_LOG_TRACE("  find-under-prefix " << prefix);
-    iterator match = this->findLeftmost(interest, left, right);
-    if (match != right) {
-      return match;
-    }
-    right = left;
-  }
-  return last;
-}
-
-iterator
-Cs::findRightmostAmongExact(const Interest& interest, iterator first, iterator last) const
-{
-  return find_last_if(first, last, bind(&EntryImpl::canSatisfy, _1, interest));
-}
-
 void
 Cs::dump()
 {
@@ -29,6 +29,7 @@
 #include "cs-policy.hpp"
 #include "cs-internal.hpp"
 #include "cs-entry-impl.hpp"
+#include "cs-table.hpp"
 #include <ndn-cxx/util/signal.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
@@ -39,7 +40,8 @@ namespace cs {
  *
  *  This Content Store implementation consists of a Table and a replacement policy.
  *
- *  The Table is a container ( \c std::set ) sorted by full Names of stored Data packets.
+ *  The Table stores Data packets and indexes them by the prefixes of their Names,
+ *  so that exact and prefix lookups do not compare full Names.
  *  Data packets are wrapped in Entry objects. Each Entry contains the Data packet itself,
  *  and a few additional attributes such as when the Data becomes non-fresh.
  *
@@ -179,25 +181,7 @@ public: // enumeration
     return boost::make_transform_iterator(m_table.end(), EntryFromEntryImpl());
   }
 
-private: // find
-  /** \brief find leftmost match in [first,last)
-   *  \return the leftmost match, or last if not found
-   */
-  iterator
-  findLeftmost(const Interest& interest, iterator left, iterator right) const;
-
-  /** \brief find rightmost match in [first,last)
-   *  \return the rightmost match, or last if not found
-   */
-  iterator
-  findRightmost(const Interest& interest, iterator first, iterator last) const;
-
-  /** \brief find rightmost match among entries with exact Names in [first,last)
-   *  \return the rightmost match, or last if not found
-   */
-  iterator
-  findRightmostAmongExact(const Interest& interest, iterator first, iterator last) const;
-
+private:
   void
   setPolicyImpl(unique_ptr<Policy> policy);
 
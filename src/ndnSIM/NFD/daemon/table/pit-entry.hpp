@@ -30,6 +30,8 @@
 #include "pit-out-record.hpp"
 #include "core/scheduler.hpp"
 
+#include <boost/container/small_vector.hpp>
+
 namespace nfd {
 
 namespace name_tree {
@@ -39,12 +41,20 @@ class Entry;
 namespace pit {
 
 /** \brief an unordered collection of in-records
+ *
+ *  Most Interests arrive from one or two downstreams, so their in-records are stored inline
+ *  without a heap allocation.  Inserting or deleting an in-record invalidates iterators and
+ *  references to other in-records of the same entry.
  */
-typedef std::list<InRecord> InRecordCollection;
+typedef boost::container::small_vector<InRecord, 2> InRecordCollection;
 
 /** \brief an unordered collection of out-records
+ *
+ *  Most Interests are forwarded to one upstream, so its out-record is stored inline
+ *  without a heap allocation.  Inserting or deleting an out-record invalidates iterators and
+ *  references to other out-records of the same entry.
  */
-typedef std::list<OutRecord> OutRecordCollection;
+typedef boost::container::small_vector<OutRecord, 1> OutRecordCollection;
 
 /** \brief an Interest table entry
  *
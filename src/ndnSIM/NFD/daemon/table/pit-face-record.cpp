@@ -29,7 +29,7 @@ namespace nfd {
 namespace pit {
 
 FaceRecord::FaceRecord(Face& face)
-  : m_face(face)
+  : m_face(&face)
   , m_lastNonce(0)
   , m_lastRenewed(time::steady_clock::TimePoint::min())
   , m_expiry(time::steady_clock::TimePoint::min())
@@ -28,6 +28,8 @@
 
 #include "fw/strategy-info.hpp"
 
+#include <algorithm>
+
 namespace nfd {
 
 /** \brief base class for an entity onto which StrategyInfo items may be placed
@@ -46,7 +48,7 @@ public:
     static_assert(std::is_base_of<fw::StrategyInfo, T>::value,
                   "T must inherit from StrategyInfo");
 
-    auto it = m_items.find(T::getTypeId());
+    auto it = this->find(T::getTypeId());
     if (it == m_items.end()) {
       return nullptr;
     }
@@ -65,12 +67,12 @@ public:
     static_assert(std::is_base_of<fw::StrategyInfo, T>::value,
                   "T must inherit from StrategyInfo");
 
-    unique_ptr<fw::StrategyInfo>& item = m_items[T::getTypeId()];
-    bool isNew = (item == nullptr);
-    if (isNew) {
-      item.reset(new T(std::forward<A>(args)...));
+    auto it = this->find(T::getTypeId());
+    if (it != m_items.end()) {
+      return {static_cast<T*>(it->second.get()), false};
     }
-    return {static_cast<T*>(item.get()), isNew};
+    m_items.emplace_back(T::getTypeId(), make_unique<T>(std::forward<A>(args)...));
+    return {static_cast<T*>(m_items.back().second.get()), true};
   }
 
   /** \brief erase a StrategyInfo item
@@ -84,7 +86,12 @@ public:
     static_assert(std::is_base_of<fw::StrategyInfo, T>::value,
                   "T must inherit from StrategyInfo");
 
-    return m_items.erase(T::getTypeId());
+    auto it = this->find(T::getTypeId());
+    if (it == m_items.end()) {
+      return 0;
+    }
+    m_items.erase(it);
+    return 1;
   }
 
   /** \brief clear all StrategyInfo items
@@ -93,7 +100,28 @@ public:
   clearStrategyInfo();
 
 private:
-  std::unordered_map<int, unique_ptr<fw::StrategyInfo>> m_items;
+  /** \brief StrategyInfo items keyed by type ID
+   *
+   *  A host carries at most a few items, so a vector with linear lookup is smaller and faster
+   *  than a hash table.  This matters for PIT in-records and out-records, which are numerous.
+   */
+  using ItemList = std::vector<std::pair<int, unique_ptr<fw::StrategyInfo>>>;
+
+  ItemList::const_iterator
+  find(int typeId) const
+  {
+    return std::find_if(m_items.begin(), m_items.end(),
+                        [typeId] (const ItemList::value_type& item) { return item.first == typeId; });
+  }
+
+  ItemList::iterator
+  find(int typeId)
+  {
+    return std::find_if(m_items.begin(), m_items.end(),
+                        [typeId] (const ItemList::value_type& item) { return item.first == typeId; });
+  }
+
+  ItemList m_items;
 };
 
 } // namespace nfd
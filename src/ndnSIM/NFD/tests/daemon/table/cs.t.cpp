@@ -409,6 +409,40 @@ BOOST_FIXTURE_TEST_CASE(Erase, FindFixture)
   BOOST_CHECK_EQUAL(m_cs.size(), 2);
 }
 
+BOOST_FIXTURE_TEST_CASE(EraseReinsert, FindFixture)
+{
+  Name n1 = insert(1, "/A/B");
+  insert(2, "/A/B/C");
+  insert(3, "/A/D");
+
+  // prefixes /A and /A/B remain under other Data
+  BOOST_CHECK_EQUAL(erase(n1, 2), 1);
+  startInterest(n1);
+  CHECK_CS_FIND(0);
+  startInterest("/A/B");
+  CHECK_CS_FIND(2);
+
+  BOOST_CHECK_EQUAL(erase("/A/B", 2), 1);
+  startInterest("/A/B");
+  CHECK_CS_FIND(0);
+  startInterest("/A")
+    .setChildSelector(1);
+  CHECK_CS_FIND(3);
+
+  insert(4, "/A/B/C");
+  startInterest("/A/B");
+  CHECK_CS_FIND(4);
+
+  BOOST_CHECK_EQUAL(erase("/", 5), 2);
+  BOOST_CHECK_EQUAL(m_cs.size(), 0);
+  startInterest("/");
+  CHECK_CS_FIND(0);
+
+  insert(5, "/A/B");
+  startInterest("/A");
+  CHECK_CS_FIND(5);
+}
+
 // When the capacity limit is set to zero, Data cannot be inserted;
 // this test case covers this situation.
 // The behavior of non-zero capacity limit depends on the eviction policy,
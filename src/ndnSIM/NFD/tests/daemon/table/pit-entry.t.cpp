@@ -174,6 +174,51 @@ BOOST_AUTO_TEST_CASE(InOutRecords)
   BOOST_CHECK(entry.getOutRecord(*face2) == entry.out_end());
 }
 
+BOOST_AUTO_TEST_CASE(ManyRecords)
+{
+  std::vector<shared_ptr<Face>> faces;
+  for (size_t i = 0; i < 6; ++i) {
+    faces.push_back(make_shared<DummyFace>());
+  }
+  shared_ptr<Interest> interest = makeInterest("/KuYfjtRq");
+  Entry entry(*interest);
+
+  // insert more records than can be stored inline
+  for (size_t i = 0; i < faces.size(); ++i) {
+    interest->setNonce(1000 + i);
+    entry.insertOrUpdateInRecord(*faces[i], *interest);
+    entry.insertOrUpdateOutRecord(*faces[i], *interest);
+  }
+  BOOST_CHECK_EQUAL(entry.getInRecords().size(), faces.size());
+  BOOST_CHECK_EQUAL(entry.getOutRecords().size(), faces.size());
+
+  // records keep their state after being moved
+  for (size_t i = 0; i < faces.size(); ++i) {
+    auto inRecord = entry.getInRecord(*faces[i]);
+    BOOST_REQUIRE(inRecord != entry.in_end());
+    BOOST_CHECK_EQUAL(inRecord->getLastNonce(), 1000 + i);
+    auto outRecord = entry.getOutRecord(*faces[i]);
+    BOOST_REQUIRE(outRecord != entry.out_end());
+    BOOST_CHECK_EQUAL(outRecord->getLastNonce(), 1000 + i);
+  }
+
+  // delete records from the middle and the ends
+  for (size_t i : {2, 0, 5}) {
+    entry.deleteInRecord(*faces[i]);
+    entry.deleteOutRecord(*faces[i]);
+  }
+  BOOST_CHECK_EQUAL(entry.getInRecords().size(), 3);
+  BOOST_CHECK_EQUAL(entry.getOutRecords().size(), 3);
+  for (size_t i = 0; i < faces.size(); ++i) {
+    bool isDeleted = i == 0 || i == 2 || i == 5;
+    BOOST_CHECK_EQUAL(entry.getInRecord(*faces[i]) == entry.in_end(), isDeleted);
+    BOOST_CHECK_EQUAL(entry.getOutRecord(*faces[i]) == entry.out_end(), isDeleted);
+    if (!isDeleted) {
+      BOOST_CHECK_EQUAL(entry.getInRecord(*faces[i])->getLastNonce(), 1000 + i);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(Lifetime)
 {
   shared_ptr<Interest> interest = makeInterest("ndn:/7oIEurbgy6");
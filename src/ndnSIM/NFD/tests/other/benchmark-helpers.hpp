@@ -32,4 +32,30 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/output_test_stream.hpp>
 
+#include <cstddef>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace nfd {
+namespace tests {
+
+/** \return bytes allocated from the heap, or 0 if unknown
+ */
+inline size_t
+getAllocatedBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+  return static_cast<unsigned int>(mallinfo().uordblks);
+#else
+  return 0;
+#endif
+}
+
+} // namespace tests
+} // namespace nfd
+
 #endif // NFD_TESTS_OTHER_BENCHMARK_HELPERS_HPP
@@ -244,5 +244,45 @@ BOOST_FIXTURE_TEST_CASE(Rightmost, CsBenchmarkFixture)
   std::cout << "find(rightmost) " << (N_INTERESTS * N_CHILDREN * REPEAT) << ": " << d << std::endl;
 }
 
+// find(exact) hit, Interest Name is full Name of Data
+BOOST_FIXTURE_TEST_CASE(FindFullName, CsBenchmarkFixture)
+{
+  constexpr size_t REPEAT = 4;
+
+  std::vector<shared_ptr<Data>> dataWorkload = makeDataWorkload(CS_CAPACITY);
+  std::vector<shared_ptr<Interest>> interestWorkload;
+  for (const auto& data : dataWorkload) {
+    cs.insert(*data, false);
+    interestWorkload.push_back(make_shared<Interest>(data->getFullName()));
+  }
+  BOOST_REQUIRE(cs.size() == CS_CAPACITY);
+
+  time::microseconds d = timedRun([&] {
+    for (size_t j = 0; j < REPEAT; ++j) {
+      for (const auto& interest : interestWorkload) {
+        find(*interest);
+      }
+    }
+  });
+
+  std::cout << "find(full-name) " << (CS_CAPACITY * REPEAT) << ": " << d << std::endl;
+}
+
+// heap memory of table and policy per entry, excluding Data packets
+BOOST_FIXTURE_TEST_CASE(MemoryPerEntry, CsBenchmarkFixture)
+{
+  std::vector<shared_ptr<Data>> dataWorkload = makeDataWorkload(CS_CAPACITY);
+
+  size_t before = getAllocatedBytes();
+  for (const auto& data : dataWorkload) {
+    cs.insert(*data, false);
+  }
+  size_t after = getAllocatedBytes();
+  BOOST_REQUIRE(cs.size() == CS_CAPACITY);
+
+  std::cout << "memory per entry " << CS_CAPACITY << ": "
+            << (after - before) / CS_CAPACITY << " bytes" << std::endl;
+}
+
 } // namespace tests
 } // namespace nfd
@@ -24,6 +24,8 @@
  */
 
 #include "benchmark-helpers.hpp"
+#include "face/generic-link-service.hpp"
+#include "face/internal-transport.hpp"
 #include "table/fib.hpp"
 #include "table/pit.hpp"
 
@@ -153,5 +155,81 @@ BOOST_FIXTURE_TEST_CASE(SimpleExchanges, PitFibBenchmarkFixture)
   std::cout << time::duration_cast<time::microseconds>(t2 - t1) << std::endl;
 }
 
+// This test case models PIT entries that aggregate Interests from several downstreams.
+// For every Interest, a PIT entry is inserted with nInRecords in-records and one out-record.
+// When all entries are pending, records are looked up and iterated as when Data returns,
+// then entries are erased.  Throughput is reported in entries per second, and memory
+// in heap bytes per pending entry (including its name tree entry).
+BOOST_FIXTURE_TEST_CASE(AggregatedExchanges, PitFibBenchmarkFixture)
+{
+  // number of PIT entries
+  const size_t nEntries = 200000;
+  // total amount of FIB entires
+  const size_t nFibEntries = 2000;
+
+  generatePacketsAndPopulateFib(nEntries, nFibEntries, 1, 2, 3);
+  for (const auto& interest : interests) {
+    interest->getNonce(); // do not allocate a Nonce while measuring
+  }
+
+  std::vector<shared_ptr<Face>> faces;
+  for (size_t i = 0; i < 5; i++) {
+    faces.push_back(make_shared<Face>(make_unique<face::GenericLinkService>(),
+                                      make_unique<face::InternalForwarderTransport>()));
+  }
+  Face& upstream = *faces.back();
+  pitEntries.reserve(nEntries);
+
+  for (size_t nInRecords : {1, 2, 4}) {
+    size_t nRecordsVisited = 0;
+
+#ifdef HAVE_VALGRIND
+    CALLGRIND_START_INSTRUMENTATION;
+#endif
+
+    size_t memoryBefore = getAllocatedBytes();
+    auto t1 = time::steady_clock::now();
+
+    for (size_t i = 0; i < nEntries; ++i) {
+      // process incoming Interests and forward the first one
+      shared_ptr<pit::Entry> pitEntry = m_pit.insert(*interests[i]).first;
+      for (size_t j = 0; j < nInRecords; ++j) {
+        pitEntry->insertOrUpdateInRecord(*faces[j], *interests[i]);
+      }
+      pitEntry->insertOrUpdateOutRecord(upstream, *interests[i]);
+      pitEntries.push_back(pitEntry);
+    }
+
+    size_t memoryPending = getAllocatedBytes();
+
+    for (const shared_ptr<pit::Entry>& pitEntry : pitEntries) {
+      // process incoming Data: satisfy downstreams and delete PIT entry
+      if (pitEntry->getOutRecord(upstream) != pitEntry->out_end()) {
+        for (const pit::InRecord& inRecord : pitEntry->getInRecords()) {
+          nRecordsVisited += inRecord.getExpiry() > time::steady_clock::TimePoint::min();
+        }
+      }
+      pitEntry->clearInRecords();
+      pitEntry->deleteOutRecord(upstream);
+      m_pit.erase(pitEntry.get());
+    }
+
+    auto t2 = time::steady_clock::now();
+
+#ifdef HAVE_VALGRIND
+    CALLGRIND_STOP_INSTRUMENTATION;
+#endif
+
+    pitEntries.clear();
+    BOOST_CHECK_EQUAL(nRecordsVisited, nEntries * nInRecords);
+    BOOST_CHECK_EQUAL(m_pit.size(), 0);
+
+    auto duration = time::duration_cast<time::microseconds>(t2 - t1);
+    std::cout << "in-records " << nInRecords << ": " << duration << ", "
+              << static_cast<uint64_t>(nEntries * 1000000.0 / duration.count()) << " entries/s, "
+              << (memoryPending - memoryBefore) / nEntries << " bytes per entry" << std::endl;
+  }
+}
+
 } // namespace tests
 } // namespace nfd
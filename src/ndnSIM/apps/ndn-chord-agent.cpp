@@ -0,0 +1,464 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ndn-chord-agent.hpp"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+#include "model/ndn-l3-protocol.hpp"
+#include "helper/ndn-fib-helper.hpp"
+
+NS_LOG_COMPONENT_DEFINE("ndn.ChordAgent");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED(ChordAgent);
+
+static const name::Component HELLO("hello");
+static const name::Component JOIN("join");
+static const name::Component STABILIZE("stabilize");
+static const name::Component NOTIFY("notify");
+static const name::Component FIND("find");
+static const name::Component REGISTER("register");
+static const name::Component RESOLVE("resolve");
+
+static const uint32_t N_FINGERS = 64;
+
+TypeId
+ChordAgent::GetTypeId(void)
+{
+  static TypeId tid =
+    TypeId("ns3::ndn::ChordAgent")
+      .SetGroupName("Ndn")
+      .SetParent<App>()
+      .AddConstructor<ChordAgent>()
+      .AddAttribute("RequestLifetime", "Lifetime of request Interests, request fails after it",
+                    StringValue("2s"), MakeTimeAccessor(&ChordAgent::m_requestLifetime),
+                    MakeTimeChecker())
+      .AddAttribute("JoinRetryInterval", "Time before a failed join is retried",
+                    StringValue("1s"), MakeTimeAccessor(&ChordAgent::m_joinRetryInterval),
+                    MakeTimeChecker())
+      .AddAttribute("StabilizeInterval", "Time between stabilize requests to the successor",
+                    StringValue("1s"), MakeTimeAccessor(&ChordAgent::m_stabilizeInterval),
+                    MakeTimeChecker())
+      .AddAttribute("FixFingersInterval", "Time between refreshes of one finger",
+                    StringValue("500ms"), MakeTimeAccessor(&ChordAgent::m_fixFingersInterval),
+                    MakeTimeChecker())
+      .AddAttribute("RegisterInterval", "Time between registrations of local prefixes",
+                    StringValue("10s"), MakeTimeAccessor(&ChordAgent::m_registerInterval),
+                    MakeTimeChecker());
+  return tid;
+}
+
+ChordAgent::ChordAgent()
+  : m_rand(CreateObject<UniformRandomVariable>())
+  , m_nextFinger(0)
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+// inherited from Application base class.
+void
+ChordAgent::StartApplication()
+{
+  NS_LOG_FUNCTION_NOARGS();
+  App::StartApplication();
+
+  m_router = GetNode()->GetObject<ChordRouter>();
+  NS_ASSERT_MSG(m_router != 0, "ChordRouter should be installed on the node " << GetNode());
+
+  FibHelper::AddRoute(GetNode(), ChordRouter::GetPrefix(), m_face, 0);
+  m_router->SetResolver(std::bind(&ChordAgent::Resolve, this, std::placeholders::_1,
+                                  std::placeholders::_2));
+
+  if (m_router->IsJoined()) {
+    OnJoined();
+    return;
+  }
+
+  SendRequest(HELLO, 0);
+  m_joinEvent = Simulator::Schedule(m_joinRetryInterval, &ChordAgent::Join, this);
+}
+
+void
+ChordAgent::StopApplication()
+{
+  NS_LOG_FUNCTION_NOARGS();
+
+  Simulator::Cancel(m_joinEvent);
+  Simulator::Cancel(m_stabilizeEvent);
+  Simulator::Cancel(m_fixFingersEvent);
+  Simulator::Cancel(m_registerEvent);
+  for (auto& request : m_requests) {
+    Simulator::Cancel(request.second.timeout);
+  }
+  m_requests.clear();
+  m_resolving.clear();
+  m_router->SetResolver(nullptr);
+
+  App::StopApplication();
+}
+
+void
+ChordAgent::SendRequest(const name::Component& op, uint64_t key, uint32_t finger)
+{
+  if (!m_active)
+    return;
+
+  Request request = {op, key, finger, EventId()};
+
+  // requests this node would answer itself never leave the node
+  uint64_t closest = 0;
+  if (op != HELLO && m_router->IsJoined() && m_router->FindClosestPreceding(key, closest)
+      && closest == m_router->GetRingId() && m_router->IsResponsible(key)) {
+    Reply reply;
+    ProcessRequest(op, key, m_router->GetRingId(), reply);
+    ProcessReply(request, reply);
+    return;
+  }
+
+  uint64_t nonce = m_rand->GetInteger(0, std::numeric_limits<uint32_t>::max());
+  while (m_requests.find(nonce) != m_requests.end()) {
+    nonce = m_rand->GetInteger(0, std::numeric_limits<uint32_t>::max());
+  }
+
+  if (op == HELLO) {
+    key = m_router->IsJoined() ? 1 : 0;
+  }
+
+  Name name(ChordRouter::GetPrefix());
+  name.append(op).appendNumber(key).appendNumber(m_router->GetRingId()).appendNumber(nonce);
+
+  shared_ptr<Interest> interest = make_shared<Interest>(name);
+  interest->setCanBePrefix(true);
+  interest->setNonce(nonce);
+  interest->setInterestLifetime(time::milliseconds(m_requestLifetime.GetMilliSeconds()));
+
+  request.timeout =
+    Simulator::Schedule(m_requestLifetime, &ChordAgent::ProcessFailure, this, nonce);
+  m_requests[nonce] = request;
+
+  NS_LOG_INFO("> " << name);
+
+  m_transmittedInterests(interest, this, m_face);
+  m_appLink->onReceiveInterest(*interest);
+}
+
+void
+ChordAgent::OnInterest(shared_ptr<const Interest> interest)
+{
+  App::OnInterest(interest); // tracing inside
+
+  NS_LOG_FUNCTION(this << interest);
+
+  // non-members do not answer, Interests reach them only as hello
+  const Name& name = interest->getName();
+  if (!m_active || !m_router->IsJoined() || name.size() != 5)
+    return;
+
+  Reply reply;
+  ProcessRequest(name[1], name[2].toNumber(), name[3].toNumber(), reply);
+
+  Name dataName(name);
+  dataName.appendNumber(reply.responder).appendNumber(reply.successor);
+  if (reply.hasPredecessor) {
+    dataName.appendNumber(reply.predecessor);
+  }
+
+  auto data = make_shared<Data>();
+  data->setName(dataName);
+  data->setFreshnessPeriod(::ndn::time::milliseconds(0));
+  if (reply.hasProducer) {
+    data->setContent(::ndn::makeNonNegativeIntegerBlock(::ndn::tlv::Content, reply.producer));
+  }
+
+  Signature signature;
+  SignatureInfo signatureInfo(static_cast< ::ndn::tlv::SignatureTypeValue>(255));
+  signature.setInfo(signatureInfo);
+  signature.setValue(::ndn::makeNonNegativeIntegerBlock(::ndn::tlv::SignatureValue, 0));
+  data->setSignature(signature);
+
+  NS_LOG_INFO("< " << dataName);
+
+  // to create real wire encoding
+  data->wireEncode();
+
+  m_transmittedDatas(data, this, m_face);
+  m_appLink->onReceiveData(*data);
+}
+
+void
+ChordAgent::OnData(shared_ptr<const Data> data)
+{
+  if (!m_active)
+    return;
+
+  App::OnData(data); // tracing inside
+
+  NS_LOG_FUNCTION(this << data);
+
+  // <request>/<responder>/<successor>[/<predecessor>]
+  const Name& name = data->getName();
+  if (name.size() < 7)
+    return;
+
+  auto request = m_requests.find(name[4].toNumber());
+  if (request == m_requests.end())
+    return;
+
+  Reply reply;
+  reply.responder = name[5].toNumber();
+  reply.successor = name[6].toNumber();
+  reply.hasPredecessor = name.size() > 7;
+  reply.predecessor = reply.hasPredecessor ? name[7].toNumber() : 0;
+  reply.hasProducer = data->getContent().value_size() > 0;
+  reply.producer = reply.hasProducer ? ::ndn::readNonNegativeInteger(data->getContent()) : 0;
+
+  Simulator::Cancel(request->second.timeout);
+  Request completed = request->second;
+  m_requests.erase(request);
+
+  ProcessReply(completed, reply);
+}
+
+void
+ChordAgent::OnNack(shared_ptr<const lp::Nack> nack)
+{
+  App::OnNack(nack); // tracing inside
+
+  const Name& name = nack->getInterest().getName();
+  NS_LOG_INFO("NACK received for: " << name << ", reason: " << nack->getReason());
+  if (name.size() != 5)
+    return;
+
+  auto request = m_requests.find(name[4].toNumber());
+  if (request != m_requests.end()) {
+    Simulator::Cancel(request->second.timeout);
+    ProcessFailure(request->first);
+  }
+}
+
+void
+ChordAgent::ProcessRequest(const name::Component& op, uint64_t key, uint64_t origin,
+                           Reply& reply)
+{
+  uint64_t self = m_router->GetRingId();
+
+  if (op == NOTIFY && origin != self) {
+    if (!m_router->HasPredecessor()
+        || ChordRouter::InInterval(origin, m_router->GetPredecessor(), self)) {
+      NS_LOG_DEBUG("Node " << self << " predecessor " << origin);
+      m_router->SetPredecessor(origin);
+    }
+    if (m_router->GetSuccessor() == self) {
+      // ring of one node
+      m_router->SetSuccessor(origin);
+    }
+  }
+  else if (op == REGISTER) {
+    m_router->AddRegistration(key, origin);
+  }
+
+  reply.hasProducer = op == RESOLVE && m_router->FindRegistration(key, reply.producer);
+
+  reply.responder = self;
+  reply.successor = m_router->GetSuccessor();
+  reply.hasPredecessor = m_router->HasPredecessor();
+  reply.predecessor = m_router->GetPredecessor();
+}
+
+void
+ChordAgent::ProcessReply(const Request& request, const Reply& reply)
+{
+  uint64_t self = m_router->GetRingId();
+
+  if (request.op == HELLO) {
+    if (!m_router->IsJoined() && m_joinEvent.IsRunning()) {
+      Simulator::Cancel(m_joinEvent);
+      Join();
+    }
+  }
+  else if (request.op == JOIN) {
+    if (m_router->IsJoined())
+      return;
+
+    // responder may have picked this node up as successor from its requests already
+    uint64_t successor = reply.successor != self ? reply.successor : reply.responder;
+    NS_LOG_DEBUG("Node " << self << " joined, successor " << successor);
+    m_router->SetSuccessor(successor);
+    m_router->SetJoined();
+    OnJoined();
+  }
+  else if (request.op == STABILIZE) {
+    uint64_t successor = m_router->GetSuccessor();
+    // successor did not answer itself, the member preceding its identifier did
+    if (reply.responder != successor && ChordRouter::InInterval(reply.responder, self, successor)) {
+      successor = reply.responder;
+    }
+    if (reply.hasPredecessor && reply.predecessor != successor
+        && ChordRouter::InInterval(reply.predecessor, self, successor)) {
+      successor = reply.predecessor;
+    }
+    m_router->SetSuccessor(successor);
+    if (successor != self) {
+      SendRequest(NOTIFY, successor);
+    }
+  }
+  else if (request.op == FIND) {
+    m_router->SetFinger(request.finger, reply.responder);
+  }
+  else if (request.op == RESOLVE) {
+    if (reply.hasProducer) {
+      m_router->AddRegistration(request.key, reply.producer);
+    }
+    CompleteResolve(request.key, reply.hasProducer, reply.producer);
+  }
+}
+
+void
+ChordAgent::ProcessFailure(uint64_t nonce)
+{
+  auto request = m_requests.find(nonce);
+  if (request == m_requests.end())
+    return;
+
+  name::Component op = request->second.op;
+  uint64_t key = request->second.key;
+  m_requests.erase(request);
+
+  if (op == JOIN) {
+    m_joinEvent = Simulator::Schedule(m_joinRetryInterval, &ChordAgent::Join, this);
+  }
+  else if (op == STABILIZE) {
+    // successor is gone, fall back to the closest member following this node
+    uint64_t self = m_router->GetRingId();
+    uint64_t successor = m_router->GetSuccessor();
+    NS_LOG_DEBUG("Node " << self << " lost successor " << successor);
+    m_router->RemoveRoute(successor);
+    if (!m_router->FindClosestSucceeding(successor)) {
+      successor = self;
+    }
+    m_router->SetSuccessor(successor);
+  }
+  else if (op == RESOLVE) {
+    CompleteResolve(key, false, 0);
+  }
+}
+
+void
+ChordAgent::Join()
+{
+  if (m_router->IsJoined())
+    return;
+
+  SendRequest(JOIN, m_router->GetRingId());
+}
+
+void
+ChordAgent::OnJoined()
+{
+  SendRequest(HELLO, 1);
+  if (m_router->GetSuccessor() != m_router->GetRingId()) {
+    SendRequest(NOTIFY, m_router->GetSuccessor());
+  }
+
+  m_stabilizeEvent = Simulator::Schedule(m_stabilizeInterval, &ChordAgent::Stabilize, this);
+  m_fixFingersEvent = Simulator::Schedule(m_fixFingersInterval, &ChordAgent::FixFingers, this);
+  Register();
+}
+
+void
+ChordAgent::Stabilize()
+{
+  uint64_t self = m_router->GetRingId();
+  if (m_router->GetSuccessor() == self && m_router->HasPredecessor()) {
+    m_router->SetSuccessor(m_router->GetPredecessor());
+  }
+  if (m_router->GetSuccessor() != self) {
+    SendRequest(STABILIZE, m_router->GetSuccessor());
+  }
+
+  m_stabilizeEvent = Simulator::Schedule(m_stabilizeInterval, &ChordAgent::Stabilize, this);
+}
+
+void
+ChordAgent::FixFingers()
+{
+  uint64_t self = m_router->GetRingId();
+
+  // fingers starting before the successor are this node itself
+  for (uint32_t i = 0; i < N_FINGERS; i++) {
+    uint32_t finger = m_nextFinger;
+    m_nextFinger = (m_nextFinger + 1) % N_FINGERS;
+
+    uint64_t start = self + (static_cast<uint64_t>(1) << finger);
+    if (!ChordRouter::InInterval(start, self, m_router->GetSuccessor())) {
+      SendRequest(FIND, start, finger);
+      break;
+    }
+  }
+
+  m_fixFingersEvent = Simulator::Schedule(m_fixFingersInterval, &ChordAgent::FixFingers, this);
+}
+
+void
+ChordAgent::Register()
+{
+  for (const auto& prefix : m_router->GetLocalPrefixes()) {
+    SendRequest(REGISTER, m_router->GetKey(*prefix));
+  }
+
+  m_registerEvent = Simulator::Schedule(m_registerInterval, &ChordAgent::Register, this);
+}
+
+void
+ChordAgent::Resolve(uint64_t key, const ChordRouter::ResolveCallback& callback)
+{
+  if (!m_router->IsJoined()) {
+    callback(false, 0);
+    return;
+  }
+
+  std::vector<ChordRouter::ResolveCallback>& callbacks = m_resolving[key];
+  callbacks.push_back(callback);
+  if (callbacks.size() == 1) {
+    SendRequest(RESOLVE, key);
+  }
+}
+
+void
+ChordAgent::CompleteResolve(uint64_t key, bool isFound, uint64_t producer)
+{
+  auto resolving = m_resolving.find(key);
+  if (resolving == m_resolving.end())
+    return;
+
+  std::vector<ChordRouter::ResolveCallback> callbacks;
+  callbacks.swap(resolving->second);
+  m_resolving.erase(resolving);
+
+  for (const auto& callback : callbacks) {
+    callback(isFound, producer);
+  }
+}
+
+} // namespace ndn
+} // namespace ns3
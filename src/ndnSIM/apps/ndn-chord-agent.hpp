@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CHORD_AGENT_H
+#define NDN_CHORD_AGENT_H
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include "ndn-app.hpp"
+#include "ns3/ndnSIM/model/ndn-chord-router.hpp"
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-apps
+ * @brief Maintains the node's ChordRouter (ring membership, successor, predecessor, fingers and
+ *        content registrations) with Interests and Data under /chord
+ *
+ * Requests are named /chord/<op>/<key>/<origin>/<nonce> and are routed by
+ * nfd::fw::ChordStrategy to the member most closely preceding key, which answers with Data
+ * named <request>/<responder>/<successor>[/<predecessor>]:
+ *
+ * - hello: sent to physical neighbours on start and after joining (key is 1 once joined),
+ *   members answer
+ * - join: key is the joining node, its successor is the responder's successor
+ * - stabilize, notify: key is the successor, Chord stabilization
+ * - find: key is GetRingId () + 2^i, the responder becomes finger i
+ * - register: key is the ring key of a local prefix, the responder keeps the registration
+ * - resolve: key is the ring key of a content name, the responder answers with the registered
+ *   producer as content (empty if none); the result is cached as a registration of this node
+ *
+ * Resolve requests are issued for nfd::fw::ChordStrategy through ChordRouter::Resolve, concurrent
+ * requests for one key are coalesced.
+ *
+ * The node is a member from the start if ChordRouter::IsJoined () (bootstrap node).
+ */
+class ChordAgent : public App {
+public:
+  static TypeId
+  GetTypeId(void);
+
+  ChordAgent();
+
+  // inherited from NdnApp
+  virtual void
+  OnInterest(shared_ptr<const Interest> interest);
+
+  virtual void
+  OnData(shared_ptr<const Data> data);
+
+  virtual void
+  OnNack(shared_ptr<const lp::Nack> nack);
+
+protected:
+  // inherited from Application base class.
+  virtual void
+  StartApplication(); // Called at time specified by Start
+
+  virtual void
+  StopApplication(); // Called at time specified by Stop
+
+private:
+  struct Request
+  {
+    name::Component op;
+    uint64_t key;
+    uint32_t finger;
+    EventId timeout;
+  };
+
+  struct Reply
+  {
+    uint64_t responder;
+    uint64_t successor;
+    bool hasPredecessor;
+    uint64_t predecessor;
+    bool hasProducer;
+    uint64_t producer;
+  };
+
+  void
+  SendRequest(const name::Component& op, uint64_t key, uint32_t finger = 0);
+
+  void
+  ProcessRequest(const name::Component& op, uint64_t key, uint64_t origin, Reply& reply);
+
+  void
+  ProcessReply(const Request& request, const Reply& reply);
+
+  void
+  ProcessFailure(uint64_t nonce);
+
+  void
+  Join();
+
+  void
+  OnJoined();
+
+  void
+  Stabilize();
+
+  void
+  FixFingers();
+
+  void
+  Register();
+
+  void
+  Resolve(uint64_t key, const ChordRouter::ResolveCallback& callback);
+
+  void
+  CompleteResolve(uint64_t key, bool isFound, uint64_t producer);
+
+private:
+  Ptr<ChordRouter> m_router;
+  Ptr<UniformRandomVariable> m_rand;
+  std::map<uint64_t, Request> m_requests; ///< @brief Pending requests indexed by nonce
+  std::map<uint64_t, std::vector<ChordRouter::ResolveCallback>> m_resolving; ///< @brief by key
+  uint32_t m_nextFinger;
+
+  EventId m_joinEvent;
+  EventId m_stabilizeEvent;
+  EventId m_fixFingersEvent;
+  EventId m_registerEvent;
+
+  Time m_requestLifetime;
+  Time m_joinRetryInterval;
+  Time m_stabilizeInterval;
+  Time m_fixFingersInterval;
+  Time m_registerInterval;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CHORD_AGENT_H
@@ -0,0 +1,234 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// ndn-chord-routing.cpp
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "ns3/ndnSIM/apps/ndn-app.hpp"
+#include "ns3/ndnSIM/model/ndn-chord-router.hpp"
+
+#include <iostream>
+#include <set>
+
+namespace ns3 {
+
+/**
+ * This scenario compares Chord routing (ndn::ChordRoutingHelper) with FIBs computed by
+ * ndn::GlobalRoutingHelper on a grid topology (using PointToPointGrid module)
+ *
+ * Every node produces Data under its own prefix /node<id>, so global routing installs a FIB
+ * entry per prefix on every node.  With Chord routing, nodes only keep routes to ring members
+ * they heard from and the registrations of the prefixes they precede on the ring.
+ *
+ * Consumers on random nodes request Data of a random other node with frequency 10 Interests per
+ * second, starting after the Chord ring settled.
+ *
+ * The scenario prints one CSV row:
+ *
+ *     routing,nodes,fibEntries,chordEntries,stateBytes,interests,satisfied,meanDelayMs,meanHops,
+ *     chordInterests
+ *
+ * stateBytes estimates the size of FIB entries (entry, prefix wire encoding and next hops) and
+ * of Chord routes and registrations.
+ *
+ * To run scenario and compare both, use the following commands:
+ *
+ *     ./waf --run="ndn-chord-routing --routing=global --size=8"
+ *     ./waf --run="ndn-chord-routing --routing=chord --size=8"
+ */
+
+struct Statistics
+{
+  std::set<std::pair<ndn::App*, uint32_t>> interests; ///< (consumer, sequence number)
+  uint64_t satisfied = 0;
+  double delayMs = 0;
+  uint64_t hops = 0;
+  uint64_t chordInterests = 0;
+};
+
+static void
+ConsumerInterest(Statistics* stats, shared_ptr<const ndn::Interest> interest, Ptr<ndn::App> app,
+                 shared_ptr<ndn::Face> face)
+{
+  stats->interests.insert(std::make_pair(PeekPointer(app),
+                                         interest->getName().at(-1).toSequenceNumber()));
+}
+
+static void
+ConsumerDelay(Statistics* stats, Ptr<ndn::App> app, uint32_t seqno, Time delay,
+              uint32_t retxCount, int32_t hopCount)
+{
+  stats->satisfied++;
+  stats->delayMs += delay.GetSeconds() * 1000;
+  stats->hops += hopCount;
+}
+
+static void
+ChordInterest(Statistics* stats, shared_ptr<const ndn::Interest> interest, Ptr<ndn::App> app,
+              shared_ptr<ndn::Face> face)
+{
+  stats->chordInterests++;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string routing = "chord";
+  uint32_t size = 6;
+  uint32_t nConsumers = 10;
+  double settle = 20;
+  double duration = 20;
+
+  Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("10Mbps"));
+  Config::SetDefault("ns3::PointToPointChannel::Delay", StringValue("5ms"));
+  Config::SetDefault("ns3::QueueBase::MaxPackets", UintegerValue(100));
+
+  CommandLine cmd;
+  cmd.AddValue("routing", "Route computation: global or chord", routing);
+  cmd.AddValue("size", "Grid has size x size nodes", size);
+  cmd.AddValue("consumers", "Number of consumers", nConsumers);
+  cmd.AddValue("settle", "Seconds between the last join and the start of consumers", settle);
+  cmd.AddValue("duration", "Seconds consumers run", duration);
+  cmd.Parse(argc, argv);
+
+  PointToPointHelper p2p;
+  PointToPointGridHelper grid(size, size, p2p);
+  grid.BoundingBox(100, 100, 200, 200);
+
+  NodeContainer nodes;
+  for (uint32_t row = 0; row < size; row++) {
+    for (uint32_t col = 0; col < size; col++) {
+      nodes.Add(grid.GetNode(row, col));
+    }
+  }
+
+  // Install NDN stack on all nodes
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+
+  Statistics stats;
+  Time start = Seconds(settle);
+
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndn::ChordRoutingHelper ndnChordRoutingHelper;
+  if (routing == "global") {
+    ndn::StrategyChoiceHelper::InstallAll("/", "/localhost/nfd/strategy/best-route");
+    ndnGlobalRoutingHelper.Install(nodes);
+  }
+  else {
+    ApplicationContainer agents = ndnChordRoutingHelper.Install(nodes);
+    for (ApplicationContainer::Iterator agent = agents.Begin(); agent != agents.End(); agent++) {
+      (*agent)->TraceConnectWithoutContext("TransmittedInterests",
+                                           MakeBoundCallback(&ChordInterest, &stats));
+    }
+    start += ndnChordRoutingHelper.GetLastJoinTime();
+  }
+
+  // Every node produces its own prefix
+  for (NodeContainer::Iterator node = nodes.Begin(); node != nodes.End(); node++) {
+    std::string prefix = "/node" + std::to_string((*node)->GetId());
+
+    ndn::AppHelper producerHelper("ns3::ndn::Producer");
+    producerHelper.SetPrefix(prefix);
+    producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
+    producerHelper.Install(*node);
+
+    if (routing == "global") {
+      ndnGlobalRoutingHelper.AddOrigin(prefix, *node);
+    }
+    else {
+      ndnChordRoutingHelper.AddOrigin(prefix, *node);
+    }
+  }
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable>();
+  for (uint32_t i = 0; i < nConsumers; i++) {
+    uint32_t consumer = random->GetInteger(0, nodes.GetN() - 1);
+    uint32_t producer = random->GetInteger(0, nodes.GetN() - 2);
+    if (producer >= consumer) {
+      producer++;
+    }
+
+    ndn::AppHelper consumerHelper("ns3::ndn::ConsumerCbr");
+    consumerHelper.SetPrefix("/node" + std::to_string(nodes.Get(producer)->GetId()));
+    consumerHelper.SetAttribute("Frequency", StringValue("10"));
+    ApplicationContainer apps = consumerHelper.Install(nodes.Get(consumer));
+    apps.Start(start);
+    apps.Stop(start + Seconds(duration));
+
+    apps.Get(0)->TraceConnectWithoutContext("TransmittedInterests",
+                                            MakeBoundCallback(&ConsumerInterest, &stats));
+    apps.Get(0)->TraceConnectWithoutContext("FirstInterestDataDelay",
+                                            MakeBoundCallback(&ConsumerDelay, &stats));
+  }
+
+  if (routing == "global") {
+    // Calculate and install FIBs
+    ndn::GlobalRoutingHelper::CalculateRoutes();
+  }
+
+  Simulator::Stop(start + Seconds(duration + 2));
+  Simulator::Run();
+
+  // Routing state of all nodes
+  uint64_t fibEntries = 0;
+  uint64_t chordEntries = 0;
+  uint64_t stateBytes = 0;
+  for (NodeContainer::Iterator node = nodes.Begin(); node != nodes.End(); node++) {
+    const nfd::Fib& fib = (*node)->GetObject<ndn::L3Protocol>()->getForwarder()->getFib();
+    for (const auto& entry : fib) {
+      fibEntries++;
+      stateBytes += sizeof(nfd::fib::Entry) + entry.getPrefix().wireEncode().size()
+                    + entry.getNextHops().size() * sizeof(nfd::fib::NextHop);
+    }
+
+    Ptr<ndn::ChordRouter> router = (*node)->GetObject<ndn::ChordRouter>();
+    if (router != 0) {
+      chordEntries += router->GetRoutes().size() + router->GetNRegistrations();
+      stateBytes +=
+        router->GetRoutes().size() * (sizeof(uint64_t) + sizeof(ndn::ChordRouter::Route));
+      stateBytes += router->GetNRegistrations() * (2 * sizeof(uint64_t) + sizeof(Time));
+    }
+  }
+
+  std::cout << "routing,nodes,fibEntries,chordEntries,stateBytes,interests,satisfied,meanDelayMs,"
+            << "meanHops,chordInterests" << std::endl;
+  std::cout << routing << "," << nodes.GetN() << "," << fibEntries << "," << chordEntries << ","
+            << stateBytes << "," << stats.interests.size() << "," << stats.satisfied << ","
+            << (stats.satisfied ? stats.delayMs / stats.satisfied : 0) << ","
+            << (stats.satisfied ? static_cast<double>(stats.hops) / stats.satisfied : 0) << ","
+            << stats.chordInterests << std::endl;
+
+  Simulator::Destroy();
+
+  return 0;
+}
+
+} // namespace ns3
+
+int
+main(int argc, char* argv[])
+{
+  return ns3::main(argc, argv);
+}
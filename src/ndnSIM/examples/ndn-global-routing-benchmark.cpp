@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+// ndn-global-routing-benchmark.cpp
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/point-to-point-layout-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * This benchmark measures how long ndn::GlobalRoutingHelper takes to calculate and install
+ * routes on a grid topology (using PointToPointGrid module), for several numbers of threads.
+ *
+ * Prefixes /origin<i> are produced by randomly chosen nodes.  For every number of threads,
+ * routes are calculated again on the same topology, and the benchmark prints one CSV row:
+ *
+ *     nodes,origins,threads,setupSeconds,failures,updateSeconds
+ *
+ * setupSeconds is the wall-clock time of CalculateRoutes (or CalculateAllPossibleRoutes).
+ *
+ * With --failures=N, routes are calculated with incremental updates enabled, then N randomly
+ * chosen links fail one after another and are brought up again in reverse order.
+ * updateSeconds is the mean wall-clock time of GlobalRoutingHelper::FailLink and UpLink per
+ * event, to compare with setupSeconds of a full calculation.
+ *
+ * To run the benchmark on 4900 nodes:
+ *
+ *     ./waf --run="ndn-global-routing-benchmark --size=70 --threads=1,2,4,8"
+ *
+ * and to measure incremental updates after 100 link failures:
+ *
+ *     ./waf --run="ndn-global-routing-benchmark --size=70 --threads=1 --failures=100"
+ */
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t size = 30;
+  uint32_t nOrigins = 50;
+  std::string threads = "1,2,4,8";
+  bool allPossible = false;
+  uint32_t nFailures = 0;
+
+  CommandLine cmd;
+  cmd.AddValue("size", "Grid has size x size nodes", size);
+  cmd.AddValue("origins", "Number of prefixes, each produced by a random node", nOrigins);
+  cmd.AddValue("threads", "Comma-separated numbers of threads to measure", threads);
+  cmd.AddValue("all", "Use CalculateAllPossibleRoutes instead of CalculateRoutes", allPossible);
+  cmd.AddValue("failures", "Number of links to fail and bring up again", nFailures);
+  cmd.Parse(argc, argv);
+
+  PointToPointHelper p2p;
+  PointToPointGridHelper grid(size, size, p2p);
+  grid.BoundingBox(100, 100, 200, 200);
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndnGlobalRoutingHelper.InstallAll();
+
+  NodeContainer nodes = NodeContainer::GetGlobal();
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable>();
+  for (uint32_t i = 0; i < nOrigins; i++) {
+    Ptr<Node> node = nodes.Get(random->GetInteger(0, nodes.GetN() - 1));
+    ndnGlobalRoutingHelper.AddOrigin("/origin" + std::to_string(i), node);
+  }
+
+  std::vector<std::pair<Ptr<Node>, Ptr<Node>>> links;
+  for (uint32_t row = 0; row < size; row++) {
+    for (uint32_t col = 0; col < size; col++) {
+      if (col + 1 < size) {
+        links.push_back(std::make_pair(grid.GetNode(row, col), grid.GetNode(row, col + 1)));
+      }
+      if (row + 1 < size) {
+        links.push_back(std::make_pair(grid.GetNode(row, col), grid.GetNode(row + 1, col)));
+      }
+    }
+  }
+
+  std::vector<std::pair<Ptr<Node>, Ptr<Node>>> failures;
+  for (uint32_t i = 0; i < nFailures && !links.empty(); i++) {
+    uint32_t link = random->GetInteger(0, links.size() - 1);
+    failures.push_back(links[link]);
+    links.erase(links.begin() + link);
+  }
+
+  ndn::GlobalRoutingHelper::SetIncrementalUpdates(!failures.empty());
+
+  std::cout << "nodes,origins,threads,setupSeconds,failures,updateSeconds" << std::endl;
+
+  std::istringstream threadList(threads);
+  std::string nThreads;
+  while (std::getline(threadList, nThreads, ',')) {
+    ndn::GlobalRoutingHelper::SetCalculationThreads(std::stoul(nThreads));
+
+    auto start = std::chrono::steady_clock::now();
+    if (allPossible) {
+      ndn::GlobalRoutingHelper::CalculateAllPossibleRoutes();
+    }
+    else {
+      ndn::GlobalRoutingHelper::CalculateRoutes();
+    }
+    std::chrono::duration<double> setup = std::chrono::steady_clock::now() - start;
+
+    // let FIB management process the route commands
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+
+    std::chrono::duration<double> update(0);
+    for (size_t i = 0; i < 2 * failures.size(); i++) {
+      start = std::chrono::steady_clock::now();
+      if (i < failures.size()) {
+        ndn::GlobalRoutingHelper::FailLink(failures[i].first, failures[i].second);
+      }
+      else {
+        const auto& link = failures[2 * failures.size() - 1 - i];
+        ndn::GlobalRoutingHelper::UpLink(link.first, link.second);
+      }
+      update += std::chrono::steady_clock::now() - start;
+
+      Simulator::Stop(Seconds(1));
+      Simulator::Run();
+    }
+
+    std::cout << nodes.GetN() << "," << nOrigins << "," << nThreads << "," << setup.count() << ","
+              << failures.size() << ","
+              << (failures.empty() ? 0 : update.count() / (2 * failures.size())) << std::endl;
+  }
+
+  Simulator::Destroy();
+
+  return 0;
+}
+
+} // namespace ns3
+
+int
+main(int argc, char* argv[])
+{
+  return ns3::main(argc, argv);
+}
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ndn-chord-routing-helper.hpp"
+
+#include "model/ndn-l3-protocol.hpp"
+#include "model/ndn-chord-router.hpp"
+#include "model/ndn-chord-strategy.hpp"
+#include "helper/ndn-strategy-choice-helper.hpp"
+#include "helper/ndn-network-region-table-helper.hpp"
+
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/application.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <deque>
+#include <set>
+
+NS_LOG_COMPONENT_DEFINE("ndn.ChordRoutingHelper");
+
+namespace ns3 {
+namespace ndn {
+
+ChordRoutingHelper::ChordRoutingHelper()
+  : m_joinInterval(MilliSeconds(100))
+  , m_hasBootstrap(false)
+{
+  m_agentFactory.SetTypeId("ns3::ndn::ChordAgent");
+}
+
+void
+ChordRoutingHelper::SetJoinInterval(Time interval)
+{
+  m_joinInterval = interval;
+}
+
+void
+ChordRoutingHelper::SetAgentAttribute(const std::string& name, const AttributeValue& value)
+{
+  m_agentFactory.Set(name, value);
+}
+
+ApplicationContainer
+ChordRoutingHelper::Install(const NodeContainer& nodes)
+{
+  std::set<uint32_t> pending;
+  for (NodeContainer::Iterator node = nodes.Begin(); node != nodes.End(); node++) {
+    if ((*node)->GetObject<ChordRouter>() == 0) {
+      pending.insert((*node)->GetId());
+    }
+  }
+
+  // breadth-first order over links from the first node, then unreachable nodes
+  std::vector<Ptr<Node>> order;
+  std::deque<Ptr<Node>> queue;
+  for (NodeContainer::Iterator start = nodes.Begin(); start != nodes.End(); start++) {
+    if (pending.erase((*start)->GetId()) == 0)
+      continue;
+
+    queue.push_back(*start);
+    while (!queue.empty()) {
+      Ptr<Node> node = queue.front();
+      queue.pop_front();
+      order.push_back(node);
+
+      for (uint32_t deviceId = 0; deviceId < node->GetNDevices(); deviceId++) {
+        Ptr<Channel> ch = node->GetDevice(deviceId)->GetChannel();
+        if (ch == 0)
+          continue;
+
+        for (uint32_t otherId = 0; otherId < ch->GetNDevices(); otherId++) {
+          Ptr<Node> otherNode = ch->GetDevice(otherId)->GetNode();
+          if (pending.erase(otherNode->GetId()) != 0) {
+            queue.push_back(otherNode);
+          }
+        }
+      }
+    }
+  }
+
+  ApplicationContainer agents;
+  for (const auto& node : order) {
+    NS_ASSERT_MSG(node->GetObject<L3Protocol>() != 0,
+                  "Cannot install ChordRoutingHelper before Ndn is installed on a node");
+
+    Ptr<ChordRouter> router = CreateObject<ChordRouter>();
+    Name nodeName(ChordRouter::GetPrefix());
+    router->SetRingId(ChordRouter::Hash(nodeName.appendNumber(node->GetId())));
+    node->AggregateObject(router);
+
+    Time start = m_lastJoinTime;
+    if (!m_hasBootstrap) {
+      router->SetJoined();
+      m_hasBootstrap = true;
+    }
+    else {
+      start += m_joinInterval;
+    }
+    m_lastJoinTime = start;
+
+    NS_LOG_DEBUG("Node " << node->GetId() << " ring identifier " << router->GetRingId()
+                         << " starts at " << start.GetSeconds() << "s");
+
+    NetworkRegionTableHelper::AddRegionName(node, ChordRouter::GetNodeName(router->GetRingId()));
+    StrategyChoiceHelper::Install(node, "/", nfd::fw::ChordStrategy::getStrategyName());
+
+    Ptr<Application> agent = m_agentFactory.Create<Application>();
+    node->AddApplication(agent);
+    agent->SetStartTime(start);
+    agents.Add(agent);
+  }
+
+  return agents;
+}
+
+ApplicationContainer
+ChordRoutingHelper::InstallAll()
+{
+  return Install(NodeContainer::GetGlobal());
+}
+
+Time
+ChordRoutingHelper::GetLastJoinTime() const
+{
+  return m_lastJoinTime;
+}
+
+void
+ChordRoutingHelper::AddOrigin(const std::string& prefix, Ptr<Node> node)
+{
+  Ptr<ChordRouter> router = node->GetObject<ChordRouter>();
+  NS_ASSERT_MSG(router != 0, "ChordRouter is not installed on the node");
+
+  router->AddLocalPrefix(make_shared<Name>(prefix));
+}
+
+void
+ChordRoutingHelper::AddOrigins(const std::string& prefix, const NodeContainer& nodes)
+{
+  for (NodeContainer::Iterator node = nodes.Begin(); node != nodes.End(); node++) {
+    AddOrigin(prefix, *node);
+  }
+}
+
+} // namespace ndn
+} // namespace ns3
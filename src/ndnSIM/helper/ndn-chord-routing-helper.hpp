@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CHORD_ROUTING_HELPER_H
+#define NDN_CHORD_ROUTING_HELPER_H
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/application-container.h"
+
+namespace ns3 {
+
+class Node;
+class NodeContainer;
+
+namespace ndn {
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Helper to route Interests over a Chord ring (nfd::fw::ChordStrategy) instead of FIB
+ *        entries computed by GlobalRoutingHelper
+ *
+ * Installs on each node a ChordRouter (identifier is the hash of the node ID), a ChordAgent
+ * maintaining it, network region /chord/node/<id> and ChordStrategy for "/".  The first node
+ * installed bootstraps the ring; the agents of the other nodes start one after another in
+ * breadth-first order of the topology from it, so each joins through an already joined neighbour.
+ *
+ * Producers' prefixes are announced with AddOrigin, like with GlobalRoutingHelper, but each node
+ * only keeps state for its ring neighbours, fingers and the keys it precedes.
+ */
+class ChordRoutingHelper {
+public:
+  ChordRoutingHelper();
+
+  /**
+   * @brief Set the time between the starts of consecutive agents
+   */
+  void
+  SetJoinInterval(Time interval);
+
+  /**
+   * @brief Set attribute of the ChordAgent applications created by Install
+   */
+  void
+  SetAgentAttribute(const std::string& name, const AttributeValue& value);
+
+  /**
+   * @brief Install Chord routing on nodes
+   *
+   * NDN stack must be installed on the nodes.  Nodes of previous Install calls are not revisited,
+   * the first node of the first call bootstraps the ring.
+   *
+   * @returns ChordAgent applications
+   */
+  ApplicationContainer
+  Install(const NodeContainer& nodes);
+
+  /**
+   * @brief Install Chord routing on all nodes
+   */
+  ApplicationContainer
+  InstallAll();
+
+  /**
+   * @brief Get time the agent of the last installed node starts
+   */
+  Time
+  GetLastJoinTime() const;
+
+  /**
+   * @brief Add `prefix' as origin on `node'
+   * @param prefix Prefix that is originated by node, e.g., node is a producer for this prefix
+   * @param node   Pointer to a node
+   *
+   * Prefix must have at least ChordRouter::PrefixComponents components.
+   */
+  void
+  AddOrigin(const std::string& prefix, Ptr<Node> node);
+
+  /**
+   * @brief Add `prefix' as origin on all `nodes'
+   * @param prefix Prefix that is originated by nodes
+   * @param nodes NodeContainer
+   */
+  void
+  AddOrigins(const std::string& prefix, const NodeContainer& nodes);
+
+private:
+  ObjectFactory m_agentFactory;
+  Time m_joinInterval;
+  Time m_lastJoinTime;
+  bool m_hasBootstrap;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CHORD_ROUTING_HELPER_H
@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ndn-global-routing-graph.hpp"
+
+#include "model/ndn-net-device-transport.hpp"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/assert.h"
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <boost/property_map/function_property_map.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+
+namespace ns3 {
+namespace ndn {
+
+// same as the cost of boost::WeightInf
+const uint32_t GlobalRoutingGraph::INFINITE_COST = std::numeric_limits<uint16_t>::max();
+
+// value std::numeric_limits<uint16_t>::max() MUST NOT be used (reserved)
+const uint32_t GlobalRoutingGraph::DISABLED_METRIC = std::numeric_limits<uint16_t>::max() - 1;
+
+static const uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Dijkstra visitor that records the parent edge and the first edge of the path to each
+ *        vertex
+ *
+ * The first edge is inherited when an edge is relaxed, as the face of the distance tuple
+ * of boost::NdnGlobalRouterGraph is.
+ */
+class TreeRecorder
+{
+public:
+  typedef boost::on_edge_relaxed event_filter;
+
+  explicit
+  TreeRecorder(GlobalRoutingGraph::ShortestPathTree& tree)
+    : m_tree(tree)
+  {
+  }
+
+  void
+  operator()(const GlobalRoutingGraph::Edge& e, const GlobalRoutingGraph::Graph& graph)
+  {
+    GlobalRoutingGraph::Vertex u = boost::source(e, graph);
+    GlobalRoutingGraph::Vertex v = boost::target(e, graph);
+    uint32_t edge = boost::get(boost::edge_index, graph, e);
+    m_tree.parentEdges[v] = edge;
+    m_tree.firstEdges[v] = u == m_tree.source ? edge : m_tree.firstEdges[u];
+  }
+
+private:
+  GlobalRoutingGraph::ShortestPathTree& m_tree;
+};
+
+GlobalRoutingGraph::GlobalRoutingGraph()
+{
+  for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); node++) {
+    Ptr<GlobalRouter> gr = (*node)->GetObject<GlobalRouter>();
+    if (gr != 0) {
+      m_routers.push_back(gr);
+      m_nodes.push_back(*node);
+    }
+  }
+
+  for (ChannelList::Iterator channel = ChannelList::Begin(); channel != ChannelList::End();
+       channel++) {
+    Ptr<GlobalRouter> gr = (*channel)->GetObject<GlobalRouter>();
+    if (gr != 0) {
+      m_routers.push_back(gr);
+    }
+  }
+
+  std::unordered_map<const GlobalRouter*, Vertex> vertices;
+  for (Vertex vertex = 0; vertex < m_routers.size(); vertex++) {
+    vertices[PeekPointer(m_routers[vertex])] = vertex;
+  }
+
+  for (Vertex vertex = 0; vertex < m_routers.size(); vertex++) {
+    for (const auto& incidency : m_routers[vertex]->GetIncidencies()) {
+      auto target = vertices.find(PeekPointer(std::get<2>(incidency)));
+      NS_ASSERT(target != vertices.end());
+
+      const shared_ptr<Face>& face = std::get<1>(incidency);
+      m_edges.push_back(std::make_pair(vertex, target->second));
+      m_faces.push_back(face);
+      m_metrics.push_back(face == nullptr ? 0 : static_cast<uint16_t>(face->getMetric()));
+    }
+
+    if (!m_routers[vertex]->GetLocalPrefixes().empty()) {
+      m_origins.push_back(vertex);
+    }
+  }
+
+  m_graph = Graph(boost::edges_are_sorted, m_edges.begin(), m_edges.end(), m_routers.size());
+  m_isEnabled.assign(m_edges.size(), true);
+
+  m_inEdgeOffsets.assign(m_routers.size() + 1, 0);
+  for (const auto& edge : m_edges) {
+    m_inEdgeOffsets[edge.second + 1]++;
+  }
+  std::partial_sum(m_inEdgeOffsets.begin(), m_inEdgeOffsets.end(), m_inEdgeOffsets.begin());
+  m_inEdges.resize(m_edges.size());
+  std::vector<uint32_t> inEdgeEnds(m_inEdgeOffsets.begin(), m_inEdgeOffsets.end() - 1);
+  for (uint32_t edge = 0; edge < m_edges.size(); edge++) {
+    m_inEdges[inEdgeEnds[m_edges[edge].second]++] = edge;
+  }
+
+  std::sort(m_origins.begin(), m_origins.end(), [this] (Vertex a, Vertex b) {
+      return PeekPointer(m_routers[a]) < PeekPointer(m_routers[b]);
+    });
+}
+
+uint32_t
+GlobalRoutingGraph::GetMetric(const ShortestPathTree& tree, uint32_t edge) const
+{
+  if (!m_isEnabled[edge]) {
+    return INFINITE_COST;
+  }
+  if (tree.enabledFace != nullptr && m_edges[edge].first == tree.source &&
+      m_faces[edge].get() != tree.enabledFace) {
+    return DISABLED_METRIC;
+  }
+  return m_metrics[edge];
+}
+
+void
+GlobalRoutingGraph::ComputeRoutes(Vertex source, const Face* enabledFace,
+                                  std::vector<Route>& routes) const
+{
+  ShortestPathTree tree;
+  ComputeTree(source, enabledFace, tree);
+  GetRoutes(tree, routes);
+}
+
+void
+GlobalRoutingGraph::ComputeTree(Vertex source, const Face* enabledFace,
+                                ShortestPathTree& tree) const
+{
+  tree.source = source;
+  tree.enabledFace = enabledFace;
+  tree.distances.resize(m_routers.size());
+  tree.parentEdges.assign(m_routers.size(), NO_EDGE);
+  tree.firstEdges.assign(m_routers.size(), NO_EDGE);
+
+  auto weights = boost::make_function_property_map<Edge, uint32_t>([&] (const Edge& e) {
+      return GetMetric(tree, boost::get(boost::edge_index, m_graph, e));
+    });
+
+  // paths that cost INFINITE_COST or more are never relaxed, so distances fit in uint16_t
+  boost::dijkstra_shortest_paths(m_graph, source,
+                                 boost::weight_map(weights)
+                                   .distance_map(boost::make_iterator_property_map(
+                                     tree.distances.begin(),
+                                     boost::get(boost::vertex_index, m_graph)))
+                                   .distance_inf(INFINITE_COST)
+                                   .distance_compare(std::less<uint32_t>())
+                                   .distance_combine(std::plus<uint32_t>())
+                                   .visitor(boost::make_dijkstra_visitor(TreeRecorder(tree))));
+}
+
+void
+GlobalRoutingGraph::GetRoutes(const ShortestPathTree& tree, std::vector<Route>& routes) const
+{
+  routes.clear();
+  for (Vertex origin : m_origins) {
+    uint32_t edge = tree.firstEdges[origin];
+    if (origin == tree.source || edge == NO_EDGE) {
+      continue;
+    }
+    if (tree.enabledFace != nullptr && GetMetric(tree, edge) == DISABLED_METRIC) {
+      continue;
+    }
+    routes.push_back({origin, edge, tree.distances[origin]});
+  }
+}
+
+std::vector<uint32_t>
+GlobalRoutingGraph::FindLinkEdges(Ptr<Node> node1, Ptr<Node> node2) const
+{
+  auto vertex1 = std::find(m_nodes.begin(), m_nodes.end(), node1);
+  auto vertex2 = std::find(m_nodes.begin(), m_nodes.end(), node2);
+  if (vertex1 == m_nodes.end() || vertex2 == m_nodes.end()) {
+    return {};
+  }
+
+  auto findEdge = [this] (Vertex from, Vertex to, Ptr<Channel> channel) {
+    for (const auto& e : boost::make_iterator_range(boost::out_edges(from, m_graph))) {
+      uint32_t edge = boost::get(boost::edge_index, m_graph, e);
+      if (boost::target(e, m_graph) != to) {
+        continue;
+      }
+      auto transport = dynamic_cast<NetDeviceTransport*>(m_faces[edge]->getTransport());
+      if (channel == nullptr || transport->GetNetDevice()->GetChannel() == channel) {
+        return edge;
+      }
+    }
+    return NO_EDGE;
+  };
+
+  std::vector<uint32_t> edges;
+  uint32_t edge = findEdge(vertex1 - m_nodes.begin(), vertex2 - m_nodes.begin(), nullptr);
+  if (edge != NO_EDGE) {
+    edges.push_back(edge);
+
+    auto transport = dynamic_cast<NetDeviceTransport*>(m_faces[edge]->getTransport());
+    edge = findEdge(vertex2 - m_nodes.begin(), vertex1 - m_nodes.begin(),
+                    transport->GetNetDevice()->GetChannel());
+    if (edge != NO_EDGE) {
+      edges.push_back(edge);
+    }
+  }
+  return edges;
+}
+
+uint32_t
+GlobalRoutingGraph::FindEdge(const Face* face) const
+{
+  for (uint32_t edge = 0; edge < m_faces.size(); edge++) {
+    if (m_faces[edge].get() == face) {
+      return edge;
+    }
+  }
+  return m_faces.size();
+}
+
+bool
+GlobalRoutingGraph::IsTreeAffected(uint32_t edge, const ShortestPathTree& tree) const
+{
+  Vertex from = m_edges[edge].first;
+  Vertex to = m_edges[edge].second;
+
+  if (!m_isEnabled[edge]) {
+    return tree.parentEdges[to] == edge;
+  }
+  return tree.distances[from] + GetMetric(tree, edge) < tree.distances[to];
+}
+
+void
+GlobalRoutingGraph::SetParent(ShortestPathTree& tree, Vertex vertex, uint32_t edge,
+                              uint32_t distance) const
+{
+  Vertex parent = m_edges[edge].first;
+  tree.distances[vertex] = distance;
+  tree.parentEdges[vertex] = edge;
+  tree.firstEdges[vertex] = parent == tree.source ? edge : tree.firstEdges[parent];
+}
+
+template<class Queue>
+void
+GlobalRoutingGraph::PropagateDistances(ShortestPathTree& tree, Queue& queue) const
+{
+  while (!queue.empty()) {
+    uint32_t distance = queue.top().first;
+    Vertex vertex = queue.top().second;
+    queue.pop();
+    if (distance != tree.distances[vertex]) {
+      continue; // outdated
+    }
+
+    for (const auto& e : boost::make_iterator_range(boost::out_edges(vertex, m_graph))) {
+      uint32_t edge = boost::get(boost::edge_index, m_graph, e);
+      Vertex target = boost::target(e, m_graph);
+      uint32_t targetDistance = distance + GetMetric(tree, edge);
+      if (targetDistance < tree.distances[target]) {
+        SetParent(tree, target, edge, targetDistance);
+        queue.push(std::make_pair(targetDistance, target));
+      }
+    }
+  }
+}
+
+void
+GlobalRoutingGraph::UpdateTree(uint32_t edge, ShortestPathTree& tree) const
+{
+  if (!IsTreeAffected(edge, tree)) {
+    return;
+  }
+
+  typedef std::pair<uint32_t, Vertex> QueueItem;
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+  if (m_isEnabled[edge]) {
+    Vertex to = m_edges[edge].second;
+    uint32_t distance = tree.distances[m_edges[edge].first] + GetMetric(tree, edge);
+    SetParent(tree, to, edge, distance);
+    queue.push(std::make_pair(distance, to));
+    PropagateDistances(tree, queue);
+    return;
+  }
+
+  // paths to the detached subtree are the only ones that can become longer
+  std::vector<Vertex> subtree{m_edges[edge].second};
+  for (size_t i = 0; i < subtree.size(); i++) {
+    for (const auto& e : boost::make_iterator_range(boost::out_edges(subtree[i], m_graph))) {
+      Vertex target = boost::target(e, m_graph);
+      if (tree.parentEdges[target] == boost::get(boost::edge_index, m_graph, e)) {
+        subtree.push_back(target);
+      }
+    }
+  }
+
+  for (Vertex vertex : subtree) {
+    tree.distances[vertex] = INFINITE_COST;
+    tree.parentEdges[vertex] = NO_EDGE;
+    tree.firstEdges[vertex] = NO_EDGE;
+  }
+
+  // reattach the subtree through its best edges from the rest of the tree, whose distances
+  // did not change
+  std::vector<std::pair<uint32_t, uint32_t>> attachments; // distance and edge
+  attachments.reserve(subtree.size());
+  for (Vertex vertex : subtree) {
+    std::pair<uint32_t, uint32_t> best(INFINITE_COST, NO_EDGE);
+    for (uint32_t i = m_inEdgeOffsets[vertex]; i < m_inEdgeOffsets[vertex + 1]; i++) {
+      uint32_t inEdge = m_inEdges[i];
+      uint32_t distance = tree.distances[m_edges[inEdge].first] + GetMetric(tree, inEdge);
+      if (distance < best.first) {
+        best = std::make_pair(distance, inEdge);
+      }
+    }
+    attachments.push_back(best);
+  }
+
+  for (size_t i = 0; i < subtree.size(); i++) {
+    if (attachments[i].second != NO_EDGE) {
+      SetParent(tree, subtree[i], attachments[i].second, attachments[i].first);
+      queue.push(std::make_pair(attachments[i].first, subtree[i]));
+    }
+  }
+  PropagateDistances(tree, queue);
+}
+
+} // namespace ndn
+} // namespace ns3
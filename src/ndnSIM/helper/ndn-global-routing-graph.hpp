@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_GLOBAL_ROUTING_GRAPH_H
+#define NDN_GLOBAL_ROUTING_GRAPH_H
+
+/// @cond include_hidden
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+#include "ns3/ndnSIM/model/ndn-global-router.hpp"
+
+#include "ns3/ptr.h"
+
+#include <boost/graph/compressed_sparse_row_graph.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+namespace ndn {
+
+/**
+ * @brief Snapshot of GlobalRouter incidencies as a compressed sparse row graph
+ *
+ * Vertices are GlobalRouters of nodes (in NodeList order), followed by GlobalRouters of
+ * channels.  Out-edges keep the order of GlobalRouter::GetIncidencies, as in
+ * boost::NdnGlobalRouterGraph, so that shortest paths break ties the same way.
+ *
+ * Face metrics are copied when the snapshot is taken.  ComputeRoutes and ComputeTree do not
+ * modify the snapshot nor touch ns-3 objects, so they can run on several threads at once.
+ *
+ * Edges can be disabled (e.g., when a link fails) and enabled again.  Shortest path trees kept
+ * from ComputeTree are then repaired with UpdateTree, which only visits vertices whose paths
+ * change, instead of being calculated again.
+ */
+class GlobalRoutingGraph : boost::noncopyable
+{
+public:
+  typedef boost::compressed_sparse_row_graph<boost::directedS, boost::no_property,
+                                             boost::no_property, boost::no_property,
+                                             uint32_t, uint32_t> Graph;
+  typedef boost::graph_traits<Graph>::vertex_descriptor Vertex;
+  typedef boost::graph_traits<Graph>::edge_descriptor Edge;
+
+  /**
+   * @brief Shortest path from a source to a vertex that has local prefixes
+   */
+  struct Route
+  {
+    Vertex origin;
+    uint32_t edge; ///< index of the first edge of the path
+    uint32_t cost;
+  };
+
+  /**
+   * @brief Shortest path tree from a node, about 10 bytes per vertex
+   */
+  struct ShortestPathTree
+  {
+    Vertex source;
+    const Face* enabledFace;         ///< see ComputeRoutes
+    std::vector<uint16_t> distances; ///< INFINITE_COST if the vertex is not reachable
+    std::vector<uint32_t> parentEdges;
+    std::vector<uint32_t> firstEdges;
+  };
+
+  /**
+   * @brief Paths that cost this much are not found
+   */
+  static const uint32_t INFINITE_COST;
+
+  /**
+   * @brief Metric of faces disabled while calculating routes via another face
+   */
+  static const uint32_t DISABLED_METRIC;
+
+  /**
+   * @brief Take a snapshot of GlobalRouters installed on nodes and channels
+   */
+  GlobalRoutingGraph();
+
+  size_t
+  GetNVertices() const
+  {
+    return m_routers.size();
+  }
+
+  /**
+   * @brief Number of vertices that are nodes, they come first
+   */
+  size_t
+  GetNNodes() const
+  {
+    return m_nodes.size();
+  }
+
+  Ptr<GlobalRouter>
+  GetRouter(Vertex vertex) const
+  {
+    return m_routers[vertex];
+  }
+
+  Ptr<Node>
+  GetNode(Vertex vertex) const
+  {
+    return m_nodes[vertex];
+  }
+
+  const shared_ptr<Face>&
+  GetFace(uint32_t edge) const
+  {
+    return m_faces[edge];
+  }
+
+  /**
+   * @brief Calculate shortest paths from @p source to vertices that have local prefixes
+   * @param source      vertex of a node
+   * @param enabledFace if not nullptr, other faces of @p source have DISABLED_METRIC, and
+   *                    routes via them are omitted
+   * @param[out] routes routes to reachable vertices other than @p source, in the order the
+   *                    former std::map keyed by GlobalRouter pointer used to install them
+   */
+  void
+  ComputeRoutes(Vertex source, const Face* enabledFace, std::vector<Route>& routes) const;
+
+  /**
+   * @brief Calculate shortest path tree from @p source
+   * @param enabledFace see ComputeRoutes
+   */
+  void
+  ComputeTree(Vertex source, const Face* enabledFace, ShortestPathTree& tree) const;
+
+  /**
+   * @brief Get routes of a tree, same as ComputeRoutes would calculate
+   */
+  void
+  GetRoutes(const ShortestPathTree& tree, std::vector<Route>& routes) const;
+
+  /**
+   * @brief Find edges of the point-to-point link between two nodes, in both directions
+   *
+   * If nodes are connected with several links, the first one of @p node1 is used, as in
+   * LinkControlHelper.
+   */
+  std::vector<uint32_t>
+  FindLinkEdges(Ptr<Node> node1, Ptr<Node> node2) const;
+
+  /**
+   * @return index of the edge from @p face, or GetNEdges() if there is none
+   */
+  uint32_t
+  FindEdge(const Face* face) const;
+
+  size_t
+  GetNEdges() const
+  {
+    return m_edges.size();
+  }
+
+  bool
+  IsEdgeEnabled(uint32_t edge) const
+  {
+    return m_isEnabled[edge];
+  }
+
+  /**
+   * @brief Enable or disable an edge
+   *
+   * Kept trees that IsTreeAffected by the change must be repaired with UpdateTree before
+   * another edge is changed.
+   */
+  void
+  SetEdgeEnabled(uint32_t edge, bool isEnabled)
+  {
+    m_isEnabled[edge] = isEnabled;
+  }
+
+  /**
+   * @brief Check whether shortest paths of @p tree change after @p edge was enabled or disabled
+   */
+  bool
+  IsTreeAffected(uint32_t edge, const ShortestPathTree& tree) const;
+
+  /**
+   * @brief Repair @p tree after @p edge was enabled or disabled
+   *
+   * When the edge is disabled, the subtree below it is detached and reattached from the rest
+   * of the tree.  When the edge is enabled, shortened paths are propagated from its target.
+   * In both cases Dijkstra runs only over vertices whose paths change.
+   */
+  void
+  UpdateTree(uint32_t edge, ShortestPathTree& tree) const;
+
+private:
+  uint32_t
+  GetMetric(const ShortestPathTree& tree, uint32_t edge) const;
+
+  void
+  SetParent(ShortestPathTree& tree, Vertex vertex, uint32_t edge, uint32_t distance) const;
+
+  /**
+   * @brief Continue Dijkstra from vertices in @p queue, relaxing edges of the current tree
+   */
+  template<class Queue>
+  void
+  PropagateDistances(ShortestPathTree& tree, Queue& queue) const;
+
+private:
+  std::vector<Ptr<GlobalRouter>> m_routers;
+  std::vector<Ptr<Node>> m_nodes;
+  std::vector<shared_ptr<Face>> m_faces; ///< by edge index, nullptr from a channel
+  std::vector<uint32_t> m_metrics;       ///< by edge index, 0 from a channel
+  std::vector<Vertex> m_origins;         ///< vertices that have local prefixes
+  std::vector<std::pair<Vertex, Vertex>> m_edges; ///< source and target, by edge index
+  std::vector<bool> m_isEnabled;                 ///< by edge index
+  std::vector<uint32_t> m_inEdgeOffsets;         ///< by vertex, into m_inEdges
+  std::vector<uint32_t> m_inEdges;               ///< edge indices, grouped by target
+  Graph m_graph;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+/// @endcond
+
+#endif // NDN_GLOBAL_ROUTING_GRAPH_H
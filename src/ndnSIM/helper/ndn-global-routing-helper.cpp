@@ -29,6 +29,7 @@
 #include "helper/ndn-fib-helper.hpp"
 #include "model/ndn-net-device-transport.hpp"
 #include "model/ndn-global-router.hpp"
+#include "helper/ndn-global-routing-graph.hpp"
 
 #include "daemon/table/fib.hpp"
 #include "daemon/fw/forwarder.hpp"
@@ -49,12 +50,11 @@
 
 #include <boost/lexical_cast.hpp>
 #include <boost/foreach.hpp>
-#include <boost/concept/assert.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
 
-#include <unordered_map>
-
-#include "boost-graph-ndn-global-routing-helper.hpp"
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
 
 #include <math.h>
 
@@ -214,176 +214,412 @@ GlobalRoutingHelper::AddOriginsForAll()
   }
 }
 
-void
-GlobalRoutingHelper::CalculateRoutes()
+static uint32_t g_nCalculationThreads = 0;
+static bool g_isIncremental = false;
+
+/**
+ * @brief Shortest path tree to calculate from a node
+ */
+struct RouteCalculation
 {
-  /**
-   * Implementation of route calculation is heavily based on Boost Graph Library
-   * See http://www.boost.org/doc/libs/1_49_0/libs/graph/doc/table_of_contents.html for more details
-   */
+  GlobalRoutingGraph::Vertex source;
+  const Face* enabledFace; ///< see GlobalRoutingGraph::ComputeRoutes
+};
 
-  BOOST_CONCEPT_ASSERT((boost::VertexListGraphConcept<boost::NdnGlobalRouterGraph>));
-  BOOST_CONCEPT_ASSERT((boost::IncidenceGraphConcept<boost::NdnGlobalRouterGraph>));
+/**
+ * @brief Snapshot and shortest path trees that installed routes come from
+ *
+ * Trees are in the order of their calculations, so trees of a node are adjacent.
+ */
+struct KeptRoutes
+{
+  std::unique_ptr<GlobalRoutingGraph> graph;
+  std::vector<GlobalRoutingGraph::ShortestPathTree> trees;
+};
 
-  boost::NdnGlobalRouterGraph graph;
-  // typedef graph_traits < NdnGlobalRouterGraph >::vertex_descriptor vertex_descriptor;
+static KeptRoutes g_keptRoutes;
 
-  // For now we doing Dijkstra for every node.  Can be replaced with Bellman-Ford or Floyd-Warshall.
-  // Other algorithms should be faster, but they need additional EdgeListGraph concept provided by
-  // the graph, which
-  // is not obviously how implement in an efficient manner
-  for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); node++) {
-    Ptr<GlobalRouter> source = (*node)->GetObject<GlobalRouter>();
-    if (source == 0) {
-      NS_LOG_DEBUG("Node " << (*node)->GetId() << " does not export GlobalRouter interface");
-      continue;
+// faces of links failed with GlobalRoutingHelper::FailLink
+static std::set<const Face*> g_failedFaces;
+
+static void
+ClearKeptRoutes()
+{
+  g_keptRoutes.trees.clear();
+  g_keptRoutes.graph.reset();
+  g_failedFaces.clear();
+}
+
+static void
+InstallRoutes(const GlobalRoutingGraph& graph, const RouteCalculation& calculation,
+              const std::vector<GlobalRoutingGraph::Route>& routes)
+{
+  Ptr<Node> node = graph.GetNode(calculation.source);
+  NS_LOG_DEBUG("Reachability from Node: " << node->GetId() << " ("
+                                          << Names::FindName(node) << ")");
+
+  for (const auto& route : routes) {
+    const shared_ptr<Face>& face = graph.GetFace(route.edge);
+    for (const auto& prefix : graph.GetRouter(route.origin)->GetLocalPrefixes()) {
+      NS_LOG_DEBUG(" prefix " << *prefix << " reachable via face " << *face
+                   << " with distance " << route.cost);
+
+      FibHelper::AddRoute(node, *prefix, face, route.cost);
     }
+  }
+}
 
-    boost::DistancesMap distances;
+/**
+ * @brief Calculate shortest path trees on worker threads, and install their routes in order
+ *
+ * Calculations are done in batches.  Worker threads calculate the next batch while the
+ * calling thread installs routes of the current one, as only the latter touches ns-3 objects.
+ */
+static void
+CalculateAndInstallRoutes(std::unique_ptr<GlobalRoutingGraph> graph,
+                          const std::vector<RouteCalculation>& calculations)
+{
+  for (const Face* face : g_failedFaces) {
+    uint32_t edge = graph->FindEdge(face);
+    if (edge < graph->GetNEdges()) {
+      graph->SetEdgeEnabled(edge, false);
+    }
+  }
 
-    dijkstra_shortest_paths(graph, source,
-                            // predecessor_map (boost::ref(predecessors))
-                            // .
-                            distance_map(boost::ref(distances))
-                              .distance_inf(boost::WeightInf)
-                              .distance_zero(boost::WeightZero)
-                              .distance_compare(boost::WeightCompare())
-                              .distance_combine(boost::WeightCombine()));
+  std::vector<GlobalRoutingGraph::ShortestPathTree> trees;
+  if (g_isIncremental) {
+    trees.resize(calculations.size());
+  }
+  auto calculate = [&] (size_t c, std::vector<GlobalRoutingGraph::Route>& routes) {
+    if (g_isIncremental) {
+      graph->ComputeTree(calculations[c].source, calculations[c].enabledFace, trees[c]);
+      graph->GetRoutes(trees[c], routes);
+    }
+    else {
+      graph->ComputeRoutes(calculations[c].source, calculations[c].enabledFace, routes);
+    }
+  };
 
-    // NS_LOG_DEBUG (predecessors.size () << ", " << distances.size ());
+  uint32_t nThreads = g_nCalculationThreads;
+  if (nThreads == 0) {
+    nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
 
-    Ptr<L3Protocol> L3protocol = (*node)->GetObject<L3Protocol>();
-    shared_ptr<nfd::Forwarder> forwarder = L3protocol->getForwarder();
+  if (nThreads == 1) {
+    std::vector<GlobalRoutingGraph::Route> routes;
+    for (size_t c = 0; c < calculations.size(); c++) {
+      calculate(c, routes);
+      InstallRoutes(*graph, calculations[c], routes);
+    }
+  }
+  else {
+    const size_t batchSize = 16 * nThreads;
+    std::vector<std::vector<GlobalRoutingGraph::Route>> current, next;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextCalculation(0);
+
+    auto startBatch = [&] (size_t begin) {
+      size_t end = std::min(begin + batchSize, calculations.size());
+      next.resize(end - begin);
+      nextCalculation = begin;
+      for (uint32_t i = 0; i < nThreads; i++) {
+        workers.emplace_back([&, begin, end] {
+            for (size_t c = nextCalculation++; c < end; c = nextCalculation++) {
+              calculate(c, next[c - begin]);
+            }
+          });
+      }
+    };
 
-    NS_LOG_DEBUG("Reachability from Node: " << source->GetObject<Node>()->GetId());
-    for (const auto& dist : distances) {
-      if (dist.first == source)
+    auto finishBatch = [&] {
+      for (auto& worker : workers) {
+        worker.join();
+      }
+      workers.clear();
+      current.swap(next);
+    };
+
+    for (size_t begin = 0; begin < calculations.size(); begin += batchSize) {
+      if (begin == 0) {
+        startBatch(begin);
+      }
+      finishBatch();
+      if (begin + batchSize < calculations.size()) {
+        startBatch(begin + batchSize);
+      }
+
+      for (size_t c = begin; c < std::min(begin + batchSize, calculations.size()); c++) {
+        InstallRoutes(*graph, calculations[c], current[c - begin]);
+      }
+    }
+    finishBatch();
+  }
+
+  if (g_isIncremental) {
+    g_keptRoutes.graph = std::move(graph);
+    g_keptRoutes.trees = std::move(trees);
+    Simulator::ScheduleDestroy(&ClearKeptRoutes);
+  }
+  else {
+    g_keptRoutes.trees.clear();
+    g_keptRoutes.graph.reset();
+  }
+}
+
+typedef std::map<GlobalRoutingGraph::Vertex, const GlobalRoutingGraph::Route*> RoutesByOrigin;
+
+// next hops of a prefix in the order of installation, the last cost of a face wins
+typedef std::vector<std::pair<shared_ptr<Face>, uint32_t>> NextHops;
+
+static void
+AddNextHops(const GlobalRoutingGraph& graph, const std::vector<GlobalRoutingGraph::Route>& routes,
+            const std::set<Name>& prefixes, std::map<Name, NextHops>& nextHops)
+{
+  for (const auto& route : routes) {
+    const shared_ptr<Face>& face = graph.GetFace(route.edge);
+    for (const auto& prefix : graph.GetRouter(route.origin)->GetLocalPrefixes()) {
+      if (prefixes.count(*prefix) == 0) {
         continue;
+      }
+
+      NextHops& prefixNextHops = nextHops[*prefix];
+      auto nextHop = std::find_if(prefixNextHops.begin(), prefixNextHops.end(),
+                                  [&face] (const NextHops::value_type& nh) {
+                                    return nh.first == face;
+                                  });
+      if (nextHop == prefixNextHops.end()) {
+        prefixNextHops.push_back(std::make_pair(face, route.cost));
+      }
       else {
-        // cout << "  Node " << dist.first->GetObject<Node> ()->GetId ();
-        if (std::get<0>(dist.second) == 0) {
-          // cout << " is unreachable" << endl;
-        }
-        else {
-          for (const auto& prefix : dist.first->GetLocalPrefixes()) {
-            NS_LOG_DEBUG(" prefix " << prefix << " reachable via face " << *std::get<0>(dist.second)
-                         << " with distance " << std::get<1>(dist.second) << " with delay "
-                         << std::get<2>(dist.second));
-
-            FibHelper::AddRoute(*node, *prefix, std::get<0>(dist.second),
-                                std::get<1>(dist.second));
-          }
-        }
+        nextHop->second = route.cost;
       }
     }
   }
 }
 
-void
-GlobalRoutingHelper::CalculateAllPossibleRoutes()
+/**
+ * @brief Add and remove routes of a node whose trees changed
+ * @param oldRoutes routes that trees of the node had before the change, by tree index
+ */
+static void
+UpdateInstalledRoutes(GlobalRoutingGraph::Vertex source,
+                      const std::map<size_t, std::vector<GlobalRoutingGraph::Route>>& oldRoutes)
 {
-  /**
-   * Implementation of route calculation is heavily based on Boost Graph Library
-   * See http://www.boost.org/doc/libs/1_49_0/libs/graph/doc/table_of_contents.html for more details
-   */
-
-  BOOST_CONCEPT_ASSERT((boost::VertexListGraphConcept<boost::NdnGlobalRouterGraph>));
-  BOOST_CONCEPT_ASSERT((boost::IncidenceGraphConcept<boost::NdnGlobalRouterGraph>));
+  const GlobalRoutingGraph& graph = *g_keptRoutes.graph;
+  const auto& trees = g_keptRoutes.trees;
+  Ptr<Node> node = graph.GetNode(source);
+
+  auto isFromSource = [source] (const GlobalRoutingGraph::ShortestPathTree& tree) {
+    return tree.source == source;
+  };
+  auto treesBegin = std::find_if(trees.begin(), trees.end(), isFromSource);
+  auto treesEnd = std::find_if_not(treesBegin, trees.end(), isFromSource);
+
+  std::vector<std::vector<GlobalRoutingGraph::Route>> newRoutes;
+  std::set<Name> prefixes; // prefixes whose routes changed
+  for (auto tree = treesBegin; tree != treesEnd; tree++) {
+    newRoutes.emplace_back();
+    graph.GetRoutes(*tree, newRoutes.back());
+
+    auto old = oldRoutes.find(tree - trees.begin());
+    if (old == oldRoutes.end()) {
+      continue;
+    }
 
-  boost::NdnGlobalRouterGraph graph;
-  // typedef graph_traits < NdnGlobalRouterGraph >::vertex_descriptor vertex_descriptor;
+    RoutesByOrigin oldByOrigin, newByOrigin;
+    for (const auto& route : old->second) {
+      oldByOrigin[route.origin] = &route;
+    }
+    for (const auto& route : newRoutes.back()) {
+      newByOrigin[route.origin] = &route;
+    }
 
-  // For now we doing Dijkstra for every node.  Can be replaced with Bellman-Ford or Floyd-Warshall.
-  // Other algorithms should be faster, but they need additional EdgeListGraph concept provided by
-  // the graph, which
-  // is not obviously how implement in an efficient manner
-  for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); node++) {
-    Ptr<GlobalRouter> source = (*node)->GetObject<GlobalRouter>();
-    if (source == 0) {
-      NS_LOG_DEBUG("Node " << (*node)->GetId() << " does not export GlobalRouter interface");
-      continue;
+    auto addPrefixes = [&] (GlobalRoutingGraph::Vertex origin) {
+      for (const auto& prefix : graph.GetRouter(origin)->GetLocalPrefixes()) {
+        prefixes.insert(*prefix);
+      }
+    };
+    for (const auto& route : oldByOrigin) {
+      auto newRoute = newByOrigin.find(route.first);
+      if (newRoute == newByOrigin.end() || newRoute->second->edge != route.second->edge ||
+          newRoute->second->cost != route.second->cost) {
+        addPrefixes(route.first);
+      }
     }
+    for (const auto& route : newByOrigin) {
+      if (oldByOrigin.count(route.first) == 0) {
+        addPrefixes(route.first);
+      }
+    }
+  }
 
-    Ptr<L3Protocol> L3protocol = (*node)->GetObject<L3Protocol>();
-    shared_ptr<nfd::Forwarder> forwarder = L3protocol->getForwarder();
+  if (prefixes.empty()) {
+    return;
+  }
 
-    NS_LOG_DEBUG("Reachability from Node: " << source->GetObject<Node>()->GetId() << " ("
-                                            << Names::FindName(source->GetObject<Node>()) << ")");
+  std::map<Name, NextHops> oldNextHops, newNextHops;
+  for (auto tree = treesBegin; tree != treesEnd; tree++) {
+    auto old = oldRoutes.find(tree - trees.begin());
+    AddNextHops(graph, old != oldRoutes.end() ? old->second : newRoutes[tree - treesBegin],
+                prefixes, oldNextHops);
+    AddNextHops(graph, newRoutes[tree - treesBegin], prefixes, newNextHops);
+  }
 
-    Ptr<L3Protocol> l3 = source->GetObject<L3Protocol>();
-    NS_ASSERT(l3 != 0);
+  NS_LOG_DEBUG("Updating routes of Node: " << node->GetId() << " (" << Names::FindName(node)
+                                           << ")");
+  for (const Name& prefix : prefixes) {
+    const NextHops& oldPrefixNextHops = oldNextHops[prefix];
+    const NextHops& newPrefixNextHops = newNextHops[prefix];
+
+    for (const auto& oldNextHop : oldPrefixNextHops) {
+      if (std::none_of(newPrefixNextHops.begin(), newPrefixNextHops.end(),
+                       [&oldNextHop] (const NextHops::value_type& nh) {
+                         return nh.first == oldNextHop.first;
+                       })) {
+        NS_LOG_DEBUG(" prefix " << prefix << " no longer reachable via face "
+                     << *oldNextHop.first);
+        FibHelper::RemoveRoute(node, prefix, oldNextHop.first);
+      }
+    }
 
-    // remember interface statuses
-    std::list<nfd::FaceId> faceIds;
-    std::unordered_map<nfd::FaceId, uint16_t> originalMetrics;
-    for (auto& nfdFace : l3->getForwarder()->getFaceTable()) {
-      faceIds.push_back(nfdFace.getId());
-      originalMetrics[nfdFace.getId()] = nfdFace.getMetric();
-      nfdFace.setMetric(std::numeric_limits<uint16_t>::max() - 1);
-      // value std::numeric_limits<uint16_t>::max () MUST NOT be used (reserved)
+    for (const auto& newNextHop : newPrefixNextHops) {
+      if (std::none_of(oldPrefixNextHops.begin(), oldPrefixNextHops.end(),
+                       [&newNextHop] (const NextHops::value_type& nh) {
+                         return nh == newNextHop;
+                       })) {
+        NS_LOG_DEBUG(" prefix " << prefix << " reachable via face " << *newNextHop.first
+                     << " with distance " << newNextHop.second);
+        FibHelper::AddRoute(node, prefix, newNextHop.first, newNextHop.second);
+      }
     }
+  }
+}
 
-    for (auto& faceId : faceIds) {
-      auto* face = l3->getForwarder()->getFaceTable().get(faceId);
-      NS_ASSERT(face != nullptr);
-      auto transport = dynamic_cast<NetDeviceTransport*>(face->getTransport());
-      if (transport == nullptr) {
-        NS_LOG_DEBUG("Skipping non ndnSIM-specific transport face");
+/**
+ * @brief Enable or disable edges, repair kept trees, and update routes that changed
+ */
+static void
+UpdateRoutes(const std::vector<uint32_t>& edges, bool isEnabled)
+{
+  GlobalRoutingGraph& graph = *g_keptRoutes.graph;
+  auto& trees = g_keptRoutes.trees;
+
+  // routes before the first change of each tree, which is repaired for every edge in turn
+  std::map<size_t, std::vector<GlobalRoutingGraph::Route>> oldRoutes;
+  for (uint32_t edge : edges) {
+    if (graph.IsEdgeEnabled(edge) == isEnabled) {
+      continue;
+    }
+    graph.SetEdgeEnabled(edge, isEnabled);
+
+    for (size_t t = 0; t < trees.size(); t++) {
+      if (!graph.IsTreeAffected(edge, trees[t])) {
         continue;
       }
+      if (oldRoutes.count(t) == 0) {
+        graph.GetRoutes(trees[t], oldRoutes[t]);
+      }
+      graph.UpdateTree(edge, trees[t]);
+    }
+  }
+
+  std::set<GlobalRoutingGraph::Vertex> sources;
+  for (const auto& old : oldRoutes) {
+    sources.insert(trees[old.first].source);
+  }
+  for (GlobalRoutingGraph::Vertex source : sources) {
+    UpdateInstalledRoutes(source, oldRoutes);
+  }
+}
+
+static std::vector<uint32_t>
+FindLinkEdges(Ptr<Node> node1, Ptr<Node> node2)
+{
+  if (g_keptRoutes.graph == nullptr) {
+    NS_FATAL_ERROR("Routes must be calculated with incremental updates enabled, "
+                   "see GlobalRoutingHelper::SetIncrementalUpdates");
+  }
+
+  std::vector<uint32_t> edges = g_keptRoutes.graph->FindLinkEdges(node1, node2);
+  if (edges.empty()) {
+    NS_FATAL_ERROR("There is no link between Node# " << node1->GetId() << " and Node# "
+                   << node2->GetId());
+  }
+  return edges;
+}
+
+void
+GlobalRoutingHelper::SetCalculationThreads(uint32_t nThreads)
+{
+  g_nCalculationThreads = nThreads;
+}
 
-      // enabling only faceId
-      face->setMetric(originalMetrics[faceId]);
+void
+GlobalRoutingHelper::SetIncrementalUpdates(bool isEnabled)
+{
+  g_isIncremental = isEnabled;
+}
 
-      boost::DistancesMap distances;
+void
+GlobalRoutingHelper::FailLink(Ptr<Node> node1, Ptr<Node> node2)
+{
+  NS_LOG_FUNCTION(node1->GetId() << node2->GetId());
 
-      NS_LOG_DEBUG("-----------");
+  std::vector<uint32_t> edges = FindLinkEdges(node1, node2);
+  for (uint32_t edge : edges) {
+    g_failedFaces.insert(g_keptRoutes.graph->GetFace(edge).get());
+  }
+  UpdateRoutes(edges, false);
+}
 
-      dijkstra_shortest_paths(graph, source,
-                              // predecessor_map (boost::ref(predecessors))
-                              // .
-                              distance_map(boost::ref(distances))
-                                .distance_inf(boost::WeightInf)
-                                .distance_zero(boost::WeightZero)
-                                .distance_compare(boost::WeightCompare())
-                                .distance_combine(boost::WeightCombine()));
+void
+GlobalRoutingHelper::UpLink(Ptr<Node> node1, Ptr<Node> node2)
+{
+  NS_LOG_FUNCTION(node1->GetId() << node2->GetId());
 
-      // NS_LOG_DEBUG (predecessors.size () << ", " << distances.size ());
+  std::vector<uint32_t> edges = FindLinkEdges(node1, node2);
+  for (uint32_t edge : edges) {
+    g_failedFaces.erase(g_keptRoutes.graph->GetFace(edge).get());
+  }
+  UpdateRoutes(edges, true);
+}
 
-      for (const auto& dist : distances) {
-        if (dist.first == source)
-          continue;
-        else {
-          // cout << "  Node " << dist.first->GetObject<Node> ()->GetId ();
-          if (std::get<0>(dist.second) == 0) {
-            // cout << " is unreachable" << endl;
-          }
-          else {
-            for (const auto& prefix : dist.first->GetLocalPrefixes()) {
-              NS_LOG_DEBUG(" prefix " << *prefix << " reachable via face "
-                           << *std::get<0>(dist.second)
-                           << " with distance " << std::get<1>(dist.second)
-                           << " with delay " << std::get<2>(dist.second));
-
-              if (std::get<0>(dist.second)->getMetric() == std::numeric_limits<uint16_t>::max() - 1)
-                continue;
-
-              FibHelper::AddRoute(*node, *prefix, std::get<0>(dist.second),
-                                  std::get<1>(dist.second));
-            }
-          }
-        }
-      }
+void
+GlobalRoutingHelper::CalculateRoutes()
+{
+  // For now we doing Dijkstra for every node.  Can be replaced with Bellman-Ford or Floyd-Warshall.
+  auto graph = make_unique<GlobalRoutingGraph>();
 
-      // disabling the face again
-      face->setMetric(std::numeric_limits<uint16_t>::max() - 1);
-    }
+  std::vector<RouteCalculation> calculations;
+  for (GlobalRoutingGraph::Vertex source = 0; source < graph->GetNNodes(); source++) {
+    calculations.push_back({source, nullptr});
+  }
 
-    // recover original interface statuses
-    for (auto& i : originalMetrics) {
-      l3->getForwarder()->getFaceTable().get(i.first)->setMetric(i.second);
+  CalculateAndInstallRoutes(std::move(graph), calculations);
+}
+
+void
+GlobalRoutingHelper::CalculateAllPossibleRoutes()
+{
+  // For every face of every node, Dijkstra is done with all other faces of the node disabled
+  // (they get GlobalRoutingGraph::DISABLED_METRIC), and routes via disabled faces are ignored.
+  auto graph = make_unique<GlobalRoutingGraph>();
+
+  std::vector<RouteCalculation> calculations;
+  for (GlobalRoutingGraph::Vertex source = 0; source < graph->GetNNodes(); source++) {
+    Ptr<L3Protocol> l3 = graph->GetNode(source)->GetObject<L3Protocol>();
+    NS_ASSERT(l3 != 0);
+
+    for (const auto& face : l3->getForwarder()->getFaceTable()) {
+      if (dynamic_cast<NetDeviceTransport*>(face.getTransport()) == nullptr) {
+        NS_LOG_DEBUG("Skipping non ndnSIM-specific transport face");
+        continue;
+      }
+      calculations.push_back({source, &face});
     }
   }
+
+  CalculateAndInstallRoutes(std::move(graph), calculations);
 }
 
 } // namespace ndn
@@ -111,6 +111,60 @@ public:
   static void
   CalculateAllPossibleRoutes();
 
+  /**
+   * @brief Set number of threads that calculate shortest path trees
+   *
+   * Shortest path trees from different nodes are calculated in parallel on a snapshot of the
+   * topology, while routes are installed on the calling thread in the same order regardless of
+   * the number of threads.
+   *
+   * @param nThreads number of threads, or 0 (default) to use all hardware threads
+   */
+  static void
+  SetCalculationThreads(uint32_t nThreads);
+
+  /**
+   * @brief Keep shortest path trees of calculated routes, so that FailLink and UpLink can
+   *        update routes incrementally
+   *
+   * Trees take about 10 bytes per node for every node (or every face of every node, with
+   * CalculateAllPossibleRoutes), and are kept until routes are calculated again or the
+   * simulator is destroyed.
+   *
+   * @param isEnabled whether routes calculated afterwards keep their trees (default false)
+   */
+  static void
+  SetIncrementalUpdates(bool isEnabled);
+
+  /**
+   * @brief Update routes after the link between two nodes failed
+   *
+   * Only shortest path trees that used the link are repaired, and only routes that changed
+   * are added to or removed from FIBs.  The link itself is not changed, which can be done
+   * using LinkControlHelper::FailLink.  The link is also excluded from routes calculated
+   * afterwards, until UpLink is called.
+   *
+   * Incremental updates must be enabled before routes are calculated.
+   *
+   * Note that only links over PointToPointChannels are supported by this helper method
+   *
+   * @param node1 one node
+   * @param node2 another node
+   */
+  static void
+  FailLink(Ptr<Node> node1, Ptr<Node> node2);
+
+  /**
+   * @brief Update routes after the link between two nodes was re-enabled
+   *
+   * @see FailLink
+   *
+   * @param node1 one node
+   * @param node2 another node
+   */
+  static void
+  UpLink(Ptr<Node> node1, Ptr<Node> node2);
+
 private:
   void
   Install(Ptr<Channel> channel);
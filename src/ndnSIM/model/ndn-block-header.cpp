@@ -19,16 +19,13 @@
 
 #include "ndn-block-header.hpp"
 
-#include <iosfwd>
-#include <boost/iostreams/concepts.hpp>
-#include <boost/iostreams/stream.hpp>
+#include "ns3/packet.h"
 
 #include <ndn-cxx/encoding/tlv.hpp>
 #include <ndn-cxx/interest.hpp>
 #include <ndn-cxx/data.hpp>
 #include <ndn-cxx/lp/packet.hpp>
 
-namespace io = boost::iostreams;
 namespace nfdFace = nfd::face;
 
 namespace ns3 {
@@ -61,6 +58,24 @@ BlockHeader::BlockHeader(const nfdFace::Transport::Packet& packet)
 {
 }
 
+BlockHeader::BlockHeader(nfdFace::Transport::Packet&& packet)
+  : m_block(std::move(packet.packet))
+{
+}
+
+BlockHeader::BlockHeader(const ns3::Packet& packet)
+{
+  auto buffer = make_shared<::ndn::Buffer>(packet.GetSize());
+  packet.CopyData(buffer->data(), buffer->size());
+
+  // block shares the buffer
+  bool isOk = false;
+  std::tie(isOk, m_block) = Block::fromBuffer(buffer, 0);
+  if (!isOk) {
+    BOOST_THROW_EXCEPTION(::ndn::tlv::Error("Packet does not contain a complete TLV block"));
+  }
+}
+
 uint32_t
 BlockHeader::GetSerializedSize(void) const
 {
@@ -73,37 +88,52 @@ BlockHeader::Serialize(ns3::Buffer::Iterator start) const
   start.Write(m_block.wire(), m_block.size());
 }
 
-class Ns3BufferIteratorSource : public io::source {
-public:
-  Ns3BufferIteratorSource(ns3::Buffer::Iterator& is)
-    : m_is(is)
-  {
+static uint64_t
+readVarNumber(ns3::Buffer::Iterator& i)
+{
+  if (i.IsEnd()) {
+    BOOST_THROW_EXCEPTION(::ndn::tlv::Error("Empty buffer during TLV processing"));
   }
 
-  std::streamsize
-  read(char* buf, std::streamsize nMaxRead)
-  {
-    std::streamsize i = 0;
-    for (; i < nMaxRead && !m_is.IsEnd(); ++i) {
-      buf[i] = m_is.ReadU8();
-    }
-    if (i == 0) {
-      return -1;
-    }
-    else {
-      return i;
-    }
+  uint8_t firstOctet = i.ReadU8();
+  if (firstOctet < 253) {
+    return firstOctet;
   }
 
-private:
-  ns3::Buffer::Iterator& m_is;
-};
+  uint32_t size = firstOctet == 253 ? 2 : firstOctet == 254 ? 4 : 8;
+  if (i.GetRemainingSize() < size) {
+    BOOST_THROW_EXCEPTION(::ndn::tlv::Error("Insufficient data during TLV processing"));
+  }
+  switch (size) {
+  case 2:
+    return i.ReadNtohU16();
+  case 4:
+    return i.ReadNtohU32();
+  default:
+    return i.ReadNtohU64();
+  }
+}
 
 uint32_t
 BlockHeader::Deserialize(ns3::Buffer::Iterator start)
 {
-  io::stream<Ns3BufferIteratorSource> is(start);
-  m_block = ::ndn::Block::fromStream(is);
+  // TLV-TYPE and TLV-LENGTH give the block size, then the wire is read into the block's buffer
+  // as is, without parsing it again
+  ns3::Buffer::Iterator i = start;
+  uint64_t type = readVarNumber(i);
+  if (type > std::numeric_limits<uint32_t>::max()) {
+    BOOST_THROW_EXCEPTION(::ndn::tlv::Error("TLV-TYPE number exceeds allowed maximum"));
+  }
+  uint64_t length = readVarNumber(i);
+  if (length > i.GetRemainingSize()) {
+    BOOST_THROW_EXCEPTION(::ndn::tlv::Error("Not enough bytes in packet to fully parse TLV"));
+  }
+  uint32_t tlSize = i.GetDistanceFrom(start);
+
+  auto buffer = make_shared<::ndn::Buffer>(tlSize + length);
+  start.Read(buffer->data(), buffer->size());
+  m_block = Block(buffer, static_cast<uint32_t>(type), buffer->begin(), buffer->end(),
+                  buffer->begin() + tlSize, buffer->end());
   return m_block.size();
 }
 
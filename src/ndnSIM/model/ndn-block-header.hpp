@@ -27,6 +27,9 @@
 namespace nfdFace = nfd::face;
 
 namespace ns3 {
+
+class Packet;
+
 namespace ndn {
 
 class BlockHeader : public Header {
@@ -41,6 +44,23 @@ public:
 
   BlockHeader(const nfdFace::Transport::Packet& packet);
 
+  /**
+   * @brief Take over the block of an outgoing packet, without copying its element tree
+   */
+  BlockHeader(nfdFace::Transport::Packet&& packet);
+
+  /**
+   * @brief Decode the block the packet starts with, leaving the packet untouched
+   *
+   * The wire is copied once from the packet storage into the buffer backing the block,
+   * without copying the packet or reading it through a stream.  Bytes after the block (e.g.,
+   * link layer padding) are ignored.
+   *
+   * @throw ::ndn::tlv::Error packet does not start with a complete TLV block
+   */
+  explicit
+  BlockHeader(const ns3::Packet& packet);
+
   virtual uint32_t
   GetSerializedSize(void) const;
 
@@ -0,0 +1,341 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ndn-chord-router.hpp"
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <ndn-cxx/util/sha256.hpp>
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("ndn.ChordRouter");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED(ChordRouter);
+
+TypeId
+ChordRouter::GetTypeId()
+{
+  static TypeId tid =
+    TypeId("ns3::ndn::ChordRouter")
+      .SetGroupName("Ndn")
+      .SetParent<Object>()
+      .AddConstructor<ChordRouter>()
+      .AddAttribute("MaxRoutes",
+                    "Maximum number of routes towards ring members (successor, predecessor and "
+                    "fingers are never evicted)",
+                    UintegerValue(256), MakeUintegerAccessor(&ChordRouter::m_maxRoutes),
+                    MakeUintegerChecker<uint32_t>(1))
+      .AddAttribute("PrefixComponents",
+                    "Number of leading name components hashed to the ring key of a content name",
+                    UintegerValue(1), MakeUintegerAccessor(&ChordRouter::m_prefixComponents),
+                    MakeUintegerChecker<uint32_t>(1))
+      .AddAttribute("RegistrationLifetime",
+                    "Time a content registration is kept unless refreshed by its producer",
+                    TimeValue(Seconds(30)),
+                    MakeTimeAccessor(&ChordRouter::m_registrationLifetime), MakeTimeChecker());
+  return tid;
+}
+
+ChordRouter::ChordRouter()
+  : m_ringId(0)
+  , m_joined(false)
+  , m_successor(0)
+  , m_hasPredecessor(false)
+  , m_predecessor(0)
+  , m_fingers(64, 0)
+  , m_maxRoutes(256)
+  , m_prefixComponents(1)
+{
+}
+
+uint64_t
+ChordRouter::Hash(const Name& name)
+{
+  ::ndn::util::Sha256 digest;
+  digest << name.wireEncode();
+  ::ndn::ConstBufferPtr buffer = digest.computeDigest();
+
+  uint64_t id = 0;
+  for (size_t i = 0; i < sizeof(id); i++) {
+    id = (id << 8) | (*buffer)[i];
+  }
+  return id;
+}
+
+const Name&
+ChordRouter::GetPrefix()
+{
+  static Name prefix("/chord");
+  return prefix;
+}
+
+Name
+ChordRouter::GetNodeName(uint64_t id)
+{
+  return Name(GetPrefix()).append("node").appendNumber(id);
+}
+
+bool
+ChordRouter::InInterval(uint64_t x, uint64_t from, uint64_t to)
+{
+  // unsigned arithmetic wraps around the ring
+  return x - from - 1 < to - from || from == to;
+}
+
+uint64_t
+ChordRouter::GetRingId() const
+{
+  return m_ringId;
+}
+
+void
+ChordRouter::SetRingId(uint64_t id)
+{
+  NS_ASSERT_MSG(!m_joined, "Ring identifier cannot change after the node joined");
+  m_ringId = id;
+  m_successor = id;
+  m_fingers.assign(m_fingers.size(), id);
+}
+
+uint64_t
+ChordRouter::GetKey(const Name& name) const
+{
+  return Hash(name.getPrefix(m_prefixComponents));
+}
+
+bool
+ChordRouter::IsJoined() const
+{
+  return m_joined;
+}
+
+void
+ChordRouter::SetJoined()
+{
+  m_joined = true;
+}
+
+uint64_t
+ChordRouter::GetSuccessor() const
+{
+  return m_successor;
+}
+
+void
+ChordRouter::SetSuccessor(uint64_t id)
+{
+  m_successor = id;
+}
+
+bool
+ChordRouter::HasPredecessor() const
+{
+  return m_hasPredecessor;
+}
+
+uint64_t
+ChordRouter::GetPredecessor() const
+{
+  return m_predecessor;
+}
+
+void
+ChordRouter::SetPredecessor(uint64_t id)
+{
+  m_hasPredecessor = true;
+  m_predecessor = id;
+}
+
+void
+ChordRouter::ClearPredecessor()
+{
+  m_hasPredecessor = false;
+}
+
+void
+ChordRouter::SetFinger(uint32_t i, uint64_t id)
+{
+  NS_ASSERT(i < m_fingers.size());
+  m_fingers[i] = id;
+}
+
+bool
+ChordRouter::IsPinned(uint64_t id) const
+{
+  return id == m_successor || (m_hasPredecessor && id == m_predecessor)
+         || std::find(m_fingers.begin(), m_fingers.end(), id) != m_fingers.end();
+}
+
+void
+ChordRouter::LearnRoute(uint64_t id, nfd::FaceId face, uint64_t hops)
+{
+  if (id == m_ringId)
+    return;
+
+  auto route = m_routes.find(id);
+  if (route != m_routes.end()) {
+    if (face != route->second.face && hops >= route->second.hops) {
+      return;
+    }
+    route->second.face = face;
+    route->second.hops = hops;
+    route->second.learned = Simulator::Now();
+    return;
+  }
+
+  NS_LOG_DEBUG("Node " << m_ringId << " learned route to " << id << " via face " << face
+                       << " (" << hops << " hops)");
+  m_routes[id] = {face, hops, Simulator::Now()};
+
+  if (m_routes.size() > m_maxRoutes) {
+    auto oldest = m_routes.end();
+    for (auto i = m_routes.begin(); i != m_routes.end(); ++i) {
+      if (i->first != id && !IsPinned(i->first)
+          && (oldest == m_routes.end() || i->second.learned < oldest->second.learned)) {
+        oldest = i;
+      }
+    }
+    if (oldest != m_routes.end()) {
+      m_routes.erase(oldest);
+    }
+  }
+}
+
+void
+ChordRouter::RemoveRoute(uint64_t id)
+{
+  m_routes.erase(id);
+}
+
+const ChordRouter::Route*
+ChordRouter::FindRoute(uint64_t id) const
+{
+  auto route = m_routes.find(id);
+  if (route == m_routes.end())
+    return nullptr;
+  return &route->second;
+}
+
+const ChordRouter::RouteTable&
+ChordRouter::GetRoutes() const
+{
+  return m_routes;
+}
+
+bool
+ChordRouter::FindClosestPreceding(uint64_t key, uint64_t& id) const
+{
+  bool found = false;
+
+  if (!m_routes.empty()) {
+    // greatest identifier <= key, wrapping around to the greatest identifier on the ring
+    auto route = m_routes.upper_bound(key);
+    if (route == m_routes.begin()) {
+      route = m_routes.end();
+    }
+    --route;
+    id = route->first;
+    found = true;
+  }
+
+  if (m_joined && (!found || key - m_ringId < key - id)) {
+    id = m_ringId;
+    found = true;
+  }
+  return found;
+}
+
+bool
+ChordRouter::IsResponsible(uint64_t key) const
+{
+  return InInterval(key + 1, m_ringId, m_successor);
+}
+
+bool
+ChordRouter::FindClosestSucceeding(uint64_t& id) const
+{
+  if (m_routes.empty())
+    return false;
+
+  auto route = m_routes.upper_bound(m_ringId);
+  if (route == m_routes.end()) {
+    route = m_routes.begin();
+  }
+  id = route->first;
+  return true;
+}
+
+void
+ChordRouter::AddRegistration(uint64_t key, uint64_t producer)
+{
+  m_registrations[key] = {producer, Simulator::Now() + m_registrationLifetime};
+}
+
+bool
+ChordRouter::FindRegistration(uint64_t key, uint64_t& producer) const
+{
+  auto registration = m_registrations.find(key);
+  if (registration == m_registrations.end() || registration->second.expire < Simulator::Now())
+    return false;
+
+  producer = registration->second.producer;
+  return true;
+}
+
+size_t
+ChordRouter::GetNRegistrations() const
+{
+  return m_registrations.size();
+}
+
+void
+ChordRouter::SetResolver(const Resolver& resolver)
+{
+  m_resolver = resolver;
+}
+
+bool
+ChordRouter::Resolve(uint64_t key, const ResolveCallback& callback)
+{
+  if (!m_resolver)
+    return false;
+
+  m_resolver(key, callback);
+  return true;
+}
+
+void
+ChordRouter::AddLocalPrefix(shared_ptr<Name> prefix)
+{
+  m_localPrefixes.push_back(prefix);
+}
+
+const ChordRouter::LocalPrefixList&
+ChordRouter::GetLocalPrefixes() const
+{
+  return m_localPrefixes;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,294 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CHORD_ROUTER_H
+#define NDN_CHORD_ROUTER_H
+
+#include "ns3/ndnSIM/model/ndn-common.hpp"
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include <functional>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-helpers
+ * @brief Per-node Chord state used by nfd::fw::ChordStrategy to forward Interests without FIB
+ *
+ * Each node has a 64-bit identifier on the ring.  Instead of a FIB entry per prefix, the node
+ * keeps routes (next hop face) towards the ring members it has heard from: physical neighbours,
+ * its successor, predecessor and fingers, and members whose Chord messages travelled through the
+ * node.  Routes are learned from the reverse path of /chord Interests and Data and are only
+ * replaced by routes with a smaller hop count, so following them does not loop.
+ *
+ * /chord requests are forwarded greedily to the known member whose identifier most closely
+ * precedes the key (Chord's closest preceding finger); the member where no closer one is known is
+ * the predecessor of the key and answers requests and holds content registrations for it.  The
+ * first node of a content Interest resolves its key to the producer (Resolve), then the Interest
+ * is forwarded greedily towards the producer's identifier.
+ */
+class ChordRouter : public Object {
+public:
+  /**
+   * @brief Route towards a ring member
+   */
+  struct Route
+  {
+    nfd::FaceId face; ///< @brief Next hop face
+    uint64_t hops;    ///< @brief Hop count of the packet the route was learned from
+    Time learned;     ///< @brief Time route was last learned or refreshed
+  };
+
+  /**
+   * @brief Routes indexed by ring identifier
+   */
+  typedef std::map<uint64_t, Route> RouteTable;
+
+  /**
+   * @brief List of locally exported prefixes
+   */
+  typedef std::list<shared_ptr<Name>> LocalPrefixList;
+
+  /**
+   * @brief Receives the producer registered for a key, isFound is false if none is
+   */
+  typedef std::function<void(bool isFound, uint64_t producer)> ResolveCallback;
+
+  /**
+   * @brief Looks up the producer of a key on the ring (installed by ChordAgent)
+   */
+  typedef std::function<void(uint64_t key, const ResolveCallback& callback)> Resolver;
+
+  static TypeId
+  GetTypeId();
+
+  /**
+   * @brief Default constructor
+   */
+  ChordRouter();
+
+  /**
+   * @brief Map name to ring identifier (first 8 bytes of SHA-256 of the name's wire encoding)
+   */
+  static uint64_t
+  Hash(const Name& name);
+
+  /**
+   * @brief Namespace of Chord maintenance Interests and Data, /chord
+   */
+  static const Name&
+  GetPrefix();
+
+  /**
+   * @brief Name of a ring member, /chord/node/<id>, used as forwarding hint and network region
+   */
+  static Name
+  GetNodeName(uint64_t id);
+
+  /**
+   * @brief Check whether x lies in the ring interval (from, to]
+   *
+   * The interval covers the whole ring if from == to.
+   */
+  static bool
+  InInterval(uint64_t x, uint64_t from, uint64_t to);
+
+  /**
+   * @brief Get ring identifier of the node
+   */
+  uint64_t
+  GetRingId() const;
+
+  /**
+   * @brief Set ring identifier of the node (must be called before the node joins)
+   */
+  void
+  SetRingId(uint64_t id);
+
+  /**
+   * @brief Ring key of a content name (hash of its first PrefixComponents components)
+   */
+  uint64_t
+  GetKey(const Name& name) const;
+
+  /**
+   * @brief Whether the node is a member of the ring
+   */
+  bool
+  IsJoined() const;
+
+  /**
+   * @brief Mark the node as a member of the ring
+   */
+  void
+  SetJoined();
+
+  uint64_t
+  GetSuccessor() const;
+
+  void
+  SetSuccessor(uint64_t id);
+
+  bool
+  HasPredecessor() const;
+
+  uint64_t
+  GetPredecessor() const;
+
+  void
+  SetPredecessor(uint64_t id);
+
+  void
+  ClearPredecessor();
+
+  /**
+   * @brief Record finger i (the member preceding GetRingId () + 2^i)
+   */
+  void
+  SetFinger(uint32_t i, uint64_t id);
+
+  /**
+   * @brief Learn or refresh route towards a ring member
+   * @param id    Identifier of the member
+   * @param face  Face the member's packet came from
+   * @param hops  Hop count of the packet
+   *
+   * An existing route is replaced only by one over another face with a smaller hop count, or
+   * refreshed by one over the same face.  When the table holds more than MaxRoutes entries, the
+   * least recently learned route that is not the successor, predecessor or a finger is evicted.
+   */
+  void
+  LearnRoute(uint64_t id, nfd::FaceId face, uint64_t hops);
+
+  /**
+   * @brief Remove route towards a member (e.g., member stopped answering)
+   */
+  void
+  RemoveRoute(uint64_t id);
+
+  /**
+   * @brief Get route towards a member, nullptr if none is known
+   */
+  const Route*
+  FindRoute(uint64_t id) const;
+
+  const RouteTable&
+  GetRoutes() const;
+
+  /**
+   * @brief Find the known member most closely preceding (or equal to) key
+   * @param key      Ring key
+   * @param[out] id  Identifier of the member, GetRingId () if it is the node itself
+   * @returns false if no member is known and the node is not joined
+   *
+   * The node itself is a candidate once joined.
+   */
+  bool
+  FindClosestPreceding(uint64_t key, uint64_t& id) const;
+
+  /**
+   * @brief Check if the node is the member preceding key, i.e., key is in [GetRingId (),
+   *        GetSuccessor ())
+   */
+  bool
+  IsResponsible(uint64_t key) const;
+
+  /**
+   * @brief Find the known member most closely following the node (successor candidate)
+   * @returns false if no other member is known
+   */
+  bool
+  FindClosestSucceeding(uint64_t& id) const;
+
+  /**
+   * @brief Record that the producer member serves names with key (node precedes the key, or
+   *        caches a resolved key)
+   */
+  void
+  AddRegistration(uint64_t key, uint64_t producer);
+
+  /**
+   * @brief Find producer registered for key
+   */
+  bool
+  FindRegistration(uint64_t key, uint64_t& producer) const;
+
+  /**
+   * @brief Number of registrations held by the node
+   */
+  size_t
+  GetNRegistrations() const;
+
+  void
+  SetResolver(const Resolver& resolver);
+
+  /**
+   * @brief Look up the producer of key on the ring, callback may be invoked before returning
+   * @returns false if no resolver is installed (callback is not invoked)
+   */
+  bool
+  Resolve(uint64_t key, const ResolveCallback& callback);
+
+  /**
+   * @brief Add new locally exported prefix (registered with the ring by ChordAgent)
+   */
+  void
+  AddLocalPrefix(shared_ptr<Name> prefix);
+
+  const LocalPrefixList&
+  GetLocalPrefixes() const;
+
+private:
+  bool
+  IsPinned(uint64_t id) const;
+
+private:
+  uint64_t m_ringId;
+  bool m_joined;
+  uint64_t m_successor;
+  bool m_hasPredecessor;
+  uint64_t m_predecessor;
+  std::vector<uint64_t> m_fingers;
+
+  RouteTable m_routes;
+  uint32_t m_maxRoutes;
+
+  struct Registration
+  {
+    uint64_t producer;
+    Time expire;
+  };
+  std::map<uint64_t, Registration> m_registrations;
+  Time m_registrationLifetime;
+  Resolver m_resolver;
+
+  uint32_t m_prefixComponents;
+  LocalPrefixList m_localPrefixes;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CHORD_ROUTER_H
@@ -0,0 +1,377 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ndn-chord-strategy.hpp"
+
+#include "NFD/daemon/fw/algorithm.hpp"
+#include "core/logger.hpp"
+
+#include <ndn-cxx/lp/tags.hpp>
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+namespace nfd {
+namespace fw {
+
+NFD_REGISTER_STRATEGY(ChordStrategy);
+
+NFD_LOG_INIT("ChordStrategy");
+
+using ns3::ndn::ChordRouter;
+
+static const name::Component HELLO("hello");
+static const name::Component NODE("node");
+
+static uint64_t
+getHopCount(const ndn::TagHost& packet)
+{
+  auto hopCountTag = packet.getTag<ndn::lp::HopCountTag>();
+  if (hopCountTag == nullptr) {
+    return 1;
+  }
+  return hopCountTag->get();
+}
+
+static bool
+isChordName(const Name& name, size_t minSize)
+{
+  return name.size() >= minSize && ChordRouter::GetPrefix().isPrefixOf(name);
+}
+
+ChordStrategy::ChordStrategy(Forwarder& forwarder, const Name& name)
+  : Strategy(forwarder)
+  , ProcessNackTraits(this)
+{
+  ParsedInstanceName parsed = parseInstanceName(name);
+  if (!parsed.parameters.empty()) {
+    BOOST_THROW_EXCEPTION(std::invalid_argument("ChordStrategy does not accept parameters"));
+  }
+  if (parsed.version && *parsed.version != getStrategyName()[-1].toVersion()) {
+    BOOST_THROW_EXCEPTION(std::invalid_argument(
+      "ChordStrategy does not support version " + to_string(*parsed.version)));
+  }
+  this->setInstanceName(makeInstanceName(name, getStrategyName()));
+}
+
+const Name&
+ChordStrategy::getStrategyName()
+{
+  static Name strategyName("/localhost/nfd/strategy/chord/%FD%01");
+  return strategyName;
+}
+
+ns3::Ptr<ChordRouter>
+ChordStrategy::getRouter()
+{
+  // strategy is created by the forwarder of one node, events of that node run in its context
+  if (m_router == nullptr) {
+    uint32_t context = ns3::Simulator::GetContext();
+    if (context < ns3::NodeList::GetNNodes()) {
+      m_router = ns3::NodeList::GetNode(context)->GetObject<ChordRouter>();
+    }
+  }
+  return m_router;
+}
+
+void
+ChordStrategy::afterReceiveInterest(const Face& inFace, const Interest& interest,
+                                    const shared_ptr<pit::Entry>& pitEntry)
+{
+  if (hasPendingOutRecords(*pitEntry)) {
+    // not a new Interest, don't forward
+    return;
+  }
+
+  const Name& name = interest.getName();
+  bool isChord = isChordName(name, 5);
+
+  if (!isChord && interest.getForwardingHint().empty() &&
+      forwardToLocal(inFace, interest, pitEntry)) {
+    return;
+  }
+
+  ns3::Ptr<ChordRouter> router = getRouter();
+  if (router == nullptr) {
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " no ChordRouter");
+    noRoute(inFace, interest, pitEntry);
+    return;
+  }
+
+  uint64_t key = 0;
+  bool isHinted = false;
+  if (isChord) {
+    // /chord/<op>/<key>/<origin>/<nonce>, hello Interests carry 1 as key if origin is a member
+    bool isHello = name[1] == HELLO;
+    key = name[2].toNumber();
+    if (inFace.getScope() == ndn::nfd::FACE_SCOPE_NON_LOCAL && (!isHello || key == 1)) {
+      router->LearnRoute(name[3].toNumber(), inFace.getId(), getHopCount(interest));
+    }
+
+    if (isHello) {
+      if (inFace.getScope() == ndn::nfd::FACE_SCOPE_LOCAL) {
+        broadcast(inFace, interest, pitEntry);
+      }
+      else if (!forwardToLocal(inFace, interest, pitEntry)) {
+        noRoute(inFace, interest, pitEntry);
+      }
+      return;
+    }
+  }
+  else if (!interest.getForwardingHint().empty()) {
+    // routed towards the producer's identifier, hint naming this node is stripped by the network
+    // region table
+    const Name& hint = interest.getForwardingHint().begin()->name;
+    if (hint.size() != 3 || !ChordRouter::GetPrefix().isPrefixOf(hint) || hint[1] != NODE ||
+        hint[2].toNumber() == router->GetRingId()) {
+      noRoute(inFace, interest, pitEntry);
+      return;
+    }
+    isHinted = true;
+    key = hint[2].toNumber();
+  }
+  else {
+    resolve(router->GetKey(name), inFace, interest, pitEntry);
+    return;
+  }
+
+  // closest preceding member with a usable route, never the origin of a request (e.g., join of
+  // the origin itself)
+  uint64_t origin = isChord ? name[3].toNumber() : router->GetRingId();
+  uint64_t closest = key;
+  Face* outFace = nullptr;
+  for (size_t i = 0; i <= router->GetRoutes().size(); ++i) {
+    if (!router->FindClosestPreceding(closest, closest) || closest == router->GetRingId()) {
+      break;
+    }
+    if (closest != origin) {
+      outFace = getMemberFace(closest, inFace, interest);
+      if (outFace != nullptr) {
+        break;
+      }
+    }
+    closest--;
+  }
+
+  if (outFace != nullptr) {
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " member=" << closest
+                  << " to=" << outFace->getId());
+    this->sendInterest(pitEntry, *outFace, interest);
+    return;
+  }
+
+  if (closest != router->GetRingId()) {
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " no ring member known");
+    noRoute(inFace, interest, pitEntry);
+    return;
+  }
+
+  if (!router->IsResponsible(key) && router->GetSuccessor() != origin) {
+    // no closer member known, but the key is past the successor
+    forwardToMember(router->GetSuccessor(), inFace, interest, pitEntry);
+    return;
+  }
+
+  if (isHinted) {
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " no route to producer " << key);
+    noRoute(inFace, interest, pitEntry);
+    return;
+  }
+
+  // this node precedes the key
+  if (!forwardToLocal(inFace, interest, pitEntry)) {
+    noRoute(inFace, interest, pitEntry);
+  }
+}
+
+void
+ChordStrategy::beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry,
+                                     const Face& inFace, const Data& data)
+{
+  // /chord/<op>/<key>/<origin>/<nonce>/<responder>/<successor>[/<predecessor>]
+  const Name& name = data.getName();
+  if (!isChordName(name, 6) || inFace.getScope() == ndn::nfd::FACE_SCOPE_LOCAL) {
+    return;
+  }
+
+  ns3::Ptr<ChordRouter> router = getRouter();
+  if (router == nullptr) {
+    return;
+  }
+
+  uint64_t hops = getHopCount(data);
+  router->LearnRoute(name[5].toNumber(), inFace.getId(), hops);
+
+  // successor and predecessor of the responder are reachable through it, but their distance is
+  // unknown: only used until a route is learned from their own packets
+  for (size_t i = 6; i < name.size(); ++i) {
+    if (router->FindRoute(name[i].toNumber()) == nullptr) {
+      router->LearnRoute(name[i].toNumber(), inFace.getId(), hops + 1);
+    }
+  }
+}
+
+void
+ChordStrategy::afterReceiveNack(const Face& inFace, const lp::Nack& nack,
+                                const shared_ptr<pit::Entry>& pitEntry)
+{
+  this->processNack(inFace, nack, pitEntry);
+}
+
+bool
+ChordStrategy::forwardToLocal(const Face& inFace, const Interest& interest,
+                              const shared_ptr<pit::Entry>& pitEntry)
+{
+  const fib::Entry& fibEntry = this->lookupFib(*pitEntry);
+
+  bool isSent = false;
+  for (const auto& nexthop : fibEntry.getNextHops()) {
+    Face& outFace = nexthop.getFace();
+    if (outFace.getScope() != ndn::nfd::FACE_SCOPE_LOCAL || outFace.getId() == inFace.getId() ||
+        wouldViolateScope(inFace, interest, outFace)) {
+      continue;
+    }
+
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " local=" << outFace.getId());
+    this->sendInterest(pitEntry, outFace, interest);
+    isSent = true;
+  }
+  return isSent;
+}
+
+Face*
+ChordStrategy::getMemberFace(uint64_t id, const Face& inFace, const Interest& interest)
+{
+  const ChordRouter::Route* route = m_router->FindRoute(id);
+  Face* outFace = route == nullptr ? nullptr : this->getFace(route->face);
+  if (outFace == nullptr) {
+    m_router->RemoveRoute(id);
+    return nullptr;
+  }
+
+  if (outFace->getId() == inFace.getId() || wouldViolateScope(inFace, interest, *outFace)) {
+    return nullptr;
+  }
+  return outFace;
+}
+
+void
+ChordStrategy::forwardToMember(uint64_t id, const Face& inFace, const Interest& interest,
+                               const shared_ptr<pit::Entry>& pitEntry)
+{
+  Face* outFace = getMemberFace(id, inFace, interest);
+  if (outFace == nullptr) {
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " no route to member " << id);
+    noRoute(inFace, interest, pitEntry);
+    return;
+  }
+
+  NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " member=" << id
+                << " to=" << outFace->getId());
+  this->sendInterest(pitEntry, *outFace, interest);
+}
+
+void
+ChordStrategy::resolve(uint64_t key, const Face& inFace, const Interest& interest,
+                       const shared_ptr<pit::Entry>& pitEntry)
+{
+  // an Interest cannot return through a node it already passed, so the producer is looked up
+  // before the Interest leaves this node rather than at the member preceding the key
+  uint64_t producer = 0;
+  if (m_router->FindRegistration(key, producer)) {
+    forwardToProducer(producer, inFace, interest, pitEntry);
+    return;
+  }
+
+  NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " resolving " << key);
+  weak_ptr<pit::Entry> weakPitEntry = pitEntry;
+  FaceId inFaceId = inFace.getId();
+  bool isRequested = m_router->Resolve(key, [this, weakPitEntry, inFaceId] (bool isFound,
+                                                                             uint64_t producer) {
+    shared_ptr<pit::Entry> pitEntry = weakPitEntry.lock();
+    Face* inFace = this->getFace(inFaceId);
+    if (pitEntry == nullptr || inFace == nullptr || !pitEntry->hasInRecords() ||
+        hasPendingOutRecords(*pitEntry)) {
+      return;
+    }
+
+    if (!isFound) {
+      NFD_LOG_DEBUG(pitEntry->getInterest() << " from=" << inFaceId << " no producer registered");
+      noRoute(*inFace, pitEntry->getInterest(), pitEntry);
+      return;
+    }
+    forwardToProducer(producer, *inFace, pitEntry->getInterest(), pitEntry);
+  });
+
+  if (!isRequested) {
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " no ChordAgent");
+    noRoute(inFace, interest, pitEntry);
+  }
+}
+
+void
+ChordStrategy::forwardToProducer(uint64_t producer, const Face& inFace, const Interest& interest,
+                                 const shared_ptr<pit::Entry>& pitEntry)
+{
+  if (producer == m_router->GetRingId()) {
+    // local producers are reached through the FIB
+    NFD_LOG_DEBUG(interest << " from=" << inFace.getId() << " local producer not found");
+    noRoute(inFace, interest, pitEntry);
+    return;
+  }
+
+  Interest hinted(interest);
+  hinted.setForwardingHint(DelegationList{{1, ChordRouter::GetNodeName(producer)}});
+  afterReceiveInterest(inFace, hinted, pitEntry);
+}
+
+void
+ChordStrategy::broadcast(const Face& inFace, const Interest& interest,
+                         const shared_ptr<pit::Entry>& pitEntry)
+{
+  std::vector<FaceId> faceIds;
+  for (const Face& face : this->getFaceTable()) {
+    if (face.getScope() == ndn::nfd::FACE_SCOPE_NON_LOCAL && face.getId() != inFace.getId()) {
+      faceIds.push_back(face.getId());
+    }
+  }
+
+  for (FaceId faceId : faceIds) {
+    this->sendInterest(pitEntry, *this->getFace(faceId), interest);
+  }
+
+  if (faceIds.empty()) {
+    this->rejectPendingInterest(pitEntry);
+  }
+}
+
+void
+ChordStrategy::noRoute(const Face& inFace, const Interest& interest,
+                       const shared_ptr<pit::Entry>& pitEntry)
+{
+  lp::NackHeader nackHeader;
+  nackHeader.setReason(lp::NackReason::NO_ROUTE);
+  this->sendNack(pitEntry, inFace, nackHeader);
+
+  this->rejectPendingInterest(pitEntry);
+}
+
+} // namespace fw
+} // namespace nfd
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDNSIM_MODEL_NDN_CHORD_STRATEGY_HPP
+#define NDNSIM_MODEL_NDN_CHORD_STRATEGY_HPP
+
+#include "ns3/ndnSIM/model/ndn-chord-router.hpp"
+
+#include "NFD/daemon/fw/strategy.hpp"
+#include "NFD/daemon/fw/process-nack-traits.hpp"
+
+namespace nfd {
+namespace fw {
+
+/** \brief a forwarding strategy that routes Interests over a Chord ring instead of the FIB
+ *
+ *  Requires ns3::ndn::ChordRouter on the node (see ns3::ndn::ChordRoutingHelper).
+ *
+ *  - Interests that a local application (producer, NFD management) has a FIB entry for are
+ *    delivered to it.
+ *  - /chord/hello Interests from a local application are sent to every non-local face, those
+ *    from other nodes are delivered to the local ns3::ndn::ChordAgent.
+ *  - Other /chord Interests carry their ring key as third component.  They are sent to the known
+ *    member whose identifier most closely precedes the key, the member that knows no closer one
+ *    delivers them to its ChordAgent.
+ *  - Content Interests are keyed by the hash of their first components (ChordRouter::GetKey).
+ *    The first node resolves the key to its producer through the ChordAgent (result is cached)
+ *    and adds forwarding hint /chord/node/<producer>.
+ *  - Interests with forwarding hint /chord/node/<id> are sent to the known member most closely
+ *    preceding id, the hint is stripped at the producer by its network region table.
+ *
+ *  Routes towards members are learned from incoming /chord Interests (origin) and Data
+ *  (responder, its successor and predecessor).  A member whose route leads back to the incoming
+ *  face is skipped for the next closest one.  Interests that cannot be routed are rejected with
+ *  Nack NoRoute, Nacks from upstream are returned downstream once every upstream has Nacked.
+ */
+class ChordStrategy : public Strategy
+                    , public ProcessNackTraits<ChordStrategy>
+{
+public:
+  explicit
+  ChordStrategy(Forwarder& forwarder, const Name& name = getStrategyName());
+
+  static const Name&
+  getStrategyName();
+
+  void
+  afterReceiveInterest(const Face& inFace, const Interest& interest,
+                       const shared_ptr<pit::Entry>& pitEntry) override;
+
+  void
+  beforeSatisfyInterest(const shared_ptr<pit::Entry>& pitEntry,
+                        const Face& inFace, const Data& data) override;
+
+  void
+  afterReceiveNack(const Face& inFace, const lp::Nack& nack,
+                   const shared_ptr<pit::Entry>& pitEntry) override;
+
+private:
+  friend ProcessNackTraits<ChordStrategy>;
+
+  ns3::Ptr<ns3::ndn::ChordRouter>
+  getRouter();
+
+  /** \brief send Interest to FIB nexthops on local faces
+   *  \return whether Interest was sent
+   */
+  bool
+  forwardToLocal(const Face& inFace, const Interest& interest,
+                 const shared_ptr<pit::Entry>& pitEntry);
+
+  /** \brief Face of the route towards a member, nullptr if unknown or leading back to inFace
+   */
+  Face*
+  getMemberFace(uint64_t id, const Face& inFace, const Interest& interest);
+
+  void
+  forwardToMember(uint64_t id, const Face& inFace, const Interest& interest,
+                  const shared_ptr<pit::Entry>& pitEntry);
+
+  /** \brief Forward a content Interest towards the producer of key, resolving it through the
+   *         ChordAgent unless already known
+   */
+  void
+  resolve(uint64_t key, const Face& inFace, const Interest& interest,
+          const shared_ptr<pit::Entry>& pitEntry);
+
+  void
+  forwardToProducer(uint64_t producer, const Face& inFace, const Interest& interest,
+                    const shared_ptr<pit::Entry>& pitEntry);
+
+  void
+  broadcast(const Face& inFace, const Interest& interest,
+            const shared_ptr<pit::Entry>& pitEntry);
+
+  void
+  noRoute(const Face& inFace, const Interest& interest,
+          const shared_ptr<pit::Entry>& pitEntry);
+
+private:
+  ns3::Ptr<ns3::ndn::ChordRouter> m_router;
+};
+
+} // namespace fw
+} // namespace nfd
+
+#endif // NDNSIM_MODEL_NDN_CHORD_STRATEGY_HPP
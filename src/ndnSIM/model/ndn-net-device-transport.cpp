@@ -103,8 +103,8 @@ NetDeviceTransport::doSend(Packet&& packet)
   NS_LOG_FUNCTION(this << "Sending packet from netDevice with URI"
                   << this->getLocalUri());
 
-  // convert NFD packet to NS3 packet
-  BlockHeader header(packet);
+  // convert NFD packet to NS3 packet, the wire is copied only into the NS3 packet buffer
+  BlockHeader header(std::move(packet));
 
   Ptr<ns3::Packet> ns3Packet = Create<ns3::Packet>();
   ns3Packet->AddHeader(header);
@@ -124,11 +124,8 @@ NetDeviceTransport::receiveFromNetDevice(Ptr<NetDevice> device,
 {
   NS_LOG_FUNCTION(device << p << protocol << from << to << packetType);
 
-  // Convert NS3 packet to NFD packet
-  Ptr<ns3::Packet> packet = p->Copy();
-
-  BlockHeader header;
-  packet->RemoveHeader(header);
+  // Convert NS3 packet to NFD packet, decoding straight from the received packet's buffer
+  BlockHeader header(*p);
 
   auto nfdPacket = Packet(std::move(header.getBlock()));
 
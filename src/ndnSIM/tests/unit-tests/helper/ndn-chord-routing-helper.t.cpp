@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2011-2015  Regents of the University of California.
+ *
+ * This file is part of ndnSIM. See AUTHORS for complete list of ndnSIM authors and
+ * contributors.
+ *
+ * ndnSIM is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "helper/ndn-chord-routing-helper.hpp"
+
+#include "model/ndn-chord-router.hpp"
+#include "helper/ndn-app-helper.hpp"
+#include "apps/ndn-app.hpp"
+
+#include "../tests-common.hpp"
+
+#include <map>
+
+namespace ns3 {
+namespace ndn {
+
+BOOST_AUTO_TEST_SUITE(HelperChordRoutingHelper)
+
+BOOST_FIXTURE_TEST_CASE(RouterClosestPreceding, CleanupFixture)
+{
+  Ptr<ChordRouter> router = CreateObject<ChordRouter>();
+  router->SetRingId(100);
+
+  uint64_t id = 0;
+  BOOST_CHECK_EQUAL(router->FindClosestPreceding(150, id), false);
+
+  router->SetJoined();
+  BOOST_CHECK_EQUAL(router->FindClosestPreceding(150, id), true);
+  BOOST_CHECK_EQUAL(id, 100);
+  BOOST_CHECK_EQUAL(router->IsResponsible(150), true);
+
+  router->LearnRoute(200, 1, 1);
+  router->LearnRoute(50, 2, 1);
+  router->SetSuccessor(200);
+
+  BOOST_CHECK_EQUAL(router->FindClosestPreceding(150, id), true);
+  BOOST_CHECK_EQUAL(id, 100);
+  BOOST_CHECK_EQUAL(router->FindClosestPreceding(200, id), true);
+  BOOST_CHECK_EQUAL(id, 200);
+  BOOST_CHECK_EQUAL(router->FindClosestPreceding(70, id), true);
+  BOOST_CHECK_EQUAL(id, 50);
+  // wraps around the ring
+  BOOST_CHECK_EQUAL(router->FindClosestPreceding(10, id), true);
+  BOOST_CHECK_EQUAL(id, 200);
+
+  BOOST_CHECK_EQUAL(router->IsResponsible(100), true);
+  BOOST_CHECK_EQUAL(router->IsResponsible(199), true);
+  BOOST_CHECK_EQUAL(router->IsResponsible(200), false);
+  BOOST_CHECK_EQUAL(router->IsResponsible(50), false);
+
+  // longer route over another face does not replace the existing one
+  router->LearnRoute(200, 3, 2);
+  BOOST_CHECK_EQUAL(router->FindRoute(200)->face, 1);
+  router->LearnRoute(200, 3, 0);
+  BOOST_CHECK_EQUAL(router->FindRoute(200)->face, 3);
+}
+
+class ChordRoutingHelperFixture : public ScenarioHelperWithCleanupFixture
+{
+public:
+  ChordRoutingHelperFixture()
+  {
+    Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("10Mbps"));
+    Config::SetDefault("ns3::PointToPointChannel::Delay", StringValue("10ms"));
+    Config::SetDefault("ns3::QueueBase::MaxPackets", UintegerValue(20));
+
+    // 1 -- 2 -- 3 -- 4
+    //      |
+    //      5
+    createTopology({
+        {"1", "2"},
+        {"2", "3"},
+        {"3", "4"},
+        {"2", "5"}
+      });
+
+    for (const std::string& name : {"1", "2", "3", "4", "5"}) {
+      nodes.Add(getNode(name));
+    }
+  }
+
+public:
+  NodeContainer nodes;
+};
+
+static void
+CountSatisfied(size_t* nSatisfied, Ptr<App> app, uint32_t seqno, Time delay, uint32_t retxCount,
+               int32_t hopCount)
+{
+  (*nSatisfied)++;
+}
+
+BOOST_FIXTURE_TEST_SUITE(Scenario, ChordRoutingHelperFixture)
+
+BOOST_AUTO_TEST_CASE(RingForms)
+{
+  ChordRoutingHelper chordRoutingHelper;
+  ApplicationContainer agents;
+  BOOST_CHECK_NO_THROW(agents = chordRoutingHelper.Install(nodes));
+  BOOST_CHECK_EQUAL(agents.GetN(), 5);
+
+  Simulator::Stop(chordRoutingHelper.GetLastJoinTime() + Seconds(5.0));
+  Simulator::Run();
+
+  std::map<uint64_t, Ptr<ChordRouter>> ring;
+  for (NodeContainer::Iterator node = nodes.Begin(); node != nodes.End(); node++) {
+    Ptr<ChordRouter> router = (*node)->GetObject<ChordRouter>();
+    BOOST_REQUIRE(router != nullptr);
+    BOOST_CHECK_EQUAL(router->IsJoined(), true);
+    ring[router->GetRingId()] = router;
+  }
+  BOOST_REQUIRE_EQUAL(ring.size(), 5);
+
+  for (auto member = ring.begin(); member != ring.end(); ++member) {
+    auto next = std::next(member) == ring.end() ? ring.begin() : std::next(member);
+    BOOST_CHECK_EQUAL(member->second->GetSuccessor(), next->first);
+    BOOST_CHECK(member->second->FindRoute(next->first) != nullptr);
+    BOOST_REQUIRE_EQUAL(next->second->HasPredecessor(), true);
+    BOOST_CHECK_EQUAL(next->second->GetPredecessor(), member->first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InterestsSatisfied)
+{
+  ChordRoutingHelper chordRoutingHelper;
+  chordRoutingHelper.Install(nodes);
+  chordRoutingHelper.AddOrigin("/prefix", getNode("4"));
+
+  Time start = chordRoutingHelper.GetLastJoinTime() + Seconds(5.0);
+  addApps({
+      {"4", "ns3::ndn::Producer", {{"Prefix", "/prefix"}, {"PayloadSize", "100"}}, "0s", "100s"}
+    });
+
+  AppHelper consumerHelper("ns3::ndn::ConsumerCbr");
+  consumerHelper.SetPrefix("/prefix");
+  consumerHelper.SetAttribute("Frequency", StringValue("10"));
+  ApplicationContainer consumer = consumerHelper.Install(getNode("5"));
+  consumer.Start(start);
+  consumer.Stop(start + Seconds(1.0) - MilliSeconds(1));
+
+  size_t nSatisfied = 0;
+  consumer.Get(0)->TraceConnectWithoutContext("FirstInterestDataDelay",
+                                              MakeBoundCallback(&CountSatisfied, &nSatisfied));
+
+  Simulator::Stop(start + Seconds(2.0));
+  Simulator::Run();
+
+  BOOST_CHECK_EQUAL(nSatisfied, 10);
+
+  // only Chord routes, no FIB entry for the producer's prefix outside the producer
+  for (const std::string& name : {"1", "2", "3", "5"}) {
+    nfd::Fib& fib = getNode(name)->GetObject<L3Protocol>()->getForwarder()->getFib();
+    BOOST_CHECK(fib.findExactMatch("/prefix") == nullptr);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace ndn
+} // namespace ns3
@@ -190,6 +190,101 @@ BOOST_AUTO_TEST_CASE(CalculateRoutesBasedOnLinkDelay)
   }
 }
 
+BOOST_AUTO_TEST_CASE(CalculateRoutesOnThreads)
+{
+  PointToPointHelper p2p;
+  PointToPointGridHelper grid(4, 4, p2p);
+  grid.BoundingBox(100, 100, 200, 200);
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndnGlobalRoutingHelper.InstallAll();
+  ndnGlobalRoutingHelper.AddOrigin("/prefix", grid.GetNode(0, 0));
+
+  ndn::GlobalRoutingHelper::SetCalculationThreads(3);
+  ndn::GlobalRoutingHelper::CalculateRoutes();
+  ndn::GlobalRoutingHelper::SetCalculationThreads(0);
+
+  Simulator::Stop(Seconds(1));
+  Simulator::Run();
+
+  auto getNextHops = [&] (uint32_t row, uint32_t col) -> const nfd::fib::NextHopList& {
+    auto l3 = grid.GetNode(row, col)->GetObject<ndn::L3Protocol>();
+    const nfd::fib::Entry* entry = l3->getForwarder()->getFib().findExactMatch("/prefix");
+    BOOST_REQUIRE(entry != nullptr);
+    return entry->getNextHops();
+  };
+
+  BOOST_REQUIRE_EQUAL(getNextHops(0, 1).size(), 1);
+  uint64_t linkCost = getNextHops(0, 1).begin()->getCost();
+  for (uint32_t row = 0; row < 4; row++) {
+    for (uint32_t col = 0; col < 4; col++) {
+      if (row == 0 && col == 0)
+        continue;
+      BOOST_REQUIRE_EQUAL(getNextHops(row, col).size(), 1);
+      BOOST_CHECK_EQUAL(getNextHops(row, col).begin()->getCost(), (row + col) * linkCost);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(UpdateRoutesOnLinkFailure)
+{
+  PointToPointHelper p2p;
+  PointToPointGridHelper grid(3, 3, p2p);
+  grid.BoundingBox(100, 100, 200, 200);
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndnGlobalRoutingHelper.InstallAll();
+  ndnGlobalRoutingHelper.AddOrigin("/prefix", grid.GetNode(0, 0));
+
+  ndn::GlobalRoutingHelper::SetIncrementalUpdates(true);
+  ndn::GlobalRoutingHelper::CalculateRoutes();
+  ndn::GlobalRoutingHelper::SetIncrementalUpdates(false);
+
+  auto getNextHops = [&] (uint32_t row, uint32_t col) -> const nfd::fib::NextHopList& {
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+
+    auto l3 = grid.GetNode(row, col)->GetObject<ndn::L3Protocol>();
+    const nfd::fib::Entry* entry = l3->getForwarder()->getFib().findExactMatch("/prefix");
+    BOOST_REQUIRE(entry != nullptr);
+    return entry->getNextHops();
+  };
+
+  auto getNeighbor = [] (const nfd::fib::NextHop& nextHop) {
+    auto transport = dynamic_cast<NetDeviceTransport*>(nextHop.getFace().getTransport());
+    BOOST_REQUIRE(transport != nullptr);
+    Ptr<Channel> channel = transport->GetNetDevice()->GetChannel();
+    Ptr<Node> node = channel->GetDevice(0)->GetNode();
+    return node != transport->GetNetDevice()->GetNode() ? node : channel->GetDevice(1)->GetNode();
+  };
+
+  BOOST_REQUIRE_EQUAL(getNextHops(0, 1).size(), 1);
+  uint64_t linkCost = getNextHops(0, 1).begin()->getCost();
+  BOOST_CHECK_EQUAL(getNeighbor(*getNextHops(0, 1).begin()), grid.GetNode(0, 0));
+
+  ndn::GlobalRoutingHelper::FailLink(grid.GetNode(0, 0), grid.GetNode(0, 1));
+  BOOST_REQUIRE_EQUAL(getNextHops(0, 1).size(), 1);
+  BOOST_CHECK_EQUAL(getNextHops(0, 1).begin()->getCost(), 3 * linkCost);
+  BOOST_CHECK_EQUAL(getNeighbor(*getNextHops(0, 1).begin()), grid.GetNode(1, 1));
+  BOOST_REQUIRE_EQUAL(getNextHops(0, 2).size(), 1);
+  BOOST_CHECK_EQUAL(getNextHops(0, 2).begin()->getCost(), 4 * linkCost);
+  BOOST_REQUIRE_EQUAL(getNextHops(1, 1).size(), 1);
+  BOOST_CHECK_EQUAL(getNextHops(1, 1).begin()->getCost(), 2 * linkCost);
+
+  ndn::GlobalRoutingHelper::UpLink(grid.GetNode(0, 1), grid.GetNode(0, 0));
+  BOOST_REQUIRE_EQUAL(getNextHops(0, 1).size(), 1);
+  BOOST_CHECK_EQUAL(getNextHops(0, 1).begin()->getCost(), linkCost);
+  BOOST_CHECK_EQUAL(getNeighbor(*getNextHops(0, 1).begin()), grid.GetNode(0, 0));
+  BOOST_REQUIRE_EQUAL(getNextHops(0, 2).size(), 1);
+  BOOST_CHECK_EQUAL(getNextHops(0, 2).begin()->getCost(), 2 * linkCost);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace ndn
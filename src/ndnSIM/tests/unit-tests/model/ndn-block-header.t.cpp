@@ -155,6 +155,66 @@ BOOST_AUTO_TEST_CASE(PrintLpPacket)
   }
 }
 
+BOOST_AUTO_TEST_CASE(DecodeFromPacket)
+{
+  Interest interest("/prefix");
+  interest.setNonce(10);
+  lp::Packet lpPacket(interest.wireEncode());
+  Block wire = lpPacket.wireEncode();
+
+  Ptr<Packet> packet = Create<Packet>();
+  packet->AddHeader(BlockHeader(nfd::face::Transport::Packet(Block(wire))));
+
+  {
+    BlockHeader header;
+    BOOST_CHECK_EQUAL(packet->PeekHeader(header), 18);
+    BOOST_CHECK(header.getBlock() == wire);
+    BOOST_CHECK_EQUAL(header.getBlock().type(), ::ndn::tlv::Interest);
+  }
+
+  {
+    BlockHeader header(*packet);
+    BOOST_CHECK(header.getBlock() == wire);
+    BOOST_CHECK_EQUAL(packet->GetSize(), 18);
+  }
+
+  // link layer padding after the block
+  packet->AddPaddingAtEnd(20);
+  {
+    BlockHeader header(*packet);
+    BOOST_CHECK(header.getBlock() == wire);
+
+    BlockHeader peeked;
+    BOOST_CHECK_EQUAL(packet->PeekHeader(peeked), 18);
+    BOOST_CHECK(peeked.getBlock() == wire);
+  }
+
+  // truncated block
+  Ptr<Packet> truncated = Create<Packet>(wire.wire(), wire.size() - 1);
+  BOOST_CHECK_THROW(BlockHeader header(*truncated), ::ndn::tlv::Error);
+  {
+    BlockHeader header;
+    BOOST_CHECK_THROW(truncated->PeekHeader(header), ::ndn::tlv::Error);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DecodeLargeTypeLength)
+{
+  // TLV-LENGTH in 3 octets
+  Data data("/other/prefix");
+  data.setContent(std::make_shared< ::ndn::Buffer>(1024));
+  ndn::StackHelper::getKeyChain().sign(data);
+  Block wire(lp::tlv::LpPacket, data.wireEncode());
+  wire.encode();
+  BOOST_REQUIRE_GT(wire.size() - wire.value_size(), 2);
+
+  Ptr<Packet> packet = Create<Packet>(wire.wire(), wire.size());
+  BlockHeader header;
+  BOOST_CHECK_EQUAL(packet->RemoveHeader(header), wire.size());
+  BOOST_CHECK(header.getBlock() == wire);
+  BOOST_CHECK_EQUAL(packet->GetSize(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace ndn